@@ -2,8 +2,13 @@
 
 #include "desk_up_backend_interface.h"
 #include "window_core.h"
+#include "restore_plan.h"
+#include "mapped_workspace.h"
+#include "workspace_manifest.h"
 #include <filesystem>
+#include <fstream>
 #include <string>
+#include <vector>
 
 namespace fs = std::filesystem;
 
@@ -141,10 +146,74 @@ static void BM_CompleteWorkspaceCycle(benchmark::State& state) {
     DU_Destroy();
 }
 
+// Writes the manifest of a workspace of state.range(0) windows, spread over 16 executables, and returns its file
+static fs::path makePlannedWorkspace(benchmark::State& state) {
+    auto dir = fs::temp_directory_path() / "deskup_benchmark_restore_plan";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    std::vector<windowDesc> windows;
+    for (int64_t i = 0; i < state.range(0); i++) {
+        windows.push_back(windowDesc("window" + std::to_string(i), int(i), int(i) * 2, 800, 600,
+            "C:\\Program Files\\App\\App" + std::to_string(i % 16) + ".exe"));
+    }
+
+    fs::path manifest = dir / DeskUp::Workspace::MANIFEST_FILE_NAME;
+    DeskUp::Workspace::writeManifest(manifest, windows);
+    return manifest;
+}
+
+// What a restore does with no valid cached plan: map the manifest, then check, decode and group every record
+static void BM_LoadPlanCompiled(benchmark::State& state) {
+    fs::path manifest = makePlannedWorkspace(state);
+
+    for (auto _ : state) {
+        auto mapped = DeskUp::Workspace::MappedWorkspace::open(manifest);
+        auto plan = DeskUp::Restore::compilePlan(mapped.value().view(), DeskUp::Restore::planStamp(mapped.value().bytes()).value_or(0));
+        benchmark::DoNotOptimize(plan);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    fs::remove_all(manifest.parent_path());
+}
+
+// What a restore does with a valid cached plan: read the header of the manifest, then the plan
+static void BM_LoadPlanCached(benchmark::State& state) {
+    fs::path manifest = makePlannedWorkspace(state);
+    fs::path file = manifest.parent_path() / "plan";
+
+    {
+        auto mapped = DeskUp::Workspace::MappedWorkspace::open(manifest);
+        auto stamp = DeskUp::Restore::planStamp(mapped.value().bytes()).value_or(0);
+        DeskUp::Restore::writePlan(file, DeskUp::Restore::compilePlan(mapped.value().view(), stamp));
+    }
+
+    for (auto _ : state) {
+        std::string header(sizeof(DeskUp::Workspace::ManifestHeader), '\0');
+        std::ifstream in(manifest, std::ios::in | std::ios::binary);
+        in.read(header.data(), header.size());
+
+        auto stamp = DeskUp::Restore::planStamp(header);
+        auto plan = DeskUp::Restore::readPlan(file);
+        if (!plan.has_value() || plan.value().stamp != stamp) {
+            state.SkipWithError("Stale or unreadable plan");
+            break;
+        }
+        benchmark::DoNotOptimize(plan);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    fs::remove_all(manifest.parent_path());
+}
+
 BENCHMARK(BM_IsWorkspaceValid);
 BENCHMARK(BM_ExistsWorkspace);
 BENCHMARK(BM_ExistsFile);
 BENCHMARK(BM_SaveAllWindowsLocal);
 BENCHMARK(BM_RestoreWindows);
 BENCHMARK(BM_RemoveWorkspace);
-BENCHMARK(BM_CompleteWorkspaceCycle);
\ No newline at end of file
+BENCHMARK(BM_CompleteWorkspaceCycle);
+BENCHMARK(BM_LoadPlanCompiled)->Arg(16)->Arg(256)->Arg(4096);
+BENCHMARK(BM_LoadPlanCached)->Arg(16)->Arg(256)->Arg(4096);
\ No newline at end of file
@@ -1,7 +1,20 @@
 #include <benchmark/benchmark.h>
 
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
 #include "window_core.h"
+#include "window_core_backend.h"
 #include "desk_up_window_device.h"
+#include "desk_up_window_backend.h"
+#include "window_desc_loader.h"
+#include "window_desc_schema.h"
+#include "workspace_manifest.h"
+#include "crc32c.h"
+#include "workspace_writer.h"
 
 // Benchmark device initialization
 static void BM_CreateWindowDevice(benchmark::State& state) {
@@ -12,6 +25,21 @@ static void BM_CreateWindowDevice(benchmark::State& state) {
     }
 }
 
+// The window the per-window queries are benchmarked on: the first open window, found through the device
+static windowHandle benchmarkWindow() {
+    if (!current_window_backend->selectOpenWindow) {
+        return nullptr;
+    }
+
+    auto windows = current_window_backend->getAllOpenWindows(current_window_backend.get());
+    if (!windows.has_value() || windows->empty()) {
+        return nullptr;
+    }
+
+    auto window = current_window_backend->selectOpenWindow(current_window_backend.get(), windows->front());
+    return window.has_value() ? *window : nullptr;
+}
+
 // Benchmark getting window geometry (X position)
 static void BM_GetWindowXPos(benchmark::State& state) {
     DU_Init();
@@ -20,8 +48,15 @@ static void BM_GetWindowXPos(benchmark::State& state) {
         return;
     }
 
+    windowHandle window = benchmarkWindow();
+    if (!window) {
+        state.SkipWithError("No open window");
+        DU_Destroy();
+        return;
+    }
+
     for (auto _ : state) {
-        auto result = current_window_backend->getWindowXPos(current_window_backend.get());
+        auto result = current_window_backend->getWindowXPos(current_window_backend.get(), window);
         benchmark::DoNotOptimize(result);
     }
 
@@ -36,8 +71,15 @@ static void BM_GetWindowYPos(benchmark::State& state) {
         return;
     }
 
+    windowHandle window = benchmarkWindow();
+    if (!window) {
+        state.SkipWithError("No open window");
+        DU_Destroy();
+        return;
+    }
+
     for (auto _ : state) {
-        auto result = current_window_backend->getWindowYPos(current_window_backend.get());
+        auto result = current_window_backend->getWindowYPos(current_window_backend.get(), window);
         benchmark::DoNotOptimize(result);
     }
 
@@ -52,8 +94,15 @@ static void BM_GetWindowWidth(benchmark::State& state) {
         return;
     }
 
+    windowHandle window = benchmarkWindow();
+    if (!window) {
+        state.SkipWithError("No open window");
+        DU_Destroy();
+        return;
+    }
+
     for (auto _ : state) {
-        auto result = current_window_backend->getWindowWidth(current_window_backend.get());
+        auto result = current_window_backend->getWindowWidth(current_window_backend.get(), window);
         benchmark::DoNotOptimize(result);
     }
 
@@ -68,8 +117,15 @@ static void BM_GetWindowHeight(benchmark::State& state) {
         return;
     }
 
+    windowHandle window = benchmarkWindow();
+    if (!window) {
+        state.SkipWithError("No open window");
+        DU_Destroy();
+        return;
+    }
+
     for (auto _ : state) {
-        auto result = current_window_backend->getWindowHeight(current_window_backend.get());
+        auto result = current_window_backend->getWindowHeight(current_window_backend.get(), window);
         benchmark::DoNotOptimize(result);
     }
 
@@ -84,11 +140,18 @@ static void BM_GetAllWindowGeometry(benchmark::State& state) {
         return;
     }
 
+    windowHandle window = benchmarkWindow();
+    if (!window) {
+        state.SkipWithError("No open window");
+        DU_Destroy();
+        return;
+    }
+
     for (auto _ : state) {
-        auto x = current_window_backend->getWindowXPos(current_window_backend.get());
-        auto y = current_window_backend->getWindowYPos(current_window_backend.get());
-        auto w = current_window_backend->getWindowWidth(current_window_backend.get());
-        auto h = current_window_backend->getWindowHeight(current_window_backend.get());
+        auto x = current_window_backend->getWindowXPos(current_window_backend.get(), window);
+        auto y = current_window_backend->getWindowYPos(current_window_backend.get(), window);
+        auto w = current_window_backend->getWindowWidth(current_window_backend.get(), window);
+        auto h = current_window_backend->getWindowHeight(current_window_backend.get(), window);
         benchmark::DoNotOptimize(x);
         benchmark::DoNotOptimize(y);
         benchmark::DoNotOptimize(w);
@@ -106,8 +169,15 @@ static void BM_GetPathFromWindow(benchmark::State& state) {
         return;
     }
 
+    windowHandle window = benchmarkWindow();
+    if (!window) {
+        state.SkipWithError("No open window");
+        DU_Destroy();
+        return;
+    }
+
     for (auto _ : state) {
-        auto result = current_window_backend->getPathFromWindow(current_window_backend.get());
+        auto result = current_window_backend->getPathFromWindow(current_window_backend.get(), window);
         benchmark::DoNotOptimize(result);
     }
 
@@ -147,6 +217,295 @@ static void BM_GetDeskUpPath(benchmark::State& state) {
     DU_Destroy();
 }
 
+// Geometry of the benchmark window, queried through backend
+template <DeskUp::Backend::WindowBackend B>
+static void queryGeometryThrough(benchmark::State& state, B backend) {
+    windowHandle window = benchmarkWindow();
+    if (!window) {
+        state.SkipWithError("No open window");
+        return;
+    }
+
+    for (auto _ : state) {
+        auto result = backend.getWindowGeometry(window);
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+// Benchmark the geometry query through the function pointers of the device (plugins, tests, multi-platform builds)
+static void BM_GetWindowGeometryDeviceBackend(benchmark::State& state) {
+    DU_Init();
+    if (!current_window_backend) {
+        state.SkipWithError("Backend not initialized");
+        return;
+    }
+
+    queryGeometryThrough(state, DeskUp::Backend::DeviceBackend{current_window_backend.get()});
+
+    DU_Destroy();
+}
+
+#if defined(DESKUP_STATIC_BACKEND) && defined(_WIN32)
+// Benchmark the same query through the backend bound at compile time, as DU_WithBackend picks it on single-platform builds
+static void BM_GetWindowGeometryStaticBackend(benchmark::State& state) {
+    DU_Init();
+    if (!WinWindowBackend::owns(current_window_backend.get())) {
+        state.SkipWithError("Backend not initialized");
+        DU_Destroy();
+        return;
+    }
+
+    queryGeometryThrough(state, WinWindowBackend{current_window_backend.get()});
+
+    DU_Destroy();
+}
+#endif
+
+// A geometry query that does no work, so that the dispatch benchmarks only measure how it is reached
+static DeskUp::Result<windowGeometry> noopGeometry(DeskUpWindowDevice *, windowHandle) {
+    return windowGeometry{1, 2, 3, 4};
+}
+
+// Dispatch cost alone: an indirect call through the function pointer of a device
+static void BM_DispatchDevicePointer(benchmark::State& state) {
+    DeskUpWindowDevice device{};
+    device.getWindowGeometry = noopGeometry;
+    DeskUpWindowDevice * target = &device;
+
+    for (auto _ : state) {
+        // the pointer is opaque to the optimizer, as it is for a device created at runtime
+        benchmark::DoNotOptimize(target);
+        auto result = target->getWindowGeometry(target, nullptr);
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+// Dispatch cost alone: the same function called directly, as a static backend does
+static void BM_DispatchStatic(benchmark::State& state) {
+    DeskUpWindowDevice device{};
+    DeskUpWindowDevice * target = &device;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(target);
+        auto result = noopGeometry(target, nullptr);
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+// Writes a legacy workspace (one 5-line file per window) with state.range(0) windows
+static std::filesystem::path makeLegacyWorkspace(benchmark::State& state) {
+    auto dir = std::filesystem::temp_directory_path() / "deskup_benchmark_legacy_workspace";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    for (int64_t i = 0; i < state.range(0); i++) {
+        windowDesc w("window" + std::to_string(i), int(i), int(i) * 2, 800, 600, "C:\\Program Files\\App\\app" + std::to_string(i) + ".exe");
+        w.saveTo(dir / w.name);
+    }
+
+    return dir;
+}
+
+// Benchmark loading a whole legacy workspace with a single reused loader
+static void BM_LoadManyLegacyWorkspace(benchmark::State& state) {
+    auto dir = makeLegacyWorkspace(state);
+
+    windowDescLoader loader;
+    std::vector<windowDesc> windows;
+    windows.reserve(state.range(0));
+
+    for (auto _ : state) {
+        windows.clear();
+        int res = loader.loadMany(dir, windows);
+        benchmark::DoNotOptimize(res);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    std::filesystem::remove_all(dir);
+}
+
+// Benchmark parsing a single window file already in memory
+static void BM_ParseLegacyWindow(benchmark::State& state) {
+    const std::string text = "\"C:\\\\Program Files\\\\App\\\\app.exe\"\n120\n-40\n1280\n720";
+
+    for (auto _ : state) {
+        windowDesc w;
+        int res = windowDescLoader::parse(text, w);
+        benchmark::DoNotOptimize(res);
+        benchmark::DoNotOptimize(w);
+    }
+}
+
+// Baseline: the hand-written writer windowDesc::saveTo used before the field table
+static void BM_SerializeHandWritten(benchmark::State& state) {
+    windowDesc w("app", 120, -40, 1280, 720, "C:\\Program Files\\App\\app.exe");
+
+    for (auto _ : state) {
+        std::ostringstream out;
+        out << w.pathToExec.string() << '\n' << w.x << '\n' << w.y << '\n' << w.w << '\n' << w.h;
+        benchmark::DoNotOptimize(out.str());
+    }
+}
+
+// Benchmark the writer generated from the windowDesc field table
+static void BM_SerializeFieldTable(benchmark::State& state) {
+    windowDesc w("app", 120, -40, 1280, 720, "C:\\Program Files\\App\\app.exe");
+    std::string out;
+
+    for (auto _ : state) {
+        out.clear();
+        windowDescSchema::write(w, out);
+        benchmark::DoNotOptimize(out);
+    }
+}
+
+// Baseline: the hand-written getline/stoi reader WIN_recoverSavedWindow used before the field table
+static void BM_ParseHandWritten(benchmark::State& state) {
+    const std::string text = "C:\\Program Files\\App\\app.exe\n120\n-40\n1280\n720";
+
+    for (auto _ : state) {
+        std::istringstream in(text);
+        std::string line;
+        windowDesc w;
+        int i = 0;
+
+        while (std::getline(in, line)) {
+            try {
+                switch (i) {
+                    case 0: w.pathToExec = line; w.name = w.pathToExec.stem().string(); break;
+                    case 1: w.x = std::stoi(line); break;
+                    case 2: w.y = std::stoi(line); break;
+                    case 3: w.w = std::stoi(line); break;
+                    case 4: w.h = std::stoi(line); break;
+                    default: break;
+                }
+            } catch (...) {
+                state.SkipWithError("parse failed");
+            }
+            i++;
+        }
+
+        benchmark::DoNotOptimize(w);
+    }
+}
+
+// Benchmark the reader generated from the windowDesc field table
+static void BM_ParseFieldTable(benchmark::State& state) {
+    const std::string text = "C:\\Program Files\\App\\app.exe\n120\n-40\n1280\n720";
+
+    for (auto _ : state) {
+        windowDesc w;
+        int res = windowDescSchema::parse(text, w);
+        benchmark::DoNotOptimize(res);
+        benchmark::DoNotOptimize(w);
+    }
+}
+
+// Benchmark the CRC32C kernel selected for this CPU over state.range(0) bytes
+static void BM_Crc32c(benchmark::State& state) {
+    std::string data(static_cast<std::size_t>(state.range(0)), '\0');
+    for (std::size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<char>(i * 31);
+    }
+
+    state.SetLabel(DeskUp::Workspace::crc32cIsHardwareAccelerated() ? "sse4.2" : "table");
+
+    for (auto _ : state) {
+        auto crc = DeskUp::Workspace::crc32c(data);
+        benchmark::DoNotOptimize(crc);
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+// Benchmark the startup integrity scan: state.range(0) workspaces of 32 windows each
+static void BM_VerifyWorkspaces(benchmark::State& state) {
+    auto dir = std::filesystem::temp_directory_path() / "deskup_benchmark_verify";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    std::vector<windowDesc> windows;
+    for (int i = 0; i < 32; i++) {
+        windows.emplace_back("window" + std::to_string(i), i, i * 2, 800, 600, "C:\\Program Files\\App\\app" + std::to_string(i % 8) + ".exe");
+    }
+
+    std::vector<std::filesystem::path> manifests;
+    for (int64_t i = 0; i < state.range(0); i++) {
+        manifests.push_back(dir / ("ws" + std::to_string(i) + ".deskup"));
+        if (!DeskUp::Workspace::writeManifest(manifests.back(), windows).has_value()) {
+            state.SkipWithError("Could not write the workspaces");
+            return;
+        }
+    }
+
+    for (auto _ : state) {
+        for (const auto& manifest : manifests) {
+            auto res = DeskUp::Workspace::verifyWorkspace(manifest);
+            benchmark::DoNotOptimize(res);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    std::filesystem::remove_all(dir);
+}
+
+// Windows of the save benchmarks
+static std::vector<windowDesc> makeSaveWindows(int64_t count) {
+    std::vector<windowDesc> windows;
+    for (int64_t i = 0; i < count; i++) {
+        windows.emplace_back("window" + std::to_string(i), int(i), int(i) * 2, 800, 600, "C:\\Program Files\\App\\app" + std::to_string(i) + ".exe");
+    }
+    return windows;
+}
+
+// Baseline: the legacy layout, one file opened and written per window with windowDesc::saveTo
+static void BM_SaveWorkspacePerWindowFiles(benchmark::State& state) {
+    auto dir = std::filesystem::temp_directory_path() / "deskup_benchmark_save_legacy";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    const auto windows = makeSaveWindows(state.range(0));
+
+    for (auto _ : state) {
+        for (auto w : windows) {
+            int res = w.saveTo(dir / w.name);
+            benchmark::DoNotOptimize(res);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    std::filesystem::remove_all(dir);
+}
+
+// Save of state.range(1) windows through WorkspaceWriter, with the durability given by state.range(0)
+static void BM_SaveWorkspaceWriter(benchmark::State& state) {
+    auto dir = std::filesystem::temp_directory_path() / "deskup_benchmark_save_writer";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    const auto mode = static_cast<DeskUp::Workspace::Durability>(state.range(0));
+    const char * labels[] = {"none", "fsync", "atomic_rename"};
+    state.SetLabel(labels[state.range(0)]);
+
+    const auto windows = makeSaveWindows(state.range(1));
+    const auto file = dir / DeskUp::Workspace::MANIFEST_FILE_NAME;
+
+    for (auto _ : state) {
+        DeskUp::Workspace::WorkspaceWriter writer(mode);
+        writer.add(windows);
+
+        auto res = writer.commit(file);
+        if (!res.has_value()) {
+            state.SkipWithError("Could not write the workspace");
+            break;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+    std::filesystem::remove_all(dir);
+}
+
 BENCHMARK(BM_CreateWindowDevice);
 BENCHMARK(BM_GetWindowXPos);
 BENCHMARK(BM_GetWindowYPos);
@@ -155,4 +514,20 @@ BENCHMARK(BM_GetWindowHeight);
 BENCHMARK(BM_GetAllWindowGeometry);
 BENCHMARK(BM_GetPathFromWindow);
 BENCHMARK(BM_GetAllOpenWindows);
-BENCHMARK(BM_GetDeskUpPath);
\ No newline at end of file
+BENCHMARK(BM_GetDeskUpPath);
+BENCHMARK(BM_GetWindowGeometryDeviceBackend);
+#if defined(DESKUP_STATIC_BACKEND) && defined(_WIN32)
+BENCHMARK(BM_GetWindowGeometryStaticBackend);
+#endif
+BENCHMARK(BM_DispatchDevicePointer);
+BENCHMARK(BM_DispatchStatic);
+BENCHMARK(BM_LoadManyLegacyWorkspace)->Arg(8)->Arg(64);
+BENCHMARK(BM_ParseLegacyWindow);
+BENCHMARK(BM_SerializeHandWritten);
+BENCHMARK(BM_SerializeFieldTable);
+BENCHMARK(BM_ParseHandWritten);
+BENCHMARK(BM_ParseFieldTable);
+BENCHMARK(BM_Crc32c)->Arg(64)->Arg(4096)->Arg(1 << 20);
+BENCHMARK(BM_VerifyWorkspaces)->Arg(100)->Arg(500);
+BENCHMARK(BM_SaveWorkspacePerWindowFiles)->Arg(32);
+BENCHMARK(BM_SaveWorkspaceWriter)->ArgsProduct({{0, 1, 2}, {32}});
@@ -0,0 +1,175 @@
+/**
+ * @file async_operation.h
+ * @brief Handle to a save or restore running on its own thread, with progress reporting and cooperative cancellation.
+ *
+ * This file is part of DeskUp
+ *
+ * @details
+ * `DeskUpBackendInterface::saveAllWindowsLocal()` and `DeskUpBackendInterface::restoreWindows()` block until they are done.
+ * Their asynchronous variants return a @ref DeskUp::Async::AsyncOperation right away instead: the result is collected with
+ * @ref DeskUp::Async::AsyncOperation::get, and @ref DeskUp::Async::AsyncOperation::cancel asks the operation to stop
+ * at the next window. The work in flight (a single launch, a single write) is always finished, so nothing is left half done.
+ *
+ * Progress is reported through a @ref DeskUp::Async::ProgressCallback, once every time a window enters a new
+ * @ref DeskUp::Async::Phase.
+ *
+ * @author
+ *   Nicolas Serrano Garcia <serranogarcianicolas@gmail.com>
+ * @date
+ *   2025
+ * @copyright
+ *   Copyright (C) 2025 Nicolas Serrano Garcia
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASYNCOPERATION_H
+#define ASYNCOPERATION_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "desk_up_error.h"
+
+namespace DeskUp::Async {
+
+    /**
+     * @enum Phase
+     * @brief The step a window has just entered.
+     * @version 0.3.4
+     * @date 2025
+     */
+    enum class Phase : std::uint8_t {
+        Saving,     /**< The window was enumerated and handed to the disk writer. */
+        Closing,    /**< The running instances of the window's executable are being closed. */
+        Launching,  /**< The window's executable is being launched. */
+        Placing,    /**< The window is being moved to its saved geometry. */
+        Done        /**< Nothing else will be done to the window. */
+    };
+
+    /**
+     * @struct Progress
+     * @brief A single progress notification.
+     * @version 0.3.4
+     * @date 2025
+     */
+    struct Progress {
+        Phase phase = Phase::Done;
+        std::size_t window = 0;     /**< Index of the window in the workspace. */
+        std::size_t completed = 0;  /**< Windows done so far, this one included if \c phase is `Phase::Done`. */
+        std::size_t total = 0;      /**< Windows in the operation. \c 0 while a save is still enumerating them. */
+    };
+
+    /**
+     * @brief Receives the progress of an operation. Calls are never concurrent, but they come from the operation's worker
+     * threads, so the callback must not block for long and must hand the notification over to the UI thread itself.
+     * @version 0.3.4
+     * @date 2025
+     */
+    using ProgressCallback = std::function<void(const Progress&)>;
+
+    /**
+     * @brief Notifies \c progress, if there is one.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline void notify(const ProgressCallback& progress, Phase phase, std::size_t window, std::size_t completed, std::size_t total){
+        if(progress){
+            progress(Progress{phase, window, completed, total});
+        }
+    }
+
+    /**
+     * @brief The error an operation returns when it stopped because it was cancelled.
+     * @param where Context of the error, as in every other `DeskUp::Error`.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline DeskUp::Error cancelledError(const std::string& where){
+        return DeskUp::Error(DeskUp::Level::Warning, DeskUp::ErrType::Cancelled, 0, where + "|cancelled");
+    }
+
+    /**
+     * @class AsyncOperation
+     * @brief Runs a function on its own thread and holds its result.
+     *
+     * @details The function receives a `std::stop_token` that @ref cancel requests a stop on. Destroying the handle
+     * cancels the operation and waits for it to stop. Exceptions escaping the function are returned as
+     * Level::Error, ErrType::Unexpected errors.
+     *
+     * @tparam T The value type of the `DeskUp::Result` the operation returns (\c void for a `DeskUp::Status`).
+     * @version 0.3.4
+     * @date 2025
+     */
+    template<typename T>
+    class AsyncOperation {
+    public:
+        using Work = std::function<DeskUp::Result<T>(std::stop_token)>;
+
+        /** @brief Starts \c work on a new thread. */
+        explicit AsyncOperation(Work work){
+            std::promise<DeskUp::Result<T>> promise;
+            result = promise.get_future();
+
+            worker = std::jthread([work = std::move(work), promise = std::move(promise)](std::stop_token stop) mutable {
+                try {
+                    promise.set_value(work(stop));
+                }
+                catch(const std::exception& e){
+                    promise.set_value(std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::Unexpected, 0,
+                        std::string("AsyncOperation|exception_") + e.what())));
+                }
+            });
+        }
+
+        AsyncOperation(AsyncOperation&&) noexcept = default;
+        AsyncOperation& operator=(AsyncOperation&&) noexcept = default;
+
+        /** @brief Asks the operation to stop at the next window. Returns right away. */
+        void cancel() noexcept { worker.request_stop(); }
+
+        /** @brief Whether @ref cancel was called. */
+        bool cancelled() const noexcept { return worker.get_stop_token().stop_requested(); }
+
+        /** @brief Whether the result is available, i.e. whether @ref get won't block. */
+        bool ready() const { return waitFor(std::chrono::milliseconds(0)); }
+
+        /** @brief Waits at most \c timeout for the result. Returns whether it is available. */
+        template<typename Rep, typename Period>
+        bool waitFor(std::chrono::duration<Rep, Period> timeout) const {
+            return result.wait_for(timeout) == std::future_status::ready;
+        }
+
+        /**
+         * @brief Blocks until the operation is done and returns its result. Can only be called once.
+         * @errors Whatever the operation returned. Level::Warning, ErrType::Cancelled if it stopped because of @ref cancel.
+         */
+        DeskUp::Result<T> get() { return result.get(); }
+
+    private:
+        //declared first so that it is destroyed after the worker is joined
+        std::future<DeskUp::Result<T>> result;
+        std::jthread worker;
+    };
+}
+
+#endif
@@ -4,11 +4,40 @@
 #include <string>
 #include <filesystem>
 #include <cctype>
+#include <thread>
+#include <algorithm>
+#include <fstream>
+#include <optional>
+#include <mutex>
+#include <atomic>
 
 #include "window_core.h"
+#include "window_core_backend.h"
+#include "workspace_manifest.h"
+#include "mapped_workspace.h"
+#include "workspace_store.h"
+#include "workspace_reclaimer.h"
+#include "bounded_queue.h"
+#include "restore_scheduler.h"
+#include "launch_profile.h"
+#include "restore_plan.h"
 
 namespace fs = std::filesystem;
 
+//windows waiting between the enumeration and the disk writer of a streaming save
+static constexpr std::size_t STREAM_QUEUE_CAPACITY = 64;
+
+//a workspace saved in one go replaces its manifest atomically, as a streamed one does: after a crash, the folder holds either the old one or the new one.
+//Store entries are written the same way, flushed before and after their header
+static constexpr DeskUp::Workspace::Durability SAVE_DURABILITY = DeskUp::Workspace::Durability::AtomicRename;
+
+//the store isn't thread-safe, and async saves and restores reach it from their own thread while the GUI lists or deletes
+//workspaces. Every call into current_workspace_store goes through this mutex, which is never held while windows are enumerated
+static std::mutex storeMutex;
+
+//tells apart the manifests of the streamed saves running at the same time
+static std::atomic<unsigned int> storeSaveCount{0};
+
 //TODO: rewrite the error message to be the actual message you want shown, so as to be more specific with the message shown
 
 static fs::path constructWsDir(std::string workspace){
@@ -29,61 +58,492 @@ static fs::path createDirFromWs(std::string workspace){
 	return workspacePath;
 }
 
-DeskUp::Status DeskUpBackendInterface::saveAllWindowsLocal(std::string workspaceName){
-	//it is mandatory that the files saved have w, h >= 0, 5 LINES, no endl
+//hands path to the background reclaimer, or deletes it right away if there is none
+static void discard(const fs::path& path){
+	if(current_workspace_reclaimer){
+		current_workspace_reclaimer->reclaim(path);
+		return;
+	}
+
+	std::error_code err;
+	fs::remove_all(path, err);
+}
+
+//any file other than the manifest is a window saved with the legacy layout. Once the manifest exists they are never read again
+static void discardLegacyFiles(const fs::path& workspacePath){
+	std::error_code err;
+	for (const auto& file : fs::directory_iterator{workspacePath, err}) {
+		if(file.is_regular_file(err) && file.path().filename() != DeskUp::Workspace::MANIFEST_FILE_NAME){
+			discard(file.path());
+		}
+	}
+}
+
+//enumeration and disk writes overlap: the backend hands each window to a bounded queue as soon as it is described,
+//and a writer thread appends it to the manifest. Only a handful of windows are ever held in memory. The writer is not finished here
+template<DeskUp::Backend::WindowBackend B>
+static DeskUp::Status streamWorkspace(B backend, DeskUp::Workspace::ManifestStreamWriter& writer,
+	std::stop_token stop, const DeskUp::Async::ProgressCallback& progress){
+
+	BoundedQueue<windowDesc> queue(STREAM_QUEUE_CAPACITY);
+	DeskUp::Status writeResult;
+	std::size_t enumerated = 0;
+
+	std::thread diskWriter([&]{
+		while(auto window = queue.pop()){
+			if(auto res = writer.append(*window); !res.has_value()){
+				writeResult = std::move(res);
+				//wakes the enumeration up so that it stops producing
+				queue.close();
+				return;
+			}
+		}
+	});
+
+	DeskUp::Status enumResult = backend.streamOpenWindows([&](windowDesc&& window) -> DeskUp::Status {
+		//the windows already queued are still written, but the manifest is never finished, so it can't be mistaken for a complete one
+		if(stop.stop_requested()){
+			return std::unexpected(DeskUp::Async::cancelledError("saveAllWindowsLocal"));
+		}
+
+		DeskUp::Async::notify(progress, DeskUp::Async::Phase::Saving, enumerated, enumerated, 0);
+		enumerated++;
+
+		if(!queue.push(std::move(window))){
+			return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::Io, 0, "saveAllWindowsLocal|writer_stopped"));
+		}
+		return {};
+	});
+
+	queue.close();
+	diskWriter.join();
+
+	//a failed write is what made the enumeration stop, so it is the one worth reporting
+	if(!writeResult.has_value()){
+		return writeResult;
+	}
+
+	return enumResult;
+}
+
+//without streaming, every window is known at once: last chance to stop before anything is written
+static DeskUp::Status notifyEnumerated(const std::vector<windowDesc>& windows, std::stop_token stop, const DeskUp::Async::ProgressCallback& progress){
+	if(stop.stop_requested()){
+		return std::unexpected(DeskUp::Async::cancelledError("saveAllWindowsLocal"));
+	}
+
+	for(std::size_t i = 0; i < windows.size(); i++){
+		DeskUp::Async::notify(progress, DeskUp::Async::Phase::Saving, i, i, windows.size());
+	}
+
+	return {};
+}
+
+
+//whether the stored manifest already holds exactly these windows, with the same geometry
+static bool isStoredWorkspaceCurrent(std::string_view manifest, const std::vector<windowDesc>& windows){
+
+	auto view = DeskUp::Workspace::WorkspaceView::fromBytes(manifest);
+	if(!view.has_value() || !view.value().hasChecksums() || !DeskUp::Workspace::verifyManifest(manifest).has_value()){
+		return false;
+	}
+
+	auto matches = DeskUp::Workspace::matchRecords(view.value(), windows);
+	if(!matches.has_value()){
+		return false;
+	}
+
+	for(std::size_t w = 0; w < windows.size(); w++){
+		auto record = view.value()[matches.value()[w]];
+		if(record.x() != windows[w].x || record.y() != windows[w].y || record.w() != windows[w].w || record.h() != windows[w].h){
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//streams a complete manifest into file. A failed or cancelled save removes it
+template<DeskUp::Backend::WindowBackend B>
+static DeskUp::Status streamToFile(B backend, const fs::path& file, std::stop_token stop, const DeskUp::Async::ProgressCallback& progress){
+
+	DeskUp::Status res;
+	{
+		auto writer = DeskUp::Workspace::ManifestStreamWriter::open(file);
+		if(!writer.has_value()){
+			res = std::unexpected(std::move(writer.error()));
+		}
+		else{
+			res = streamWorkspace(backend, writer.value(), stop, progress);
+			if(res.has_value()){
+				res = writer->finish();
+			}
+		}
+	}
+
+	//the writer has closed the file by now, so it can be removed or renamed
+	if(!res.has_value()){
+		std::error_code ec;
+		fs::remove(file, ec);
+	}
+
+	return res;
+}
+
+//the manifest is streamed into a file next to it, which only replaces it once complete and on the disk. A failed or cancelled
+//save removes that file and leaves the previous manifest as it was
+template<DeskUp::Backend::WindowBackend B>
+static DeskUp::Status streamToManifest(B backend, const fs::path& manifest, std::stop_token stop, const DeskUp::Async::ProgressCallback& progress){
+
+	fs::path temporary = manifest;
+	temporary += DeskUp::Workspace::ATOMIC_WRITE_SUFFIX;
+
+	if(auto res = streamToFile(backend, temporary, stop, progress); !res.has_value()){
+		return res;
+	}
+
+	return DeskUp::Workspace::publishDurably(temporary, manifest);
+}
+
+//the workspace becomes a single entry appended to the store. The windows are enumerated with the store unlocked (a streamed save
+//goes to a manifest of its own next to the log), so listing or deleting workspaces never waits for a save: only the append does
+template<DeskUp::Backend::WindowBackend B>
+static DeskUp::Status saveToStore(B backend, const std::string& workspaceName, std::stop_token stop, const DeskUp::Async::ProgressCallback& progress){
+
+	if(!backend.canStream()){
+		auto windows = backend.getAllOpenWindows();
+		if(!windows.has_value()){
+			return std::unexpected(std::move(windows.error()));
+		}
+
+		if(auto res = notifyEnumerated(windows.value(), stop, progress); !res.has_value()){
+			return res;
+		}
+
+		const std::string manifest = DeskUp::Workspace::encodeManifest(windows.value());
+
+		std::lock_guard lock(storeMutex);
+		return current_workspace_store->put(workspaceName, manifest, SAVE_DURABILITY);
+	}
+
+	fs::path temporary;
+	{
+		std::lock_guard lock(storeMutex);
+		temporary = current_workspace_store->file();
+	}
+	temporary += "." + std::to_string(storeSaveCount++) + DeskUp::Workspace::ATOMIC_WRITE_SUFFIX;
+
+	DeskUp::Status res = streamToFile(backend, temporary, stop, progress);
+	if(!res.has_value()){
+		return res;
+	}
+
+	{
+		//the mapping has to be gone before the file can be removed
+		auto mapped = DeskUp::Workspace::MappedWorkspace::open(temporary);
+		if(!mapped.has_value()){
+			res = std::unexpected(std::move(mapped.error()));
+		}
+		else{
+			std::lock_guard lock(storeMutex);
+			res = current_workspace_store->put(workspaceName, mapped.value().bytes(), SAVE_DURABILITY);
+		}
+	}
+
+	std::error_code ec;
+	fs::remove(temporary, ec);
+
+	return res;
+}
+
+template<DeskUp::Backend::WindowBackend B>
+static DeskUp::Status saveWorkspaceWith(B backend, const std::string& workspaceName, std::stop_token stop, const DeskUp::Async::ProgressCallback& progress){
+
+	if(current_workspace_store){
+		return saveToStore(backend, workspaceName, stop, progress);
+	}
 
 	fs::path workspacePath = createDirFromWs(workspaceName);
 
-	//get all the open windows
-    auto windows = current_window_backend.get()->getAllOpenWindows(current_window_backend.get());
+	//the whole workspace goes to a single manifest file
+	workspacePath /= DeskUp::Workspace::MANIFEST_FILE_NAME;
+
+	if(backend.canStream()){
+		return streamToManifest(backend, workspacePath, stop, progress);
+	}
+
+	//backends that can't stream: enumerate everything first, then write it in one go
+    auto windows = backend.getAllOpenWindows();
 
     if(!windows.has_value()){
         return std::unexpected(std::move(windows.error()));
     }
 
-    DeskUp::Error lastErr;
+	if(auto res = notifyEnumerated(windows.value(), stop, progress); !res.has_value()){
+		return res;
+	}
 
-	//used to assign different names to windows of the same instance
-	int id = 0;
+	DeskUp::Workspace::WorkspaceWriter writer(SAVE_DURABILITY);
+	writer.add(windows.value());
 
-    for(unsigned int i = 0; i < windows.value().size(); i++){
+	return writer.commit(workspacePath);
+}
 
-		//make a copy of the workspaceDir
-		fs::path copyWs(workspacePath);
+//every window of the save is queried through the backend, bound at compile time on single-platform builds
+static DeskUp::Status saveWorkspace(const std::string& workspaceName, std::stop_token stop, const DeskUp::Async::ProgressCallback& progress){
+	return DU_WithBackend([&](auto backend){
+		return saveWorkspaceWith(backend, workspaceName, stop, progress);
+	});
+}
 
-		//add the file name
-        copyWs /= windows.value()[i].name;
+//the open windows, enumerated through the backend
+static DeskUp::Result<std::vector<windowDesc>> openWindows(){
+	return DU_WithBackend([](auto backend){
+		return backend.getAllOpenWindows();
+	});
+}
 
-        if(existsFile(copyWs)){
-            copyWs += std::to_string(id++);
-        }
+DeskUp::Status DeskUpBackendInterface::saveAllWindowsLocal(std::string workspaceName){
+	return saveWorkspace(workspaceName, {}, {});
+}
 
-        if(int res = windows.value()[i].saveTo(copyWs); res < 0){
+DeskUp::Async::AsyncOperation<void> DeskUpBackendInterface::saveAllWindowsLocalAsync(std::string workspaceName, DeskUp::Async::ProgressCallback progress){
+	return DeskUp::Async::AsyncOperation<void>([workspaceName = std::move(workspaceName), progress = std::move(progress)](std::stop_token stop){
+		return saveWorkspace(workspaceName, stop, progress);
+	});
+}
 
-            auto err = DeskUp::Error::fromSaveError(res);
+DeskUp::Result<unsigned int> DeskUpBackendInterface::updateWorkspace(std::string workspaceName){
 
-			//can only happen if the disk is full
-            if(err.isFatal()){
-                return std::unexpected(std::move(err));
-            }
+    auto windows = openWindows();
 
-			//any other error is not fatal, so save the last one and continue
-            lastErr = err;
-        }
+    if(!windows.has_value()){
+        return std::unexpected(std::move(windows.error()));
     }
 
-	//if no error was set inside the loop, the error gets default initialized to no error
-    if(!lastErr){
-        return {};
+	//entries of the log are never patched in place: a changed workspace gets a new entry, an unchanged one nothing at all
+	if(current_workspace_store){
+		std::lock_guard lock(storeMutex);
+
+		if(auto manifest = current_workspace_store->get(workspaceName); manifest.has_value() && isStoredWorkspaceCurrent(manifest.value(), windows.value())){
+			return 0u;
+		}
+
+		if(auto res = current_workspace_store->put(workspaceName, DeskUp::Workspace::encodeManifest(windows.value()), SAVE_DURABILITY); !res.has_value()){
+			return std::unexpected(std::move(res.error()));
+		}
+
+		return static_cast<unsigned int>(windows.value().size());
+	}
+
+	fs::path workspacePath = createDirFromWs(workspaceName);
+
+	fs::path manifest = workspacePath / DeskUp::Workspace::MANIFEST_FILE_NAME;
+
+	auto delta = DeskUp::Workspace::updateManifest(manifest, windows.value());
+	if(!delta.has_value()){
+		return std::unexpected(std::move(delta.error()));
+	}
+
+	discardLegacyFiles(workspacePath);
+
+	return static_cast<unsigned int>(delta.value().changed);
+}
+
+DeskUp::Status DeskUpBackendInterface::replaceWorkspace(std::string workspaceName){
+
+	//nothing is touched until the new windows are known, so a failed enumeration leaves the old workspace as it was
+    auto windows = openWindows();
+
+    if(!windows.has_value()){
+        return std::unexpected(std::move(windows.error()));
     }
 
-    return std::unexpected(std::move(lastErr));
+	//a single appended entry: the index only switches to it once it is complete, and compaction reclaims the old one
+	if(current_workspace_store){
+		std::lock_guard lock(storeMutex);
+		return current_workspace_store->put(workspaceName, DeskUp::Workspace::encodeManifest(windows.value()), SAVE_DURABILITY);
+	}
+
+	fs::path workspacePath = createDirFromWs(workspaceName);
+
+	//staged next to the manifest and published with one rename
+	DeskUp::Workspace::WorkspaceWriter writer(DeskUp::Workspace::Durability::AtomicRename);
+	writer.add(windows.value());
+
+	if(auto res = writer.commit(workspacePath / DeskUp::Workspace::MANIFEST_FILE_NAME); !res.has_value()){
+		return res;
+	}
+
+	discardLegacyFiles(workspacePath);
+
+	return {};
 }
 
-DeskUp::Status DeskUpBackendInterface::restoreWindows(std::string workspaceName){
+//workspaces saved before the manifest existed hold one 5-line file per window, which the backend knows how to parse
+template<DeskUp::Backend::WindowBackend B>
+static DeskUp::Result<std::vector<windowDesc>> recoverLegacyWorkspace(B backend, const fs::path& workspacePath){
+	std::vector<windowDesc> windows;
+
+	for (const auto& file : fs::directory_iterator{workspacePath}) {
+		if(!file.is_regular_file()){
+			continue;
+		}
+
+		//can't throw fatal errors
+		auto res = backend.recoverSavedWindow(file.path());
+		if (!res.has_value()){
+			std::cout << "Unrecoverable window: " << res.error().what();
+			return std::unexpected(std::move(res.error()));
+		}
+
+		windows.push_back(std::move(res.value()));
+	}
+
+	return windows;
+}
+
+static fs::path planFile(const std::string& workspaceName){
+	return fs::path(DESKUPDIR) / (DeskUp::Restore::RESTORE_PLAN_PREFIX + workspaceName);
+}
+
+//the plan cached by a previous restore is used as long as the manifest didn't change, so the records are only checked, decoded
+//and grouped the first time
+static std::optional<DeskUp::Restore::RestorePlan> cachedPlan(const std::string& workspaceName, std::optional<std::uint64_t> stamp){
+	if(!stamp){
+		return std::nullopt;
+	}
+
+	auto cached = DeskUp::Restore::readPlan(planFile(workspaceName));
+	if(!cached.has_value() || cached.value().stamp != *stamp){
+		return std::nullopt;
+	}
+
+	return std::move(cached.value());
+}
+
+static DeskUp::Restore::RestorePlan compileAndCache(const std::string& workspaceName, std::optional<std::uint64_t> stamp,
+	const DeskUp::Workspace::WorkspaceView& view){
+
+	auto plan = DeskUp::Restore::compilePlan(view, stamp.value_or(0));
+
+	//the plan is only a shortcut, the restore goes on without it
+	if(stamp){
+		if(auto res = DeskUp::Restore::writePlan(planFile(workspaceName), plan); !res.has_value()){
+			std::cout << "Uncached restore plan: " << res.error().what();
+		}
+	}
+
+	return plan;
+}
+
+//only the header is needed to tell whether the cached plan is still valid
+static std::optional<std::uint64_t> manifestStamp(const fs::path& manifest){
+	std::string header(sizeof(DeskUp::Workspace::ManifestHeader), '\0');
+
+	std::ifstream in(manifest, std::ios::in | std::ios::binary);
+	if(!in.read(header.data(), header.size())){
+		return std::nullopt;
+	}
+
+	return DeskUp::Restore::planStamp(header);
+}
+
+//what the caller asked of a restore, besides the workspace
+struct RestoreRequest {
+	DeskUp::Restore::RestoreFilter filter;
+	std::size_t concurrency = DeskUp::Restore::DEFAULT_RESTORE_CONCURRENCY;
+	DeskUp::Restore::RestoreMode mode = DeskUp::Restore::RestoreMode::Relaunch;
+	std::optional<std::chrono::milliseconds> deadline;
+};
+
+static RestoreRequest requestOf(std::size_t concurrency, DeskUp::Restore::RestoreMode mode){
+	RestoreRequest request;
+	request.concurrency = concurrency;
+	request.mode = mode;
+	return request;
+}
+
+//the launch times of previous restores order and budget this one, and the ones of this restore are added to them
+static DeskUp::Result<DeskUp::Restore::RestoreReport> runProfiled(const DeskUp::Restore::RestorePlan& plan, const RestoreRequest& request,
+	bool forceTermination, std::stop_token stop, const DeskUp::Async::ProgressCallback& progress){
+
+	const fs::path file = fs::path(DESKUPDIR) / DeskUp::Restore::LAUNCH_PROFILES_FILE_NAME;
+
+	//the profiles are only a hint: without them, windows are launched in workspace order
+	DeskUp::Restore::LaunchProfiles profiles;
+	if(auto loaded = DeskUp::Restore::LaunchProfiles::load(file); loaded.has_value()){
+		profiles = std::move(loaded.value());
+	}
+	else{
+		std::cout << "Unread launch profiles: " << loaded.error().what();
+	}
+
+	DeskUp::Restore::RestoreScheduler scheduler(current_window_backend.get(), request.concurrency, request.mode);
+	scheduler.useProfiles(&profiles);
+	if(request.deadline){
+		scheduler.useDeadline(*request.deadline);
+	}
+
+	//a selective restore only closes, launches and places the windows it selected
+	std::optional<DeskUp::Restore::RestorePlan> selection;
+	if(!request.filter.selectsAll()){
+		selection = DeskUp::Restore::selectPlan(plan, request.filter);
+	}
+
+	auto report = scheduler.run(selection ? *selection : plan, forceTermination, stop, progress);
+
+	if(profiles.size() > 0){
+		if(auto saved = profiles.save(file); !saved.has_value()){
+			std::cout << "Unsaved launch profiles: " << saved.error().what();
+		}
+	}
+
+	return report;
+}
+
+//the compiled workspace: the cached plan while the manifest is unchanged, compiled (and cached) again otherwise
+static DeskUp::Result<DeskUp::Restore::RestorePlan> loadPlan(const std::string& workspaceName){
     //initially, the user will need to write the name of the workspace, but when it is shown as a choose option visually (select the workspace),
     //there will be no need to check if the workspace exists, because the same program will identify the name and therefore pass it correctly
 
+	if(current_workspace_store){
+		std::unique_lock lock(storeMutex);
+
+		if(!current_workspace_store->contains(workspaceName)){
+			return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::InvalidInput, 0, "restoreWindows|no_workspace_" + workspaceName));
+		}
+
+		//only the header of the entry is read to tell whether the cached plan is still valid
+		auto header = current_workspace_store->header(workspaceName);
+		lock.unlock();
+
+		if(header.has_value()){
+			if(auto plan = cachedPlan(workspaceName, DeskUp::Restore::planStamp(header.value()))){
+				return std::move(*plan);
+			}
+		}
+
+		//a single read of the entry, then the same lazy walk as a mapped manifest, over a copy the store no longer guards
+		lock.lock();
+		auto manifest = current_workspace_store->get(workspaceName);
+		lock.unlock();
+
+		if(!manifest.has_value()){
+			return std::unexpected(std::move(manifest.error()));
+		}
+
+		//stamped from the manifest actually compiled, which a save may have replaced since its header was read
+		auto stamp = DeskUp::Restore::planStamp(manifest.value());
+
+		auto view = DeskUp::Workspace::WorkspaceView::fromBytes(manifest.value());
+		if(!view.has_value()){
+			return std::unexpected(std::move(view.error()));
+		}
+
+		return compileAndCache(workspaceName, stamp, view.value());
+	}
+
     fs::path p = constructWsDir(workspaceName);
 
 	//this just simply means there is an error in the workspace name itself and/or the deskup path
@@ -91,53 +551,186 @@ DeskUp::Status DeskUpBackendInterface::restoreWindows(std::string workspaceName)
         return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::InvalidInput, 0, "restoreWindows|no_path_" + p.string()));
     }
 
+	fs::path manifest = p / DeskUp::Workspace::MANIFEST_FILE_NAME;
+
+	if(DeskUpBackendInterface::existsFile(manifest)){
+		auto stamp = manifestStamp(manifest);
+		if(auto plan = cachedPlan(workspaceName, stamp)){
+			return std::move(*plan);
+		}
+
+		//the manifest is mapped instead of read
+		auto mapped = DeskUp::Workspace::MappedWorkspace::open(manifest);
+		if(!mapped.has_value()){
+			return std::unexpected(std::move(mapped.error()));
+		}
+
+		return compileAndCache(workspaceName, stamp, mapped.value().view());
+	}
+
+	//workspaces saved before the manifest existed
+	auto windows = DU_WithBackend([&](auto backend){
+		return recoverLegacyWorkspace(backend, p);
+	});
+	if(!windows.has_value()){
+		return std::unexpected(std::move(windows.error()));
+	}
+
+    return DeskUp::Restore::compilePlan(std::move(windows.value()));
+}
+
+static DeskUp::Result<DeskUp::Restore::RestoreReport> restoreWorkspace(const std::string& workspaceName, const RestoreRequest& request,
+	std::stop_token stop, const DeskUp::Async::ProgressCallback& progress){
+
 	//might want to ask the user
     bool forceTermination = true;
 
-    for (const auto& file : fs::directory_iterator{p}) {
-		//can't throw fatal errors
-        auto res = current_window_backend->recoverSavedWindow(current_window_backend.get(), file.path());
-        if (!res.has_value()){
-			std::cout << "Unrecoverable window: " << res.error().what();
-			return std::unexpected(std::move(res.error()));
+	auto plan = loadPlan(workspaceName);
+	if(!plan.has_value()){
+		return std::unexpected(std::move(plan.error()));
+	}
+
+	return runProfiled(plan.value(), request, forceTermination, stop, progress);
+}
+
+//every layer is loaded before anything is closed, so a missing one leaves the desktop untouched
+static DeskUp::Result<DeskUp::Restore::RestoreReport> restoreLayers(const std::vector<std::string>& workspaceNames, const RestoreRequest& request){
+
+    bool forceTermination = true;
+
+	std::vector<DeskUp::Restore::RestorePlan> layers;
+	layers.reserve(workspaceNames.size());
+
+	for(const auto& workspaceName : workspaceNames){
+		auto plan = loadPlan(workspaceName);
+		if(!plan.has_value()){
+			return std::unexpected(std::move(plan.error()));
+		}
+		layers.push_back(std::move(plan.value()));
+	}
+
+	return runProfiled(DeskUp::Restore::mergePlans(layers), request, forceTermination, {}, {});
+}
+
+DeskUp::Status DeskUpBackendInterface::restoreWindows(std::string workspaceName){
+	if(auto res = restoreWindowsWithReport(std::move(workspaceName)); !res.has_value()){
+		return std::unexpected(std::move(res.error()));
+	}
+
+	return {};
+}
+
+DeskUp::Result<DeskUp::Restore::RestoreReport> DeskUpBackendInterface::restoreWindowsWithReport(std::string workspaceName, std::size_t concurrency, DeskUp::Restore::RestoreMode mode){
+	return restoreWorkspace(workspaceName, requestOf(concurrency, mode), {}, {});
+}
+
+DeskUp::Result<DeskUp::Restore::RestoreReport> DeskUpBackendInterface::restoreWindowsWithin(std::string workspaceName,
+	std::chrono::milliseconds deadline, std::size_t concurrency, DeskUp::Restore::RestoreMode mode){
+
+	auto request = requestOf(concurrency, mode);
+	request.deadline = deadline;
+
+	return restoreWorkspace(workspaceName, request, {}, {});
+}
+
+DeskUp::Result<DeskUp::Restore::RestoreReport> DeskUpBackendInterface::restoreWorkspaces(const std::vector<std::string>& workspaceNames,
+	std::size_t concurrency, DeskUp::Restore::RestoreMode mode){
+
+	return restoreLayers(workspaceNames, requestOf(concurrency, mode));
+}
+
+DeskUp::Result<DeskUp::Restore::RestoreReport> DeskUpBackendInterface::restoreSelection(std::string workspaceName,
+	const DeskUp::Restore::RestoreFilter& filter, std::size_t concurrency, DeskUp::Restore::RestoreMode mode){
+
+	auto request = requestOf(concurrency, mode);
+	request.filter = filter;
+
+	return restoreWorkspace(workspaceName, request, {}, {});
+}
+
+DeskUp::Async::AsyncOperation<DeskUp::Restore::RestoreReport> DeskUpBackendInterface::restoreWindowsAsync(std::string workspaceName,
+	DeskUp::Async::ProgressCallback progress, std::size_t concurrency, DeskUp::Restore::RestoreMode mode){
+
+	return DeskUp::Async::AsyncOperation<DeskUp::Restore::RestoreReport>(
+		[workspaceName = std::move(workspaceName), progress = std::move(progress), concurrency, mode](std::stop_token stop){
+			return restoreWorkspace(workspaceName, requestOf(concurrency, mode), stop, progress);
+		});
+}
+
+DeskUp::Status DeskUpBackendInterface::verifyWorkspace(const std::string& workspaceName){
+
+	if(current_workspace_store){
+		std::unique_lock lock(storeMutex);
+		auto manifest = current_workspace_store->get(workspaceName);
+		lock.unlock();
+
+		if(!manifest.has_value()){
+			if(manifest.error().type() == DeskUp::ErrType::NotFound){
+				return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::InvalidInput, 0, "verifyWorkspace|no_workspace_" + workspaceName));
+			}
+			return std::unexpected(std::move(manifest.error()));
 		}
 
-		//from here we expect valid window
+		return DeskUp::Workspace::verifyManifest(manifest.value());
+	}
 
-		auto window = res.value();
+	fs::path p = constructWsDir(workspaceName);
 
-        auto closeRes = current_window_backend->closeProcessFromPath(current_window_backend.get(), window.pathToExec, forceTermination);
-        if (!closeRes.has_value() && closeRes.error().isFatal())
-        if (!closeRes.has_value()){
-            if(closeRes.error().isFatal()){
-                return std::unexpected(std::move(closeRes.error()));
-            }
+	std::error_code err;
+	if(!fs::is_directory(p, err)){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::InvalidInput, 0, "verifyWorkspace|no_path_" + p.string()));
+	}
 
-            std::cout << "Unclosed window: " << closeRes.error().what();
-        }
+	fs::path manifest = p / DeskUp::Workspace::MANIFEST_FILE_NAME;
 
-        auto loadRes = current_window_backend->loadWindowFromPath(current_window_backend.get(), window.pathToExec);
-        if (!loadRes.has_value()){
-            if(loadRes.error().isFatal()){
-                return std::unexpected(std::move(loadRes.error()));
-            }
+	//legacy workspaces carry no checksum
+	if(!existsFile(manifest)){
+		return {};
+	}
 
-            std::cout << "Unopened window: " << loadRes.error().what();
-        }
+	return DeskUp::Workspace::verifyWorkspace(manifest);
+}
 
-        auto resizeRes = current_window_backend->resizeWindow(current_window_backend.get(), window);
-        if (!resizeRes.has_value() && resizeRes.error().isFatal())
-        if (!resizeRes.has_value()){
-            if(resizeRes.error().isFatal()){
-                return std::unexpected(std::move(resizeRes.error()));
-            }
+std::vector<std::pair<std::string, DeskUp::Error>> DeskUpBackendInterface::findCorruptedWorkspaces(){
 
-            std::cout << "Unresized window: " << resizeRes.error().what();
-        }
-    }
+	std::vector<std::pair<std::string, DeskUp::Error>> corrupted;
 
-    return {};
-};
+	if(current_workspace_store){
+		std::vector<std::string> names;
+		{
+			std::lock_guard lock(storeMutex);
+			names = current_workspace_store->names();
+		}
+
+		//each one is verified on its own, so the store is free in between
+		for(std::string& name : names){
+			if(auto res = verifyWorkspace(name); !res.has_value()){
+				corrupted.emplace_back(std::move(name), std::move(res.error()));
+			}
+		}
+
+		return corrupted;
+	}
+
+	std::error_code err;
+	for (const auto& entry : fs::directory_iterator{fs::path(DESKUPDIR), err}) {
+		if(!entry.is_directory(err)){
+			continue;
+		}
+
+		std::string name = entry.path().filename().string();
+
+		if(DeskUp::Workspace::isRetired(name)){
+			continue;
+		}
+
+		if(auto res = verifyWorkspace(name); !res.has_value()){
+			corrupted.emplace_back(std::move(name), std::move(res.error()));
+		}
+	}
+
+	return corrupted;
+}
 
 bool DeskUpBackendInterface::isWorkspaceValid(const std::string& workspaceName){
     if(workspaceName.empty()){
@@ -153,6 +746,11 @@ bool DeskUpBackendInterface::isWorkspaceValid(const std::string& workspaceName){
         }
     }
 
+	//reserved for files waiting to be reclaimed
+	if(DeskUp::Workspace::isRetired(workspaceName)){
+		return false;
+	}
+
     return true;
 }
 
@@ -161,6 +759,12 @@ bool DeskUpBackendInterface::existsWorkspace(const std::string& workspaceName){
         return false;
     }
 
+	//answered from the index, the disk is never touched
+	if(current_workspace_store){
+		std::lock_guard lock(storeMutex);
+		return current_workspace_store->contains(workspaceName);
+	}
+
     fs::path p{DESKUPDIR};
     p /= workspaceName;
 
@@ -176,19 +780,53 @@ int DeskUpBackendInterface::removeWorkspace(const std::string& workspaceName){
         return 0;
     }
 
+	//the cached plan goes with its workspace
+	std::error_code ec;
+	fs::remove(planFile(workspaceName), ec);
+
+	if(current_workspace_store){
+		std::lock_guard lock(storeMutex);
+		auto res = current_workspace_store->remove(workspaceName);
+		return res.has_value() && res.value() ? 1 : 0;
+	}
+
     fs::path p{DESKUPDIR};
     p /= workspaceName;
 
+	//one rename makes the workspace disappear, the recursive delete happens in the background
+	auto retired = DeskUp::Workspace::retire(p);
+	if(!retired.has_value()){
+		return 0;
+	}
 
-    std::error_code err;
+	discard(retired.value());
 
-    fs::remove_all(p, err);
+    return 1;
+}
 
-    if(err){
-        return 0;
-    }
+std::vector<std::string> DeskUpBackendInterface::listWorkspaces(){
 
-    return 1;
+	if(current_workspace_store){
+		std::lock_guard lock(storeMutex);
+		return current_workspace_store->names();
+	}
+
+	std::vector<std::string> names;
+
+	std::error_code err;
+	for (const auto& entry : fs::directory_iterator{fs::path(DESKUPDIR), err}) {
+		if(entry.is_directory(err)){
+			auto u8 = entry.path().filename().u8string();
+			std::string name(u8.begin(), u8.end());
+
+			if(!DeskUp::Workspace::isRetired(name)){
+				names.push_back(std::move(name));
+			}
+		}
+	}
+
+	std::sort(names.begin(), names.end());
+	return names;
 }
 
 bool DeskUpBackendInterface::existsFile(const fs::path& filePath){
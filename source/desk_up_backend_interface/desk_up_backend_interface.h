@@ -29,10 +29,14 @@
 #define DESKUPBACKENDINTERFACE_H
 
 #include <string>
+#include <vector>
+#include <utility>
 #include <expected>
 #include <filesystem>
 
 #include "desk_up_error.h"
+#include "restore_scheduler.h"
+#include "async_operation.h"
 
 namespace fs = std::filesystem;
 
@@ -45,6 +49,12 @@ namespace fs = std::filesystem;
  * active backend device (see @ref current_window_backend) to work with
  * window snapshots and workspaces.
  *
+ * Storage:
+ * - When @ref current_workspace_store is set, every workspace is an entry of the
+ *   workspace store (`DeskUp::Workspace::WorkspaceStore`), and existence checks and
+ *   listing are answered from its in-memory index.
+ * - Otherwise each workspace is a directory `<DESKUPDIR>/<workspaceName>`.
+ *
  * Error handling:
  * - All functions now return `DeskUp::Status` or `DeskUp::Result<T>` values
  *   instead of throwing exceptions.
@@ -70,12 +80,25 @@ struct DeskUpBackendInterface{
      * @details
      * Builds `<DESKUPDIR>/<workspaceName>` and ensures the directory exists.
      * Then asks the active backend device to enumerate all open windows and writes
-     * each window's description to an individual file using `windowDesc::saveTo()`.
-     * Non-fatal save errors are skipped; fatal ones abort the operation.
+     * them to the workspace manifest (`DeskUp::Workspace::MANIFEST_FILE_NAME`).
+     *
+     * If the device implements `streamOpenWindows`, the save is streamed: every window goes through a bounded
+     * queue to a writer thread that appends it to a temporary manifest while the enumeration is still running, so
+     * memory use doesn't grow with the number of windows. Once complete, the temporary manifest is flushed and renamed
+     * over the old one (`DeskUp::Workspace::publishDurably()`). Otherwise all windows are enumerated first and written
+     * by a `DeskUp::Workspace::WorkspaceWriter` with `Durability::AtomicRename`: a single write to a temporary file,
+     * flushed and renamed over the manifest. Either way, a crash or a failed save never leaves a half-written workspace
+     * behind: the previous manifest stays until the new one replaces it.
+     *
+     * With a workspace store, no directory is created: a streamed manifest goes to a temporary file next to the store log,
+     * and the complete manifest is then appended to the log (`WorkspaceStore::put()`) with `Durability::AtomicRename`: the
+     * entry is flushed before and after its header is written, so after a crash the store holds either the old workspace or
+     * the new one. The store is only locked for that append, so the windows are never enumerated while it is.
      *
      * **Calls (indirectly through the backend):**
-     * - `DeskUpWindowDevice::getAllOpenWindows(DeskUpWindowDevice*)`
-     * - `windowDesc::saveTo(const std::string&)`
+     * - `DeskUpWindowDevice::streamOpenWindows(DeskUpWindowDevice*, sink)` when available, else
+     *   `DeskUpWindowDevice::getAllOpenWindows(DeskUpWindowDevice*)`
+     * - `DeskUp::Workspace::ManifestStreamWriter` or `DeskUp::Workspace::WorkspaceWriter`
      *
      * **Reads:**
      * - @ref DESKUPDIR (must have been set by a prior @ref DU_Init call).
@@ -84,9 +107,9 @@ struct DeskUpBackendInterface{
      * @return `DeskUp::Status` — empty on success, or `std::unexpected(DeskUp::Error)` on failure.
      *
      * @errors
-     * - Level::Fatal, ErrType::Os or ErrType::InvalidInput → Enumeration or write failure.
-     * - Level::Warning → One or more windows skipped (non-fatal save errors).
-     * - Level::Retry → Temporary filesystem access problems.
+     * - Level::Fatal, ErrType::Os or ErrType::InvalidInput → Enumeration failure.
+     * - Level::Fatal, ErrType::DiskFull → The manifest could not be written because the disk is full.
+     * - Level::Error → The manifest could not be opened, written or renamed. The previous manifest is left as it was.
      *
      * @note Ensure @ref DU_Init has been called successfully before invoking this method so that
      *       @ref DESKUPDIR and @ref current_window_backend are properly initialized.
@@ -95,22 +118,124 @@ struct DeskUpBackendInterface{
      */
     static DeskUp::Status saveAllWindowsLocal(std::string workspaceName);
 
+    /**
+     * @brief Same as @ref saveAllWindowsLocal, on its own thread.
+     *
+     * @details Returns right away. \c progress is notified with `DeskUp::Async::Phase::Saving` for every enumerated
+     * window (with a \c total of \c 0 while the backend streams them). After `AsyncOperation::cancel()`, no further window
+     * is enumerated and the save fails; like any other failed save, it is abandoned before it replaces anything, so the
+     * workspace saved before (if any) is left as it was.
+     *
+     * @param workspaceName Name of the workspace folder to create/use under @ref DESKUPDIR.
+     * @param progress Called from the operation's threads. May be empty.
+     * @return The handle of the running save.
+     * @errors Through `AsyncOperation::get()`: the same as @ref saveAllWindowsLocal, plus Level::Warning,
+     * ErrType::Cancelled if it was cancelled.
+     * @note Don't run another operation on the same workspace until this one is done.
+     * @version 0.3.4
+     * @date 2025
+     */
+    static DeskUp::Async::AsyncOperation<void> saveAllWindowsLocalAsync(std::string workspaceName, DeskUp::Async::ProgressCallback progress = {});
+
+    /**
+     * @brief Overwrites an existing workspace with the currently enumerated windows, writing only what changed.
+     *
+     * @details
+     * Asks the active backend device to enumerate all open windows and compares them against the
+     * manifest of `<DESKUPDIR>/<workspaceName>` through `DeskUp::Workspace::updateManifest()`:
+     * nothing is written if no window changed, windows that only moved or were resized get their record
+     * patched into a copy of the manifest, and the manifest is only encoded again when windows appeared or vanished.
+     * If the workspace was saved with the legacy one-file-per-window layout, its files are handed to
+     * the workspace reclaimer once the manifest has been written. Either way, the new manifest
+     * replaces the old one with a single rename. The directory is created if it does not exist yet.
+     *
+     * With a workspace store, an unchanged workspace writes nothing and a changed one is appended again as a whole, as
+     * durably as a save.
+     *
+     * **Calls (indirectly through the backend):**
+     * - `DeskUpWindowDevice::getAllOpenWindows(DeskUpWindowDevice*)`
+     * - `DeskUp::Workspace::updateManifest(const fs::path&, const std::vector<windowDesc>&)`
+     *
+     * **Reads:**
+     * - @ref DESKUPDIR (must have been set by a prior @ref DU_Init call).
+     *
+     * @param workspaceName Name of the workspace folder to update under @ref DESKUPDIR.
+     * @return The number of window records that changed: every window when the manifest was encoded again, 0 if the
+     * workspace was already up to date.
+     *
+     * @errors
+     * - Level::Fatal, ErrType::Os or ErrType::InvalidInput → Enumeration failure.
+     * - Level::Fatal, ErrType::DiskFull → The manifest could not be written because the disk is full.
+     * - Level::Error → The manifest could not be opened, written or patched.
+     *
+     * @note Ensure @ref DU_Init has been called successfully before invoking this method so that
+     *       @ref DESKUPDIR and @ref current_window_backend are properly initialized.
+     * @version 0.3.4
+     * @date 2025
+     */
+    static DeskUp::Result<unsigned int> updateWorkspace(std::string workspaceName);
+
+    /**
+     * @brief Atomically replaces a workspace with the currently enumerated windows.
+     *
+     * @details
+     * The windows are enumerated before anything is touched, so a failed enumeration leaves the workspace as it was.
+     * Then the new manifest is staged next to the old one and published with a single rename
+     * (`DeskUp::Workspace::Durability::AtomicRename`): at any point, the workspace is either the old one or the
+     * new one. Files of the legacy one-file-per-window layout are left to the workspace reclaimer
+     * (@ref current_workspace_reclaimer), so the only cost the caller waits for is the write and the rename.
+     *
+     * With a workspace store, the new manifest is a single appended entry, flushed as a save's. The store only switches to it
+     * once it is complete, and the replaced entry is reclaimed when the log is compacted.
+     *
+     * The workspace is created if it does not exist yet.
+     *
+     * **Calls (indirectly through the backend):**
+     * - `DeskUpWindowDevice::getAllOpenWindows(DeskUpWindowDevice*)`
+     * - `DeskUp::Workspace::WorkspaceWriter` or `DeskUp::Workspace::WorkspaceStore::put()`
+     *
+     * **Reads:**
+     * - @ref DESKUPDIR (must have been set by a prior @ref DU_Init call).
+     *
+     * @param workspaceName Name of the workspace to replace.
+     * @return `DeskUp::Status` — empty once the new workspace is published.
+     *
+     * @errors
+     * - Level::Fatal, ErrType::Os or ErrType::InvalidInput → Enumeration failure.
+     * - Level::Fatal, ErrType::DiskFull → The manifest could not be written because the disk is full.
+     * - Level::Error → The manifest could not be written, flushed or renamed. The old workspace is untouched.
+     *
+     * @note Ensure @ref DU_Init has been called successfully before invoking this method so that
+     *       @ref DESKUPDIR and @ref current_window_backend are properly initialized.
+     * @version 0.3.4
+     * @date 2025
+     */
+    static DeskUp::Status replaceWorkspace(std::string workspaceName);
+
     /**
      * @brief Restores all tabs saved previously in the workspace name specified by the parameter.
      *
      * @details
-     * Iterates over all files in `<DESKUPDIR>/<workspaceName>` and, for each saved window:
-     * 1. Loads the window description from file (`recoverSavedWindow`).
-     * 2. Closes existing process instances of that executable (`closeProcessFromPath`).
-     * 3. Launches a new process (`loadWindowFromPath`).
-     * 4. Resizes the new window to the stored geometry (`resizeWindow`).
+     * Loads every saved window of `<DESKUPDIR>/<workspaceName>`. Workspaces holding a manifest
+     * are mapped read-only through `DeskUp::Workspace::MappedWorkspace`, and each record is only
+     * materialized right before its window is launched; workspaces saved with the legacy
+     * one-file-per-window layout are loaded file by file (`recoverSavedWindow`). With a workspace store,
+     * the manifest is read from the store log with a single read and walked the same way.
+     * Records of a manifest whose checksum doesn't match are skipped (and logged to console),
+     * so a single damaged record doesn't prevent the rest of the workspace from being restored.
+     * Then the windows are handed to a `DeskUp::Restore::RestoreScheduler`, which restores up to
+     * `DeskUp::Restore::DEFAULT_RESTORE_CONCURRENCY` of them at the same time:
+     * 1. Closes existing process instances of each executable once, all of them in a single call when the
+     *    device implements `closeProcessesFromPaths` (`closeProcessFromPath` otherwise).
+     * 2. Launches a new process per saved window (`loadWindowFromPath`).
+     * 3. Resizes each new window to the stored geometry as soon as its launch returns (`resizeWindow`).
      *
      * Non-fatal backend errors (Retry or Warning) are logged to console but do not abort
      * the overall restore cycle. Fatal errors propagate as a failed `DeskUp::Status`.
      *
      * **Calls (indirectly through the backend):**
      * - `DeskUpWindowDevice::recoverSavedWindow`
-     * - `DeskUpWindowDevice::closeProcessFromPath`
+     * - `DeskUpWindowDevice::closeProcessesFromPaths` or `DeskUpWindowDevice::closeProcessFromPath`
      * - `DeskUpWindowDevice::loadWindowFromPath`
      * - `DeskUpWindowDevice::resizeWindow`
      *
@@ -122,7 +247,9 @@ struct DeskUpBackendInterface{
      *
      * @errors
      * - Level::Fatal, ErrType::NotFound → Workspace directory missing.
+     * - Level::Error, ErrType::InvalidInput → Workspace missing from the workspace store.
      * - Level::Fatal, ErrType::InvalidInput → Corrupted or incomplete window file.
+     * - Level::Error, ErrType::InvalidFormat or ErrType::CorruptedData → Unreadable manifest.
      * - Level::Retry, ErrType::NotFound → Process launched but no main HWND found.
      * - Level::Warning → Individual window restore failed but continued.
      *
@@ -133,12 +260,169 @@ struct DeskUpBackendInterface{
      */
     static DeskUp::Status restoreWindows(std::string workspaceName);
 
+    /**
+     * @brief Same as @ref restoreWindows, with a chosen concurrency, returning what the restore did.
+     *
+     * @details The returned `DeskUp::Restore::RestoreReport` holds how many windows were restored or
+     * failed and the time it took until every window was restored.
+     *
+     * @param workspaceName Name of the workspace folder to use under @ref DESKUPDIR.
+     * @param concurrency Maximum number of windows restored at the same time. \c 1 restores them one after another.
+     * @param mode `DeskUp::Restore::RestoreMode::ReuseLive` moves the saved windows that are already open instead of closing
+     * and launching their app again, and only launches the rest.
+     * @return The report of the restore, or `std::unexpected(DeskUp::Error)` on failure.
+     * @errors Same as @ref restoreWindows, plus any fatal error of `getAllOpenWindows` in \c ReuseLive mode.
+     * @version 0.3.4
+     * @date 2025
+     */
+    static DeskUp::Result<DeskUp::Restore::RestoreReport> restoreWindowsWithReport(std::string workspaceName,
+        std::size_t concurrency = DeskUp::Restore::DEFAULT_RESTORE_CONCURRENCY,
+        DeskUp::Restore::RestoreMode mode = DeskUp::Restore::RestoreMode::Relaunch);
+
+    /**
+     * @brief Same as @ref restoreWindowsWithReport, returning within \c deadline.
+     *
+     * @details Meant for login scripts, which need an upper bound on the time a restore takes. The deadline is split into
+     * the budgets of the steps as they start (see `DeskUp::Restore::RestoreScheduler::useDeadline()`): a launch waits at most
+     * the time left, and the windows whose step ran out of time, or never started, are counted in
+     * `DeskUp::Restore::RestoreReport::late` instead of holding up the rest.
+     *
+     * The bound holds for devices implementing `loadWindowFromPathWithin`. On the others, a launch waits as long as the
+     * device does. Loading the workspace and closing the running apps are not budgeted, but they don't wait on any app to start,
+     * and the apps aren't closed at all once the deadline has passed.
+     *
+     * @param workspaceName Name of the workspace folder to use under @ref DESKUPDIR.
+     * @param deadline The longest the windows may take to be restored, from the moment the restore starts launching them.
+     * @param concurrency Maximum number of windows restored at the same time.
+     * @param mode See `DeskUp::Restore::RestoreMode`.
+     * @return The report of the restore, which succeeds even if some windows were late.
+     * @errors Same as @ref restoreWindowsWithReport.
+     * @version 0.3.4
+     * @date 2025
+     */
+    static DeskUp::Result<DeskUp::Restore::RestoreReport> restoreWindowsWithin(std::string workspaceName,
+        std::chrono::milliseconds deadline,
+        std::size_t concurrency = DeskUp::Restore::DEFAULT_RESTORE_CONCURRENCY,
+        DeskUp::Restore::RestoreMode mode = DeskUp::Restore::RestoreMode::Relaunch);
+
+    /**
+     * @brief Restores several workspaces laid on top of each other, in a single pass.
+     *
+     * @details Restoring a base workspace and then a project workspace with two calls closes and launches the apps they share
+     * twice. Here, every workspace is compiled (or its cached plan read) first, and the plans are merged with
+     * `DeskUp::Restore::mergePlans()`: an app saved by several layers is restored once, with the windows of the last layer
+     * holding it. The merged plan then runs as a single restore, with one scan of the open windows (in \c ReuseLive mode)
+     * and one close phase.
+     *
+     * Nothing is closed or launched if any of the workspaces can't be loaded.
+     *
+     * @param workspaceNames The workspaces, from the bottom layer to the top one.
+     * @param concurrency Maximum number of windows restored at the same time.
+     * @param mode See `DeskUp::Restore::RestoreMode`.
+     * @return The report of the merged restore.
+     * @errors Same as @ref restoreWindowsWithReport, for the first workspace that couldn't be loaded.
+     * @version 0.3.4
+     * @date 2025
+     */
+    static DeskUp::Result<DeskUp::Restore::RestoreReport> restoreWorkspaces(const std::vector<std::string>& workspaceNames,
+        std::size_t concurrency = DeskUp::Restore::DEFAULT_RESTORE_CONCURRENCY,
+        DeskUp::Restore::RestoreMode mode = DeskUp::Restore::RestoreMode::Relaunch);
+
+    /**
+     * @brief Same as @ref restoreWindowsWithReport, restoring only the windows selected by \c filter.
+     *
+     * @details The workspace is compiled (or its cached plan read) as in a full restore, then narrowed down with
+     * `DeskUp::Restore::selectPlan()`, which looks the executables of the filter up in the plan's groups. Only the selected
+     * windows are closed, launched and placed, so the cost of the restore follows the size of the selection.
+     *
+     * Closing works per executable: in \c Relaunch mode, every running instance of a selected window's executable is closed,
+     * selected or not.
+     *
+     * @param workspaceName Name of the workspace folder to use under @ref DESKUPDIR.
+     * @param filter The apps, window names and monitor or area to restore. An empty filter restores the whole workspace.
+     * @param concurrency Maximum number of windows restored at the same time.
+     * @param mode See `DeskUp::Restore::RestoreMode`.
+     * @return The report of the restore. Its window counts only cover the selection.
+     * @errors Same as @ref restoreWindowsWithReport.
+     * @version 0.3.4
+     * @date 2025
+     */
+    static DeskUp::Result<DeskUp::Restore::RestoreReport> restoreSelection(std::string workspaceName,
+        const DeskUp::Restore::RestoreFilter& filter,
+        std::size_t concurrency = DeskUp::Restore::DEFAULT_RESTORE_CONCURRENCY,
+        DeskUp::Restore::RestoreMode mode = DeskUp::Restore::RestoreMode::Relaunch);
+
+    /**
+     * @brief Same as @ref restoreWindowsWithReport, on its own thread.
+     *
+     * @details Returns right away. \c progress is notified every time a window enters a new `DeskUp::Async::Phase`, and
+     * with `Phase::Done` once it is restored. After `AsyncOperation::cancel()`, the steps already running are finished but
+     * no new one is started, so no app is left half launched.
+     *
+     * @param workspaceName Name of the workspace folder to use under @ref DESKUPDIR.
+     * @param progress Called from the restore's worker threads, one call at a time. May be empty.
+     * @param concurrency Maximum number of windows restored at the same time.
+     * @param mode See `DeskUp::Restore::RestoreMode`.
+     * @return The handle of the running restore.
+     * @errors Through `AsyncOperation::get()`: the same as @ref restoreWindowsWithReport, plus Level::Warning,
+     * ErrType::Cancelled if it was cancelled before every window was restored.
+     * @version 0.3.4
+     * @date 2025
+     */
+    static DeskUp::Async::AsyncOperation<DeskUp::Restore::RestoreReport> restoreWindowsAsync(std::string workspaceName,
+        DeskUp::Async::ProgressCallback progress = {},
+        std::size_t concurrency = DeskUp::Restore::DEFAULT_RESTORE_CONCURRENCY,
+        DeskUp::Restore::RestoreMode mode = DeskUp::Restore::RestoreMode::Relaunch);
+
+    /**
+     * @brief Checks the integrity of a saved workspace without decoding or restoring it.
+     *
+     * @details
+     * Runs `DeskUp::Workspace::verifyWorkspace()` on the manifest of `<DESKUPDIR>/<workspaceName>`,
+     * which validates its header and compares its CRC32C checksum against its raw bytes.
+     * Workspaces saved with the legacy one-file-per-window layout have no checksums and are
+     * reported as intact: they can only be checked by parsing them. With a workspace store, the manifest is
+     * read from the store log and checked the same way.
+     *
+     * **Reads:**
+     * - @ref DESKUPDIR (workspace base directory).
+     *
+     * @param workspaceName Name of the workspace folder to check under @ref DESKUPDIR.
+     * @return `DeskUp::Status` — empty if the workspace is intact.
+     *
+     * @errors
+     * - Level::Error, ErrType::InvalidInput → Workspace directory missing, or workspace missing from the store.
+     * - Any error returned by `DeskUp::Workspace::verifyWorkspace()` or `WorkspaceStore::get()`.
+     *
+     * @version 0.3.4
+     * @date 2025
+     */
+    static DeskUp::Status verifyWorkspace(const std::string& workspaceName);
+
+    /**
+     * @brief Lists every saved workspace that fails @ref verifyWorkspace.
+     *
+     * @details Meant to be called at startup, so that damaged workspaces can be flagged before the user
+     * tries to restore them. Each workspace costs a single pass over its manifest.
+     *
+     * **Reads:**
+     * - The workspaces of @ref current_workspace_store, or filesystem state under @ref DESKUPDIR.
+     *
+     * @return The names of the damaged workspaces, paired with the reason they failed. Empty if all of them are intact
+     * or if @ref DESKUPDIR can't be listed.
+     *
+     * @version 0.3.4
+     * @date 2025
+     */
+    static std::vector<std::pair<std::string, DeskUp::Error>> findCorruptedWorkspaces();
+
     /**
      * @brief This function checks whether if a string is a valid name for a workspace folder.
      *
      * @details
      * A workspace name is invalid if it is empty or contains any of the following
-     * forbidden characters: `\\ / : ? * " < > |`.
+     * forbidden characters: `\\ / : ? * " < > |`. Names starting with
+     * `DeskUp::Workspace::RETIRED_PREFIX` are reserved for files waiting to be reclaimed.
      *
      * **Reads:**
      * - Pure string validation, does not access filesystem.
@@ -157,7 +441,8 @@ struct DeskUpBackendInterface{
      * @brief This function checks whether if a given workspace with the name \c workspaceName already exists.
      *
      * @details
-     * Checks whether `<DESKUPDIR>/<workspaceName>` exists and is a directory.
+     * With a workspace store, looks the name up in its index without touching the disk.
+     * Otherwise checks whether `<DESKUPDIR>/<workspaceName>` exists and is a directory.
      *
      * **Reads:**
      * - Filesystem state under @ref DESKUPDIR.
@@ -176,7 +461,9 @@ struct DeskUpBackendInterface{
      * @brief This function deletes a workspace.
      *
      * @details
-     * Removes `<DESKUPDIR>/<workspaceName>` recursively from disk.
+     * With a workspace store, appends a tombstone for it (`WorkspaceStore::remove()`).
+     * Otherwise retires `<DESKUPDIR>/<workspaceName>` with a single rename (`DeskUp::Workspace::retire()`)
+     * and leaves the recursive delete to the workspace reclaimer (@ref current_workspace_reclaimer).
      * Returns `1` on success, `0` if the workspace does not exist or deletion failed.
      *
      * **Reads:**
@@ -192,6 +479,23 @@ struct DeskUpBackendInterface{
      */
     static int removeWorkspace(const std::string& workspaceName);
 
+    /**
+     * @brief Lists the names of every saved workspace, sorted.
+     *
+     * @details
+     * With a workspace store, the names come from its index and the disk is not touched.
+     * Otherwise every directory under @ref DESKUPDIR is listed.
+     *
+     * **Reads:**
+     * - @ref current_workspace_store, or filesystem state under @ref DESKUPDIR.
+     *
+     * @return The workspace names. Empty if there are none or @ref DESKUPDIR can't be listed.
+     *
+     * @version 0.3.4
+     * @date 2025
+     */
+    static std::vector<std::string> listWorkspaces();
+
     /**
      * @brief Checks whether a given file path exists on disk.
      *
@@ -0,0 +1,213 @@
+#include "launch_profile.h"
+#include "backend_utils.h"
+#include "crc32c.h"
+#include "workspace_writer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <system_error>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static std::string keyOf(const fs::path& executable){
+	return normalizePathLower(executable.string());
+}
+
+//every integer is stored little-endian, whatever the host is
+static void putInt(std::string& out, std::uint32_t value, std::size_t size){
+	for(std::size_t i = 0; i < size; i++){
+		out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+	}
+}
+
+static bool getInt(std::string_view in, std::size_t& offset, std::size_t size, std::uint32_t& value){
+	if(in.size() - offset < size){
+		return false;
+	}
+
+	value = 0;
+	for(std::size_t i = 0; i < size; i++){
+		value |= static_cast<std::uint32_t>(static_cast<unsigned char>(in[offset + i])) << (8 * i);
+	}
+	offset += size;
+	return true;
+}
+
+static DeskUp::Error malformed(const fs::path& file){
+	return DeskUp::Error(DeskUp::Level::Warning, DeskUp::ErrType::InvalidFormat, 0, "LaunchProfiles::load|malformed_" + file.string());
+}
+
+std::size_t DeskUp::Restore::LatencyHistogram::bucketOf(std::chrono::milliseconds latency) noexcept {
+	std::size_t bucket = 0;
+	while(bucket + 1 < LATENCY_BUCKETS && latency >= upperBound(bucket)){
+		bucket++;
+	}
+	return bucket;
+}
+
+void DeskUp::Restore::LatencyHistogram::record(std::chrono::milliseconds latency) noexcept {
+	if(samples() >= LATENCY_MAX_SAMPLES){
+		//rounded up, so that a bucket holding a single launch isn't forgotten
+		for(auto& count : counts){
+			count = (count + 1) / 2;
+		}
+	}
+	counts[bucketOf(latency)]++;
+}
+
+std::uint32_t DeskUp::Restore::LatencyHistogram::samples() const noexcept {
+	std::uint32_t total = 0;
+	for(auto count : counts){
+		total += count;
+	}
+	return total;
+}
+
+std::optional<std::chrono::milliseconds> DeskUp::Restore::LatencyHistogram::percentile(double fraction) const noexcept {
+	const std::uint32_t total = samples();
+	if(total == 0){
+		return std::nullopt;
+	}
+
+	const auto rank = std::max<std::uint32_t>(1, static_cast<std::uint32_t>(std::ceil(std::clamp(fraction, 0.0, 1.0) * total)));
+
+	std::uint32_t seen = 0;
+	for(std::size_t i = 0; i < LATENCY_BUCKETS; i++){
+		seen += counts[i];
+		if(seen >= rank){
+			return upperBound(i);
+		}
+	}
+	return upperBound(LATENCY_BUCKETS - 1);
+}
+
+DeskUp::Result<DeskUp::Restore::LaunchProfiles> DeskUp::Restore::LaunchProfiles::load(const fs::path& file){
+
+	LaunchProfiles profiles;
+
+	std::error_code ec;
+	if(!fs::exists(file, ec)){
+		return profiles;
+	}
+
+	std::ifstream in(file, std::ios::in | std::ios::binary | std::ios::ate);
+	if(!in.is_open()){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Warning, DeskUp::ErrType::Io, 0, "LaunchProfiles::load|file_unopen_" + file.string()));
+	}
+
+	const std::streamoff size = in.tellg();
+	if(size < 0){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Warning, DeskUp::ErrType::Io, 0, "LaunchProfiles::load|no_size_" + file.string()));
+	}
+
+	std::string image(static_cast<std::size_t>(size), '\0');
+	in.seekg(0);
+	in.read(image.data(), size);
+
+	if(in.gcount() != size){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Warning, DeskUp::ErrType::Io, 0, "LaunchProfiles::load|short_read_" + file.string()));
+	}
+
+	if(image.size() < sizeof(LAUNCH_PROFILES_MAGIC) + 8 || std::memcmp(image.data(), LAUNCH_PROFILES_MAGIC, sizeof(LAUNCH_PROFILES_MAGIC)) != 0){
+		return std::unexpected(malformed(file));
+	}
+
+	std::string_view body(image.data(), image.size() - 4);
+	std::size_t offset = body.size();
+	std::uint32_t checksum = 0;
+	getInt(image, offset, 4, checksum);
+
+	if(DeskUp::Workspace::crc32c(body) != checksum){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Warning, DeskUp::ErrType::CorruptedData, 0, "LaunchProfiles::load|bad_checksum_" + file.string()));
+	}
+
+	offset = sizeof(LAUNCH_PROFILES_MAGIC);
+	std::uint32_t version = 0, count = 0;
+	getInt(body, offset, 2, version);
+	getInt(body, offset, 2, count);
+
+	if(version > LAUNCH_PROFILES_VERSION){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Warning, DeskUp::ErrType::InvalidFormat, 0, "LaunchProfiles::load|newer_version_" + file.string()));
+	}
+
+	for(std::uint32_t i = 0; i < count; i++){
+		std::uint32_t length = 0;
+		if(!getInt(body, offset, 2, length) || body.size() - offset < length){
+			return std::unexpected(malformed(file));
+		}
+
+		std::string key(body.substr(offset, length));
+		offset += length;
+
+		LatencyHistogram histogram;
+		for(auto& bucket : histogram.counts){
+			if(!getInt(body, offset, 4, bucket)){
+				return std::unexpected(malformed(file));
+			}
+		}
+
+		profiles.histograms.insert_or_assign(std::move(key), histogram);
+	}
+
+	return profiles;
+}
+
+DeskUp::Status DeskUp::Restore::LaunchProfiles::save(const fs::path& file) const {
+
+	//executables whose path doesn't fit are just not profiled
+	std::vector<const std::pair<const std::string, LatencyHistogram> *> entries;
+	for(const auto& entry : histograms){
+		if(entry.first.size() <= std::numeric_limits<std::uint16_t>::max()){
+			entries.push_back(&entry);
+		}
+	}
+	entries.resize(std::min<std::size_t>(entries.size(), std::numeric_limits<std::uint16_t>::max()));
+
+	std::string image(LAUNCH_PROFILES_MAGIC, sizeof(LAUNCH_PROFILES_MAGIC));
+	putInt(image, LAUNCH_PROFILES_VERSION, 2);
+	putInt(image, static_cast<std::uint32_t>(entries.size()), 2);
+
+	for(const auto * entry : entries){
+		putInt(image, static_cast<std::uint32_t>(entry->first.size()), 2);
+		image += entry->first;
+		for(auto count : entry->second.counts){
+			putInt(image, count, 4);
+		}
+	}
+
+	putInt(image, DeskUp::Workspace::crc32c(image), 4);
+
+	return DeskUp::Workspace::writeDurably(file, image, DeskUp::Workspace::Durability::AtomicRename);
+}
+
+void DeskUp::Restore::LaunchProfiles::record(const fs::path& executable, std::chrono::milliseconds latency){
+	histograms[keyOf(executable)].record(latency);
+}
+
+const DeskUp::Restore::LatencyHistogram * DeskUp::Restore::LaunchProfiles::find(const fs::path& executable) const {
+	auto it = histograms.find(keyOf(executable));
+	return it == histograms.end() ? nullptr : &it->second;
+}
+
+std::optional<std::chrono::milliseconds> DeskUp::Restore::LaunchProfiles::expected(const fs::path& executable) const {
+	const auto * histogram = find(executable);
+	return histogram ? histogram->percentile(0.5) : std::nullopt;
+}
+
+std::optional<std::chrono::milliseconds> DeskUp::Restore::LaunchProfiles::budget(const fs::path& executable) const {
+	const auto * histogram = find(executable);
+	if(!histogram){
+		return std::nullopt;
+	}
+
+	auto p90 = histogram->percentile(0.9);
+	if(!p90){
+		return std::nullopt;
+	}
+
+	return std::clamp(*p90 * 2, MIN_LAUNCH_BUDGET, MAX_LAUNCH_BUDGET);
+}
@@ -0,0 +1,204 @@
+/**
+ * @file launch_profile.h
+ * @brief How long each app takes from being launched until its window shows up, learned from previous restores.
+ *
+ * This file is part of DeskUp
+ *
+ * @details
+ * A restore can't finish before the slowest of its apps has started, so that app should be the first one launched.
+ * Every launch made by a restore is timed, and the time is added to a @ref DeskUp::Restore::LatencyHistogram kept per
+ * executable. The histograms of every executable are a @ref DeskUp::Restore::LaunchProfiles, persisted in
+ * `<DESKUPDIR>/<LAUNCH_PROFILES_FILE_NAME>` between runs.
+ *
+ * `DeskUp::Restore::RestoreScheduler` uses them twice:
+ * - Apps are launched slowest first (by median launch time), so the restore lasts about as long as the slowest app.
+ * - Devices implementing `loadWindowFromPathWithin` are given a wait budget per app, derived from how long it usually takes,
+ *   instead of waiting on it forever.
+ *
+ * The file is only a hint: a missing or damaged one just means every app is treated as unknown.
+ *
+ * | Offset | Size      | Contents                                                       |
+ * |:------:|:---------:|:---------------------------------------------------------------|
+ * | 0      | 4         | @ref DeskUp::Restore::LAUNCH_PROFILES_MAGIC                    |
+ * | 4      | 4         | Version, then number of executables, 2 bytes each              |
+ * | 8      | variable  | Per executable: path length (2 bytes), path, one 4-byte count per bucket |
+ * | end-4  | 4         | CRC32C of everything before it                                 |
+ *
+ * @author
+ *   Nicolas Serrano Garcia <serranogarcianicolas@gmail.com>
+ * @date
+ *   2025
+ * @copyright
+ *   Copyright (C) 2025 Nicolas Serrano Garcia
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LAUNCHPROFILE_H
+#define LAUNCHPROFILE_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <filesystem>
+
+#include "desk_up_error.h"
+
+namespace fs = std::filesystem;
+
+namespace DeskUp::Restore {
+
+    /**
+     * @brief Name of the profiles file inside `DESKUPDIR`.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr const char * LAUNCH_PROFILES_FILE_NAME = "launch_profiles.dulp";
+
+    /**
+     * @brief The four bytes every profiles file starts with.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr char LAUNCH_PROFILES_MAGIC[4] = {'D', 'U', 'L', 'P'};
+
+    /**
+     * @brief The profiles file version written by this build of DeskUp.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr std::uint16_t LAUNCH_PROFILES_VERSION = 1;
+
+    /**
+     * @brief Number of buckets of a @ref LatencyHistogram. Bucket \c i holds the launches shorter than
+     * `LATENCY_BUCKET_BASE << i` (and not shorter than the bound of bucket `i - 1`); the last one holds every longer launch too.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr std::size_t LATENCY_BUCKETS = 12;
+
+    /**
+     * @brief Upper bound of the first bucket of a @ref LatencyHistogram. With 12 buckets the last bound is about 100 s.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr std::chrono::milliseconds LATENCY_BUCKET_BASE{50};
+
+    /**
+     * @brief Samples a histogram holds before every count is halved, so that old launches weigh less than recent ones.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr std::uint32_t LATENCY_MAX_SAMPLES = 32;
+
+    /**
+     * @brief Shortest and longest wait budget @ref LaunchProfiles::budget returns.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr std::chrono::milliseconds MIN_LAUNCH_BUDGET{2000};
+    inline constexpr std::chrono::milliseconds MAX_LAUNCH_BUDGET{60000};
+
+    /**
+     * @struct LatencyHistogram
+     * @brief Launch times of a single executable, in buckets doubling in width.
+     * @version 0.3.4
+     * @date 2025
+     */
+    struct LatencyHistogram {
+        std::array<std::uint32_t, LATENCY_BUCKETS> counts{};
+
+        /** @brief The bucket a launch of \c latency falls in. */
+        static std::size_t bucketOf(std::chrono::milliseconds latency) noexcept;
+
+        /** @brief The upper bound of bucket \c bucket. */
+        static std::chrono::milliseconds upperBound(std::size_t bucket) noexcept {
+            return LATENCY_BUCKET_BASE * (1LL << bucket);
+        }
+
+        /** @brief Adds a launch of \c latency, halving every count first if there are @ref LATENCY_MAX_SAMPLES already. */
+        void record(std::chrono::milliseconds latency) noexcept;
+
+        /** @brief Number of launches held. */
+        std::uint32_t samples() const noexcept;
+
+        /**
+         * @brief The upper bound of the bucket holding the launch at \c fraction of the sorted launches (0.5 for the median).
+         * @return \c std::nullopt if the histogram is empty.
+         */
+        std::optional<std::chrono::milliseconds> percentile(double fraction) const noexcept;
+    };
+
+    /**
+     * @class LaunchProfiles
+     * @brief The launch histograms of every executable restored so far, by case-insensitive path.
+     *
+     * @details Not thread-safe: the scheduler reads it from its workers, but it is only modified once they are done.
+     *
+     * @version 0.3.4
+     * @date 2025
+     */
+    class LaunchProfiles {
+    public:
+        /**
+         * @brief Reads the profiles stored at \c file.
+         *
+         * @param file The profiles file. It doesn't have to exist.
+         * @return The profiles. Empty if \c file doesn't exist.
+         * @errors
+         * - Level::Warning, ErrType::Io → \c file exists but could not be read.
+         * - Level::Warning, ErrType::InvalidFormat → \c file is not a profiles file, or a newer version of it.
+         * - Level::Warning, ErrType::CorruptedData → The checksum doesn't match.
+         * @version 0.3.4
+         * @date 2025
+         */
+        static DeskUp::Result<LaunchProfiles> load(const fs::path& file);
+
+        /**
+         * @brief Replaces \c file with these profiles, atomically (see `Durability::AtomicRename`).
+         * @errors Any error returned by `writeDurably()`.
+         * @version 0.3.4
+         * @date 2025
+         */
+        DeskUp::Status save(const fs::path& file) const;
+
+        /** @brief Adds a launch of \c executable that took \c latency. */
+        void record(const fs::path& executable, std::chrono::milliseconds latency);
+
+        /** @brief The histogram of \c executable, or \c nullptr if it was never launched. */
+        const LatencyHistogram * find(const fs::path& executable) const;
+
+        /** @brief Median launch time of \c executable, or \c std::nullopt if it was never launched. */
+        std::optional<std::chrono::milliseconds> expected(const fs::path& executable) const;
+
+        /**
+         * @brief How long a launch of \c executable should be waited on: twice its 90th percentile, clamped to
+         * [@ref MIN_LAUNCH_BUDGET, @ref MAX_LAUNCH_BUDGET].
+         * @return \c std::nullopt if it was never launched, in which case the device waits as long as it always has.
+         */
+        std::optional<std::chrono::milliseconds> budget(const fs::path& executable) const;
+
+        /** @brief Number of profiled executables. */
+        std::size_t size() const noexcept { return histograms.size(); }
+
+    private:
+        std::unordered_map<std::string, LatencyHistogram> histograms;
+    };
+}
+
+#endif
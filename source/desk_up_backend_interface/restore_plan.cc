@@ -0,0 +1,397 @@
+#include "restore_plan.h"
+#include "backend_utils.h"
+#include "crc32c.h"
+#include "workspace_manifest.h"
+#include "workspace_writer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+static void putU32(std::string& out, std::uint32_t value){
+	out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+static bool getU32(std::string_view in, std::size_t& offset, std::uint32_t& value){
+	if(in.size() - offset < sizeof(value)){
+		return false;
+	}
+	std::memcpy(&value, in.data() + offset, sizeof(value));
+	offset += sizeof(value);
+	return true;
+}
+
+static std::uint32_t planChecksum(DeskUp::Restore::PlanHeader header, std::string_view body) noexcept {
+	header.checksum = 0;
+	auto crc = DeskUp::Workspace::crc32c(&header, sizeof(header));
+	return DeskUp::Workspace::crc32c(body, crc);
+}
+
+static DeskUp::Error planError(DeskUp::ErrType type, const std::string& what){
+	return DeskUp::Error(DeskUp::Level::Warning, type, 0, "decodePlan|" + what);
+}
+
+DeskUp::Restore::RestorePlan DeskUp::Restore::compilePlan(std::vector<windowDesc> windows, std::uint64_t stamp){
+
+	RestorePlan plan;
+	plan.stamp = stamp;
+	plan.windows.reserve(windows.size());
+	plan.keys.reserve(windows.size());
+
+	std::unordered_map<std::string, std::size_t> executableIndex;
+
+	for(auto& window : windows){
+		if(window.pathToExec.empty()){
+			std::cout << "Window without executable: " << window.name;
+			continue;
+		}
+
+		std::string key = normalizePathLower(window.pathToExec.string());
+
+		auto [it, inserted] = executableIndex.try_emplace(key, plan.executables.size());
+		if(inserted){
+			plan.executables.push_back(window.pathToExec);
+			plan.windowsOf.emplace_back();
+		}
+		plan.windowsOf[it->second].push_back(plan.windows.size());
+
+		plan.keys.push_back(std::move(key));
+		plan.windows.push_back(std::move(window));
+	}
+
+	return plan;
+}
+
+DeskUp::Restore::RestorePlan DeskUp::Restore::compilePlan(const DeskUp::Workspace::WorkspaceView& view, std::uint64_t stamp){
+	std::vector<windowDesc> windows;
+	windows.reserve(view.size());
+
+	for (std::size_t i = 0; i < view.size(); i++) {
+		//a damaged record is the only thing lost, the rest of the workspace can still be restored
+		if(!view.intact(i)){
+			std::cout << "Corrupted window record: " << i;
+			continue;
+		}
+
+		windows.push_back(view[i].toWindowDesc());
+	}
+
+	return compilePlan(std::move(windows), stamp);
+}
+
+bool DeskUp::Restore::Region::holds(const windowDesc& window) const noexcept {
+	//64 bits, so that huge saved geometries can't overflow
+	const long long centreX = static_cast<long long>(window.x) + window.w / 2;
+	const long long centreY = static_cast<long long>(window.y) + window.h / 2;
+
+	return centreX >= x && centreX < static_cast<long long>(x) + w && centreY >= y && centreY < static_cast<long long>(y) + h;
+}
+
+bool DeskUp::Restore::matchesPattern(std::string_view name, std::string_view pattern){
+	auto same = [](char a, char b){
+		return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+	};
+
+	//greedy match that only backtracks to the last '*'
+	std::size_t n = 0, p = 0;
+	std::size_t star = std::string_view::npos, resume = 0;
+
+	while(n < name.size()){
+		if(p < pattern.size() && (pattern[p] == '?' || (pattern[p] != '*' && same(pattern[p], name[n])))){
+			n++;
+			p++;
+		}
+		else if(p < pattern.size() && pattern[p] == '*'){
+			star = p++;
+			resume = n;
+		}
+		else if(star != std::string_view::npos){
+			p = star + 1;
+			n = ++resume;
+		}
+		else{
+			return false;
+		}
+	}
+
+	while(p < pattern.size() && pattern[p] == '*'){
+		p++;
+	}
+	return p == pattern.size();
+}
+
+DeskUp::Restore::RestorePlan DeskUp::Restore::mergePlans(const std::vector<RestorePlan>& layers){
+
+	//the topmost layer holding each executable
+	std::unordered_map<std::string_view, std::size_t> ownerOf;
+	std::size_t total = 0;
+	for(std::size_t l = 0; l < layers.size(); l++){
+		for(const auto& group : layers[l].windowsOf){
+			ownerOf.insert_or_assign(layers[l].keys[group.front()], l);
+		}
+		total += layers[l].windows.size();
+	}
+
+	RestorePlan merged;
+	merged.windows.reserve(total);
+	merged.keys.reserve(total);
+
+	std::unordered_map<std::string_view, std::size_t> executableIndex;
+
+	for(std::size_t l = 0; l < layers.size(); l++){
+		const auto& layer = layers[l];
+		for(std::size_t i = 0; i < layer.windows.size(); i++){
+			const std::string& key = layer.keys[i];
+			if(ownerOf.at(key) != l){
+				continue;
+			}
+
+			auto [it, inserted] = executableIndex.try_emplace(key, merged.executables.size());
+			if(inserted){
+				merged.executables.push_back(layer.windows[i].pathToExec);
+				merged.windowsOf.emplace_back();
+			}
+			merged.windowsOf[it->second].push_back(merged.windows.size());
+
+			merged.keys.push_back(key);
+			merged.windows.push_back(layer.windows[i]);
+		}
+	}
+
+	return merged;
+}
+
+DeskUp::Restore::RestorePlan DeskUp::Restore::selectPlan(const RestorePlan& plan, const RestoreFilter& filter){
+
+	//the groups of the plan are the index: without executables in the filter, every group is a candidate
+	std::vector<std::size_t> groups;
+	if(filter.executables.empty()){
+		groups.resize(plan.executables.size());
+		for(std::size_t e = 0; e < groups.size(); e++){
+			groups[e] = e;
+		}
+	}
+	else{
+		std::unordered_map<std::string, std::size_t> groupOf;
+		for(std::size_t e = 0; e < plan.executables.size(); e++){
+			groupOf.emplace(plan.keys[plan.windowsOf[e].front()], e);
+		}
+
+		for(const auto& executable : filter.executables){
+			if(auto it = groupOf.find(normalizePathLower(executable.string())); it != groupOf.end()){
+				groups.push_back(it->second);
+			}
+		}
+
+		std::sort(groups.begin(), groups.end());
+		groups.erase(std::unique(groups.begin(), groups.end()), groups.end());
+	}
+
+	//window index, then its group in the plan
+	std::vector<std::pair<std::size_t, std::size_t>> selected;
+	for(std::size_t e : groups){
+		for(std::size_t i : plan.windowsOf[e]){
+			const windowDesc& window = plan.windows[i];
+			if((filter.namePattern.empty() || matchesPattern(window.name, filter.namePattern)) && (!filter.region || filter.region->holds(window))){
+				selected.emplace_back(i, e);
+			}
+		}
+	}
+
+	//the windows of the plan are in workspace order, and so are the ones of the selection
+	std::sort(selected.begin(), selected.end());
+
+	RestorePlan selection;
+	selection.windows.reserve(selected.size());
+	selection.keys.reserve(selected.size());
+
+	std::unordered_map<std::size_t, std::size_t> selectedGroup;
+	for(auto [i, e] : selected){
+		auto [it, inserted] = selectedGroup.try_emplace(e, selection.executables.size());
+		if(inserted){
+			selection.executables.push_back(plan.executables[e]);
+			selection.windowsOf.emplace_back();
+		}
+		selection.windowsOf[it->second].push_back(selection.windows.size());
+
+		selection.keys.push_back(plan.keys[i]);
+		selection.windows.push_back(plan.windows[i]);
+	}
+
+	return selection;
+}
+
+std::optional<std::uint64_t> DeskUp::Restore::planStamp(std::string_view manifest) noexcept {
+	DeskUp::Workspace::ManifestHeader header;
+	if(manifest.size() < sizeof(header)){
+		return std::nullopt;
+	}
+
+	std::memcpy(&header, manifest.data(), sizeof(header));
+	return planStamp(header);
+}
+
+std::optional<std::uint64_t> DeskUp::Restore::planStamp(const DeskUp::Workspace::ManifestHeader& header) noexcept {
+	if(header.version < 2){
+		return std::nullopt;
+	}
+
+	return (static_cast<std::uint64_t>(header.recordCount) << 32) | header.checksum;
+}
+
+std::string DeskUp::Restore::encodePlan(const RestorePlan& plan){
+
+	std::string body;
+
+	std::vector<std::uint32_t> executableOf(plan.windows.size(), 0);
+	for(std::size_t e = 0; e < plan.executables.size(); e++){
+		const std::string& key = plan.keys[plan.windowsOf[e].front()];
+		putU32(body, static_cast<std::uint32_t>(key.size()));
+		body += key;
+
+		for(std::size_t i : plan.windowsOf[e]){
+			executableOf[i] = static_cast<std::uint32_t>(e);
+		}
+	}
+
+	//the windows are stored decoded, so that reading them back is a copy
+	for(std::size_t i = 0; i < plan.windows.size(); i++){
+		const windowDesc& window = plan.windows[i];
+		auto path = window.pathToExec.u8string();
+
+		PlanWindow record{window.x, window.y, window.w, window.h, executableOf[i],
+			static_cast<std::uint32_t>(path.size()), static_cast<std::uint32_t>(window.name.size()), 0};
+
+		body.append(reinterpret_cast<const char *>(&record), sizeof(record));
+		body.append(path.begin(), path.end());
+		body += window.name;
+	}
+
+	PlanHeader header{};
+	std::memcpy(header.magic, RESTORE_PLAN_MAGIC, sizeof(header.magic));
+	header.version = RESTORE_PLAN_VERSION;
+	header.headerSize = sizeof(PlanHeader);
+	header.stamp = plan.stamp;
+	header.windowCount = static_cast<std::uint32_t>(plan.windows.size());
+	header.executableCount = static_cast<std::uint32_t>(plan.executables.size());
+	header.checksum = planChecksum(header, body);
+
+	std::string image(reinterpret_cast<const char *>(&header), sizeof(header));
+	image += body;
+	return image;
+}
+
+DeskUp::Result<DeskUp::Restore::RestorePlan> DeskUp::Restore::decodePlan(std::string_view bytes){
+
+	PlanHeader header;
+	if(bytes.size() < sizeof(header)){
+		return std::unexpected(planError(DeskUp::ErrType::InvalidFormat, "too_short"));
+	}
+	std::memcpy(&header, bytes.data(), sizeof(header));
+
+	if(std::memcmp(header.magic, RESTORE_PLAN_MAGIC, sizeof(header.magic)) != 0 || header.version != RESTORE_PLAN_VERSION
+		|| header.headerSize != sizeof(PlanHeader)){
+		return std::unexpected(planError(DeskUp::ErrType::InvalidFormat, "bad_header"));
+	}
+
+	std::string_view body = bytes.substr(sizeof(header));
+	if(planChecksum(header, body) != header.checksum){
+		return std::unexpected(planError(DeskUp::ErrType::CorruptedData, "bad_checksum"));
+	}
+
+	//a count the body can't hold is a damaged header, not a reason to allocate
+	if(header.executableCount > body.size() / sizeof(std::uint32_t) || header.windowCount > body.size() / sizeof(PlanWindow)){
+		return std::unexpected(planError(DeskUp::ErrType::CorruptedData, "bad_counts"));
+	}
+
+	RestorePlan plan;
+	plan.stamp = header.stamp;
+
+	std::vector<std::string> executableKeys;
+	executableKeys.reserve(header.executableCount);
+
+	std::size_t offset = 0;
+	for(std::uint32_t e = 0; e < header.executableCount; e++){
+		std::uint32_t length = 0;
+		if(!getU32(body, offset, length) || body.size() - offset < length){
+			return std::unexpected(planError(DeskUp::ErrType::CorruptedData, "bad_group"));
+		}
+		executableKeys.emplace_back(body.substr(offset, length));
+		offset += length;
+	}
+
+	plan.windows.reserve(header.windowCount);
+	plan.keys.reserve(header.windowCount);
+	plan.windowsOf.resize(header.executableCount);
+
+	for(std::uint32_t i = 0; i < header.windowCount; i++){
+		PlanWindow record;
+		if(body.size() - offset < sizeof(record)){
+			return std::unexpected(planError(DeskUp::ErrType::CorruptedData, "bad_window"));
+		}
+		std::memcpy(&record, body.data() + offset, sizeof(record));
+		offset += sizeof(record);
+
+		if(record.executable >= header.executableCount || body.size() - offset < std::uint64_t(record.pathLength) + record.nameLength){
+			return std::unexpected(planError(DeskUp::ErrType::CorruptedData, "bad_window"));
+		}
+
+		std::string_view path = body.substr(offset, record.pathLength);
+		offset += record.pathLength;
+
+		windowDesc window;
+		window.x = record.x;
+		window.y = record.y;
+		window.w = record.w;
+		window.h = record.h;
+		window.pathToExec = fs::path(std::u8string(path.begin(), path.end()));
+		window.name = std::string(body.substr(offset, record.nameLength));
+		offset += record.nameLength;
+
+		plan.windowsOf[record.executable].push_back(plan.windows.size());
+		plan.keys.push_back(executableKeys[record.executable]);
+		plan.windows.push_back(std::move(window));
+	}
+
+	//every executable holds at least one window
+	for(const auto& group : plan.windowsOf){
+		if(group.empty()){
+			return std::unexpected(planError(DeskUp::ErrType::CorruptedData, "empty_group"));
+		}
+		plan.executables.push_back(plan.windows[group.front()].pathToExec);
+	}
+
+	return plan;
+}
+
+DeskUp::Result<DeskUp::Restore::RestorePlan> DeskUp::Restore::readPlan(const fs::path& file){
+
+	std::ifstream in(file, std::ios::in | std::ios::binary | std::ios::ate);
+	if(!in.is_open()){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Warning, DeskUp::ErrType::FileNotFound, 0, "readPlan|file_unopen_" + file.string()));
+	}
+
+	const std::streamoff size = in.tellg();
+	if(size < 0){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Warning, DeskUp::ErrType::Io, 0, "readPlan|no_size_" + file.string()));
+	}
+
+	std::string image(static_cast<std::size_t>(size), '\0');
+	in.seekg(0);
+	in.read(image.data(), size);
+
+	if(in.gcount() != size){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Warning, DeskUp::ErrType::Io, 0, "readPlan|short_read_" + file.string()));
+	}
+
+	return decodePlan(image);
+}
+
+DeskUp::Status DeskUp::Restore::writePlan(const fs::path& file, const RestorePlan& plan){
+	return DeskUp::Workspace::writeDurably(file, encodePlan(plan), DeskUp::Workspace::Durability::AtomicRename);
+}
@@ -0,0 +1,296 @@
+/**
+ * @file restore_plan.h
+ * @brief Compiled, cached form of a workspace, ready to be handed to the restore scheduler.
+ *
+ * This file is part of DeskUp
+ *
+ * @details
+ * Before a single app is launched, a restore checks every record of the manifest, decodes it, normalizes the path of
+ * every window and groups the windows by executable. None of that changes between two restores of the same workspace,
+ * which is the common case (the same workspace at every login), so it is done once and kept in a
+ * @ref DeskUp::Restore::RestorePlan.
+ *
+ * The plan is cached in `<DESKUPDIR>/<RESTORE_PLAN_PREFIX><workspace>`, next to the workspace, and is only used while its
+ * stamp (see @ref DeskUp::Restore::planStamp) matches the manifest it was compiled from. Only the header of the manifest is
+ * read to tell. Any save of the workspace changes the stamp and the plan is compiled again by the next restore.
+ *
+ * The plan holds its windows already decoded and grouped, so reading it back is a single checksum and a copy of every
+ * field: no manifest record is checked, decoded or normalized again.
+ *
+ * | Offset      | Size         | Contents                                                                        |
+ * |:-----------:|:------------:|:--------------------------------------------------------------------------------|
+ * | 0           | 32           | @ref DeskUp::Restore::PlanHeader                                                |
+ * | 32          | variable     | Per executable: key length (4 bytes), key                                       |
+ * | after it    | variable     | Per window, in workspace order: a @ref DeskUp::Restore::PlanWindow, its path and its name |
+ *
+ * Several workspaces restored together (a base one, then a project one on top of it) are merged into a single plan with
+ * @ref DeskUp::Restore::mergePlans, so that the apps they share are closed and launched once.
+ *
+ * A restore can also bring back only part of a workspace: @ref DeskUp::Restore::selectPlan narrows a plan down to the windows
+ * matching a @ref DeskUp::Restore::RestoreFilter, looking executables up in the groups of the plan, so only the selected
+ * windows are closed, launched and placed.
+ *
+ * @author
+ *   Nicolas Serrano Garcia <serranogarcianicolas@gmail.com>
+ * @date
+ *   2025
+ * @copyright
+ *   Copyright (C) 2025 Nicolas Serrano Garcia
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RESTOREPLAN_H
+#define RESTOREPLAN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <filesystem>
+
+#include "window_desc.h"
+#include "desk_up_error.h"
+#include "mapped_workspace.h"
+
+namespace fs = std::filesystem;
+
+namespace DeskUp::Restore {
+
+    /**
+     * @brief Prefix of the name of every cached plan inside `DESKUPDIR`. The workspace name follows it.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr const char * RESTORE_PLAN_PREFIX = ".deskup-plan-";
+
+    /**
+     * @brief The four bytes every plan file starts with.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr char RESTORE_PLAN_MAGIC[4] = {'D', 'U', 'R', 'P'};
+
+    /**
+     * @brief The plan file version written by this build of DeskUp. Plans of any other version are compiled again.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr std::uint16_t RESTORE_PLAN_VERSION = 2;
+
+    /**
+     * @struct PlanHeader
+     * @brief Fixed-size header placed at offset 0 of a plan file.
+     *
+     * @details `checksum` is the CRC32C of this header (with `checksum` set to 0) followed by every byte after it.
+     *
+     * @version 0.3.4
+     * @date 2025
+     */
+    struct PlanHeader {
+        char magic[4];                /**< Always @ref RESTORE_PLAN_MAGIC. */
+        std::uint16_t version;        /**< Format version, see @ref RESTORE_PLAN_VERSION. */
+        std::uint16_t headerSize;     /**< `sizeof(PlanHeader)` at write time. */
+        std::uint64_t stamp;          /**< @ref planStamp of the manifest the plan was compiled from. */
+        std::uint32_t windowCount;    /**< Number of windows. */
+        std::uint32_t executableCount;/**< Number of executables. */
+        std::uint32_t checksum;       /**< CRC32C of the header and the body. */
+        std::uint32_t reserved;       /**< Zeroed, kept for future use. */
+    };
+
+    static_assert(sizeof(PlanHeader) == 32, "PlanHeader must stay 32 bytes wide");
+
+    /**
+     * @struct PlanWindow
+     * @brief Fixed-size part of a window of a plan file. Its path (UTF-8) and its name follow it.
+     * @version 0.3.4
+     * @date 2025
+     */
+    struct PlanWindow {
+        std::int32_t x;               /**< X coordinate (top-left) in pixels. */
+        std::int32_t y;               /**< Y coordinate (top-left) in pixels. */
+        std::int32_t w;               /**< Width in pixels. */
+        std::int32_t h;               /**< Height in pixels. */
+        std::uint32_t executable;     /**< Index of its executable. */
+        std::uint32_t pathLength;     /**< Length in bytes of its executable path. */
+        std::uint32_t nameLength;     /**< Length in bytes of its name. */
+        std::uint32_t reserved;       /**< Zeroed, kept for future use. */
+    };
+
+    static_assert(sizeof(PlanWindow) == 32, "PlanWindow must stay 32 bytes wide");
+
+    /**
+     * @struct RestorePlan
+     * @brief The windows of a workspace, checked, decoded and grouped by executable.
+     * @version 0.3.4
+     * @date 2025
+     */
+    struct RestorePlan {
+        std::uint64_t stamp = 0;                            /**< See @ref planStamp. \c 0 for plans that are never cached. */
+        std::vector<windowDesc> windows;                    /**< The windows to restore, in workspace order. */
+        std::vector<std::string> keys;                      /**< Case-insensitive key of the executable of each window. */
+        std::vector<fs::path> executables;                  /**< Every distinct executable, in order of first appearance. */
+        std::vector<std::vector<std::size_t>> windowsOf;    /**< Indices into \c windows of the windows of each executable. */
+    };
+
+    /**
+     * @struct Region
+     * @brief A rectangle of the virtual desktop, in pixels.
+     * @version 0.3.4
+     * @date 2025
+     */
+    struct Region {
+        int x = 0;
+        int y = 0;
+        int w = 0;
+        int h = 0;
+
+        /** @brief Whether the centre of \c window lies inside the region. */
+        bool holds(const windowDesc& window) const noexcept;
+    };
+
+    /**
+     * @struct RestoreFilter
+     * @brief Which windows of a workspace a selective restore brings back. A window is selected when it matches every
+     * criterion set; an empty filter selects every window.
+     *
+     * @details Workspaces don't record the monitor of their windows, so a monitor is selected through its rectangle (its
+     * bounds on the virtual desktop): a window belongs to the monitor holding its centre.
+     *
+     * @version 0.3.4
+     * @date 2025
+     */
+    struct RestoreFilter {
+        std::vector<fs::path> executables;  /**< Executables whose windows are selected, compared case-insensitively. Empty for any. */
+        std::string namePattern;            /**< Case-insensitive pattern of the window names, where `*` matches any run of characters and `?` any single one. Empty for any. */
+        std::optional<Region> region;       /**< The monitor or area holding the centre of the selected windows. Unset for anywhere. */
+
+        /** @brief Whether the filter selects every window. */
+        bool selectsAll() const noexcept { return executables.empty() && namePattern.empty() && !region; }
+    };
+
+    /**
+     * @brief Compiles the windows of a workspace into a plan.
+     *
+     * @details Windows without an executable path can't be launched and are left out, with a message on the console.
+     *
+     * @param windows The windows, in workspace order.
+     * @param stamp Stored in the plan as is.
+     * @version 0.3.4
+     * @date 2025
+     */
+    RestorePlan compilePlan(std::vector<windowDesc> windows, std::uint64_t stamp = 0);
+
+    /**
+     * @brief Compiles a mapped or stored manifest into a plan. Damaged records are left out, with a message on the console.
+     * @version 0.3.4
+     * @date 2025
+     */
+    RestorePlan compilePlan(const DeskUp::Workspace::WorkspaceView& view, std::uint64_t stamp);
+
+    /**
+     * @brief Merges the plans of several workspaces, laid on top of each other, into one.
+     *
+     * @details An app is restored as the last layer holding it saved it: its windows in the earlier layers are dropped, so
+     * every executable appears once and takes the geometries of the topmost layer. The windows kept are in layer order,
+     * and in workspace order within each layer.
+     *
+     * @param layers The plans, from the bottom layer to the top one.
+     * @return The merged plan, which is never cached (stamp \c 0).
+     * @version 0.3.4
+     * @date 2025
+     */
+    RestorePlan mergePlans(const std::vector<RestorePlan>& layers);
+
+    /**
+     * @brief The part of \c plan selected by \c filter, grouped the same way.
+     *
+     * @details The executables of the filter are looked up in the groups of the plan, so only the windows of those
+     * executables are checked against the rest of the filter. The windows keep their relative order.
+     *
+     * @param plan The compiled workspace.
+     * @param filter The windows to keep.
+     * @return The selected windows, as a plan that is never cached (stamp \c 0).
+     * @version 0.3.4
+     * @date 2025
+     */
+    RestorePlan selectPlan(const RestorePlan& plan, const RestoreFilter& filter);
+
+    /**
+     * @brief Whether \c name matches \c pattern, case-insensitively. `*` matches any run of characters, `?` any single one.
+     * @version 0.3.4
+     * @date 2025
+     */
+    bool matchesPattern(std::string_view name, std::string_view pattern);
+
+    /**
+     * @brief Identifies the contents of a manifest without reading past its header: its checksum and its record count.
+     *
+     * @param manifest The complete manifest image. Only its header is read.
+     * @return The stamp. \c std::nullopt for manifests without checksums (version 1), which are never cached.
+     * @version 0.3.4
+     * @date 2025
+     */
+    std::optional<std::uint64_t> planStamp(std::string_view manifest) noexcept;
+
+    /**
+     * @brief Same as the overload above, from a header already read (see `WorkspaceStore::header()`).
+     * @version 0.3.4
+     * @date 2025
+     */
+    std::optional<std::uint64_t> planStamp(const DeskUp::Workspace::ManifestHeader& header) noexcept;
+
+    /**
+     * @brief Serializes \c plan into an in-memory plan file image.
+     * @version 0.3.4
+     * @date 2025
+     */
+    std::string encodePlan(const RestorePlan& plan);
+
+    /**
+     * @brief Parses a plan file image. Its windows are copied as they are: the plan checksum covers them.
+     *
+     * @param bytes The complete plan file.
+     * @return The plan.
+     * @errors
+     * - Level::Warning, ErrType::InvalidFormat → Bad magic, other version or inconsistent header.
+     * - Level::Warning, ErrType::CorruptedData → The checksum doesn't match, or an index is out of range.
+     * @version 0.3.4
+     * @date 2025
+     */
+    DeskUp::Result<RestorePlan> decodePlan(std::string_view bytes);
+
+    /**
+     * @brief Reads and parses the plan stored at \c file. See @ref decodePlan.
+     * @errors
+     * - Level::Warning, ErrType::FileNotFound → There is no plan at \c file.
+     * - Level::Warning, ErrType::Io → It could not be read.
+     * - Any error returned by @ref decodePlan.
+     * @version 0.3.4
+     * @date 2025
+     */
+    DeskUp::Result<RestorePlan> readPlan(const fs::path& file);
+
+    /**
+     * @brief Replaces \c file with \c plan, atomically (see `Durability::AtomicRename`).
+     * @errors Any error returned by `writeDurably()`.
+     * @version 0.3.4
+     * @date 2025
+     */
+    DeskUp::Status writePlan(const fs::path& file, const RestorePlan& plan);
+}
+
+#endif
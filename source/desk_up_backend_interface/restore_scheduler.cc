@@ -0,0 +1,716 @@
+#include "restore_scheduler.h"
+#include "backend_utils.h"
+#include "desk_up_window_backend.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <cstdlib>
+#include <atomic>
+#include <stop_token>
+
+namespace fs = std::filesystem;
+
+enum class RestoreJobKind { Close, Launch, LaunchGroup, Reuse };
+
+struct RestoreJob {
+	RestoreJobKind kind;
+	std::size_t index;	//into the executables for a close or a group launch, into the windows for a launch or a reuse
+	std::size_t live = 0;	//into the open windows for a reuse
+};
+
+//what a job did, besides returning a fatal error
+struct RestoreOutcome {
+	bool failed = false;	//some step returned a non-fatal error
+	bool relaunched = false;	//a reuse had to launch its window after all
+	bool launched = false;	//the executable was launched
+	std::vector<std::size_t> placed;	//windows placed by a group launch
+	std::vector<std::size_t> unplaced;	//windows a group launch didn't open, to be launched one by one
+	std::vector<std::size_t> late;	//windows left unrestored because their step ran out of time
+};
+
+//everything the workers of a single run share. The executables and windowsOf are fixed before the workers start, the rest is only touched with the mutex held
+struct RestoreState {
+	std::vector<fs::path> executables;
+	std::vector<std::vector<std::size_t>> windowsOf;
+	std::vector<windowDesc> live;
+	const DeskUp::Restore::LaunchProfiles * profiles = nullptr;
+	std::optional<std::chrono::steady_clock::time_point> deadline;
+
+	std::stop_token stop;
+	const DeskUp::Async::ProgressCallback * progress = nullptr;
+	std::atomic<std::size_t> completed{0};
+	std::mutex progressMutex;
+
+	//how long each launch of the run took, recorded into the profiles once the workers are done
+	std::vector<std::pair<fs::path, std::chrono::milliseconds>> samples;
+	std::mutex samplesMutex;
+
+	std::deque<RestoreJob> jobs;
+	std::size_t outstanding = 0;
+	std::optional<DeskUp::Error> fatal;
+	DeskUp::Restore::RestoreReport report;
+
+	std::mutex mutex;
+	std::condition_variable wake;
+};
+
+//workers print from several threads at once
+static void logNonFatal(std::string_view what, const DeskUp::Error& err){
+	static std::mutex coutMutex;
+	std::lock_guard lock(coutMutex);
+	std::cout << what << err.what();
+}
+
+//callbacks are serialized, so whoever receives them never has to
+static void notify(RestoreState& state, DeskUp::Async::Phase phase, std::size_t window){
+	if(!*state.progress){
+		return;
+	}
+
+	std::lock_guard lock(state.progressMutex);
+	DeskUp::Async::notify(*state.progress, phase, window, state.completed.load(), state.report.windows);
+}
+
+static bool sameGeometry(const windowDesc& a, const windowDesc& b){
+	return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+}
+
+static long long geometryDistance(const windowDesc& a, const windowDesc& b){
+	return std::llabs((long long) a.x - b.x) + std::llabs((long long) a.y - b.y)
+		+ std::llabs((long long) a.w - b.w) + std::llabs((long long) a.h - b.h);
+}
+
+//pairs each saved window with at most one open window of the same executable. Identical geometries are paired first, so that
+//a window already in place is never taken by another record, then every remaining record takes the closest one left
+static std::vector<std::optional<std::size_t>> matchOpenWindows(const DeskUp::Restore::RestorePlan& plan, const std::vector<windowDesc>& live){
+	const auto& saved = plan.windows;
+	const auto& savedPaths = plan.keys;
+
+	std::vector<std::optional<std::size_t>> match(saved.size());
+	std::vector<bool> taken(live.size(), false);
+
+	std::vector<std::string> livePaths;
+	for(const auto& w : live){
+		livePaths.push_back(normalizePathLower(w.pathToExec.string()));
+	}
+
+	for(bool exactOnly : {true, false}){
+		for(std::size_t i = 0; i < saved.size(); i++){
+			if(match[i]){
+				continue;
+			}
+
+			std::optional<std::size_t> best;
+			for(std::size_t j = 0; j < live.size(); j++){
+				if(taken[j] || livePaths[j] != savedPaths[i] || (exactOnly && !sameGeometry(saved[i], live[j]))){
+					continue;
+				}
+				if(!best || geometryDistance(saved[i], live[j]) < geometryDistance(saved[i], live[*best])){
+					best = j;
+				}
+			}
+
+			if(best){
+				match[i] = best;
+				taken[*best] = true;
+			}
+		}
+	}
+
+	return match;
+}
+
+static std::optional<DeskUp::Error> resize(DeskUpWindowDevice * device, windowHandle handle, const windowDesc& window, bool& failed){
+	auto resizeRes = device->resizeWindow(device, handle, window);
+	if(!resizeRes.has_value()){
+		if(resizeRes.error().isFatal()){
+			return std::move(resizeRes.error());
+		}
+		logNonFatal("Unresized window: ", resizeRes.error());
+		failed = true;
+	}
+	return std::nullopt;
+}
+
+static windowGeometry geometryOf(const windowDesc& window){
+	return windowGeometry{window.x, window.y, static_cast<unsigned int>(std::max(0, window.w)), static_cast<unsigned int>(std::max(0, window.h))};
+}
+
+//the open windows matched to saved ones are all moved in a single layout, which the device applies as one transaction. The ones
+//that can't be selected anymore are left in relaunch, to be launched like the saved windows without a match
+static std::optional<DeskUp::Error> placeReused(DeskUpWindowDevice * device, RestoreState& state, const std::vector<windowDesc>& windows,
+	const std::vector<std::optional<std::size_t>>& liveOf, const std::vector<std::size_t>& reused, std::vector<std::size_t>& relaunch){
+
+	std::vector<windowPlacement> placements;
+	std::vector<std::size_t> placed;	//the window of each placement
+
+	for(std::size_t i : reused){
+		const windowDesc& open = state.live[*liveOf[i]];
+
+		//already where it was saved
+		if(sameGeometry(open, windows[i])){
+			state.report.restored++;
+			state.report.reused++;
+			state.completed++;
+			notify(state, DeskUp::Async::Phase::Done, i);
+			continue;
+		}
+
+		notify(state, DeskUp::Async::Phase::Placing, i);
+
+		auto selectRes = device->selectOpenWindow(device, open);
+		if(!selectRes.has_value()){
+			if(selectRes.error().isFatal()){
+				return std::move(selectRes.error());
+			}
+
+			//it was closed since it was enumerated
+			logNonFatal("Unmatched window: ", selectRes.error());
+			relaunch.push_back(i);
+			continue;
+		}
+
+		placements.push_back(windowPlacement{selectRes.value(), geometryOf(windows[i])});
+		placed.push_back(i);
+	}
+
+	if(placements.empty()){
+		return std::nullopt;
+	}
+
+	auto layoutRes = device->applyLayout(device, placements);
+	if(!layoutRes.has_value()){
+		if(layoutRes.error().isFatal()){
+			return std::move(layoutRes.error());
+		}
+		logNonFatal("Unplaced windows: ", layoutRes.error());
+	}
+
+	for(std::size_t k = 0; k < placed.size(); k++){
+		bool failed = !layoutRes.has_value();
+
+		if(!failed && k < layoutRes.value().size() && !layoutRes.value()[k].has_value()){
+			const auto& err = layoutRes.value()[k].error();
+			if(err.isFatal()){
+				return err;
+			}
+			logNonFatal("Unresized window: ", err);
+			failed = true;
+		}
+
+		if(failed){
+			state.report.failed++;
+		}
+		else{
+			state.report.restored++;
+			state.report.reused++;
+		}
+
+		state.completed++;
+		notify(state, DeskUp::Async::Phase::Done, placed[k]);
+	}
+
+	return std::nullopt;
+}
+
+//what is left of the run's deadline, if it has one
+static std::optional<std::chrono::milliseconds> timeLeft(const RestoreState& state){
+	if(!state.deadline){
+		return std::nullopt;
+	}
+	return std::max(std::chrono::milliseconds(0), std::chrono::duration_cast<std::chrono::milliseconds>(*state.deadline - std::chrono::steady_clock::now()));
+}
+
+static bool pastDeadline(const RestoreState& state){
+	auto left = timeLeft(state);
+	return left && left->count() == 0;
+}
+
+//the windows a job would have restored
+static std::vector<std::size_t> windowsOfJob(const RestoreState& state, const RestoreJob& job){
+	if(job.kind == RestoreJobKind::Close || job.kind == RestoreJobKind::LaunchGroup){
+		return state.windowsOf[job.index];
+	}
+	return {job.index};
+}
+
+static std::chrono::milliseconds expectedLaunch(const RestoreState& state, const fs::path& executable){
+	if(state.profiles){
+		if(auto expected = state.profiles->expected(executable)){
+			return *expected;
+		}
+	}
+	return DeskUp::Restore::UNPROFILED_LAUNCH_ESTIMATE;
+}
+
+//the windows of an executable are launched once and placed together when the device can, and launched one by one otherwise
+static void launchJobsOf(DeskUpWindowDevice * device, const RestoreState& state, std::size_t executable, std::vector<RestoreJob>& jobs){
+	const auto& group = state.windowsOf[executable];
+
+	if(DeskUp::Backend::supports(device, DeviceCapability::LaunchedWindowPlacement) && group.size() > 1){
+		jobs.push_back(RestoreJob{RestoreJobKind::LaunchGroup, executable});
+		return;
+	}
+
+	for(std::size_t i : group){
+		jobs.push_back(RestoreJob{RestoreJobKind::Launch, i});
+	}
+}
+
+//launches with the wait budget of the app or what is left of the deadline, whichever is shorter, and with the device's own wait
+//when there is neither. The time it took is kept for the profiles
+static DeskUp::Result<windowHandle> load(DeskUpWindowDevice * device, RestoreState& state, const fs::path& executable, RestoreOutcome& outcome){
+	outcome.launched = true;
+
+	std::optional<std::chrono::milliseconds> budget;
+	if(DeskUp::Backend::supports(device, DeviceCapability::BudgetedLaunch)){
+		if(state.profiles){
+			budget = state.profiles->budget(executable);
+		}
+		if(auto left = timeLeft(state)){
+			budget = budget ? std::min(*budget, *left) : *left;
+		}
+	}
+
+	const auto started = std::chrono::steady_clock::now();
+	auto loadRes = budget ? device->loadWindowFromPathWithin(device, executable, *budget) : device->loadWindowFromPath(device, executable);
+	const auto took = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+
+	//a launch that ran out of budget still tells the app takes at least that long
+	if(state.profiles && (loadRes.has_value() || loadRes.error().type() == DeskUp::ErrType::Timeout)){
+		std::lock_guard lock(state.samplesMutex);
+		state.samples.emplace_back(executable, took);
+	}
+
+	return loadRes;
+}
+
+static std::optional<DeskUp::Error> launchAndResize(DeskUpWindowDevice * device, RestoreState& state, const windowDesc& window,
+	std::size_t index, RestoreOutcome& outcome){
+
+	notify(state, DeskUp::Async::Phase::Launching, index);
+
+	auto loadRes = load(device, state, window.pathToExec, outcome);
+	if(!loadRes.has_value()){
+		if(loadRes.error().isFatal()){
+			return std::move(loadRes.error());
+		}
+		logNonFatal("Unopened window: ", loadRes.error());
+
+		//the app may still show up, just not in time to be placed
+		if(loadRes.error().type() == DeskUp::ErrType::Timeout){
+			outcome.late.push_back(index);
+		}
+		else{
+			outcome.failed = true;
+		}
+		return std::nullopt;
+	}
+
+	notify(state, DeskUp::Async::Phase::Placing, index);
+	return resize(device, loadRes.value(), window, outcome.failed);
+}
+
+//launches the executable once and hands its saved geometries to the windows it opens, in order. The windows it didn't open
+//within LAUNCHED_WINDOWS_TIMEOUT are left in outcome.unplaced
+static std::optional<DeskUp::Error> launchGroup(DeskUpWindowDevice * device, RestoreState& state, const std::vector<windowDesc>& windows,
+	std::size_t executable, RestoreOutcome& outcome){
+
+	const auto& group = state.windowsOf[executable];
+	for(std::size_t i : group){
+		notify(state, DeskUp::Async::Phase::Launching, i);
+	}
+
+	auto loadRes = load(device, state, state.executables[executable], outcome);
+	if(!loadRes.has_value()){
+		if(loadRes.error().isFatal()){
+			return std::move(loadRes.error());
+		}
+		logNonFatal("Unopened window: ", loadRes.error());
+
+		if(loadRes.error().type() == DeskUp::ErrType::Timeout){
+			outcome.late = group;
+		}
+		else{
+			outcome.failed = true;
+		}
+		return std::nullopt;
+	}
+
+	std::vector<windowDesc> geometries;
+	geometries.reserve(group.size());
+	for(std::size_t i : group){
+		geometries.push_back(windows[i]);
+		notify(state, DeskUp::Async::Phase::Placing, i);
+	}
+
+	auto timeout = DeskUp::Restore::LAUNCHED_WINDOWS_TIMEOUT;
+	if(auto left = timeLeft(state)){
+		timeout = std::min(timeout, *left);
+	}
+
+	auto placeRes = device->placeLaunchedWindows(device, loadRes.value(), geometries, timeout);
+	if(!placeRes.has_value()){
+		if(placeRes.error().isFatal()){
+			return std::move(placeRes.error());
+		}
+		logNonFatal("Unplaced windows: ", placeRes.error());
+		outcome.failed = true;
+		return std::nullopt;
+	}
+
+	const std::size_t placed = std::min(placeRes.value(), group.size());
+	outcome.placed.assign(group.begin(), group.begin() + placed);
+
+	//there is no time left to launch the windows the app didn't open
+	(pastDeadline(state) ? outcome.late : outcome.unplaced).assign(group.begin() + placed, group.end());
+	return std::nullopt;
+}
+
+//returns the fatal error of the step, if any. Everything else it did is reported through outcome
+static std::optional<DeskUp::Error> runJob(DeskUpWindowDevice * device, const RestoreJob& job, RestoreState& state,
+	const std::vector<windowDesc>& windows, bool forceTermination, RestoreOutcome& outcome){
+
+	if(job.kind == RestoreJobKind::Close){
+		for(std::size_t i : state.windowsOf[job.index]){
+			notify(state, DeskUp::Async::Phase::Closing, i);
+		}
+
+		auto closeRes = device->closeProcessFromPath(device, state.executables[job.index], forceTermination);
+		if(!closeRes.has_value()){
+			if(closeRes.error().isFatal()){
+				return std::move(closeRes.error());
+			}
+			logNonFatal("Unclosed window: ", closeRes.error());
+		}
+		return std::nullopt;
+	}
+
+	if(job.kind == RestoreJobKind::LaunchGroup){
+		return launchGroup(device, state, windows, job.index, outcome);
+	}
+
+	const windowDesc& window = windows[job.index];
+
+	if(job.kind == RestoreJobKind::Reuse){
+		const windowDesc& open = state.live[job.live];
+
+		//already where it was saved
+		if(sameGeometry(open, window)){
+			return std::nullopt;
+		}
+
+		notify(state, DeskUp::Async::Phase::Placing, job.index);
+
+		auto selectRes = device->selectOpenWindow(device, open);
+		if(selectRes.has_value()){
+			return resize(device, selectRes.value(), window, outcome.failed);
+		}
+		if(selectRes.error().isFatal()){
+			return std::move(selectRes.error());
+		}
+
+		//it was closed since it was enumerated
+		logNonFatal("Unmatched window: ", selectRes.error());
+		outcome.relaunched = true;
+	}
+
+	return launchAndResize(device, state, window, job.index, outcome);
+}
+
+static void work(DeskUpWindowDevice * device, RestoreState& state, const std::vector<windowDesc>& windows, bool forceTermination){
+
+	std::unique_lock lock(state.mutex);
+
+	while(true){
+		state.wake.wait(lock, [&]{ return state.fatal || state.stop.stop_requested() || !state.jobs.empty() || state.outstanding == 0; });
+
+		//jobs already running are left to finish, but nothing new is started after a fatal error or a cancellation
+		if(state.fatal || state.stop.stop_requested() || state.jobs.empty()){
+			return;
+		}
+
+		RestoreJob job = state.jobs.front();
+		state.jobs.pop_front();
+
+		//a step started after the deadline would only make the restore later: its windows are left as they are
+		if(pastDeadline(state)){
+			auto late = windowsOfJob(state, job);
+			state.report.late += late.size();
+
+			lock.unlock();
+			for(std::size_t i : late){
+				state.completed++;
+				notify(state, DeskUp::Async::Phase::Done, i);
+			}
+			lock.lock();
+
+			state.outstanding--;
+			state.wake.notify_all();
+			continue;
+		}
+
+		lock.unlock();
+		RestoreOutcome outcome;
+		auto fatal = runJob(device, job, state, windows, forceTermination, outcome);
+
+		if(!fatal && job.kind == RestoreJobKind::LaunchGroup){
+			//the unplaced windows aren't done yet, unless the whole group failed
+			for(std::size_t i : outcome.failed ? state.windowsOf[job.index] : outcome.placed){
+				state.completed++;
+				notify(state, DeskUp::Async::Phase::Done, i);
+			}
+			for(std::size_t i : outcome.late){
+				state.completed++;
+				notify(state, DeskUp::Async::Phase::Done, i);
+			}
+		}
+		else if(!fatal && job.kind != RestoreJobKind::Close){
+			state.completed++;
+			notify(state, DeskUp::Async::Phase::Done, job.index);
+		}
+		lock.lock();
+
+		if(outcome.launched){
+			state.report.launches++;
+		}
+
+		if(fatal){
+			if(!state.fatal){
+				state.fatal = std::move(fatal);
+			}
+		}
+		else if(job.kind == RestoreJobKind::Close){
+			//launches jump ahead of the remaining closes, so every app starts as early as it can
+			std::vector<RestoreJob> launches;
+			launchJobsOf(device, state, job.index, launches);
+			for(auto it = launches.rbegin(); it != launches.rend(); ++it){
+				state.jobs.push_front(*it);
+			}
+			state.outstanding += launches.size();
+		}
+		else if(job.kind == RestoreJobKind::LaunchGroup){
+			if(outcome.failed){
+				state.report.failed += state.windowsOf[job.index].size();
+			}
+			else{
+				state.report.restored += outcome.placed.size();
+				state.report.late += outcome.late.size();
+
+				//the app is running already, so the windows it didn't open are launched next to it, without closing it
+				for(auto it = outcome.unplaced.rbegin(); it != outcome.unplaced.rend(); ++it){
+					state.jobs.push_front(RestoreJob{RestoreJobKind::Launch, *it});
+				}
+				state.outstanding += outcome.unplaced.size();
+			}
+		}
+		else if(!outcome.late.empty()){
+			state.report.late++;
+		}
+		else{
+			outcome.failed ? state.report.failed++ : state.report.restored++;
+			if(!outcome.failed && job.kind == RestoreJobKind::Reuse && !outcome.relaunched){
+				state.report.reused++;
+			}
+		}
+
+		state.outstanding--;
+		state.wake.notify_all();
+	}
+}
+
+DeskUp::Result<DeskUp::Restore::RestoreReport> DeskUp::Restore::RestoreScheduler::run(const std::vector<windowDesc>& windows, bool forceTermination,
+	std::stop_token stop, const DeskUp::Async::ProgressCallback& progress) {
+	return run(compilePlan(windows), forceTermination, stop, progress);
+}
+
+DeskUp::Result<DeskUp::Restore::RestoreReport> DeskUp::Restore::RestoreScheduler::run(const RestorePlan& plan, bool forceTermination,
+	std::stop_token stop, const DeskUp::Async::ProgressCallback& progress) {
+
+	const auto& windows = plan.windows;
+
+	if(!device){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::DeviceNotFound, 0, "RestoreScheduler::run|no_device"));
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+
+	RestoreState state;
+	state.report.windows = windows.size();
+	state.stop = stop;
+	state.progress = &progress;
+	state.profiles = profiles;
+	if(deadline){
+		state.deadline = start + *deadline;
+	}
+
+	std::vector<std::optional<std::size_t>> liveOf(windows.size());
+
+	if(mode == RestoreMode::ReuseLive && DeskUp::Backend::supports(device, DeviceCapability::OpenWindowSelection)){
+		auto live = device->getAllOpenWindows(device);
+		if(live.has_value()){
+			state.live = std::move(live.value());
+			liveOf = matchOpenWindows(plan, state.live);
+		}
+		else if(live.error().isFatal()){
+			return std::unexpected(std::move(live.error()));
+		}
+		else{
+			//nothing can be reused, so everything is relaunched
+			logNonFatal("Unlisted windows: ", live.error());
+		}
+	}
+
+	//devices that can apply a whole layout move every reused window at once, before anything else is done. Once cancelled or
+	//late, the reused windows are left to the workers instead, which count them as such without touching them
+	const bool batchReuse = DeskUp::Backend::supports(device, DeviceCapability::BatchPlacement) && !stop.stop_requested()
+		&& !pastDeadline(state);
+
+	//an executable with a reused window is left running: its other windows are launched next to it
+	std::unordered_set<std::string> keptRunning;
+	std::vector<std::size_t> reused;
+	for(std::size_t i = 0; i < windows.size(); i++){
+		if(liveOf[i]){
+			keptRunning.insert(plan.keys[i]);
+			if(batchReuse){
+				reused.push_back(i);
+			}
+			else{
+				state.jobs.push_back(RestoreJob{RestoreJobKind::Reuse, i, *liveOf[i]});
+			}
+		}
+	}
+
+	std::vector<std::size_t> launchOnly;
+
+	if(auto fatal = placeReused(device, state, windows, liveOf, reused, launchOnly)){
+		return std::unexpected(std::move(*fatal));
+	}
+
+	//every instance of an executable is closed once, before any of its windows is launched again
+	for(std::size_t e = 0; e < plan.executables.size(); e++){
+		std::vector<std::size_t> group;
+		for(std::size_t i : plan.windowsOf[e]){
+			if(!liveOf[i]){
+				group.push_back(i);
+			}
+		}
+
+		if(group.empty()){
+			continue;
+		}
+		if(keptRunning.contains(plan.keys[plan.windowsOf[e].front()])){
+			launchOnly.insert(launchOnly.end(), group.begin(), group.end());
+			continue;
+		}
+
+		state.executables.push_back(plan.executables[e]);
+		state.windowsOf.push_back(std::move(group));
+	}
+
+	//the slowest apps go first: the restore can't end before they have started, so they are the ones worth starting early
+	std::vector<std::chrono::milliseconds> estimates;
+	for(const auto& executable : state.executables){
+		estimates.push_back(expectedLaunch(state, executable));
+	}
+
+	std::vector<std::size_t> order(state.executables.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b){ return estimates[a] > estimates[b]; });
+
+	std::vector<fs::path> executables;
+	std::vector<std::vector<std::size_t>> windowsOf;
+	for(std::size_t i : order){
+		executables.push_back(std::move(state.executables[i]));
+		windowsOf.push_back(std::move(state.windowsOf[i]));
+	}
+	state.executables = std::move(executables);
+	state.windowsOf = std::move(windowsOf);
+
+	std::stable_sort(launchOnly.begin(), launchOnly.end(), [&](std::size_t a, std::size_t b){
+		return expectedLaunch(state, windows[a].pathToExec) > expectedLaunch(state, windows[b].pathToExec);
+	});
+
+	//same for the close phase: the placement above may have used up what was left
+	const bool batchClose = DeskUp::Backend::supports(device, DeviceCapability::BatchClose) && !stop.stop_requested()
+		&& !pastDeadline(state);
+
+	if(batchClose && !state.executables.empty()){
+		//a single close phase that costs as much as the slowest app, then every window can be launched right away
+		for(const auto& group : state.windowsOf){
+			for(std::size_t i : group){
+				notify(state, DeskUp::Async::Phase::Closing, i);
+			}
+		}
+
+		auto closeRes = device->closeProcessesFromPaths(device, state.executables, forceTermination);
+		if(!closeRes.has_value()){
+			if(closeRes.error().isFatal()){
+				return std::unexpected(std::move(closeRes.error()));
+			}
+			logNonFatal("Unclosed windows: ", closeRes.error());
+		}
+
+		std::vector<RestoreJob> launches;
+		for(std::size_t i = 0; i < state.executables.size(); i++){
+			launchJobsOf(device, state, i, launches);
+		}
+		state.jobs.insert(state.jobs.end(), launches.begin(), launches.end());
+	}
+	else{
+		for(std::size_t i = 0; i < state.executables.size(); i++){
+			state.jobs.push_back(RestoreJob{RestoreJobKind::Close, i});
+		}
+	}
+
+	for(std::size_t i : launchOnly){
+		state.jobs.push_back(RestoreJob{RestoreJobKind::Launch, i});
+	}
+
+	state.outstanding = state.jobs.size();
+	//a device that can't be called from several threads at once gets a single worker
+	const std::size_t workerCount = DeskUp::Backend::supports(device, DeviceCapability::ConcurrentCalls) ? concurrency : 1;
+	state.report.concurrency = std::min(workerCount, windows.size());
+
+	//idle workers have to notice the cancellation too, not only the ones finishing a job
+	std::stop_callback wakeOnStop(stop, [&]{
+		std::lock_guard lock(state.mutex);
+		state.wake.notify_all();
+	});
+
+	std::vector<std::thread> workers;
+	workers.reserve(state.report.concurrency);
+	for(std::size_t i = 0; i < state.report.concurrency; i++){
+		workers.emplace_back(work, device, std::ref(state), std::cref(windows), forceTermination);
+	}
+
+	for(auto& worker : workers){
+		worker.join();
+	}
+
+	//launches are worth learning from even if the run didn't finish
+	if(profiles){
+		for(const auto& [executable, took] : state.samples){
+			profiles->record(executable, took);
+		}
+	}
+
+	if(state.fatal){
+		return std::unexpected(std::move(*state.fatal));
+	}
+
+	if(state.outstanding > 0){
+		return std::unexpected(DeskUp::Async::cancelledError("RestoreScheduler::run"));
+	}
+
+	state.report.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+	return state.report;
+}
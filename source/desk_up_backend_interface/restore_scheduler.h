@@ -0,0 +1,224 @@
+/**
+ * @file restore_scheduler.h
+ * @brief Restores the windows of a workspace concurrently, with a bounded number of workers.
+ *
+ * This file is part of DeskUp
+ *
+ * @details
+ * Restoring a window means closing the running instances of its executable, launching it again and moving the new
+ * window to its saved geometry. Launching is by far the slowest step, and it is mostly spent waiting for the app to
+ * start up, so restoring one window after another takes the sum of the startup time of every app.
+ *
+ * Which of the steps below are taken is negotiated with the device: each one is only used when the device advertises the
+ * matching `DeviceCapability` (see `DeskUp::Backend::supports`), and the plain per-window calls are used otherwise.
+ *
+ * @ref DeskUp::Restore::RestoreScheduler runs those steps as jobs on a pool of at most \c concurrency workers:
+ * - Each executable is closed once, no matter how many of its windows are saved. Devices implementing
+ *   `closeProcessesFromPaths` close all of them in a single call before any launch, which waits on every app at once.
+ * - Otherwise, as soon as an executable is closed, its launch jobs are queued ahead of the remaining closes.
+ * - On devices implementing `placeLaunchedWindows`, an executable with several saved windows is launched once, and its
+ *   saved geometries are handed to the windows it opens as they show up. Only the windows it doesn't open within
+ *   @ref DeskUp::Restore::LAUNCHED_WINDOWS_TIMEOUT are launched again, one by one and without closing it.
+ * - Otherwise every window is launched on its own.
+ * - A window is resized by the worker that launched it, right after the launch returns.
+ *
+ * The backend device is therefore called from several threads at once. Each worker moves the window through the handle its
+ * own launch returned, so nothing is handed over between calls (see `DeskUpWindowDevice`). Devices that don't advertise
+ * `DeviceCapability::ConcurrentCalls` get a single worker.
+ *
+ * Given the @ref DeskUp::Restore::LaunchProfiles of previous restores (@ref DeskUp::Restore::RestoreScheduler::useProfiles),
+ * the executables and windows expected to start the slowest are closed and launched first, and each launch is given a wait
+ * budget sized for its app. With enough workers, the restore then takes about as long as its slowest app. Every launch of the
+ * run is timed and recorded back into the profiles.
+ *
+ * With @ref DeskUp::Restore::RestoreMode::ReuseLive, the windows already open are matched to the saved ones first. A matched
+ * window is only moved, its executable is never closed, and only the saved windows left without a match are launched. Devices
+ * implementing `applyLayout` move every matched window in a single call before any other step, so the window manager lays them
+ * out once; otherwise each of them is moved by its own job.
+ *
+ * @author
+ *   Nicolas Serrano Garcia <serranogarcianicolas@gmail.com>
+ * @date
+ *   2025
+ * @copyright
+ *   Copyright (C) 2025 Nicolas Serrano Garcia
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RESTORESCHEDULER_H
+#define RESTORESCHEDULER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stop_token>
+#include <vector>
+
+#include "desk_up_window_device.h"
+#include "window_desc.h"
+#include "desk_up_error.h"
+#include "async_operation.h"
+#include "launch_profile.h"
+#include "restore_plan.h"
+
+namespace DeskUp::Restore {
+
+    /**
+     * @brief Number of windows restored at the same time when the caller doesn't choose one.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr std::size_t DEFAULT_RESTORE_CONCURRENCY = 8;
+
+    /**
+     * @brief Launch time assumed, when ordering launches, for executables that were never launched before.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr std::chrono::milliseconds UNPROFILED_LAUNCH_ESTIMATE{1000};
+
+    /**
+     * @brief How long an app launched for several saved windows is given to open all of them (see `placeLaunchedWindows`).
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr std::chrono::milliseconds LAUNCHED_WINDOWS_TIMEOUT{3000};
+
+    /**
+     * @enum RestoreMode
+     * @brief What a restore does with the apps that are already running.
+     * @version 0.3.4
+     * @date 2025
+     */
+    enum class RestoreMode : std::uint8_t {
+        Relaunch,   /**< Every instance of a saved executable is closed, and every saved window is launched again. */
+        ReuseLive   /**< Open windows matching a saved one (same executable, closest geometry) are moved instead. */
+    };
+
+    /**
+     * @struct RestoreReport
+     * @brief What a restore did, and how long it took.
+     * @version 0.3.4
+     * @date 2025
+     */
+    struct RestoreReport {
+        std::size_t windows = 0;            /**< Windows handed to the scheduler. */
+        std::size_t restored = 0;           /**< Windows launched and resized without any error. */
+        std::size_t failed = 0;             /**< Windows for which some step returned a non-fatal error. */
+        std::size_t reused = 0;             /**< Restored windows that were already open, and were only moved. */
+        std::size_t launches = 0;           /**< Executables launched, fewer than the windows when apps open several of them. */
+        std::size_t late = 0;               /**< Windows left where they were because their step ran out of time budget. */
+        std::size_t concurrency = 0;        /**< Workers actually started. */
+        std::chrono::milliseconds elapsed{0};  /**< Time from the start of the restore until the last window was restored. */
+    };
+
+    /**
+     * @class RestoreScheduler
+     * @brief Restores a set of windows on a pool of worker threads.
+     *
+     * @details Non-fatal errors of a step are logged to console and counted in `RestoreReport::failed`; a window whose
+     * launch failed is not resized. The first fatal error stops every worker from taking new jobs, and is returned once
+     * the jobs already running have finished.
+     *
+     * @version 0.3.4
+     * @date 2025
+     */
+    class RestoreScheduler {
+    public:
+        /**
+         * @param backend The backend device every step is run on. It must outlive the scheduler.
+         * @param workers Maximum number of windows being restored at the same time. \c 0 is treated as \c 1, and so is any
+         * value on devices without `DeviceCapability::ConcurrentCalls`.
+         * @param restoreMode See @ref RestoreMode. \c ReuseLive behaves as \c Relaunch on devices without `selectOpenWindow`.
+         */
+        explicit RestoreScheduler(DeskUpWindowDevice * backend, std::size_t workers = DEFAULT_RESTORE_CONCURRENCY,
+            RestoreMode restoreMode = RestoreMode::Relaunch) noexcept
+            : device(backend), concurrency(workers ? workers : 1), mode(restoreMode) {}
+
+        /**
+         * @brief Orders and budgets the launches of the next runs with \c profiles, and records their launch times into it.
+         *
+         * @details \c profiles is only read while the workers run, and only written by @ref run once they are done. Executables
+         * without a profile are treated as taking @ref UNPROFILED_LAUNCH_ESTIMATE, and are waited on without a budget.
+         *
+         * @param launchProfiles The profiles to use, or \c nullptr to launch in workspace order. It must outlive the runs.
+         * @version 0.3.4
+         * @date 2025
+         */
+        void useProfiles(LaunchProfiles * launchProfiles) noexcept { profiles = launchProfiles; }
+
+        /**
+         * @brief Bounds every next run to \c total, counted from the moment it starts.
+         *
+         * @details The time left is split among the steps as they start: each launch is given the time left (or the budget of
+         * its app, if shorter) through `loadWindowFromPathWithin`, and each app opening several windows is given the time left
+         * (or @ref LAUNCHED_WINDOWS_TIMEOUT, if shorter) to open them. A launch running out of its budget leaves its windows
+         * late, and the steps that haven't started when the deadline passes are not started at all: their windows are counted
+         * in `RestoreReport::late`, and the run returns normally. That includes the batched close of the apps and the layout of
+         * the reused windows, which are done before the workers start.
+         *
+         * Devices without `loadWindowFromPathWithin` can't be told how long to wait, so their launches may overrun the deadline.
+         *
+         * @param total The longest the next runs may take.
+         * @version 0.3.4
+         * @date 2025
+         */
+        void useDeadline(std::chrono::milliseconds total) noexcept { deadline = total; }
+
+        /**
+         * @brief Closes, launches and resizes every window of \c windows. Blocks until all of them are done.
+         *
+         * @details In @ref RestoreMode::ReuseLive, the open windows are enumerated once (`getAllOpenWindows`) before anything
+         * else. A saved window whose match already has its geometry needs no call at all. If a matched window can't be selected
+         * anymore (it was closed in the meantime), it is launched instead.
+         *
+         * Once the workers are done, the launch time of every executable launched is recorded into the profiles given to
+         * @ref useProfiles, if any.
+         *
+         * @param windows The windows to restore. Several of them may share an executable.
+         * @param forceTermination Passed to `closeProcessFromPath` as \c allowForce.
+         * @param stop Once a stop is requested, no new step is started. The steps already running are finished.
+         * @param progress Notified every time a window enters a new phase, from the worker threads.
+         * @return The report of the restore.
+         * @errors
+         * - Level::Error, ErrType::DeviceNotFound → \c device is \c nullptr.
+         * - Level::Warning, ErrType::Cancelled → \c stop was requested before every window was restored.
+         * - The first fatal error returned by the device.
+         * @version 0.3.4
+         * @date 2025
+         */
+        DeskUp::Result<RestoreReport> run(const std::vector<windowDesc>& windows, bool forceTermination,
+            std::stop_token stop = {}, const DeskUp::Async::ProgressCallback& progress = {});
+
+        /**
+         * @brief Same as the overload taking the windows, for a plan compiled beforehand (see `compilePlan()`). The windows
+         * are neither checked nor grouped again.
+         * @version 0.3.4
+         * @date 2025
+         */
+        DeskUp::Result<RestoreReport> run(const RestorePlan& plan, bool forceTermination,
+            std::stop_token stop = {}, const DeskUp::Async::ProgressCallback& progress = {});
+
+    private:
+        DeskUpWindowDevice * device;
+        std::size_t concurrency;
+        RestoreMode mode;
+        LaunchProfiles * profiles = nullptr;
+        std::optional<std::chrono::milliseconds> deadline;
+    };
+}
+
+#endif
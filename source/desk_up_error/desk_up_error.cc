@@ -112,4 +112,39 @@ DeskUp::Error DeskUp::Error::fromSaveError(int e){
         default: // other
             return Error(Level::Warning, ErrType::Default, e, "saveTo|unrecognized_error");
     }
-}
\ No newline at end of file
+}
+
+DeskUp::Error DeskUp::Error::fromLoadError(int e){
+    switch (e) {
+
+        case 1: // LoadErrorCode::LOAD_SUCCESS
+            return Error(Level::Info, ErrType::None, e, "recoverSavedWindow|success");
+
+        case -1: // LoadErrorCode::ERR_LOAD_NO_FILE
+            return Error(Level::Fatal, ErrType::InvalidInput, e, "recoverSavedWindow|no_file");
+
+        case -2: // LoadErrorCode::ERR_LOAD_FILE_NOT_OPEN
+            return Error(Level::Skip, ErrType::Io, e, "recoverSavedWindow|file_unopen");
+
+        case -3: // LoadErrorCode::ERR_LOAD_INCOMPLETE
+            return Error(Level::Fatal, ErrType::InvalidInput, e, "recoverSavedWindow|previous_write_failed");
+
+        case -4: // LoadErrorCode::ERR_LOAD_INVALID_X
+            return Error(Level::Retry, ErrType::InvalidInput, e, "recoverSavedWindow|invalid_read_x");
+
+        case -5: // LoadErrorCode::ERR_LOAD_INVALID_Y
+            return Error(Level::Retry, ErrType::InvalidInput, e, "recoverSavedWindow|invalid_read_y");
+
+        case -6: // LoadErrorCode::ERR_LOAD_INVALID_W
+            return Error(Level::Retry, ErrType::InvalidInput, e, "recoverSavedWindow|invalid_read_w");
+
+        case -7: // LoadErrorCode::ERR_LOAD_INVALID_H
+            return Error(Level::Retry, ErrType::InvalidInput, e, "recoverSavedWindow|invalid_read_h");
+
+        case -8: // LoadErrorCode::ERR_LOAD_UNSUPPORTED_VERSION
+            return Error(Level::Error, ErrType::InvalidFormat, e, "recoverSavedWindow|unsupported_version");
+
+        default: // other
+            return Error(Level::Warning, ErrType::Default, e, "recoverSavedWindow|unrecognized_error");
+    }
+}
@@ -109,6 +109,7 @@ namespace DeskUp {
         NotImplemented,       /**< Feature not yet implemented. */
 		PolicyUpdated,		  /**< External factors like dll dependencies have changed. */
 		FunctionFailed,		  /**< Generic function fail. */
+        Cancelled,            /**< The operation was stopped on request before it finished. */
         Default,              /**< Unspecified error type. */
         None                  /**< Represents no error. */
     };
@@ -245,6 +246,16 @@ namespace DeskUp {
          */
         static Error fromSaveError(int e);
 
+        /**
+         * @brief Converts a `LoadErrorCode` (from `window_desc_loader.cc`) into a structured error.
+         *
+         * @param e Integer error code returned by a `windowDescLoader` operation.
+         * @return A structured @ref Error describing the load failure.
+         * @version 0.3.4
+         * @date 2025
+         */
+        static Error fromLoadError(int e);
+
     private:
         Level lvl;                /**< Error severity level. */
         ErrType errType;          /**< Error category/type. */
@@ -46,6 +46,8 @@ QString ErrorAdapter::getUserMessage(const DeskUp::Error& err)
             return "The system ran out of memory.";
         case ErrType::Timeout:
             return "The operation timed out and was cancelled.";
+        case ErrType::Cancelled:
+            return "The operation was cancelled.";
         case ErrType::Unexpected:
             return "An unexpected error occurred.";
         default:
@@ -30,7 +30,30 @@ MainWindow::MainWindow(QWidget *parent)
     if (!DU_Init()) {
         QMessageBox::critical(this, "DeskUp error",
             "There was an error initializing DeskUp. Try closing and reopening the app.");
+        return;
     }
+
+    flagCorruptedWorkspaces();
+}
+
+void MainWindow::flagCorruptedWorkspaces()
+{
+    // Only checksums are compared, so this stays cheap even with many saved workspaces
+    const auto corrupted = DeskUpBackendInterface::findCorruptedWorkspaces();
+    if (corrupted.empty()) {
+        return;
+    }
+
+    QString names;
+    for (const auto& [name, error] : corrupted) {
+        names += "\n - " + QString::fromStdString(name);
+    }
+
+    statusBar()->showMessage(QString("%1 damaged workspace(s) found").arg(corrupted.size()));
+
+    QMessageBox::warning(this, "Damaged workspaces",
+        "The following workspaces are damaged and may not be restored completely:" + names +
+        "\n\nSaving them again will repair them.");
 }
 
 void MainWindow::setupMenus()
@@ -123,9 +146,8 @@ void MainWindow::onAddWorkspace(){
             QMessageBox::No);
 
         if (response == QMessageBox::Yes) {
-            DeskUpBackendInterface::removeWorkspace(ws);
-
-            if (auto res = DeskUpBackendInterface::saveAllWindowsLocal(ws); !res.has_value()) {
+            //only the windows that changed since the last save get written
+            if (auto res = DeskUpBackendInterface::updateWorkspace(ws); !res.has_value()) {
                 DeskUp::UI::ErrorAdapter::showError(std::move(res.error()));
             }
         }
@@ -20,6 +20,7 @@ private slots:
 
 private:
     void setupMenus();
+    void flagCorruptedWorkspaces();
 
     static void showSaveSuccessful();
     static void showRestoreSuccessful();
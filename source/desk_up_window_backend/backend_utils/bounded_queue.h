@@ -0,0 +1,126 @@
+/**
+ * @file bounded_queue.h
+ * @brief A fixed-capacity, blocking, multi-producer multi-consumer queue.
+ *
+ * This file is part of DeskUp
+ *
+ * @details
+ * Used to hand work between pipeline stages running on different threads (for example, the window
+ * enumeration and the disk writer of a streaming save). Because the capacity is fixed, a fast producer
+ * blocks instead of piling up items, so the memory used by the pipeline doesn't grow with the amount of work.
+ *
+ * @author
+ *   Nicolas Serrano Garcia <serranogarcianicolas@gmail.com>
+ * @date
+ *   2025
+ * @copyright
+ *   Copyright (C) 2025 Nicolas Serrano Garcia
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+/**
+ * @class BoundedQueue
+ * @brief A blocking queue holding at most \c capacity items.
+ *
+ * @details Once @ref close() is called, producers are rejected and consumers drain what is left, then receive
+ * \c std::nullopt. Closing is how either side tells the other to stop.
+ *
+ * @tparam T The item type. Must be movable.
+ * @version 0.3.4
+ * @date 2025
+ */
+template<typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(std::size_t maxItems) : capacity(maxItems ? maxItems : 1) {}
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * @brief Pushes \c item, blocking while the queue is full.
+     * @return \c false if the queue was closed (the item is dropped), \c true otherwise.
+     */
+    bool push(T item){
+        std::unique_lock lock(mutex);
+        notFull.wait(lock, [&]{ return closed || items.size() < capacity; });
+
+        if(closed){
+            return false;
+        }
+
+        items.push_back(std::move(item));
+        lock.unlock();
+        notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Pops the oldest item, blocking while the queue is empty and open.
+     * @return The item, or \c std::nullopt once the queue is closed and drained.
+     */
+    std::optional<T> pop(){
+        std::unique_lock lock(mutex);
+        notEmpty.wait(lock, [&]{ return closed || !items.empty(); });
+
+        if(items.empty()){
+            return std::nullopt;
+        }
+
+        T item = std::move(items.front());
+        items.pop_front();
+        lock.unlock();
+        notFull.notify_one();
+        return item;
+    }
+
+    /**
+     * @brief Closes the queue, waking every blocked producer and consumer.
+     */
+    void close(){
+        {
+            std::lock_guard lock(mutex);
+            closed = true;
+        }
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+
+    /** @brief Whether @ref close() has been called. */
+    bool isClosed() const {
+        std::lock_guard lock(mutex);
+        return closed;
+    }
+
+private:
+    const std::size_t capacity;
+    std::deque<T> items;
+    bool closed = false;
+    mutable std::mutex mutex;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+};
+
+#endif
@@ -0,0 +1,206 @@
+/**
+ * @file desk_up_window_backend.h
+ * @brief The contract of a window backend, as a concept, and the backend that dispatches through a \c DeskUpWindowDevice
+ *
+ * This file is part of DeskUp
+ *
+ * @details
+ * A \c DeskUpWindowDevice is a struct of function pointers: every call made through it is an indirect call the compiler can't
+ * inline or see through. That is what plugins and tests need (a device can be swapped at runtime for a dummy one), but a build
+ * that only targets one platform always ends up calling the same backend.
+ *
+ * @ref DeskUp::Backend::WindowBackend describes the calls a backend offers as a concept, so code templated on it binds them at
+ * compile time. Two kinds of types model it:
+ * - @ref DeskUp::Backend::DeviceBackend, which forwards every call to the function pointers of a device. It works with any device.
+ * - The static backend of a platform (`WinWindowBackend` on Windows), which calls the functions of that backend directly. It is
+ *   only valid for a device created by that same backend.
+ *
+ * `DU_WithBackend()` in window_core_backend.h picks one of them for the current device.
+ *
+ * @author
+ *   Nicolas Serrano Garcia <serranogarcianicolas@gmail.com>
+ * @date
+ *   2025
+ * @copyright
+ *   Copyright (C) 2025 Nicolas Serrano Garcia
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef DESKUPWINDOWBACKEND_H
+#define DESKUPWINDOWBACKEND_H
+
+#include <concepts>
+#include <vector>
+#include <filesystem>
+#include <functional>
+
+#include "desk_up_window_device.h"
+#include "window_desc.h"
+#include "desk_up_error.h"
+
+namespace fs = std::filesystem;
+
+namespace DeskUp::Backend {
+
+    /**
+     * @brief What enumerations hand every window to, as in \c DeskUpWindowDevice::streamOpenWindows.
+     * @version 0.3.4
+     * @date 2025
+     */
+    using WindowSink = std::function<DeskUp::Status(windowDesc&&)>;
+
+    /**
+     * @brief Whether \c device can be driven through \c capability: it advertises it, and it sets every pointer the capability
+     * relies on.
+     *
+     * @details A device advertising a capability it doesn't implement is treated as not having it, so a wrong advertisement
+     * only costs the faster path.
+     *
+     * @param device The device. \c nullptr supports nothing
+     * @param capability A single capability
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline bool supports(const DeskUpWindowDevice * device, DeviceCapability capability) noexcept {
+        if(!device || !hasCapability(device->capabilities, capability)){
+            return false;
+        }
+
+        switch(capability){
+            case DeviceCapability::BatchQueries:            return device->getWindowGeometry && device->getWindowsGeometry;
+            case DeviceCapability::StreamedEnumeration:     return device->streamOpenWindows != nullptr;
+            case DeviceCapability::BatchClose:              return device->closeProcessesFromPaths != nullptr;
+            case DeviceCapability::BudgetedLaunch:          return device->loadWindowFromPathWithin != nullptr;
+            case DeviceCapability::OpenWindowSelection:     return device->selectOpenWindow != nullptr;
+            case DeviceCapability::LaunchedWindowPlacement: return device->placeLaunchedWindows != nullptr;
+            case DeviceCapability::BatchPlacement:          return device->applyLayout != nullptr;
+            default:                                        return true;
+        }
+    }
+
+    /**
+     * @brief The calls every window backend offers, with the same meaning and errors as the \c DeskUpWindowDevice member of the
+     * same name (without its \c _this parameter).
+     *
+     * @details Backends are small values (usually a device pointer), passed by copy. \c canStream tells whether
+     * \c streamOpenWindows hands out the windows while they are enumerated; backends that can't still implement it, by enumerating
+     * every window first.
+     *
+     * @version 0.3.4
+     * @date 2025
+     */
+    template<typename B>
+    concept WindowBackend = std::copyable<B> && requires(const B backend, windowHandle window, const windowDesc& desc,
+        const fs::path& path, const WindowSink& sink, bool allowForce) {
+        { backend.getWindowGeometry(window) } -> std::same_as<DeskUp::Result<windowGeometry>>;
+        { backend.getPathFromWindow(window) } -> std::same_as<DeskUp::Result<fs::path>>;
+        { backend.getAllOpenWindows() } -> std::same_as<DeskUp::Result<std::vector<windowDesc>>>;
+        { backend.canStream() } -> std::same_as<bool>;
+        { backend.streamOpenWindows(sink) } -> std::same_as<DeskUp::Status>;
+        { backend.recoverSavedWindow(path) } -> std::same_as<DeskUp::Result<windowDesc>>;
+        { backend.loadWindowFromPath(path) } -> std::same_as<DeskUp::Result<windowHandle>>;
+        { backend.resizeWindow(window, desc) } -> std::same_as<DeskUp::Status>;
+        { backend.closeProcessFromPath(path, allowForce) } -> std::same_as<DeskUp::Result<unsigned int>>;
+    };
+
+    /**
+     * @struct DeviceBackend
+     * @brief The backend of any device: every call goes through the function pointers of \c device.
+     *
+     * @details The capabilities the calls rely on are replaced as the rest of DeskUp does when the device doesn't support them
+     * (see @ref supports): \c getWindowGeometry by the four per-field queries, \c streamOpenWindows by \c getAllOpenWindows.
+     *
+     * @version 0.3.4
+     * @date 2025
+     */
+    struct DeviceBackend {
+        DeskUpWindowDevice * device = nullptr;
+
+        DeskUp::Result<windowGeometry> getWindowGeometry(windowHandle window) const {
+            if(supports(device, DeviceCapability::BatchQueries)){
+                return device->getWindowGeometry(device, window);
+            }
+
+            auto x = device->getWindowXPos(device, window);
+            if(!x.has_value()){
+                return std::unexpected(std::move(x.error()));
+            }
+            auto y = device->getWindowYPos(device, window);
+            if(!y.has_value()){
+                return std::unexpected(std::move(y.error()));
+            }
+            auto w = device->getWindowWidth(device, window);
+            if(!w.has_value()){
+                return std::unexpected(std::move(w.error()));
+            }
+            auto h = device->getWindowHeight(device, window);
+            if(!h.has_value()){
+                return std::unexpected(std::move(h.error()));
+            }
+
+            return windowGeometry{x.value(), y.value(), w.value(), h.value()};
+        }
+
+        DeskUp::Result<fs::path> getPathFromWindow(windowHandle window) const {
+            return device->getPathFromWindow(device, window);
+        }
+
+        DeskUp::Result<std::vector<windowDesc>> getAllOpenWindows() const {
+            return device->getAllOpenWindows(device);
+        }
+
+        bool canStream() const {
+            return supports(device, DeviceCapability::StreamedEnumeration);
+        }
+
+        DeskUp::Status streamOpenWindows(const WindowSink& sink) const {
+            if(canStream()){
+                return device->streamOpenWindows(device, sink);
+            }
+
+            auto windows = device->getAllOpenWindows(device);
+            if(!windows.has_value()){
+                return std::unexpected(std::move(windows.error()));
+            }
+
+            for(auto& window : windows.value()){
+                if(auto res = sink(std::move(window)); !res.has_value()){
+                    return res;
+                }
+            }
+            return {};
+        }
+
+        DeskUp::Result<windowDesc> recoverSavedWindow(const fs::path& path) const {
+            return device->recoverSavedWindow(device, path);
+        }
+
+        DeskUp::Result<windowHandle> loadWindowFromPath(const fs::path& path) const {
+            return device->loadWindowFromPath(device, path);
+        }
+
+        DeskUp::Status resizeWindow(windowHandle window, const windowDesc& geometry) const {
+            return device->resizeWindow(device, window, geometry);
+        }
+
+        DeskUp::Result<unsigned int> closeProcessFromPath(const fs::path& path, bool allowForce) const {
+            return device->closeProcessFromPath(device, path, allowForce);
+        }
+    };
+
+    static_assert(WindowBackend<DeviceBackend>);
+}
+
+#endif
@@ -59,9 +59,11 @@ struct DeskUpWindowBootStrap{
     /**
      * @brief A pointer to function that creates a Device.
      *  
+     * @details The device advertises what it supports in its \c capabilities, which is how the interface negotiates the
+     * strategies it uses with it.
      * 
      * @return A pointer to a heap allocated windowDevice. 
-     * @version 0.1.0
+     * @version 0.3.4
      * @date 2025
      */
     DeskUpWindowDevice (*createDevice)();
@@ -29,14 +29,95 @@
 #define DESKUPWINDOWDEVICE_H
 
 #include <vector>
+#include <chrono>
+#include <cstdint>
 #include <string>
 #include <filesystem>
+#include <functional>
+#include <optional>
+#include <span>
 
 #include "window_desc.h"
 #include "desk_up_error.h"
 
 namespace fs = std::filesystem;
 
+/**
+ * @struct windowGeometry
+ * @brief The rectangle of a window, as a single device query returns it.
+ * @version 0.3.4
+ * @date 2025
+ */
+struct windowGeometry {
+    int x = 0;              /**< X coordinate of the top-left corner, in pixels. */
+    int y = 0;              /**< Y coordinate of the top-left corner, in pixels. */
+    unsigned int w = 0;     /**< Width in pixels. */
+    unsigned int h = 0;     /**< Height in pixels. */
+};
+
+/**
+ * @brief Opaque handle of a window, as the backend knows it (an \c HWND on Windows).
+ *
+ * @details Handles are returned by the calls that find or open a window (\c loadWindowFromPath, \c selectOpenWindow) and passed
+ * to every call that acts on one. A handle stays valid for as long as its window is open; calls given the handle of a closed
+ * window return a non-fatal error.
+ *
+ * @version 0.3.4
+ * @date 2025
+ */
+using windowHandle = void *;
+
+/**
+ * @struct windowPlacement
+ * @brief A window and the rectangle it has to be moved to: one entry of a layout applied with \c DeskUpWindowDevice::applyLayout.
+ * @version 0.3.4
+ * @date 2025
+ */
+struct windowPlacement {
+    windowHandle window = nullptr;  /**< The window to move, as returned by \c loadWindowFromPath or \c selectOpenWindow. */
+    windowGeometry geometry;        /**< Where it goes. Its width and height must not be 0. */
+};
+
+/**
+ * @enum DeviceCapability
+ * @brief The features a device advertises beyond the calls every device has. Values are flags, combined with \c operator|.
+ *
+ * @details DeskUp only takes the faster path a capability allows when the device advertises it, and when it also sets the
+ * pointers it relies on (see `DeskUp::Backend::supports`). A device advertising nothing is driven with the per-window calls
+ * only, one worker at a time.
+ *
+ * @version 0.3.4
+ * @date 2025
+ */
+enum class DeviceCapability : std::uint32_t {
+    None                    = 0,
+    BatchQueries            = 1u << 0,  /**< \c getWindowGeometry and \c getWindowsGeometry: a whole rectangle, or several, in one call. */
+    StreamedEnumeration     = 1u << 1,  /**< \c streamOpenWindows: windows are handed out while they are enumerated. */
+    BatchClose              = 1u << 2,  /**< \c closeProcessesFromPaths: every app is closed at once, against one deadline. */
+    BudgetedLaunch          = 1u << 3,  /**< \c loadWindowFromPathWithin: launches stop waiting after a budget. */
+    OpenWindowSelection     = 1u << 4,  /**< \c selectOpenWindow: windows already open can be moved instead of relaunched. */
+    LaunchedWindowPlacement = 1u << 5,  /**< \c placeLaunchedWindows: an app is launched once for all of its windows. */
+    BatchPlacement          = 1u << 6,  /**< \c applyLayout: several windows are moved in one transaction. */
+    ConcurrentCalls         = 1u << 7   /**< Calls can be made from several threads at once, each on a different window. */
+};
+
+constexpr DeviceCapability operator|(DeviceCapability a, DeviceCapability b) noexcept {
+    return static_cast<DeviceCapability>(static_cast<std::uint32_t>(a) | static_cast<std::uint32_t>(b));
+}
+
+constexpr DeviceCapability operator&(DeviceCapability a, DeviceCapability b) noexcept {
+    return static_cast<DeviceCapability>(static_cast<std::uint32_t>(a) & static_cast<std::uint32_t>(b));
+}
+
+/**
+ * @brief Whether every flag of \c wanted is in \c set.
+ * @version 0.3.4
+ * @date 2025
+ */
+constexpr bool hasCapability(DeviceCapability set, DeviceCapability wanted) noexcept {
+    return (set & wanted) == wanted;
+}
+
 /**
  * @struct DeskUpWindowDevice
  * @brief This abstract struct represents all the common calls that any backend must have.
@@ -46,6 +127,9 @@ namespace fs = std::filesystem;
  *           expected result for that specific backend.
  *           This struct also carries specific backend information needed to get information from a backend successfully.
  *
+ *           Every call acting on a window takes the handle of that window, and none of them keeps anything between two calls, so a
+ *           single device can be used from several threads at once: backends only read their \c internalData after creating it.
+ *           Devices that can't be advertise it by leaving \c DeviceCapability::ConcurrentCalls out of \c capabilities.
  *
  * @see windowData
  * @author Nicolas Serrano Garcia <serranogarcianicolas@gmail.com>
@@ -58,51 +142,85 @@ struct DeskUpWindowDevice{
      * @brief A pointer to function that is used to get the height of a window.
      *
      * @param _this The very same instance
+     * @param window The window to query
      * @return An \c unsigned \c int representing the height of the window
-     * @version 0.1.0
+     * @version 0.3.4
      * @date 2025
      */
-    DeskUp::Result<unsigned int> (*getWindowHeight)(DeskUpWindowDevice * _this);
+    DeskUp::Result<unsigned int> (*getWindowHeight)(DeskUpWindowDevice * _this, windowHandle window);
 
     /**
      * @brief A pointer to function that is used to get the width of a window.
      *
      * @param _this The very same instance
+     * @param window The window to query
      * @return An \c unsigned \c int representing the width of the window
-     * @version 0.1.0
+     * @version 0.3.4
      * @date 2025
      */
-    DeskUp::Result<unsigned int> (*getWindowWidth)(DeskUpWindowDevice * _this);
+    DeskUp::Result<unsigned int> (*getWindowWidth)(DeskUpWindowDevice * _this, windowHandle window);
 
     /**
      * @brief A pointer to function that is used to get the X position of a the top left corner of a window.
      *
      * @param _this The very same instance
+     * @param window The window to query
      * @return An \c int representing the X position of the top left corner of a window
-     * @version 0.1.0
+     * @version 0.3.4
      * @date 2025
      */
-    DeskUp::Result<int> (*getWindowXPos)(DeskUpWindowDevice * _this);
+    DeskUp::Result<int> (*getWindowXPos)(DeskUpWindowDevice * _this, windowHandle window);
 
     /**
      * @brief A pointer to function that is used to get the Y position of a the top left corner of a window.
      *
      * @param _this The very same instance
+     * @param window The window to query
      * @return An \c int representing the Y position of the top left corner of a window
-     * @version 0.1.0
+     * @version 0.3.4
      * @date 2025
      */
-    DeskUp::Result<int> (*getWindowYPos)(DeskUpWindowDevice * _this);
+    DeskUp::Result<int> (*getWindowYPos)(DeskUpWindowDevice * _this, windowHandle window);
+
+    /**
+     * @brief A pointer to function that gets the whole rectangle of a window in a single query.
+     *
+     * @details Does the work of \c getWindowXPos, \c getWindowYPos, \c getWindowWidth and \c getWindowHeight at once, which
+     * backends implement as thin wrappers around it. This pointer is optional: backends without it leave it as \c nullptr.
+     *
+     * @param _this The very same instance
+     * @param window The window to query
+     * @return The geometry of the window
+     * @version 0.3.4
+     * @date 2025
+     */
+    DeskUp::Result<windowGeometry> (*getWindowGeometry)(DeskUpWindowDevice * _this, windowHandle window) = nullptr;
+
+    /**
+     * @brief A pointer to function that gets the rectangles of several windows in one call.
+     *
+     * @details Backends able to pipeline their queries send them all at once. A window that can't be queried (it was closed
+     * in the meantime) doesn't fail the batch. This pointer is optional: backends without it leave it as \c nullptr.
+     *
+     * @param _this The very same instance
+     * @param windows The windows to query
+     * @return One entry per window of \c windows, in the same order. \c std::nullopt for the windows that couldn't be queried
+     * @version 0.3.4
+     * @date 2025
+     */
+    DeskUp::Result<std::vector<std::optional<windowGeometry>>> (*getWindowsGeometry)(DeskUpWindowDevice * _this,
+        const std::vector<windowHandle>& windows) = nullptr;
 
 	/**
      * @brief A pointer to function that is used to get the path to the executable that created the window
      *
      * @param _this The very same instance
+     * @param window The window to query
      * @return An \c filesystem::path representing the path of the window
-     * @version 0.1.0
+     * @version 0.3.4
      * @date 2025
      */
-    DeskUp::Result<fs::path> (*getPathFromWindow)(DeskUpWindowDevice * _this);
+    DeskUp::Result<fs::path> (*getPathFromWindow)(DeskUpWindowDevice * _this, windowHandle window);
 
     /**
      * @brief A pointer to function that is used to get the generic DeskUp workspaces path.
@@ -127,16 +245,50 @@ struct DeskUpWindowDevice{
      */
     DeskUp::Result<std::vector<windowDesc>> (*getAllOpenWindows)(DeskUpWindowDevice * _this);
 
+    /**
+     * @brief A pointer to function that enumerates the same windows as \c getAllOpenWindows, but hands each one to \c sink
+     * as soon as it is complete instead of collecting them in a vector.
+     *
+     * @details This lets callers overlap the per-window queries with their own work (e.g. writing to disk). If \c sink returns
+     * an error, the enumeration stops and that same error is returned. This pointer is optional: backends that can't stream
+     * leave it as \c nullptr, and callers fall back to \c getAllOpenWindows.
+     *
+     * @param _this The very same instance
+     * @param sink Called once per window, in enumeration order, on the calling thread
+     * @return \c DeskUp::Status, empty if every window was enumerated and accepted by \c sink
+     * @version 0.3.4
+     * @date 2025
+     */
+    DeskUp::Status (*streamOpenWindows)(DeskUpWindowDevice * _this, const std::function<DeskUp::Status(windowDesc&&)>& sink) = nullptr;
+
     /**
      * @brief A pointer to function that is used to open a window from a given path. If the path is empty,
      *
+     * @details Restores call it from several threads at once, each for a different window.
+     *
      * @param _this The very same instance
      * @param path a \c const \c char* to the executable
-     * @return \c void
-     * @version 0.2.0
+     * @return The handle of the main window of the launched app, to be passed to \c resizeWindow
+     * @version 0.3.4
+     * @date 2025
+     */
+    DeskUp::Result<windowHandle> (*loadWindowFromPath)(DeskUpWindowDevice * _this, const fs::path& path);
+
+    /**
+     * @brief A pointer to function that does the same as \c loadWindowFromPath, but stops waiting for the window after \c budget.
+     *
+     * @details Restores pass a budget sized from how long the app took to start in previous restores (see launch_profile.h), so
+     * that an app that never shows a window doesn't hold a worker forever. The app is left running when the budget runs out.
+     * This pointer is optional: backends without it leave it as \c nullptr, and \c loadWindowFromPath is called instead.
+     *
+     * @param _this The very same instance
+     * @param path The executable
+     * @param budget How long to wait, from the launch, for the app to show its window
+     * @return The handle of the main window of the launched app. Level::Retry, ErrType::Timeout if the window didn't show up within \c budget
+     * @version 0.3.4
      * @date 2025
      */
-    DeskUp::Status (*loadWindowFromPath)(DeskUpWindowDevice * _this, const fs::path& path);
+    DeskUp::Result<windowHandle> (*loadWindowFromPathWithin)(DeskUpWindowDevice * _this, const fs::path& path, std::chrono::milliseconds budget) = nullptr;
 
     /**
      * @brief A pointer to function that is used to recover a window from a deskUp file, which shall be located inside appData\DeskUp
@@ -153,16 +305,14 @@ struct DeskUpWindowDevice{
     /**
      * @brief A pointer to function that is used to resize a given window.
      *
-     * @details Information about the window whose geometry is intended to modify must be specified inside the \c _this->internalData parameter
-     *
-     *
      * @param _this The very same instance
-     * @param path a \c windowDesc instance whose geometry wants to be used for the resizing
+     * @param window The window to move, as returned by \c loadWindowFromPath or \c selectOpenWindow
+     * @param geometry a \c windowDesc instance whose geometry wants to be used for the resizing
      * @return A \c void
-     * @version 0.2.0
+     * @version 0.3.4
      * @date 2025
      */
-    DeskUp::Status (*resizeWindow)(DeskUpWindowDevice * _this, const windowDesc window);
+    DeskUp::Status (*resizeWindow)(DeskUpWindowDevice * _this, windowHandle window, const windowDesc geometry);
 
     /**
      * @brief A pointer to function that is used to close all the windows associated with a given path.
@@ -176,6 +326,84 @@ struct DeskUpWindowDevice{
      */
     DeskUp::Result<unsigned int> (*closeProcessFromPath)(DeskUpWindowDevice * _this, const fs::path& path, bool allowForce);
 
+    /**
+     * @brief A pointer to function that closes all the windows associated with any of the given paths, at once.
+     *
+     * @details Every close request is sent before waiting on any process, and all of them share one deadline, so the call lasts as
+     * long as the slowest app instead of the sum of all of them. This pointer is optional: backends that can't batch leave it as
+     * \c nullptr, and callers fall back to one \c closeProcessFromPath per path.
+     *
+     * @param _this The very same instance
+     * @param paths The executables to close. Callers pass each one once
+     * @param allowForce Whether if the call should force the programs to close
+     * @return The number of closed processes
+     * @version 0.3.4
+     * @date 2025
+     */
+    DeskUp::Result<unsigned int> (*closeProcessesFromPaths)(DeskUpWindowDevice * _this, const std::vector<fs::path>& paths, bool allowForce) = nullptr;
+
+    /**
+     * @brief A pointer to function that finds an open window and returns its handle, exactly as \c loadWindowFromPath returns the
+     * one it opens.
+     *
+     * @details Lets a restore move the windows that are already open instead of closing and launching their app again. This pointer
+     * is optional: backends that can't select an open window leave it as \c nullptr, and every window is launched again.
+     *
+     * @param _this The very same instance
+     * @param window An open window, as returned by \c getAllOpenWindows: its executable and its current geometry must match
+     * @return The handle of the window found
+     * @version 0.3.4
+     * @date 2025
+     */
+    DeskUp::Result<windowHandle> (*selectOpenWindow)(DeskUpWindowDevice * _this, const windowDesc& window) = nullptr;
+
+    /**
+     * @brief A pointer to function that places the windows of an app just launched by \c loadWindowFromPath.
+     *
+     * @details The first geometry goes to \c launched, the window \c loadWindowFromPath found. Every other one goes to the next top-level window
+     * the same process opens, in the order they show up, until every geometry is used or \c timeout has passed. Lets a restore
+     * launch an app once for all of its saved windows (apps reopening their previous session, for instance), instead of once per
+     * window. This pointer is optional: backends without it leave it as \c nullptr, and every window is launched on its own.
+     *
+     * @param _this The very same instance
+     * @param launched The window returned by the launch
+     * @param windows The saved windows of the launched executable, in the order their geometries should be handed out
+     * @param timeout How long to wait for the app to open the windows left after the first one
+     * @return The number of windows placed, i.e. the first ones of \c windows. The rest are up to the caller
+     * @version 0.3.4
+     * @date 2025
+     */
+    DeskUp::Result<std::size_t> (*placeLaunchedWindows)(DeskUpWindowDevice * _this, windowHandle launched,
+        const std::vector<windowDesc>& windows, std::chrono::milliseconds timeout) = nullptr;
+
+    /**
+     * @brief A pointer to function that moves and resizes several windows as a single transaction.
+     *
+     * @details Does the work of one \c resizeWindow per placement, but the window manager lays out and repaints the windows once
+     * for the whole layout instead of once per window, and the geometries are checked afterwards with a single batched read.
+     * A placement that fails (its window was closed, for instance) doesn't fail the others. This pointer is optional: backends
+     * without it leave it as \c nullptr, and callers fall back to one \c resizeWindow per window.
+     *
+     * @param _this The very same instance
+     * @param placements The windows to move and where each of them goes. Each window appears once
+     * @return One status per placement, in the same order, with the error \c resizeWindow would have returned for that window
+     * @version 0.3.4
+     * @date 2025
+     */
+    DeskUp::Result<std::vector<DeskUp::Status>> (*applyLayout)(DeskUpWindowDevice * _this, std::span<const windowPlacement> placements) = nullptr;
+
+    /**
+     * @brief The features this device advertises, filled by the \c createDevice of its bootstrap.
+     *
+     * @details The interface picks its save and restore strategies from them at runtime. Devices that don't fill it keep working
+     * with the per-window calls every device has.
+     *
+     * @see DeviceCapability
+     * @version 0.3.4
+     * @date 2025
+     */
+    DeviceCapability capabilities = DeviceCapability::None;
+
     /**
      * @brief A pointer that points to the specific information needed by each backend
      *
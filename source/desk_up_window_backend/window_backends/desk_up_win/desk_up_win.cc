@@ -8,18 +8,26 @@
 #include <iostream>
 #include <fstream>
 #include <expected>
+#include <functional>
+#include <unordered_set>
+#include <optional>
+#include <atomic>
+#include <algorithm>
 #include <shlobj.h>
 
 #include <tlhelp32.h>
 #include <shellapi.h>
 
 #include "backend_utils.h"
+#include "window_desc_loader.h"
 
 namespace fs = std::filesystem;
 using namespace std::chrono_literals;
 
+//a call made within a budget passes its deadline, and gives up once the next wait would end past it
 template<typename F>
-static DeskUp::Status retryOp(F&& f, std::string_view ctx, unsigned int maxAttempts = 3, std::chrono::milliseconds firstDelay = 50ms)
+static DeskUp::Status retryOp(F&& f, std::string_view ctx, unsigned int maxAttempts = 3, std::chrono::milliseconds firstDelay = 50ms,
+    std::optional<std::chrono::steady_clock::time_point> deadline = std::nullopt)
 {
     auto delay = firstDelay;
     for (unsigned int i = 0; i < maxAttempts; i++) {
@@ -32,6 +40,10 @@ static DeskUp::Status retryOp(F&& f, std::string_view ctx, unsigned int maxAttem
             return std::unexpected(std::move(e));
         }
 
+        if (deadline && std::chrono::steady_clock::now() + delay > *deadline) {
+            return std::unexpected(DeskUp::Error(DeskUp::Level::Retry, DeskUp::ErrType::Timeout, i+1, std::string(ctx) + "out_of_budget"));
+        }
+
         std::this_thread::sleep_for(delay);
         delay *= 2;
     }
@@ -40,10 +52,10 @@ static DeskUp::Status retryOp(F&& f, std::string_view ctx, unsigned int maxAttem
 }
 
 
-static std::unique_ptr<HWND> desk_up_hwnd = nullptr;
-
+//set when the device is created and only read afterwards, so every call can run on any thread: the window a call acts on is
+//always one of its arguments
 struct windowData{
-    HWND hwnd;
+    HWND deskUp;
 };
 
 DeskUpWindowBootStrap winWindowDevice = {
@@ -94,25 +106,34 @@ DeskUpWindowDevice WIN_CreateDevice() noexcept{
 
     //Initialize COM (Object Component Model), which may be used by the shell when recovering the windows from the files.
     CoInitializeEx(NULL, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE);
-    // Set function pointers and initialize internal data
-    desk_up_hwnd = std::make_unique<HWND>(WIN_getDeskUpHWND());
-
     DeskUpWindowDevice device;
 
     device.getWindowHeight = WIN_getWindowHeight;
     device.getWindowWidth  = WIN_getWindowWidth;
     device.getWindowXPos   = WIN_getWindowXPos;
     device.getWindowYPos   = WIN_getWindowYPos;
+    device.getWindowGeometry = WIN_getWindowGeometry;
+    device.getWindowsGeometry = WIN_getWindowsGeometry;
     device.getPathFromWindow = WIN_getPathFromWindow;
     device.getAllOpenWindows   = WIN_getAllOpenWindows;
+    device.streamOpenWindows   = WIN_streamOpenWindows;
     device.getDeskUpPath   = WIN_getDeskUpPath;
     device.loadWindowFromPath = WIN_loadProcessFromPath;
+    device.loadWindowFromPathWithin = WIN_loadProcessFromPathWithin;
     device.recoverSavedWindow = WIN_recoverSavedWindow;
     device.resizeWindow    = WIN_resizeWindow;
     device.closeProcessFromPath = WIN_closeProcessFromPath;
+    device.closeProcessesFromPaths = WIN_closeProcessesFromPaths;
+    device.selectOpenWindow = WIN_selectOpenWindow;
+    device.placeLaunchedWindows = WIN_placeLaunchedWindows;
+    device.applyLayout = WIN_applyLayout;
 	device.DestroyDevice = WIN_destroyDevice;
 
-    device.internalData = (void *) new windowData();
+    device.capabilities = DeviceCapability::BatchQueries | DeviceCapability::StreamedEnumeration | DeviceCapability::BatchClose
+        | DeviceCapability::BudgetedLaunch | DeviceCapability::OpenWindowSelection | DeviceCapability::LaunchedWindowPlacement
+        | DeviceCapability::BatchPlacement | DeviceCapability::ConcurrentCalls;
+
+    device.internalData = (void *) new windowData{WIN_getDeskUpHWND()};
 
     return device;
 }
@@ -153,113 +174,110 @@ DeskUp::Result<std::string> WIN_getDeskUpPath() noexcept{
 }
 
 
-DeskUp::Result<int> WIN_getWindowXPos(DeskUpWindowDevice* _this) noexcept {
-    const auto* data = getWindowData(_this);
-
-	if(!data){
-		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::DeviceNotFound, 0, "WIN_getWindowXPos|no_device"));
-	}
-
-    if(!IsWindow(data->hwnd)) {
-        return std::unexpected(DeskUp::Error(DeskUp::Level::Skip, DeskUp::ErrType::InvalidInput, 0, "WIN_getWindowXPos|no_hwnd"));
-    }
-
+//the whole rectangle in a single GetWindowInfo, the same one GetWindowRect reads
+static bool WIN_readGeometry(HWND hwnd, windowGeometry& geometry) noexcept {
 	//brackets necessary to initialize the struct (memset 0)
     WINDOWINFO wi{};
     wi.cbSize = sizeof(wi);
 
-    auto r = retryOp([&]{ return GetWindowInfo(data->hwnd, &wi) != 0; }, "WIN_getWindowXPos>GetWindowInfo|");
-    if (!r){
-		return std::unexpected(std::move(r.error()));
-	}
+    if(!GetWindowInfo(hwnd, &wi)){
+        return false;
+    }
 
-    return static_cast<int>(wi.rcWindow.left);
+    geometry.x = static_cast<int>(wi.rcWindow.left);
+    geometry.y = static_cast<int>(wi.rcWindow.top);
+    geometry.w = static_cast<unsigned int>(wi.rcWindow.right - wi.rcWindow.left);
+    geometry.h = static_cast<unsigned int>(wi.rcWindow.bottom - wi.rcWindow.top);
+    return true;
 }
 
-DeskUp::Result<int> WIN_getWindowYPos(DeskUpWindowDevice* _this) noexcept {
-    const auto* data = getWindowData(_this);
-
-	if(!data){
-		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::DeviceNotFound, 0, "WIN_getWindowYPos|no_device"));
+DeskUp::Result<windowGeometry> WIN_getWindowGeometry(DeskUpWindowDevice* _this, windowHandle window) noexcept {
+	if(!_this || !getWindowData(_this)){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::DeviceNotFound, 0, "WIN_getWindowGeometry|no_device"));
 	}
 
-    if(!IsWindow(data->hwnd)) {
-        return std::unexpected(DeskUp::Error(DeskUp::Level::Skip, DeskUp::ErrType::InvalidInput, 0, "WIN_getWindowYPos|no_hwnd"));
+    HWND hwnd = static_cast<HWND>(window);
+    if(!IsWindow(hwnd)) {
+        return std::unexpected(DeskUp::Error(DeskUp::Level::Skip, DeskUp::ErrType::InvalidInput, 0, "WIN_getWindowGeometry|no_hwnd"));
     }
 
-	//brackets necessary to initialize the struct (memset 0)
-    WINDOWINFO wi{};
-    wi.cbSize = sizeof(wi);
-
-    auto r = retryOp([&]{ return GetWindowInfo(data->hwnd, &wi) != 0; }, "WIN_getWindowYPos>GetWindowInfo|");
+    windowGeometry geometry;
+    auto r = retryOp([&]{ return WIN_readGeometry(hwnd, geometry); }, "WIN_getWindowGeometry>GetWindowInfo|");
     if (!r){
 		return std::unexpected(std::move(r.error()));
 	}
 
-    return static_cast<int>(wi.rcWindow.top);
+    return geometry;
 }
 
-DeskUp::Result<unsigned int> WIN_getWindowWidth(DeskUpWindowDevice* _this) noexcept{
-    const auto* data = getWindowData(_this);
-
-	if(!data){
-		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::DeviceNotFound, 0, "WIN_getWindowWidth|no_device"));
-	}
+DeskUp::Result<std::vector<std::optional<windowGeometry>>> WIN_getWindowsGeometry(DeskUpWindowDevice* _this,
+	const std::vector<windowHandle>& windows) noexcept {
 
-    if(!IsWindow(data->hwnd)) {
-        return std::unexpected(DeskUp::Error(DeskUp::Level::Skip, DeskUp::ErrType::InvalidInput, 0, "WIN_getWindowWidth|no_hwnd"));
+    if(!_this || !_this->internalData){
+        return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::DeviceNotFound, 0, "WIN_getWindowsGeometry|no_device"));
     }
 
-	//brackets necessary to initialize the struct (memset 0)
-    WINDOWINFO wi{};
-    wi.cbSize = sizeof(wi);
+	//no retries inside a batch: a window that can't be read was closed, and the others don't wait on it
+    std::vector<std::optional<windowGeometry>> geometries(windows.size());
+    for(std::size_t i = 0; i < windows.size(); i++){
+        HWND hwnd = static_cast<HWND>(windows[i]);
 
-    auto r = retryOp([&]{ return GetWindowInfo(data->hwnd, &wi) != 0; }, "WIN_getWindowWidth>GetWindowInfo|");
-    if (!r){
-		return std::unexpected(std::move(r.error()));
-	}
+        windowGeometry geometry;
+        if(IsWindow(hwnd) && WIN_readGeometry(hwnd, geometry)){
+            geometries[i] = geometry;
+        }
+    }
 
-    return static_cast<unsigned int>(wi.rcWindow.left - wi.rcWindow.right);
+    return geometries;
 }
 
-DeskUp::Result<unsigned int> WIN_getWindowHeight(DeskUpWindowDevice* _this) noexcept {
-    const auto* data = getWindowData(_this);
-
-	if(!data){
-		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::DeviceNotFound, 0, "WIN_getWindowHeight|no_device"));
+//the single-field queries are kept for existing callers, each of them is one geometry query
+DeskUp::Result<int> WIN_getWindowXPos(DeskUpWindowDevice* _this, windowHandle window) noexcept {
+    auto geometry = WIN_getWindowGeometry(_this, window);
+    if(!geometry){
+		return std::unexpected(std::move(geometry.error()));
 	}
+    return geometry->x;
+}
 
-    if(!IsWindow(data->hwnd)) {
-        return std::unexpected(DeskUp::Error(DeskUp::Level::Skip, DeskUp::ErrType::InvalidInput, 0, "WIN_getWindowHeight|no_hwnd"));
-    }
-
-	//brackets necessary to initialize the struct (memset 0)
-    WINDOWINFO wi{};
-    wi.cbSize = sizeof(wi);
-
-    auto r = retryOp([&]{ return GetWindowInfo(data->hwnd, &wi) != 0; }, "WIN_getWindowHeight>GetWindowInfo|");
-    if (!r){
-		return std::unexpected(std::move(r.error()));
+DeskUp::Result<int> WIN_getWindowYPos(DeskUpWindowDevice* _this, windowHandle window) noexcept {
+    auto geometry = WIN_getWindowGeometry(_this, window);
+    if(!geometry){
+		return std::unexpected(std::move(geometry.error()));
 	}
+    return geometry->y;
+}
 
-    return static_cast<unsigned int>(wi.rcWindow.top - wi.rcWindow.bottom);
+DeskUp::Result<unsigned int> WIN_getWindowWidth(DeskUpWindowDevice* _this, windowHandle window) noexcept{
+    auto geometry = WIN_getWindowGeometry(_this, window);
+    if(!geometry){
+		return std::unexpected(std::move(geometry.error()));
+	}
+    return geometry->w;
 }
 
+DeskUp::Result<unsigned int> WIN_getWindowHeight(DeskUpWindowDevice* _this, windowHandle window) noexcept {
+    auto geometry = WIN_getWindowGeometry(_this, window);
+    if(!geometry){
+		return std::unexpected(std::move(geometry.error()));
+	}
+    return geometry->h;
+}
 
-DeskUp::Result<fs::path> WIN_getPathFromWindow(DeskUpWindowDevice* _this) noexcept{
-	const auto* data = getWindowData(_this);
 
-	if(!data){
-		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::DeviceNotFound, 0, "WIN_getWindowWidth|no_device"));
+DeskUp::Result<fs::path> WIN_getPathFromWindow(DeskUpWindowDevice* _this, windowHandle window) noexcept{
+	if(!_this || !getWindowData(_this)){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::DeviceNotFound, 0, "WIN_getPathFromWindow|no_device"));
 	}
 
-    if(!IsWindow(data->hwnd)) {
-        return std::unexpected(DeskUp::Error(DeskUp::Level::Skip, DeskUp::ErrType::InvalidInput, 0, "WIN_getWindowWidth|no_hwnd"));
+    HWND hwnd = static_cast<HWND>(window);
+    if(!IsWindow(hwnd)) {
+        return std::unexpected(DeskUp::Error(DeskUp::Level::Skip, DeskUp::ErrType::InvalidInput, 0, "WIN_getPathFromWindow|no_hwnd"));
     }
 
     DWORD pid = 0;
 
-    auto r = retryOp([&]{ return (GetWindowThreadProcessId(data->hwnd, &pid) != 0) && (pid != 0); }, "WIN_getPathFromWindow>GetWindowThreadProcessId|");
+    auto r = retryOp([&]{ return (GetWindowThreadProcessId(hwnd, &pid) != 0) && (pid != 0); }, "WIN_getPathFromWindow>GetWindowThreadProcessId|");
     if (!r){
 		return std::unexpected(std::move(r.error()));
 	}
@@ -334,7 +352,8 @@ DeskUp::Result<fs::path> WIN_getPathFromWindow(DeskUpWindowDevice* _this) noexce
 }
 
 static std::string WIN_getNameFromPath(const fs::path& path) noexcept{
-    static int unnamedWindowNum = 0;
+	//enumerations may run on several threads at once
+    static std::atomic<int> unnamedWindowNum = 0;
     if (path.empty()) {
         return "window" + std::to_string(unnamedWindowNum++);
     }
@@ -351,6 +370,11 @@ struct saveWindowParams {
         DeskUpWindowDevice* dev;
         std::vector<windowDesc>* res;
         DeskUp::Error* err;
+        //when set, windows are handed to it instead of being pushed into res
+        const std::function<DeskUp::Status(windowDesc&&)>* sink = nullptr;
+        bool sinkFailed = false;
+        //a window with an Error-level failure is skipped, but a second one in a row stops the enumeration
+        bool levelErrorHappened = false;
 };
 
 static BOOL CALLBACK WIN_CreateAndSaveWindowProc(HWND hwnd, LPARAM lparam) noexcept{
@@ -359,13 +383,13 @@ static BOOL CALLBACK WIN_CreateAndSaveWindowProc(HWND hwnd, LPARAM lparam) noexc
 		return TRUE;
 	}
 
-	//brackets necessary to initialize the struct (memset 0)
-    RECT r{};
-    if (!GetWindowRect(hwnd, &r)){
+	//read once: the same geometry filters the window and is saved with it
+    windowGeometry geometry;
+    if (!WIN_readGeometry(hwnd, geometry)){
 		return TRUE;
 	}
 
-    if ((r.right - r.left) == 0 || (r.bottom - r.top) == 0){
+    if (geometry.w == 0 || geometry.h == 0){
 		return TRUE;
 	}
 
@@ -375,10 +399,6 @@ static BOOL CALLBACK WIN_CreateAndSaveWindowProc(HWND hwnd, LPARAM lparam) noexc
 		return TRUE;
 	}
 
-	if (*desk_up_hwnd.get() == hwnd) {
-        return TRUE;
-    }
-
     auto* parameters = reinterpret_cast<saveWindowParams*>(lparam);
     if (!parameters || !parameters->err){
 		//if the parameters didn't get passed, we can't set the error inside to inform, so just return. This is very improbable
@@ -387,13 +407,11 @@ static BOOL CALLBACK WIN_CreateAndSaveWindowProc(HWND hwnd, LPARAM lparam) noexc
 
     auto& err = *parameters->err;
 
-	if(!parameters->res){
+	if(!parameters->res && !parameters->sink){
 		err = DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::InvalidInput, 0, "WIN_CreateAndSaveWindowProc|no_parameter");
 		return FALSE;
 	}
 
-    auto& windows = *parameters->res;
-
 	if(!parameters->dev || !parameters->dev->internalData) {
 		err = DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::DeviceNotFound, 0, "WIN_CreateAndSaveWindowProc|no_device");
         return FALSE;
@@ -401,41 +419,36 @@ static BOOL CALLBACK WIN_CreateAndSaveWindowProc(HWND hwnd, LPARAM lparam) noexc
 
     DeskUpWindowDevice* dev = parameters->dev;
 
-	windowData * data = getWindowData(dev);
-    data->hwnd = hwnd;
+	if (getWindowData(dev)->deskUp == hwnd) {
+        return TRUE;
+    }
 
     windowDesc window;
 
-	static bool levelErrorHappened = false;
-
-	if (auto res = WIN_getPathFromWindow(dev); res.has_value()) {
+	if (auto res = WIN_getPathFromWindow(dev, hwnd); res.has_value()) {
         window.pathToExec = std::move(res.value());
     } else {
 		err = std::move(res.error());
 
 		if(err.isFatal()){
-			data->hwnd = nullptr;
 			return FALSE;
 		}
 
 		//hwnd might have gone invalid
-		if(err.isSkippable() && !IsWindow(data->hwnd)){
+		if(err.isSkippable() && !IsWindow(hwnd)){
 			//can't know the name of the window if it failed
 			std::cout << "Window Skipped" << std::endl;
-			data->hwnd = nullptr;
 			return TRUE;
 		}
 
 		//The data is corrupt or invalid. Skip the window
 		if(err.isError()){
-			data->hwnd = nullptr;
-
-			if(levelErrorHappened){
-				levelErrorHappened = false;
+			if(parameters->levelErrorHappened){
+				parameters->levelErrorHappened = false;
 				return FALSE;
 			}
 
-			levelErrorHappened = true;
+			parameters->levelErrorHappened = true;
 			return TRUE;
 		}
 
@@ -445,143 +458,39 @@ static BOOL CALLBACK WIN_CreateAndSaveWindowProc(HWND hwnd, LPARAM lparam) noexc
 	//can't fail
     window.name = WIN_getNameFromPath(window.pathToExec);
 
+    window.x = geometry.x;
+    window.y = geometry.y;
+    window.w = static_cast<int>(geometry.w);
+    window.h = static_cast<int>(geometry.h);
 
-    if (auto res = WIN_getWindowXPos(dev); res.has_value()) {
-        window.x = std::move(res.value());
-    } else {
-        err = std::move(res.error());
-
-		if(err.isFatal()){
-			data->hwnd = nullptr;
-			return FALSE;
-		}
-
-		//hwnd might have gone invalid
-		if(err.isSkippable() && !IsWindow(data->hwnd)){
-			std::cout << "Window Skipped: " << window.name << std::endl;
-			data->hwnd = nullptr;
-			return TRUE;
-		}
-
-		//The data is corrupt or invalid. Skip the window
-		if(err.isError()){
-			data->hwnd = nullptr;
-
-			if(levelErrorHappened){
-				levelErrorHappened = false;
-				return FALSE;
-			}
-
-			levelErrorHappened = true;
-			return TRUE;
-		}
-
-		return TRUE;
-    }
-
-    if (auto res = WIN_getWindowYPos(dev); res.has_value()) {
-        window.y = std::move(res.value());
-    } else {
-        err = std::move(res.error());
-
-		if(err.isFatal()){
-			data->hwnd = nullptr;
-			return FALSE;
-		}
-
-		//hwnd might have gone invalid
-		if(err.isSkippable() && !IsWindow(data->hwnd)){
-			std::cout << "Window Skipped: " << window.name << std::endl;
-			data->hwnd = nullptr;
-			return TRUE;
-		}
-
-		//The data is corrupt or invalid. Skip the window
-		if(err.isError()){
-			data->hwnd = nullptr;
-
-			if(levelErrorHappened){
-				levelErrorHappened = false;
-				return FALSE;
-			}
-
-			levelErrorHappened = true;
-			return TRUE;
-		}
-
-		return TRUE;
-    }
-
-    if (auto res = WIN_getWindowWidth(dev); res.has_value()) {
-        window.w = std::move(res.value());
-    } else {
-        err = std::move(res.error());
-
-		if(err.isFatal()){
-			data->hwnd = nullptr;
+	if(parameters->sink){
+		//the consumer refused the window (e.g. it could not write it), so there's no point in enumerating the rest
+		if(auto res = (*parameters->sink)(std::move(window)); !res.has_value()){
+			err = std::move(res.error());
+			parameters->sinkFailed = true;
 			return FALSE;
 		}
-
-		//hwnd might have gone invalid
-		if(err.isSkippable() && !IsWindow(data->hwnd)){
-			std::cout << "Window Skipped: " << window.name << std::endl;
-			data->hwnd = nullptr;
-			return TRUE;
-		}
-
-		//The data is corrupt or invalid. Skip the window
-		if(err.isError()){
-			data->hwnd = nullptr;
-
-			if(levelErrorHappened){
-				levelErrorHappened = false;
-				return FALSE;
-			}
-
-			levelErrorHappened = true;
-			return TRUE;
-		}
-
 		return TRUE;
-    }
-
-    if (auto res = WIN_getWindowHeight(dev); res.has_value()) {
-        window.h = std::move(res.value());
-    } else {
-        err = std::move(res.error());
-
-		if(err.isFatal()){
-			data->hwnd = nullptr;
-			return FALSE;
-		}
-
-		//hwnd might have gone invalid
-		if(err.isSkippable() && !IsWindow(data->hwnd)){
-			std::cout << "Window Skipped: " << window.name << std::endl;
-			data->hwnd = nullptr;
-			return TRUE;
-		}
-
-		//The data is corrupt or invalid. Skip the window
-		if(err.isError()){
-			data->hwnd = nullptr;
-
-			if(levelErrorHappened){
-				levelErrorHappened = false;
-				return FALSE;
-			}
+	}
 
-			levelErrorHappened = true;
-			return TRUE;
-		}
+    parameters->res->push_back(std::move(window));
+    return TRUE;
+}
 
-		return TRUE;
-    }
+//translates the error left by WIN_CreateAndSaveWindowProc when EnumDesktopWindows stops early
+static DeskUp::Error WIN_enumerationError(saveWindowParams& p, DeskUp::Error& error){
+	//errors coming from the consumer are theirs, not ours
+	if (p.sinkFailed || error.level() == DeskUp::Level::Fatal){
+		return std::move(error);
+	}
 
-    data->hwnd = nullptr;
+	if(error.level() == DeskUp::Level::Error){
+		//this only happens when something happened to the device or the windowData. For this, return an unexpected error
+		return DeskUp::Error(DeskUp::Level::Fatal, DeskUp::ErrType::Unexpected, 0u, "WIN_getAllOpenWindows>EnumDesktopWindows|device_corrupt");
+	}
 
-    windows.push_back(std::move(window));
-    return TRUE;
+	//Skippable errors should not get there. Anything else besides fatal and error will get bubbled up as a warning for the user
+	return DeskUp::Error(DeskUp::Level::Warning, DeskUp::ErrType::Unexpected, 0u, "WIN_getAllOpenWindows>EnumDesktopWindows|");
 }
 
 DeskUp::Result<std::vector<windowDesc>> WIN_getAllOpenWindows(DeskUpWindowDevice* _this) noexcept{
@@ -594,134 +503,37 @@ DeskUp::Result<std::vector<windowDesc>> WIN_getAllOpenWindows(DeskUpWindowDevice
     HDESK desktop = NULL;
 
     if (!EnumDesktopWindows(desktop, WIN_CreateAndSaveWindowProc, reinterpret_cast<LPARAM>(&p))) {
-        if (error.level() == DeskUp::Level::Fatal){
-			return std::unexpected(std::move(error));
-		}
-
-		if(error.level() == DeskUp::Level::Error){
-			//this only happens when something happened to the device or the windowData. For this, return an unexpected error
-			return std::unexpected(DeskUp::Error(DeskUp::Level::Fatal, DeskUp::ErrType::Unexpected, 0u, "WIN_getAllOpenWindows>EnumDesktopWindows|device_corrupt"));
-		}
-
-		//Skippable errors should not get there. Anything else besides fatal and error will get bubbled up as a warning for the user
-
-        return std::unexpected(DeskUp::Error(DeskUp::Level::Warning, DeskUp::ErrType::Unexpected, 0u, "WIN_getAllOpenWindows>EnumDesktopWindows|"));
+        return std::unexpected(WIN_enumerationError(p, error));
     }
 
     return windows;
 }
 
-static void stripEndlChars(std::string& s){
-    if(!s.empty() && (s.back() == '\r' || s.back() == '\n')){
-		s.pop_back();
-	}
-}
-
-DeskUp::Result<windowDesc> WIN_recoverSavedWindow(DeskUpWindowDevice*, const fs::path& path) noexcept{
-	//this function expects to receive the path from DeskUpWindow::restoreWindows, which already checks the validity of the path. Still, do it here
-    std::error_code fec;
-    if (!fs::exists(path, fec) || !fs::is_regular_file(path, fec)) {
-        return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::InvalidInput, 0, "WIN_recoverSavedWindow|no_file_" + path.string()));
-    }
-
-    if (fec) {
-        return std::unexpected(DeskUp::Error(DeskUp::Level::Skip, DeskUp::ErrType::Io, 0, "WIN_recoverSavedWindow|fs_error_" + fec.message()));
-    }
+DeskUp::Status WIN_streamOpenWindows(DeskUpWindowDevice* _this, const std::function<DeskUp::Status(windowDesc&&)>& sink) noexcept{
+    DeskUp::Error error{};
 
-    constexpr int kMaxAttempts = 3;
-    std::chrono::milliseconds delay{50};
-    std::ifstream f;
+    saveWindowParams p{ _this, nullptr, &error, &sink };
 
-	//try reopening the file if it is not opened
-    for (int attempt = 1; attempt <= kMaxAttempts; attempt++) {
-        f.open(path, std::ios::in);
-        if (f.is_open()){
-			break;
-		}
+    HDESK desktop = NULL;
 
-        if (attempt == kMaxAttempts) {
-            return std::unexpected(DeskUp::Error(DeskUp::Level::Skip, DeskUp::ErrType::Io, attempt,"WIN_recoverSavedWindow|file_unopen_" + path.string()));
-        }
-        std::this_thread::sleep_for(delay);
-        delay *= 2;
+    if (!EnumDesktopWindows(desktop, WIN_CreateAndSaveWindowProc, reinterpret_cast<LPARAM>(&p))) {
+        return std::unexpected(WIN_enumerationError(p, error));
     }
 
-    auto parse_int = [](const std::string& str, const char*) -> std::optional<int> {
-        try {
-            size_t pos = 0;
-			//can throw invalid_argument if there could not be any conversion (there are no numbers in the string or the data is corrupt)
-            int val = std::stoi(str, &pos);
-			//the string passed should be solely composed of numeric chars (check for endl or tabs is checked before calling this function)
-            if (pos != str.size()){
-				return std::nullopt;
-			}
-            return val;
-        } catch (...) {
-			//this only happens if stoi failed
-			return std::nullopt;
-		}
-    };
+    return {};
+}
 
-	std::string s;
-
-	//calls default constructor
-    windowDesc w;
-	int i = 0;
-
-	//relies on: w,h > 0, no final endl or EOF, just 5 lines
-    while (std::getline(f, s)) {
-        stripEndlChars(s);
-        switch (i) {
-            case 0:
-                w.pathToExec = s;
-                w.name = WIN_getNameFromPath(s);
-                break;
-            case 1: {
-                auto v = parse_int(s, "x");
-                if (!v) {
-					return std::unexpected(DeskUp::Error(DeskUp::Level::Retry, DeskUp::ErrType::InvalidInput, 0, "WIN_recoverSavedWindow|invalid_read_x"));
-				}
-                w.x = *v;
-                break;
-            }
-            case 2: {
-                auto v = parse_int(s, "y");
-                if (!v){
-					return std::unexpected(DeskUp::Error(DeskUp::Level::Retry, DeskUp::ErrType::InvalidInput, 0, "WIN_recoverSavedWindow|invalid_read_y"));
-				}
-                w.y = *v;
-                break;
-            }
-            case 3: {
-                auto v = parse_int(s, "w");
-                if (!v){
-					return std::unexpected(DeskUp::Error(DeskUp::Level::Retry, DeskUp::ErrType::InvalidInput, 0, "WIN_recoverSavedWindow|invalid_read_w"));
-				}
-                w.w = *v;
-                break;
-            }
-            case 4: {
-                auto v = parse_int(s, "h");
-                if (!v) {
-					return std::unexpected(DeskUp::Error(DeskUp::Level::Retry, DeskUp::ErrType::InvalidInput, 0, "WIN_recoverSavedWindow|invalid_read_h"));
-				}
-                w.h = *v;
-                break;
-            }
-            default:
-                break;
-        }
-        i++;
-    }
+DeskUp::Result<windowDesc> WIN_recoverSavedWindow(DeskUpWindowDevice*, const fs::path& path) noexcept{
+	//the legacy format is platform independent, so the parsing lives in window_desc_loader
+	windowDescLoader loader;
+	windowDesc w;
 
-    if (i < 5) {
-		//if there is less than 5 lines, this is an i/o error, not a read error, because when the file was being written was done wrongly.
-		//This is very rare, but it might identify with a write error on a specific value of any of the windowDesc info that was written.
-		//For now, just return an error
-        return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::Io, 0, "WIN_recoverSavedWindow|previous_write_failed"));
-    }
+	if(int res = loader.load(path, w); res != LOAD_SUCCESS){
+		auto err = DeskUp::Error::fromLoadError(res);
+		return std::unexpected(DeskUp::Error(err.level(), err.type(), 0, std::string("WIN_") + err.what() + "_" + path.string()));
+	}
 
-    return w;
+	return w;
 }
 
 //Helper for WIN_loadProcessFromPath. It just returns the specified handle for the pid. It is used to get the hwnd of the launched window
@@ -759,21 +571,33 @@ static HWND WIN_FindMainWindow(DWORD pid, int timeoutMs = 300) {
     };
 
     const int step = 100;
-    for (int waited = 0; waited < timeoutMs && !hwndFound; waited += step) {
+    for (int waited = 0; waited < timeoutMs && !hwndFound;) {
         std::pair<DWORD, HWND*> data{ pid, &hwndFound };
         EnumWindows(enumCallback, reinterpret_cast<LPARAM>(&data));
         if (hwndFound){
 			break;
 		}
-        Sleep(step);
+
+		//the timeout may be what is left of a launch budget, so the last nap never goes past it
+		const int nap = std::min(step, timeoutMs - waited);
+        Sleep(nap);
+		waited += nap;
     }
     return hwndFound;
 }
 
-DeskUp::Status WIN_loadProcessFromPath(DeskUpWindowDevice* _this, const fs::path& path) noexcept {
+//launches path and returns its main window. Without a budget it waits for the app to go idle as long as it takes, and then gives
+//the window 300 ms to show up. With one, both waits together stop once the budget is spent
+static DeskUp::Result<windowHandle> WIN_launch(DeskUpWindowDevice* _this, const fs::path& path, std::optional<std::chrono::milliseconds> budget) noexcept {
+
+	const auto deadline = std::chrono::steady_clock::now() + budget.value_or(std::chrono::milliseconds(0));
+	auto remainingMs = [&]{
+		return std::max<long long>(0, std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count());
+	};
 
-	auto data = getWindowData(_this);
-	data->hwnd = nullptr;
+	//the shell may need COM on the thread launching the app, which isn't always the one that created the device
+	static thread_local const bool comReady = SUCCEEDED(CoInitializeEx(NULL, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE));
+	(void) comReady;
 
     if (path.empty()) {
         return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::InvalidInput, 0, "WIN_loadProcessFromPath|no_file_" + path.string()));
@@ -842,7 +666,7 @@ DeskUp::Status WIN_loadProcessFromPath(DeskUpWindowDevice* _this, const fs::path
 		//if there is no error, just return true
         return true;
     },
-	"WIN_loadProcessFromPath>ShellExecuteEx|");
+	"WIN_loadProcessFromPath>ShellExecuteEx|", 3, 50ms, budget ? std::optional(deadline) : std::nullopt);
 
 	//the windows errors set inside the callback get translated here
     if (!status) {
@@ -862,8 +686,15 @@ DeskUp::Status WIN_loadProcessFromPath(DeskUpWindowDevice* _this, const fs::path
 
 
 		while(res != 0){
+			if(budget && remainingMs() == 0){
+				//the app is left starting up, it just won't be moved
+				CloseHandle(ShExecInfo.hProcess);
+				return std::unexpected(DeskUp::Error(DeskUp::Level::Retry, DeskUp::ErrType::Timeout, 0,
+					"WIN_loadProcessFromPath>WaitForInputIdle|no_idle_" + path.string()));
+			}
+
 			//WaitForInputIdle returns exit code 0 when the window has set up
-			res = WaitForInputIdle(ShExecInfo.hProcess, 300);
+			res = WaitForInputIdle(ShExecInfo.hProcess, budget ? static_cast<DWORD>(std::min<long long>(300, remainingMs())) : 300);
 
 			if (res == WAIT_TIMEOUT) {
 				DWORD exitCode = 0;
@@ -905,39 +736,50 @@ DeskUp::Status WIN_loadProcessFromPath(DeskUpWindowDevice* _this, const fs::path
 		//close the kernel handle, as we already have the pid
         CloseHandle(ShExecInfo.hProcess);
 
+		//apps that show their window well after going idle get whatever is left of their budget, and nothing once it is spent
+		const int windowWaitMs = budget ? static_cast<int>(remainingMs()) : 300;
+		if(budget && windowWaitMs == 0){
+			//the app is left starting up, it just won't be moved
+			return std::unexpected(DeskUp::Error(DeskUp::Level::Retry, DeskUp::ErrType::Timeout, 0,
+				"WIN_loadProcessFromPath>WIN_FindMainWindow|no_budget_" + path.string()));
+		}
+
 		//this returns nullptr if there it could'nt find the hwnd
-        auto hwnd = WIN_FindMainWindow(pid);
+        auto hwnd = WIN_FindMainWindow(pid, windowWaitMs);
         if(!hwnd){
-			return std::unexpected(DeskUp::Error(DeskUp::Level::Retry, DeskUp::ErrType::NotFound, 0, "WIN_loadProcessFromPath>WIN_FindMainWindow|no_hwnd_" + path.string()));
+			return std::unexpected(DeskUp::Error(DeskUp::Level::Retry, budget ? DeskUp::ErrType::Timeout : DeskUp::ErrType::NotFound, 0,
+				"WIN_loadProcessFromPath>WIN_FindMainWindow|no_hwnd_" + path.string()));
 		}
 
-		//set the hwnd inside the device, so that other functions can access this handle
-		data->hwnd = hwnd;
+		return static_cast<windowHandle>(hwnd);
 	}
 
-	//if nothing went wrong, just return
+	//the shell didn't hand over a process (the file was opened by an app already running), so there is no window to move
+    return std::unexpected(DeskUp::Error(DeskUp::Level::Retry, DeskUp::ErrType::NotFound, 0,
+		"WIN_loadProcessFromPath>ShellExecuteEx|no_process_" + path.string()));
+}
 
-    return {};
+DeskUp::Result<windowHandle> WIN_loadProcessFromPath(DeskUpWindowDevice* _this, const fs::path& path) noexcept {
+	return WIN_launch(_this, path, std::nullopt);
+}
+
+DeskUp::Result<windowHandle> WIN_loadProcessFromPathWithin(DeskUpWindowDevice* _this, const fs::path& path, std::chrono::milliseconds budget) noexcept {
+	return WIN_launch(_this, path, budget);
 }
 
-DeskUp::Status WIN_resizeWindow(DeskUpWindowDevice * _this, const windowDesc window) noexcept{
-	//this function expects to have the hwnd of loadProcessFromPath inside the windowData
+DeskUp::Status WIN_resizeWindow(DeskUpWindowDevice * _this, windowHandle target, const windowDesc window) noexcept{
+	//this function expects the hwnd returned by loadProcessFromPath or selectOpenWindow
 
     if(!_this || !_this->internalData){
         return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::DeviceNotFound, 0, "WIN_resizeWindow|no_device"));
     }
 
-    windowData * data = getWindowData(_this);
-
-	//the only way for the hwnd to be nullptr is if in loadProcessFromPath, the function didn't get to the end(at the start is set to nullptr
-	//and at the end is set to the valid hwnd), so if the function fails at any point, we can make sure we are not using an invalid hwnd here.
-	//Still, if we received an error in loadProcessFromPath, we should treat it before calling this function, or not even calling it at all,
-	//so this is just to double check
-    if(!data->hwnd){
+	//a failed launch returns an error instead of a handle, so the caller shouldn't even get here without one. This is just to double check
+    if(!target){
         return std::unexpected(DeskUp::Error(DeskUp::Level::Skip, DeskUp::ErrType::InvalidInput, 0, "WIN_resizeWindow|no_hwnd"));
     }
 
-	auto hwnd = data->hwnd;
+	auto hwnd = static_cast<HWND>(target);
 
     if (window.w <= 0 || window.h <= 0) {
         return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::InvalidInput, 0, "WIN_resizeWindow|invalid_wh"));
@@ -1023,6 +865,117 @@ DeskUp::Status WIN_resizeWindow(DeskUpWindowDevice * _this, const windowDesc win
     return {};
 }
 
+static bool WIN_sameGeometry(const windowGeometry& a, const windowGeometry& b) noexcept {
+	return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+}
+
+DeskUp::Result<std::vector<DeskUp::Status>> WIN_applyLayout(DeskUpWindowDevice * _this, std::span<const windowPlacement> placements) noexcept {
+
+    if(!_this || !_this->internalData){
+        return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::DeviceNotFound, 0, "WIN_applyLayout|no_device"));
+    }
+
+	std::vector<DeskUp::Status> results(placements.size());
+
+	//the placements that can be applied, and their windows
+	std::vector<std::size_t> valid;
+	std::vector<windowHandle> handles;
+
+	for(std::size_t i = 0; i < placements.size(); i++){
+		const auto& placement = placements[i];
+
+		if(!placement.window){
+			results[i] = std::unexpected(DeskUp::Error(DeskUp::Level::Skip, DeskUp::ErrType::InvalidInput, 0, "WIN_applyLayout|no_hwnd"));
+			continue;
+		}
+
+		if(placement.geometry.w == 0 || placement.geometry.h == 0){
+			results[i] = std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::InvalidInput, 0, "WIN_applyLayout|invalid_wh"));
+			continue;
+		}
+
+		valid.push_back(i);
+		handles.push_back(placement.window);
+	}
+
+	//one read for every window: the ones gone since are skipped, and the ones already in place are left alone
+	auto before = WIN_getWindowsGeometry(_this, handles);
+	if(!before){
+		return std::unexpected(std::move(before.error()));
+	}
+
+	std::vector<std::size_t> moving;	//into valid
+	for(std::size_t k = 0; k < valid.size(); k++){
+		const auto& current = before.value()[k];
+
+		if(!current){
+			results[valid[k]] = std::unexpected(DeskUp::Error(DeskUp::Level::Skip, DeskUp::ErrType::NotFound, 0, "WIN_applyLayout|invalid_hwnd"));
+		}
+		else if(!WIN_sameGeometry(*current, placements[valid[k]].geometry)){
+			moving.push_back(k);
+		}
+	}
+
+	if(moving.empty()){
+		return results;
+	}
+
+	//a single transaction: the window manager lays out and repaints the whole layout once, when EndDeferWindowPos commits it
+	bool committed = false;
+	if(HDWP batch = BeginDeferWindowPos(static_cast<int>(moving.size()))){
+		for(std::size_t k : moving){
+			const auto& geometry = placements[valid[k]].geometry;
+
+			//on failure the whole batch is freed by the system, so nothing is left to end
+			batch = DeferWindowPos(batch, static_cast<HWND>(handles[k]), nullptr, geometry.x, geometry.y,
+				static_cast<int>(geometry.w), static_cast<int>(geometry.h), SWP_SHOWWINDOW | SWP_NOZORDER);
+			if(!batch){
+				break;
+			}
+		}
+
+		committed = batch && EndDeferWindowPos(batch);
+	}
+
+	//a window that can't join the batch (it belongs to a hung app, or was closed in between) makes every window go on its own,
+	//with the checks and retries of WIN_resizeWindow
+	if(!committed){
+		for(std::size_t k : moving){
+			const auto& geometry = placements[valid[k]].geometry;
+			windowDesc target("", geometry.x, geometry.y, static_cast<int>(geometry.w), static_cast<int>(geometry.h), "");
+
+			results[valid[k]] = WIN_resizeWindow(_this, handles[k], target);
+		}
+		return results;
+	}
+
+	//and a second read to check the whole layout
+	std::vector<windowHandle> moved;
+	for(std::size_t k : moving){
+		moved.push_back(handles[k]);
+	}
+
+	auto after = WIN_getWindowsGeometry(_this, moved);
+	if(!after){
+		return std::unexpected(std::move(after.error()));
+	}
+
+	for(std::size_t j = 0; j < moving.size(); j++){
+		const std::size_t k = moving[j];
+		const auto& now = after.value()[j];
+
+		if(!now){
+			results[valid[k]] = std::unexpected(DeskUp::Error(DeskUp::Level::Skip, DeskUp::ErrType::NotFound, 0, "WIN_applyLayout|invalid_hwnd"));
+		}
+		//same as in WIN_resizeWindow: a window that didn't move at all refused to, which is only worth an Info
+		else if(WIN_sameGeometry(*now, *before.value()[k])){
+			results[valid[k]] = std::unexpected(DeskUp::Error::fromLastWinError(ERROR_INVALID_WINDOW_STYLE, "WIN_applyLayout>EndDeferWindowPos|"));
+		}
+	}
+
+	return results;
+}
+
 //in here, we don't care the reasons of it failing, if it managed to get the path then it returns true
 //this function is used to check against the
 static bool WIN_queryPathFromPid(DWORD pid, std::string& out) noexcept{
@@ -1055,17 +1008,23 @@ static bool WIN_queryPathFromPid(DWORD pid, std::string& out) noexcept{
     return converted;
 }
 
-//returns the pids(PROCESS IDs) of all the processes associated with the path.
-//For this, checks all the open processes with a snapshot, gets their associated exe and checks
-//if it is the same as the passed. There might be more than one process associated with a single path. note mentioning
-static std::vector<DWORD> WIN_getPidsByPath(const fs::path& path) noexcept{
+//returns the pids(PROCESS IDs) of all the processes associated with any of the paths.
+//For this, checks all the open processes with a single snapshot, gets their associated exe and checks
+//if it is one of the passed. There might be more than one process associated with a single path. note mentioning
+static std::vector<DWORD> WIN_getPidsByPaths(const std::vector<fs::path>& paths) noexcept{
     std::vector<DWORD> pids;
-    if(path.empty()){
+
+    std::unordered_set<std::string> targets;
+    for(const auto& path : paths){
+        if(!path.empty()){
+            targets.insert(normalizePathLower(path.string()));
+        }
+    }
+
+    if(targets.empty()){
 		return pids;
 	}
 
-    const std::string target = normalizePathLower(path.string());
-
     //this creates a snapshot of all the open processes
     HANDLE snap = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
     if(snap == INVALID_HANDLE_VALUE){
@@ -1086,7 +1045,7 @@ static std::vector<DWORD> WIN_getPidsByPath(const fs::path& path) noexcept{
 				continue;
 			}
 
-            if(normalizePathLower(img) == target){
+            if(targets.contains(normalizePathLower(img))){
                 pids.push_back(pid);
             }
         }while(Process32Next(snap, &pe));
@@ -1095,76 +1054,80 @@ static std::vector<DWORD> WIN_getPidsByPath(const fs::path& path) noexcept{
     return pids;
 }
 
-//returns all of the open top-level windows of the process we passed. There might be more than one top level window in the process
-static std::vector<HWND> WIN_GetTopLevelWindowsByPid(DWORD pid) noexcept{
-    std::vector<HWND> out;
-
-    struct Ctx{
-		DWORD pid;
-		std::vector<HWND>* out;
-	};
-
-    Ctx ctx{pid, &out};
+//asks every open top-level window of any of the processes to close, in a single pass over the windows. The messages are posted, so
+//an app showing a "save changes?" dialog doesn't hold back the requests to the rest
+static void WIN_requestCloseOfPids(const std::vector<DWORD>& pids) noexcept{
+    std::unordered_set<DWORD> targets(pids.begin(), pids.end());
 
     auto callback = [](HWND hwnd, LPARAM lp)->BOOL{
-        Ctx* c = reinterpret_cast<Ctx*>(lp);
+        auto* t = reinterpret_cast<std::unordered_set<DWORD>*>(lp);
         DWORD wpid = 0;
         GetWindowThreadProcessId(hwnd, &wpid);
-        if(wpid == c->pid /*the window is part of the current app*/ &&
+        if(t->contains(wpid) /*the window is part of one of the apps*/ &&
            GetWindow(hwnd, GW_OWNER) == nullptr /*The window does not have a father (top-level)*/ &&
     	   IsWindowVisible(hwnd) /*The window is visible*/){
-            c->out->push_back(hwnd);
+            PostMessage(hwnd, WM_CLOSE, 0, 0);
         }
         return TRUE;
     };
 
-    EnumWindows(callback, reinterpret_cast<LPARAM>(&ctx));
-    return out;
+    EnumWindows(callback, reinterpret_cast<LPARAM>(&targets));
 }
 
-//having the pid (PROCESS ID), it closes the process by creating a handle to that same process. ONLY DELETES ONE, THE ONE PASSED
-static bool WIN_closeProcessByPid(DWORD pid, DWORD timeoutMs, bool allowForce) noexcept{
-    //open a handle to the pid
-    HANDLE h = OpenProcess(SYNCHRONIZE | PROCESS_TERMINATE, FALSE, pid);
-    if(!h){
-		return false;
-	}
+//waits for every process not yet exited, all of them against the same deadline, so the whole wait lasts timeoutMs at most
+static void WIN_waitForProcesses(const std::vector<HANDLE>& handles, std::vector<bool>& exited, DWORD timeoutMs) noexcept{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
 
-    auto wins = WIN_GetTopLevelWindowsByPid(pid);
-    for(HWND w : wins){
-        SendMessageTimeout(w, WM_CLOSE, 0, 0, SMTO_ABORTIFHUNG, 2000, nullptr);
+    for(std::size_t i = 0; i < handles.size(); i++){
+        if(exited[i]){
+            continue;
+        }
+
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        exited[i] = WaitForSingleObject(handles[i], left > 0 ? (DWORD) left : 0) == WAIT_OBJECT_0;
     }
+}
 
-    DWORD wait = WaitForSingleObject(h, timeoutMs);
-    if(wait == WAIT_OBJECT_0){
-        CloseHandle(h);
-        return true;
+//closes all of the processes associated to any of the paths.
+//Every close request is sent before waiting on any process, and they all share the same deadline, first the graceful one (timeoutMs)
+//and then, if allowed, the forced one. Closing many apps therefore takes as long as the slowest of them, not the sum
+static int WIN_closeProcessesByPaths(const std::vector<fs::path>& paths, DWORD timeoutMs, bool allowForce) noexcept{
+    std::vector<DWORD> pids;
+    std::vector<HANDLE> handles;
+
+    for(DWORD pid : WIN_getPidsByPaths(paths)){
+        //open a handle to the pid
+        HANDLE h = OpenProcess(SYNCHRONIZE | PROCESS_TERMINATE, FALSE, pid);
+        if(h){
+            pids.push_back(pid);
+            handles.push_back(h);
+        }
     }
 
-    if(allowForce){
-        TerminateProcess(h, 1);
-        WaitForSingleObject(h, 1000);
+    if(handles.empty()){
+        return 0;
     }
-    CloseHandle(h);
 
-    HANDLE h2 = OpenProcess(SYNCHRONIZE, FALSE, pid);
-    if(!h2){
-		return true;
-	}
+    std::vector<bool> exited(handles.size(), false);
 
-    CloseHandle(h2);
-    return false;
-}
+    WIN_requestCloseOfPids(pids);
+    WIN_waitForProcesses(handles, exited, timeoutMs);
+
+    if(allowForce){
+        for(std::size_t i = 0; i < handles.size(); i++){
+            if(!exited[i]){
+                TerminateProcess(handles[i], 1);
+            }
+        }
+        WIN_waitForProcesses(handles, exited, 1000);
+    }
 
-//closes all of the processes associated to a path.
-//for this, get all the processes associated with the path (getPidsByPath),
-//and close all of them one by one (closeProcessByPid)
-static int WIN_closeProcessesByPath(const fs::path& path, DWORD timeoutMs, bool allowForce) noexcept{
     int closed = 0;
-    for(DWORD pid : WIN_getPidsByPath(path)){
-        if(WIN_closeProcessByPid(pid, timeoutMs, allowForce)){
+    for(std::size_t i = 0; i < handles.size(); i++){
+        if(exited[i]){
             closed++;
         }
+        CloseHandle(handles[i]);
     }
     return closed;
 }
@@ -1177,7 +1140,7 @@ DeskUp::Result<unsigned int> WIN_closeProcessFromPath(DeskUpWindowDevice*, const
         return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::InvalidInput, 0, "WIN_closeProcessFromPath|empty_path"));
     }
 
-    int n = WIN_closeProcessesByPath(path, (DWORD) 500, allowForce);
+    int n = WIN_closeProcessesByPaths({path}, (DWORD) 500, allowForce);
     if(n > 0){
         std::cout << "WIN_closeProcessByPath: Closed " << n << " windows of path: " << path << "\n";
     }
@@ -1185,8 +1148,147 @@ DeskUp::Result<unsigned int> WIN_closeProcessFromPath(DeskUpWindowDevice*, const
     return n;
 }
 
-void WIN_TEST_setHWND(DeskUpWindowDevice* _this, HWND hwnd) {
-    if (_this && _this->internalData) {
-        reinterpret_cast<windowData*>(_this->internalData)->hwnd = hwnd;
+DeskUp::Result<unsigned int> WIN_closeProcessesFromPaths(DeskUpWindowDevice*, const std::vector<fs::path>& paths, bool allowForce) noexcept{
+    for(const auto& path : paths){
+        if(path.empty()){
+            return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::InvalidInput, 0, "WIN_closeProcessesFromPaths|empty_path"));
+        }
+    }
+
+    int n = WIN_closeProcessesByPaths(paths, (DWORD) 500, allowForce);
+    if(n > 0){
+        std::cout << "WIN_closeProcessesFromPaths: Closed " << n << " processes of " << paths.size() << " paths\n";
+    }
+
+    return n;
+}
+
+//the visible top-level windows of pid, in enumeration order
+static std::vector<HWND> WIN_GetTopLevelWindowsOfPid(DWORD pid){
+	std::pair<DWORD, std::vector<HWND>> data{pid, {}};
+
+	auto callback = [](HWND hwnd, LPARAM lp)->BOOL{
+		auto d = reinterpret_cast<std::pair<DWORD, std::vector<HWND>>*>(lp);
+		DWORD winPid = 0;
+		GetWindowThreadProcessId(hwnd, &winPid);
+		if(winPid == d->first && GetWindow(hwnd, GW_OWNER) == nullptr && IsWindowVisible(hwnd)){
+			d->second.push_back(hwnd);
+		}
+		return TRUE;
+	};
+
+	EnumWindows(callback, reinterpret_cast<LPARAM>(&data));
+	return std::move(data.second);
+}
+
+DeskUp::Result<std::size_t> WIN_placeLaunchedWindows(DeskUpWindowDevice* _this, windowHandle launched, const std::vector<windowDesc>& windows,
+	std::chrono::milliseconds timeout) noexcept{
+
+    if(!_this || !_this->internalData){
+        return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::DeviceNotFound, 0, "WIN_placeLaunchedWindows|no_device"));
+    }
+
+	//the window found by the launch is the first one, and identifies the process the others belong to
+	HWND first = static_cast<HWND>(launched);
+    if(!first || windows.empty()){
+        return std::size_t{0};
     }
+
+	DWORD pid = 0;
+	GetWindowThreadProcessId(first, &pid);
+
+	std::unordered_set<HWND> placed;
+	std::size_t next = 0;
+
+	auto place = [&](HWND hwnd) -> std::optional<DeskUp::Error> {
+		placed.insert(hwnd);
+
+		auto res = WIN_resizeWindow(_this, hwnd, windows[next]);
+		if(!res.has_value() && res.error().isFatal()){
+			return std::move(res.error());
+		}
+
+		//a window that refused the geometry still counts as the one opened for it, otherwise it would be launched again
+		next++;
+		return std::nullopt;
+	};
+
+	if(auto fatal = place(first)){
+		return std::unexpected(std::move(*fatal));
+	}
+
+	const auto deadline = std::chrono::steady_clock::now() + timeout;
+	while(next < windows.size()){
+		for(HWND hwnd : WIN_GetTopLevelWindowsOfPid(pid)){
+			if(next == windows.size()){
+				break;
+			}
+			if(placed.contains(hwnd)){
+				continue;
+			}
+			if(auto fatal = place(hwnd)){
+				return std::unexpected(std::move(*fatal));
+			}
+		}
+
+		if(next == windows.size() || std::chrono::steady_clock::now() >= deadline){
+			break;
+		}
+		Sleep(100);
+	}
+
+	return next;
+}
+
+DeskUp::Result<windowHandle> WIN_selectOpenWindow(DeskUpWindowDevice* _this, const windowDesc& window) noexcept{
+    if(!_this || !_this->internalData){
+        return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::DeviceNotFound, 0, "WIN_selectOpenWindow|no_device"));
+    }
+
+    if(window.pathToExec.empty()){
+        return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::InvalidInput, 0, "WIN_selectOpenWindow|empty_path"));
+    }
+
+    struct Ctx{
+		const windowDesc* window;
+		std::string target;
+		HWND deskUp;
+		HWND found;
+	};
+
+    Ctx ctx{&window, normalizePathLower(window.pathToExec.string()), getWindowData(_this)->deskUp, nullptr};
+
+    auto callback = [](HWND hwnd, LPARAM lp)->BOOL{
+        Ctx* c = reinterpret_cast<Ctx*>(lp);
+        if(!IsWindowVisible(hwnd) || c->deskUp == hwnd){
+            return TRUE;
+        }
+
+		//the same rect the enumeration reads the geometry from
+        RECT r{};
+        if(!GetWindowRect(hwnd, &r) || r.left != c->window->x || r.top != c->window->y ||
+           (r.right - r.left) != c->window->w || (r.bottom - r.top) != c->window->h){
+            return TRUE;
+        }
+
+		//the path is only queried for the few windows with the right geometry
+        DWORD pid = 0;
+        GetWindowThreadProcessId(hwnd, &pid);
+        std::string img;
+        if(!WIN_queryPathFromPid(pid, img) || normalizePathLower(img) != c->target){
+            return TRUE;
+        }
+
+        c->found = hwnd;
+        return FALSE;
+    };
+
+    EnumWindows(callback, reinterpret_cast<LPARAM>(&ctx));
+
+	//the window might have been closed since it was enumerated
+    if(!ctx.found){
+        return std::unexpected(DeskUp::Error(DeskUp::Level::Skip, DeskUp::ErrType::NotFound, 0, "WIN_selectOpenWindow|no_hwnd_" + window.pathToExec.string()));
+    }
+
+    return static_cast<windowHandle>(ctx.found);
 }
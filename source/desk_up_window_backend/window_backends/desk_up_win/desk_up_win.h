@@ -31,12 +31,16 @@
 #include <stdexcept>
 #include <vector>
 #include <filesystem>
+#include <functional>
+#include <optional>
+#include <span>
 
 #include <stdlib.h>
 #include <Windows.h>
 
 #include "desk_up_window_bootstrap.h"
 #include "desk_up_window_device.h"
+#include "desk_up_window_backend.h"
 #include "window_desc.h"
 #include "desk_up_error.h"
 
@@ -102,69 +106,103 @@ void WIN_destroyDevice(DeskUpWindowDevice* _this) noexcept;
 DeskUp::Result<std::string> WIN_getDeskUpPath() noexcept;
 
 /**
- * @brief Gets the X position (top-left corner) of the active (client) window in the device.
+ * @brief Gets the whole rectangle of \c window, with a single `GetWindowInfo`.
  *
  * @param _this The same device instance.
+ * @param window The \c HWND of the window.
+ * @return The position and size of the window.
+ * @errors
+ * - Level::Error, ErrType::DeviceNotFound → Missing or invalid device/internal data (explicit check).
+ * - Level::Skip, ErrType::InvalidInput → \c window is not a valid HWND (explicit check).
+ * @note Indirect errors: This function wraps `GetWindowInfo` with `retryOp`, which may propagate additional system-derived errors (fatal/skip/warning/retry) classified via `Error::fromLastWinError`.
+ * @version 0.3.4
+ * @date 2025
+ */
+DeskUp::Result<windowGeometry> WIN_getWindowGeometry(DeskUpWindowDevice * _this, windowHandle window) noexcept;
+
+/**
+ * @brief Gets the rectangles of several windows, one `GetWindowInfo` each and without retries.
+ *
+ * @param _this The same device instance.
+ * @param windows The \c HWND of each window.
+ * @return One entry per window, in order. \c std::nullopt for the windows that are gone or couldn't be read.
+ * @errors
+ * - Level::Error, ErrType::DeviceNotFound → Missing or invalid device/internal data (explicit check).
+ * @version 0.3.4
+ * @date 2025
+ */
+DeskUp::Result<std::vector<std::optional<windowGeometry>>> WIN_getWindowsGeometry(DeskUpWindowDevice * _this,
+    const std::vector<windowHandle>& windows) noexcept;
+
+/**
+ * @brief Gets the X position (top-left corner) of \c window.
+ *
+ * @param _this The same device instance.
+ * @param window The \c HWND of the window.
  * @return \c int with the X coordinate of the window.
  * @errors
  * - Level::Error, ErrType::DeviceNotFound → Missing or invalid device/internal data (explicit check).
- * - Level::Skip, ErrType::InvalidInput → No valid HWND bound (explicit check).
- * @note Indirect errors: This function wraps `GetWindowInfo` with `retryOp`, which may propagate additional system-derived errors (fatal/skip/warning/retry) classified via `Error::fromLastWinError`. Those are not enumerated here because they are not produced directly by this function but rethrown from `retryOp`.
- * @version 0.1.0
+ * - Level::Skip, ErrType::InvalidInput → \c window is not a valid HWND (explicit check).
+ * @note Thin wrapper around `WIN_getWindowGeometry`, whose errors it returns as they are.
+ * @version 0.3.4
  * @date 2025
  */
-DeskUp::Result<int> WIN_getWindowXPos(DeskUpWindowDevice * _this) noexcept;
+DeskUp::Result<int> WIN_getWindowXPos(DeskUpWindowDevice * _this, windowHandle window) noexcept;
 
 /**
- * @brief Gets the Y position (top-left corner) of the active (client) window in the device.
+ * @brief Gets the Y position (top-left corner) of \c window.
  *
  * @param _this The same device instance.
+ * @param window The \c HWND of the window.
  * @return \c int with the Y coordinate of the window.
  * @errors
  * - Level::Error, ErrType::DeviceNotFound → Missing or invalid device/internal data (explicit check).
- * - Level::Skip, ErrType::InvalidInput → No valid HWND bound (explicit check).
- * @note Indirect errors: Uses `retryOp` around `GetWindowInfo`; any Windows-origin errors are classified and rethrown by `retryOp` (see `Error::fromLastWinError`). They are not listed here.
- * @version 0.1.0
+ * - Level::Skip, ErrType::InvalidInput → \c window is not a valid HWND (explicit check).
+ * @note Thin wrapper around `WIN_getWindowGeometry`, whose errors it returns as they are.
+ * @version 0.3.4
  * @date 2025
  */
-DeskUp::Result<int> WIN_getWindowYPos(DeskUpWindowDevice * _this) noexcept;
+DeskUp::Result<int> WIN_getWindowYPos(DeskUpWindowDevice * _this, windowHandle window) noexcept;
 
 /**
- * @brief Gets the width of the active (client) window in the device.
+ * @brief Gets the width of \c window.
  *
  * @param _this The same device instance.
+ * @param window The \c HWND of the window.
  * @return \c unsigned \c int with the window width.
  * @errors
  * - Level::Error, ErrType::DeviceNotFound → Missing or invalid device/internal data (explicit check).
- * - Level::Skip, ErrType::InvalidInput → No valid HWND bound (explicit check).
- * @note Indirect errors: Additional system errors may be returned via `retryOp` wrapping `GetWindowInfo`; see its implementation and `Error::fromLastWinError` for classification.
- * @version 0.1.0
+ * - Level::Skip, ErrType::InvalidInput → \c window is not a valid HWND (explicit check).
+ * @note Thin wrapper around `WIN_getWindowGeometry`, whose errors it returns as they are.
+ * @version 0.3.4
  * @date 2025
  */
-DeskUp::Result<unsigned int> WIN_getWindowWidth(DeskUpWindowDevice * _this) noexcept;
+DeskUp::Result<unsigned int> WIN_getWindowWidth(DeskUpWindowDevice * _this, windowHandle window) noexcept;
 
 /**
- * @brief Gets the height of the active (client) window in the device.
+ * @brief Gets the height of \c window.
  *
  * @param _this The same device instance.
+ * @param window The \c HWND of the window.
  * @return \c unsigned \c int with the window height.
  * @errors
  * - Level::Error, ErrType::DeviceNotFound → Missing or invalid device/internal data (explicit check).
- * - Level::Skip, ErrType::InvalidInput → No valid HWND bound (explicit check).
- * @note Indirect errors: Relies on `retryOp` for `GetWindowInfo`; propagated errors are produced by `retryOp` and not enumerated here.
- * @version 0.1.0
+ * - Level::Skip, ErrType::InvalidInput → \c window is not a valid HWND (explicit check).
+ * @note Thin wrapper around `WIN_getWindowGeometry`, whose errors it returns as they are.
+ * @version 0.3.4
  * @date 2025
  */
-DeskUp::Result<unsigned int> WIN_getWindowHeight(DeskUpWindowDevice * _this) noexcept;
+DeskUp::Result<unsigned int> WIN_getWindowHeight(DeskUpWindowDevice * _this, windowHandle window) noexcept;
 
 /**
- * @brief Gets the absolute path of the executable that owns the active window.
+ * @brief Gets the absolute path of the executable that owns \c window.
  *
  * @param _this The same device instance.
+ * @param window The \c HWND of the window.
  * @return \c fs::path with the process image path on success.
  * @errors
  * - Level::Error, ErrType::DeviceNotFound → Missing or invalid device/internal data (explicit check).
- * - Level::Skip, ErrType::InvalidInput → No valid HWND bound (explicit check).
+ * - Level::Skip, ErrType::InvalidInput → \c window is not a valid HWND (explicit check).
  * @note Indirect errors (via `retryOp`): This function internally retries three Windows API sequences: `GetWindowThreadProcessId`, `OpenProcess` + `GetExitCodeProcess`, and path resolution (e.g. `QueryFullProcessImageName`). Failures inside those lambdas are converted by `Error::fromLastWinError`. The most relevant Windows codes and their mapped DeskUp classifications for this routine are:
  *   - `ERROR_INVALID_WINDOW_HANDLE` → Level::Skip, ErrType::ConnectionRefused (invalid/closed HWND when obtaining PID).
  *   - `ERROR_ACCESS_DENIED` (transformed to `ERROR_ACCESS_DISABLED_BY_POLICY` before returning) → Level::Skip, ErrType::Default (policy or permission restriction when opening the process).
@@ -175,10 +213,10 @@ DeskUp::Result<unsigned int> WIN_getWindowHeight(DeskUpWindowDevice * _this) noe
  *   - `ERROR_WRITE_FAULT` / `ERROR_READ_FAULT` / `ERROR_CRC` / `ERROR_IO_DEVICE` / `ERROR_FUNCTION_FAILED` → Level::Retry, ErrType::Io or ErrType::Unexpected (transient or unexpected low-level I/O issues; retries attempted before surfacing).
  *   - Other unmapped codes → Level::Default, ErrType::Default.
  * These are not emitted directly by `WIN_getPathFromWindow`; they are rethrown from `retryOp` after classification. Only the explicit pre-check errors are listed in the main @errors section above.
- * @version 0.1.0
+ * @version 0.3.4
  * @date 2025
  */
-DeskUp::Result<fs::path> WIN_getPathFromWindow(DeskUpWindowDevice * _this) noexcept;
+DeskUp::Result<fs::path> WIN_getPathFromWindow(DeskUpWindowDevice * _this, windowHandle window) noexcept;
 
 /**
  * @brief Enumerates all visible/non-minimized windows on the desktop.
@@ -188,28 +226,45 @@ DeskUp::Result<fs::path> WIN_getPathFromWindow(DeskUpWindowDevice * _this) noexc
  * @errors
  * - Level::Fatal, ErrType::Unexpected → Device or windowData became corrupt during enumeration (explicit check after EnumDesktopWindows fails and error.level() == Error).
  * - Level::Warning, ErrType::Unexpected → EnumDesktopWindows returned false for an unexpected reason not classified as fatal/error (catch-all for unanticipated callback failures).
- * @note Indirect errors (via `WIN_CreateAndSaveWindowProc` callback): During enumeration, each window is processed via a callback that invokes `WIN_getPathFromWindow`, `WIN_getWindowXPos`, `WIN_getWindowYPos`, `WIN_getWindowWidth`, and `WIN_getWindowHeight`. The callback may generate:
+ * @note Indirect errors (via `WIN_CreateAndSaveWindowProc` callback): During enumeration, each window is processed via a callback that invokes `WIN_getPathFromWindow`. The geometry is the one read (with a single `GetWindowInfo`) to filter out zero-sized windows; windows that can't be read are skipped. The callback may generate:
  *   - Level::Error, ErrType::InvalidInput → Callback parameters missing (improbable).
  *   - Level::Error, ErrType::DeviceNotFound → Missing device/internal data while processing a window.
- *   - Fatal errors from any geometry/path call → Bubble up immediately, aborting enumeration.
+ *   - Fatal errors from the path call → Bubble up immediately, aborting enumeration.
  *   - Skip errors (e.g., invalid HWND mid-enumeration) → Individual window skipped, enumeration continues.
- *   - Other Error-level issues → Tolerated once (static flag `levelErrorHappened`), fatal on second consecutive occurrence.
- * Since the geometry and path functions each call `retryOp`, refer to their individual documentation (`WIN_getWindowXPos`, `WIN_getWindowYPos`, `WIN_getWindowWidth`, `WIN_getWindowHeight`, `WIN_getPathFromWindow`) for complete Windows error code mappings that may propagate through the callback.
+ *   - Other Error-level issues → Tolerated once (flag `levelErrorHappened` of the enumeration), fatal on second consecutive occurrence.
+ * Since the path function calls `retryOp`, refer to the documentation of `WIN_getPathFromWindow` for complete Windows error code mappings that may propagate through the callback.
  * @version 0.1.0
  * @date 2025
  */
 DeskUp::Result<std::vector<windowDesc>> WIN_getAllOpenWindows(DeskUpWindowDevice * _this) noexcept;
 
+/**
+ * @brief Enumerates the same windows as `WIN_getAllOpenWindows`, handing each one to \c sink as soon as its path and geometry are known.
+ *
+ * @param _this The same device instance.
+ * @param sink Receives every window, in enumeration order, on the calling thread.
+ * @return \c DeskUp::Status, empty if the whole desktop was enumerated.
+ * @errors
+ * - Any error returned by \c sink → Returned as is, and the enumeration stops.
+ * - Same errors as `WIN_getAllOpenWindows` otherwise.
+ * @version 0.3.4
+ * @date 2025
+ */
+DeskUp::Status WIN_streamOpenWindows(DeskUpWindowDevice * _this, const std::function<DeskUp::Status(windowDesc&&)>& sink) noexcept;
+
 /**
  * @brief Loads a window description from a saved workspace file.
  *
+ * @details The parsing itself is platform independent and done by `windowDescLoader::load()`.
+ *
  * @param _this The same device instance.
  * @param path Path to the saved window description file.
  * @return \c windowDesc with geometry and executable path.
- * @errors
+ * @errors Mirrors the codes of `windowDescLoader`, converted through `DeskUp::Error::fromLoadError()`:
  * - Level::Fatal, ErrType::InvalidInput → File missing or incomplete.
- * - Level::Retry, ErrType::Io → Filesystem or parse failure.
- * @version 0.2.0
+ * - Level::Skip, ErrType::Io → The file could not be opened or read.
+ * - Level::Retry, ErrType::InvalidInput → A coordinate is not an integer, or a dimension is negative.
+ * @version 0.3.4
  * @date 2025
  */
 DeskUp::Result<windowDesc> WIN_recoverSavedWindow(DeskUpWindowDevice * _this, const fs::path& path) noexcept;
@@ -219,22 +274,38 @@ DeskUp::Result<windowDesc> WIN_recoverSavedWindow(DeskUpWindowDevice * _this, co
  *
  * @param _this The same device instance.
  * @param path a literal representing the path to the executable linked with the program.
- * @return \c DeskUp::Status indicating success or failure.
+ * @return The \c HWND of the main window of the launched process.
  * @errors
  * - Level::Fatal, ErrType::InvalidInput → Empty or invalid path/device.
- * - Level::Retry, ErrType::NotFound → Process started but main HWND not found.
+ * - Level::Retry, ErrType::NotFound → Process started but main HWND not found, or the shell didn't start a process.
  * - Level::Retry, ErrType::Os → ShellExecuteEx failed.
- * @version 0.2.0
+ * @version 0.3.4
  * @date 2025
  */
-DeskUp::Status WIN_loadProcessFromPath(DeskUpWindowDevice * _this, const fs::path& path) noexcept;
+DeskUp::Result<windowHandle> WIN_loadProcessFromPath(DeskUpWindowDevice * _this, const fs::path& path) noexcept;
 
 /**
- * @brief Resizes a window according to the windowDesc parameter geometry.
+ * @brief Same as \c WIN_loadProcessFromPath, but stops waiting once \c budget has passed since the launch.
  *
- * @details Information about the window whose geometry is intended to modify must be specified inside the \c _this->internalData parameter.
+ * @details The budget covers both the wait for the app to go idle and the search of its main window, which gets whatever
+ * is left of it (at least 300 ms). The app is not closed when the budget runs out.
  *
  * @param _this The same device instance.
+ * @param path a literal representing the path to the executable linked with the program.
+ * @param budget How long to wait for the window, from the launch.
+ * @return The \c HWND of the main window of the launched process.
+ * @errors Same as \c WIN_loadProcessFromPath, plus:
+ * - Level::Retry, ErrType::Timeout → The app didn't go idle, or didn't show its main window, within \c budget.
+ * @version 0.3.4
+ * @date 2025
+ */
+DeskUp::Result<windowHandle> WIN_loadProcessFromPathWithin(DeskUpWindowDevice * _this, const fs::path& path, std::chrono::milliseconds budget) noexcept;
+
+/**
+ * @brief Resizes a window according to the windowDesc parameter geometry.
+ *
+ * @param _this The same device instance.
+ * @param target The \c HWND of the window to resize, as returned by \c WIN_loadProcessFromPath or \c WIN_selectOpenWindow.
  * @param window a windowDesc instance whose geometry will be applied to resize the window.
  * @return \c DeskUp::Status indicating success or failure.
  * @errors
@@ -242,10 +313,10 @@ DeskUp::Status WIN_loadProcessFromPath(DeskUpWindowDevice * _this, const fs::pat
  * - Level::Retry, ErrType::NotFound → HWND not found.
  * - Level::Warning, ErrType::InvalidInput → Zero or negative width/height.
  * - Level::Retry, ErrType::Os → SetWindowPos failed.
- * @version 0.2.0
+ * @version 0.3.4
  * @date 2025
  */
-DeskUp::Status WIN_resizeWindow(DeskUpWindowDevice * _this, const windowDesc window) noexcept;
+DeskUp::Status WIN_resizeWindow(DeskUpWindowDevice * _this, windowHandle target, const windowDesc window) noexcept;
 
 /**
  * @brief This function closes all the instances associated with an executable, specified by the \c path parameter.
@@ -263,11 +334,115 @@ DeskUp::Status WIN_resizeWindow(DeskUpWindowDevice * _this, const windowDesc win
 DeskUp::Result<unsigned int> WIN_closeProcessFromPath(DeskUpWindowDevice*, const fs::path& path, bool allowForce) noexcept;
 
 /**
- * @brief Test-only helper to set the internal HWND for the device.
- * @param _this The device instance.
- * @param hwnd The HWND to assign.
- * @note Only available when DESKUP_ENABLE_WIN32_TEST_HOOKS is defined.
+ * @brief Closes all the instances of every executable in \c paths at once.
+ *
+ * @details Takes a single process snapshot, posts \c WM_CLOSE to the top-level windows of every matching process, and then waits
+ * on all of them against one shared deadline (500 ms, then 1000 ms more after \c TerminateProcess if \c allowForce is set). The
+ * whole call lasts as long as the slowest process instead of the sum of all of them.
+ *
+ * @param _this The same device instance.
+ * @param paths The executables to close.
+ * @param allowForce Whether if the call should force the processes still running after the graceful deadline to close.
+ * @return \c The number of processes closed.
+ * @errors
+ * - Level::Error, ErrType::InvalidInput → One of the paths is empty.
+ * @version 0.3.4
+ * @date 2025
+ */
+DeskUp::Result<unsigned int> WIN_closeProcessesFromPaths(DeskUpWindowDevice*, const std::vector<fs::path>& paths, bool allowForce) noexcept;
+
+/**
+ * @brief Finds the open window of \c window's executable that has exactly \c window's geometry.
+ *
+ * @param _this The same device instance.
+ * @param window An open window, as enumerated by \c WIN_getAllOpenWindows.
+ * @return The \c HWND of the window found.
+ * @errors
+ * - Level::Error, ErrType::DeviceNotFound → Invalid window device.
+ * - Level::Error, ErrType::InvalidInput → Empty path.
+ * - Level::Skip, ErrType::NotFound → No open window matches anymore.
+ * @version 0.3.4
+ * @date 2025
+ */
+DeskUp::Result<windowHandle> WIN_selectOpenWindow(DeskUpWindowDevice* _this, const windowDesc& window) noexcept;
+
+/**
+ * @brief Places the windows of the process whose main window is \c launched.
+ *
+ * @details The first geometry is applied to \c launched. The visible top-level windows of the same process are then polled
+ * every 100 ms, and each new one gets the next geometry, until every geometry is used or \c timeout has passed. A window that
+ * can't be resized (non-fatal error) still uses up its geometry.
+ *
+ * @param _this The same device instance.
+ * @param launched The \c HWND returned by \c WIN_loadProcessFromPath.
+ * @param windows The geometries to hand out, in order.
+ * @param timeout How long to wait for the windows after the first one.
+ * @return The number of windows placed. \c 0 if \c launched is null.
+ * @errors
+ * - Level::Error, ErrType::DeviceNotFound → Invalid window device.
+ * - Any fatal error returned by \c WIN_resizeWindow.
+ * @version 0.3.4
+ * @date 2025
+ */
+DeskUp::Result<std::size_t> WIN_placeLaunchedWindows(DeskUpWindowDevice* _this, windowHandle launched, const std::vector<windowDesc>& windows,
+    std::chrono::milliseconds timeout) noexcept;
+
+/**
+ * @brief Moves and resizes the windows of \c placements in a single `BeginDeferWindowPos` / `EndDeferWindowPos` transaction.
+ *
+ * @details The windows are read once before the batch, with `WIN_getWindowsGeometry`, so that the ones already in place are not
+ * part of it, and once after it to check the layout. If a window can't be added to the batch, or the batch can't be committed,
+ * every window of it is moved on its own with \c WIN_resizeWindow instead.
+ *
+ * @param _this The same device instance.
+ * @param placements The \c HWND of each window and the rectangle it goes to.
+ * @return One status per placement, in order.
+ * @errors
+ * - Level::Error, ErrType::DeviceNotFound → Invalid window device.
+ * Per placement:
+ * - Level::Skip, ErrType::InvalidInput → Null HWND.
+ * - Level::Error, ErrType::InvalidInput → Zero width or height.
+ * - Level::Skip, ErrType::NotFound → The window is gone.
+ * - Level::Info, ErrType::ResourceBusy → The window didn't move.
+ * - Any error returned by \c WIN_resizeWindow, when the batch couldn't be committed.
+ * @version 0.3.4
+ * @date 2025
+ */
+DeskUp::Result<std::vector<DeskUp::Status>> WIN_applyLayout(DeskUpWindowDevice * _this, std::span<const windowPlacement> placements) noexcept;
+
+/**
+ * @struct WinWindowBackend
+ * @brief The Windows backend as a `DeskUp::Backend::WindowBackend`: every call is a direct call to the \c WIN_ function behind it.
+ *
+ * @details Unlike `DeskUp::Backend::DeviceBackend`, nothing goes through the function pointers of \c device, so the calls can be
+ * inlined into the code templated on the backend. \c device must have been created by \c WIN_CreateDevice (see \c owns), since
+ * its \c internalData is read as the Windows one.
+ *
+ * @version 0.3.4
+ * @date 2025
  */
-void WIN_TEST_setHWND(DeskUpWindowDevice* _this, HWND hwnd);
+struct WinWindowBackend {
+    DeskUpWindowDevice * device = nullptr;
+
+    /** @brief Whether \c device was created by \c WIN_CreateDevice, i.e. whether a \c WinWindowBackend can be used on it. */
+    static bool owns(const DeskUpWindowDevice * device) noexcept {
+        return device && device->DestroyDevice == WIN_destroyDevice;
+    }
+
+    DeskUp::Result<windowGeometry> getWindowGeometry(windowHandle window) const { return WIN_getWindowGeometry(device, window); }
+    DeskUp::Result<fs::path> getPathFromWindow(windowHandle window) const { return WIN_getPathFromWindow(device, window); }
+    DeskUp::Result<std::vector<windowDesc>> getAllOpenWindows() const { return WIN_getAllOpenWindows(device); }
+    bool canStream() const { return true; }
+    DeskUp::Status streamOpenWindows(const DeskUp::Backend::WindowSink& sink) const { return WIN_streamOpenWindows(device, sink); }
+    DeskUp::Result<windowDesc> recoverSavedWindow(const fs::path& path) const { return WIN_recoverSavedWindow(device, path); }
+    DeskUp::Result<windowHandle> loadWindowFromPath(const fs::path& path) const { return WIN_loadProcessFromPath(device, path); }
+    DeskUp::Status resizeWindow(windowHandle window, const windowDesc& geometry) const { return WIN_resizeWindow(device, window, geometry); }
+
+    DeskUp::Result<unsigned int> closeProcessFromPath(const fs::path& path, bool allowForce) const {
+        return WIN_closeProcessFromPath(device, path, allowForce);
+    }
+};
+
+static_assert(DeskUp::Backend::WindowBackend<WinWindowBackend>);
 
 #endif
@@ -12,6 +12,10 @@ std::string DESKUPDIR;
 
 std::unique_ptr<DeskUpWindowDevice> current_window_backend = nullptr;
 
+std::unique_ptr<DeskUp::Workspace::WorkspaceStore> current_workspace_store = nullptr;
+
+std::unique_ptr<DeskUp::Workspace::WorkspaceReclaimer> current_workspace_reclaimer = nullptr;
+
 int DU_Init(){
 
     #ifdef _WIN32
@@ -48,6 +52,25 @@ int DU_Init(){
 
     std::cout << "DeskUp path: " << DESKUPDIR << std::endl;
 
+    current_workspace_reclaimer = std::make_unique<DeskUp::Workspace::WorkspaceReclaimer>();
+    DeskUp::Workspace::reclaimRetired(DESKUPDIR, *current_workspace_reclaimer);
+
+    //without a store, workspaces keep being saved as directories
+    if(auto store = DeskUp::Workspace::WorkspaceStore::open(fs::path(DESKUPDIR) / DeskUp::Workspace::STORE_FILE_NAME); store.has_value()){
+        current_workspace_store = std::make_unique<DeskUp::Workspace::WorkspaceStore>(std::move(store.value()));
+
+        if(auto imported = DeskUp::Workspace::importWorkspaceDirectories(*current_workspace_store, DESKUPDIR); !imported.has_value()){
+            std::cout << "Could not move every workspace into the store: " << imported.error().what() << std::endl;
+        } else{
+            //they stay on disk, but aren't listed anymore
+            for(const auto& [name, err] : imported.value().skipped){
+                std::cout << "Workspace " << name << " could not be moved into the store: " << err.what() << std::endl;
+            }
+        }
+    } else{
+        std::cout << "Could not open the workspace store: " << store.error().what() << std::endl;
+    }
+
     current_window_backend = std::make_unique<DeskUpWindowDevice>(dev);
     std::cout << devName << " successfully connected as a backend!" << std::endl;
 
@@ -57,6 +80,9 @@ int DU_Init(){
 void DU_Destroy(){
 	current_window_backend.get()->DestroyDevice(current_window_backend.get());
     current_window_backend.reset();
+    current_workspace_store.reset();
+    //finishes the pending deletions
+    current_workspace_reclaimer.reset();
     DESKUPDIR.clear();
     devices.clear();
 }
\ No newline at end of file
@@ -32,6 +32,13 @@
 #include <vector>
 #include "desk_up_window_device.h"
 #include "desk_up_window_bootstrap.h"
+#include "workspace_store.h"
+#include "workspace_reclaimer.h"
+
+#if defined(DESKUP_STATIC_BACKEND) && defined(_WIN32)
+    //defined by desk_up_win.h, which brings <windows.h> along: only window_core_backend.h includes it
+    struct WinWindowBackend;
+#endif
 
 /**
  * @var std::string DESKUPDIR
@@ -64,6 +71,39 @@ extern std::string DESKUPDIR;
  */
 extern std::unique_ptr<DeskUpWindowDevice> current_window_backend;
 
+/**
+ * @var std::unique_ptr<DeskUp::Workspace::WorkspaceStore> current_workspace_store
+ * \anchor current_workspace_store_anchor
+ * @brief The store holding every saved workspace (`<DESKUPDIR>/workspaces.dulog`).
+ *
+ * @details This global pointer gets assigned when calling DU_Init(). If the store can't be opened it stays null,
+ * and workspaces keep being saved one directory each under \ref DESKUPDIR_anchor.
+ *
+ * The store isn't thread-safe. `DeskUpBackendInterface` serializes its own calls into it, including the ones made from
+ * the thread of an async save or restore, so anything else reaching it while DeskUp runs has to go through that interface.
+ *
+ * @see DU_Init()
+ * @see DeskUp::Workspace::WorkspaceStore
+ * @version 0.3.4
+ * @date 2025
+ */
+extern std::unique_ptr<DeskUp::Workspace::WorkspaceStore> current_workspace_store;
+
+/**
+ * @var std::unique_ptr<DeskUp::Workspace::WorkspaceReclaimer> current_workspace_reclaimer
+ * \anchor current_workspace_reclaimer_anchor
+ * @brief Deletes retired workspaces and files in the background.
+ *
+ * @details This global pointer gets assigned when calling DU_Init(), which also queues whatever a previous run
+ * retired without deleting. While it is null, retired files are deleted right away.
+ *
+ * @see DU_Init()
+ * @see DeskUp::Workspace::WorkspaceReclaimer
+ * @version 0.3.4
+ * @date 2025
+ */
+extern std::unique_ptr<DeskUp::Workspace::WorkspaceReclaimer> current_workspace_reclaimer;
+
 /**
  * @brief Initializes the DeskUp backend system.
  * 
@@ -72,10 +112,14 @@ extern std::unique_ptr<DeskUpWindowDevice> current_window_backend;
  *  - Calls the backend bootstrap function `isAvailable()` to check if it can be used.
  *  - If available, calls `createDevice()` to create and configure the backend device.
  *  - Calls `getDeskUpPath()` through the device to determine the workspace base directory.
+ *  - Starts the workspace reclaimer, and queues any retired file left behind by a previous run.
+ *  - Opens the workspace store inside that directory, and moves into it any workspace still saved as a directory.
  *
  * Once initialization completes successfully:
  *  - The global variable \ref DESKUPDIR_anchor contains the DeskUp workspace path.
  *  - The global pointer \ref current_window_backend_anchor references the active backend device.
+ *  - The global pointer \ref current_workspace_store_anchor references the workspace store, unless it couldn't be opened.
+ *  - The global pointer \ref current_workspace_reclaimer_anchor references the workspace reclaimer.
  *
  * @note The function currently supports only the Windows backend, which internally maps to:
  *  - @ref WIN_isAvailable()
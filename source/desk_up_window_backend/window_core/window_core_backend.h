@@ -0,0 +1,72 @@
+/**
+ * @file window_core_backend.h
+ * @brief Declares DU_WithBackend(), which hands the current device to code templated on its backend
+ *
+ * This file is part of DeskUp
+ *
+ * @details
+ * Kept apart from window_core.h: on single-platform builds the static backend is defined by its platform header
+ * (`desk_up_win.h`, which includes `<windows.h>`), and only the sources dispatching through it should see its macros.
+ * Anything else, the GUI included, only needs window_core.h.
+ *
+ * @author
+ *   Nicolas Serrano Garcia <serranogarcianicolas@gmail.com>
+ * @date
+ *   2025
+ * @copyright
+ *   Copyright (C) 2025 Nicolas Serrano Garcia
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WINDOWCOREBACKEND_H
+#define WINDOWCOREBACKEND_H
+
+#include <utility>
+
+#include "window_core.h"
+#include "desk_up_window_backend.h"
+
+#if defined(DESKUP_STATIC_BACKEND) && defined(_WIN32)
+    #include "desk_up_win.h"
+#endif
+
+/**
+ * @brief Calls \c work with a `DeskUp::Backend::WindowBackend` over \ref current_window_backend_anchor, and returns what it returns.
+ *
+ * @details \c work is a generic callable (e.g. `[&](auto backend){ ... }`), instantiated for every backend it may be given.
+ * When CMake builds for a single platform it defines \c DESKUP_STATIC_BACKEND, and a device created by that platform's
+ * bootstrap is handed to \c work as its static backend (`WinWindowBackend` on Windows), whose calls are bound at compile time.
+ * Any other device (a dummy one installed by a test, a plugin) gets a `DeskUp::Backend::DeviceBackend`, which goes through its
+ * function pointers as always. The check is made once per call to \c DU_WithBackend, not once per device call.
+ *
+ * @param work Called once, on the calling thread.
+ * @see DeskUp::Backend::WindowBackend
+ * @version 0.3.4
+ * @date 2025
+ */
+template<typename F>
+decltype(auto) DU_WithBackend(F&& work){
+    DeskUpWindowDevice * device = current_window_backend.get();
+
+    #if defined(DESKUP_STATIC_BACKEND) && defined(_WIN32)
+        if(WinWindowBackend::owns(device)){
+            return std::forward<F>(work)(WinWindowBackend{device});
+        }
+    #endif
+
+    return std::forward<F>(work)(DeskUp::Backend::DeviceBackend{device});
+}
+
+#endif
@@ -1,4 +1,5 @@
 #include "window_desc.h"
+#include "window_desc_schema.h"
 
 #include <fstream>
 #include <iostream>
@@ -43,11 +44,11 @@ int windowDesc::saveTo(fs::path path){
         }
     }
 
-    windowFile << this->pathToExec
-               << std::endl << this->x
-               << std::endl << this->y
-               << std::endl << this->w
-               << std::endl << this->h;
+    //the layout comes from the field table. Paths are written as plain UTF-8, not quoted by operator<<
+    std::string contents;
+    windowDescSchema::write(*this, contents);
+
+    windowFile.write(contents.data(), static_cast<std::streamsize>(contents.size()));
 
     if(!windowFile.good()){
         return ERR_UNKNOWN;
@@ -55,9 +56,5 @@ int windowDesc::saveTo(fs::path path){
 
     windowFile.close();
 
-    std::cout << "Saved window: " << std::endl
-              << this->pathToExec << std::endl
-              << this->x << " " << this->y << " " << this->w << " " << this->h << std::endl;
-
     return SAVE_SUCCESS;
 }
\ No newline at end of file
@@ -129,12 +129,14 @@ struct windowDesc {
      * indicate success; negative values specify different failure modes.
      *
      * **Format written to file (one value per line):**
-     * 1. Path to executable (`pathToExec`)
+     * 1. Path to executable (`pathToExec`), as UTF-8
      * 2. X coordinate
      * 3. Y coordinate
      * 4. Width
      * 5. Height
      *
+     * The layout is generated from the field table in window_desc_schema.h (see `windowDescSchema::write()`).
+     *
      * @param path Absolute or relative path to the file where data will be stored.
      * @return One of the following `SaveErrorCode` values:
      *   - `SAVE_SUCCESS` (1): File successfully written.
@@ -148,6 +150,8 @@ struct windowDesc {
      * @note The function performs basic validation and never throws exceptions.
      *       Callers are expected to check the return value and propagate or log
      *       the appropriate error code using `DeskUp::Error::fromSaveError()`.
+     * @note One file is opened per window and nothing is flushed to the disk. Whole workspaces are saved with
+     *       `DeskUp::Workspace::WorkspaceWriter`, which writes them at once with a chosen durability.
      *
      * @see windowDesc
      * @see SaveErrorCode
@@ -232,4 +236,63 @@ enum SaveErrorCode {
     ERR_UNKNOWN = -6
 };
 
+/**
+ * @enum LoadErrorCode
+ * @brief Enumerates possible results and error codes of `windowDescLoader`.
+ *
+ * @details Positive values indicate success; negative values indicate different failure modes.
+ * Use `DeskUp::Error::fromLoadError()` to turn them into a `DeskUp::Error`.
+ *
+ * @see windowDescLoader
+ * @see windowDescSchema::parse()
+ * @version 0.3.4
+ * @date 2025
+ */
+enum LoadErrorCode {
+    /**
+     * @brief The window was loaded.
+     */
+    LOAD_SUCCESS = 1,
+
+    /**
+     * @brief The path does not name a regular file (or a directory, for `loadMany()`).
+     */
+    ERR_LOAD_NO_FILE = -1,
+
+    /**
+     * @brief The file exists but could not be opened or read.
+     */
+    ERR_LOAD_FILE_NOT_OPEN = -2,
+
+    /**
+     * @brief The file has less than 5 lines. The write that produced it most likely failed.
+     */
+    ERR_LOAD_INCOMPLETE = -3,
+
+    /**
+     * @brief The X coordinate is not an integer.
+     */
+    ERR_LOAD_INVALID_X = -4,
+
+    /**
+     * @brief The Y coordinate is not an integer.
+     */
+    ERR_LOAD_INVALID_Y = -5,
+
+    /**
+     * @brief The width is not a non-negative integer.
+     */
+    ERR_LOAD_INVALID_W = -6,
+
+    /**
+     * @brief The height is not a non-negative integer.
+     */
+    ERR_LOAD_INVALID_H = -7,
+
+    /**
+     * @brief The file was written with a newer schema version than this build knows about.
+     */
+    ERR_LOAD_UNSUPPORTED_VERSION = -8
+};
+
 #endif
\ No newline at end of file
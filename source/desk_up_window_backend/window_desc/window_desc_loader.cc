@@ -0,0 +1,77 @@
+#include "window_desc_loader.h"
+#include "window_desc_schema.h"
+
+#include <fstream>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+int windowDescLoader::parse(std::string_view text, windowDesc& window) noexcept {
+	//the layout itself is generated from the field table
+	return windowDescSchema::parse(text, window);
+}
+
+int windowDescLoader::load(const fs::path& file, windowDesc& window) noexcept {
+
+	std::error_code ec;
+	if(!fs::is_regular_file(file, ec)){
+		return ERR_LOAD_NO_FILE;
+	}
+
+	std::ifstream in(file, std::ios::in | std::ios::binary | std::ios::ate);
+	if(!in.is_open()){
+		return ERR_LOAD_FILE_NOT_OPEN;
+	}
+
+	const std::streamoff size = in.tellg();
+	if(size < 0){
+		return ERR_LOAD_FILE_NOT_OPEN;
+	}
+
+	//the buffer keeps its capacity between files, so a workspace only allocates for its biggest file
+	buffer.resize(static_cast<std::size_t>(size));
+	in.seekg(0);
+	in.read(buffer.data(), size);
+
+	if(in.gcount() != size){
+		return ERR_LOAD_FILE_NOT_OPEN;
+	}
+
+	return parse(buffer, window);
+}
+
+int windowDescLoader::loadMany(const fs::path& directory, std::vector<windowDesc>& windows, fs::path * failedFile) noexcept {
+
+	std::error_code ec;
+	fs::directory_iterator it(directory, ec);
+	if(ec){
+		if(failedFile){
+			*failedFile = directory;
+		}
+		return ERR_LOAD_NO_FILE;
+	}
+
+	for(const fs::directory_iterator end; it != end;){
+		if(it->is_regular_file(ec)){
+			windowDesc w;
+			if(int res = load(it->path(), w); res != LOAD_SUCCESS){
+				if(failedFile){
+					*failedFile = it->path();
+				}
+				return res;
+			}
+
+			windows.push_back(std::move(w));
+		}
+
+		it.increment(ec);
+		if(ec){
+			if(failedFile){
+				*failedFile = directory;
+			}
+			return ERR_LOAD_FILE_NOT_OPEN;
+		}
+	}
+
+	return LOAD_SUCCESS;
+}
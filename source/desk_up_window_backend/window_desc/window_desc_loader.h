@@ -0,0 +1,113 @@
+/**
+ * @file window_desc_loader.h
+ * @brief Portable loader for the 5-line window files written by `windowDesc::saveTo()`.
+ *
+ * This file is part of DeskUp
+ *
+ * @details
+ * Workspaces saved before the binary manifest existed hold one text file per window. This loader parses them
+ * without depending on any backend: every file is read with a single call into a buffer that is reused across
+ * files, numbers are parsed with `std::from_chars` and no exception is ever thrown. Failures are reported with
+ * `LoadErrorCode` values, which `DeskUp::Error::fromLoadError()` converts into structured errors.
+ *
+ * @author
+ *   Nicolas Serrano Garcia <serranogarcianicolas@gmail.com>
+ * @date
+ *   2025
+ * @copyright
+ *   Copyright (C) 2025 Nicolas Serrano Garcia
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *   See the GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WINDOWDESCLOADER_H
+#define WINDOWDESCLOADER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <filesystem>
+
+#include "window_desc.h"
+
+namespace fs = std::filesystem;
+
+/**
+ * @class windowDescLoader
+ * @brief Loads `windowDesc` instances from the legacy one-file-per-window format.
+ *
+ * @details
+ * **Format (one value per line, as written by `windowDesc::saveTo()`):**
+ * 1. Path to executable. Paths written through `operator<<` by older versions are quoted, and get unquoted here.
+ * 2. X coordinate
+ * 3. Y coordinate
+ * 4. Width
+ * 5. Height
+ *
+ * The layout is not hand-written here: it comes from the field table in window_desc_schema.h.
+ * Lines may end in `\n` or `\r\n`. Anything after the last field is ignored. The window name is set to the
+ * stem of the executable path.
+ *
+ * A loader keeps its read buffer between calls, so reusing the same instance for a whole workspace only
+ * allocates as much as the biggest file needs.
+ *
+ * @version 0.3.4
+ * @date 2025
+ */
+class windowDescLoader {
+public:
+
+    /**
+     * @brief Parses the contents of a single window file.
+     *
+     * @param text The complete file contents.
+     * @param window Output. Only written when the parse succeeds.
+     * @return The result of `windowDescSchema::parse()`.
+     * @version 0.3.4
+     * @date 2025
+     */
+    static int parse(std::string_view text, windowDesc& window) noexcept;
+
+    /**
+     * @brief Loads a single window file.
+     *
+     * @param file The window file.
+     * @param window Output. Only written when the load succeeds.
+     * @return A `LoadErrorCode` value.
+     * @version 0.3.4
+     * @date 2025
+     */
+    int load(const fs::path& file, windowDesc& window) noexcept;
+
+    /**
+     * @brief Loads every regular file inside \c directory in a single pass.
+     *
+     * @details Loading stops at the first file that fails, which is reported through \c failedFile. The windows
+     * loaded before the failure are kept in \c windows.
+     *
+     * @param directory A workspace folder in the legacy format.
+     * @param windows Output. Loaded windows are appended to it.
+     * @param failedFile Optional output set to the file that made the load stop.
+     * @return `LOAD_SUCCESS` if every file was loaded, the code of the failing file otherwise, or
+     * `ERR_LOAD_NO_FILE` if \c directory can't be iterated.
+     * @version 0.3.4
+     * @date 2025
+     */
+    int loadMany(const fs::path& directory, std::vector<windowDesc>& windows, fs::path * failedFile = nullptr) noexcept;
+
+private:
+    std::string buffer;
+};
+
+#endif
@@ -0,0 +1,282 @@
+/**
+ * @file window_desc_schema.h
+ * @brief Compile-time field table describing how a `windowDesc` is stored on disk.
+ *
+ * This file is part of DeskUp
+ *
+ * @details
+ * The text format of a saved window (one value per line) used to be written by hand in `windowDesc::saveTo()`
+ * and read back by hand, line by line, in the backend. Both now come from @ref windowDescSchema::fields: a
+ * `constexpr` tuple with one descriptor per stored member, in the order they appear in the file.
+ *
+ * `write()` and `parse()` expand the table with a fold expression. Member pointers are compile-time constants, so
+ * every field access gets inlined and no table is walked at runtime.
+ *
+ * **Adding a field** (e.g. a monitor id): append a descriptor with `since` set to the new version, and bump
+ * @ref windowDescSchema::CURRENT_VERSION. Files written by older versions keep loading: fields they don't carry
+ * take the descriptor's `fallback` value. Files written with a version greater than 1 start with a `#v<version>`
+ * line. Version 1 files have no such line, so they are byte for byte the legacy 5-line format.
+ *
+ * @author
+ *   Nicolas Serrano Garcia <serranogarcianicolas@gmail.com>
+ * @date
+ *   2025
+ * @copyright
+ *   Copyright (C) 2025 Nicolas Serrano Garcia
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *   See the GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WINDOWDESCSCHEMA_H
+#define WINDOWDESCSCHEMA_H
+
+#include <charconv>
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <filesystem>
+
+#include "window_desc.h"
+
+namespace fs = std::filesystem;
+
+namespace windowDescSchema {
+
+    /**
+     * @brief The schema version written by this build of DeskUp.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr std::uint16_t CURRENT_VERSION = 1;
+
+    /**
+     * @struct PathField
+     * @brief Descriptor of a stored `fs::path` member. Paths are stored as UTF-8.
+     * @version 0.3.4
+     * @date 2025
+     */
+    struct PathField {
+        fs::path windowDesc::* member;  /**< The member it reads and writes. */
+        std::uint16_t since;            /**< First schema version that stores it. Older files leave it empty. */
+        int error;                      /**< `LoadErrorCode` returned when the line is missing. */
+    };
+
+    /**
+     * @struct IntField
+     * @brief Descriptor of a stored \c int member.
+     * @version 0.3.4
+     * @date 2025
+     */
+    struct IntField {
+        int windowDesc::* member;       /**< The member it reads and writes. */
+        std::uint16_t since;            /**< First schema version that stores it. */
+        int fallback;                   /**< Value given to it when loading files older than \c since. */
+        int min;                        /**< Smallest accepted value. */
+        int error;                      /**< `LoadErrorCode` returned when the line is not a valid value. */
+    };
+
+    /**
+     * @brief The stored members of `windowDesc`, in file order.
+     *
+     * @details `windowDesc::name` is not stored: it is derived from the executable path when loading.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr auto fields = std::make_tuple(
+        PathField{&windowDesc::pathToExec, 1, ERR_LOAD_INCOMPLETE},
+        IntField{&windowDesc::x, 1, 0, INT_MIN, ERR_LOAD_INVALID_X},
+        IntField{&windowDesc::y, 1, 0, INT_MIN, ERR_LOAD_INVALID_Y},
+        IntField{&windowDesc::w, 1, 0, 0, ERR_LOAD_INVALID_W},
+        IntField{&windowDesc::h, 1, 0, 0, ERR_LOAD_INVALID_H}
+    );
+
+    //per-kind codecs the table expands into. Kept inline so that write() and parse() flatten into straight-line code
+
+    //returns the next line of text (without its endl chars) and moves text past it
+    inline std::string_view nextLine(std::string_view& text) noexcept {
+        std::size_t end = text.find('\n');
+        std::string_view line = text.substr(0, end);
+        text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+
+        if(!line.empty() && line.back() == '\r'){
+            line.remove_suffix(1);
+        }
+
+        return line;
+    }
+
+    //older saveTo() wrote paths through operator<<, which quotes them the same way std::quoted does
+    inline std::string unquotePath(std::string_view s){
+        if(s.size() < 2 || s.front() != '"'){
+            return std::string(s);
+        }
+
+        std::string out;
+        out.reserve(s.size() - 2);
+
+        for(std::size_t i = 1; i < s.size(); i++){
+            char c = s[i];
+
+            if(c == '\\' && i + 1 < s.size()){
+                out += s[++i];
+            }
+            else if(c == '"'){
+                break;
+            }
+            else{
+                out += c;
+            }
+        }
+
+        return out;
+    }
+
+    inline void writeField(std::string& out, const windowDesc& window, const PathField& f){
+        auto u8 = (window.*f.member).u8string();
+        out.append(u8.begin(), u8.end());
+    }
+
+    inline void writeField(std::string& out, const windowDesc& window, const IntField& f){
+        char buf[16];
+        auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), window.*f.member);
+        out.append(buf, ptr);
+    }
+
+    inline int readField(std::string_view line, windowDesc& window, const PathField& f){
+        std::string path = unquotePath(line);
+        window.*f.member = fs::path(std::u8string(path.begin(), path.end()));
+        return LOAD_SUCCESS;
+    }
+
+    //the whole line has to be a number. Unlike stoi, from_chars neither skips whitespace nor throws
+    inline int readField(std::string_view line, windowDesc& window, const IntField& f) noexcept {
+        int v;
+        auto [ptr, ec] = std::from_chars(line.data(), line.data() + line.size(), v);
+        if(line.empty() || ec != std::errc{} || ptr != line.data() + line.size() || v < f.min){
+            return f.error;
+        }
+
+        window.*f.member = v;
+        return LOAD_SUCCESS;
+    }
+
+    inline void migrateField(windowDesc& window, const PathField& f){
+        (window.*f.member).clear();
+    }
+
+    inline void migrateField(windowDesc& window, const IntField& f) noexcept {
+        window.*f.member = f.fallback;
+    }
+
+    /**
+     * @brief Appends the on-disk representation of \c window to \c out.
+     *
+     * @tparam Version The schema version to write. Only fields with `since <= Version` are written.
+     * @param window The window to serialize.
+     * @param out Output buffer. It is appended to, not cleared.
+     * @version 0.3.4
+     * @date 2025
+     */
+    template<std::uint16_t Version = CURRENT_VERSION>
+    inline void write(const windowDesc& window, std::string& out){
+        static_assert(Version >= 1 && Version <= CURRENT_VERSION, "Unknown windowDesc schema version");
+
+        if constexpr (Version > 1){
+            out += "#v";
+            out += std::to_string(Version);
+            out += '\n';
+        }
+
+        auto writeOne = [&](const auto& f){
+            if(f.since <= Version){
+                writeField(out, window, f);
+                out += '\n';
+            }
+        };
+
+        std::apply([&](const auto&... f){ (writeOne(f), ...); }, fields);
+
+        //no endl after the last value, as the legacy format expects
+        out.pop_back();
+    }
+
+    /**
+     * @brief Parses the on-disk representation of a window.
+     *
+     * @details Fields are read in table order. Fields newer than the version of the file take their fallback
+     * value. Anything after the last field is ignored. `windowDesc::name` is set to the stem of the executable path.
+     *
+     * @param text The complete file contents.
+     * @param window Output. Only written when the parse succeeds.
+     * @return `LOAD_SUCCESS`, `ERR_LOAD_INCOMPLETE`, `ERR_LOAD_UNSUPPORTED_VERSION` or the `error` code of the
+     * first field that could not be read.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline int parse(std::string_view text, windowDesc& window){
+
+        std::uint16_t version = 1;
+
+        //version 1 files predate the version line
+        if(text.starts_with("#v")){
+            std::string_view line = nextLine(text);
+            auto [ptr, ec] = std::from_chars(line.data() + 2, line.data() + line.size(), version);
+            if(ec != std::errc{} || ptr != line.data() + line.size() || version == 0){
+                return ERR_LOAD_INCOMPLETE;
+            }
+            if(version > CURRENT_VERSION){
+                return ERR_LOAD_UNSUPPORTED_VERSION;
+            }
+        }
+
+        windowDesc w;
+        int res = LOAD_SUCCESS;
+
+        auto readOne = [&](const auto& f){
+            if(res != LOAD_SUCCESS){
+                return;
+            }
+
+            //the file predates this field
+            if(f.since > version){
+                migrateField(w, f);
+                return;
+            }
+
+            if(text.empty()){
+                res = ERR_LOAD_INCOMPLETE;
+                return;
+            }
+
+            res = readField(nextLine(text), w, f);
+        };
+
+        std::apply([&](const auto&... f){ (readOne(f), ...); }, fields);
+
+        if(res != LOAD_SUCCESS){
+            return res;
+        }
+
+        auto stem = w.pathToExec.stem().u8string();
+        w.name = std::string(stem.begin(), stem.end());
+
+        window = std::move(w);
+        return LOAD_SUCCESS;
+    }
+}
+
+#endif
@@ -0,0 +1,134 @@
+#include "crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+	#define DESKUP_CRC32C_X86 1
+	#ifdef _MSC_VER
+		#include <intrin.h>
+	#else
+		#include <cpuid.h>
+	#endif
+	#include <nmmintrin.h>
+#endif
+
+//reflected Castagnoli polynomial
+static constexpr std::uint32_t CRC32C_POLY = 0x82F63B78u;
+
+//slicing-by-8: tables[k][b] is the checksum of byte b followed by k zero bytes, so 8 bytes are folded per step
+static constexpr auto makeTables(){
+	std::array<std::array<std::uint32_t, 256>, 8> tables{};
+
+	for(std::uint32_t b = 0; b < 256; b++){
+		std::uint32_t crc = b;
+		for(int bit = 0; bit < 8; bit++){
+			crc = (crc >> 1) ^ (CRC32C_POLY & (0u - (crc & 1u)));
+		}
+		tables[0][b] = crc;
+	}
+
+	for(std::uint32_t b = 0; b < 256; b++){
+		for(std::size_t k = 1; k < 8; k++){
+			tables[k][b] = (tables[k - 1][b] >> 8) ^ tables[0][tables[k - 1][b] & 0xFFu];
+		}
+	}
+
+	return tables;
+}
+
+static constexpr auto TABLES = makeTables();
+
+static std::uint32_t crc32cPortable(const unsigned char * p, std::size_t size, std::uint32_t crc) noexcept {
+
+	while(size >= 8){
+		std::uint32_t lo, hi;
+		std::memcpy(&lo, p, 4);
+		std::memcpy(&hi, p + 4, 4);
+		lo ^= crc;
+
+		crc = TABLES[7][lo & 0xFFu] ^ TABLES[6][(lo >> 8) & 0xFFu] ^ TABLES[5][(lo >> 16) & 0xFFu] ^ TABLES[4][lo >> 24]
+			^ TABLES[3][hi & 0xFFu] ^ TABLES[2][(hi >> 8) & 0xFFu] ^ TABLES[1][(hi >> 16) & 0xFFu] ^ TABLES[0][hi >> 24];
+
+		p += 8;
+		size -= 8;
+	}
+
+	while(size--){
+		crc = (crc >> 8) ^ TABLES[0][(crc ^ *p++) & 0xFFu];
+	}
+
+	return crc;
+}
+
+#ifdef DESKUP_CRC32C_X86
+
+//compiled for SSE4.2 regardless of the global flags. Only ever called once the CPU is known to support it
+#ifndef _MSC_VER
+__attribute__((target("sse4.2")))
+#endif
+static std::uint32_t crc32cHardware(const unsigned char * p, std::size_t size, std::uint32_t crc) noexcept {
+
+	std::uint64_t crc64 = crc;
+
+	while(size >= 8){
+		std::uint64_t v;
+		std::memcpy(&v, p, 8);
+		crc64 = _mm_crc32_u64(crc64, v);
+		p += 8;
+		size -= 8;
+	}
+
+	crc = static_cast<std::uint32_t>(crc64);
+
+	while(size--){
+		crc = _mm_crc32_u8(crc, *p++);
+	}
+
+	return crc;
+}
+
+static bool cpuHasSse42() noexcept {
+	#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 1);
+		return (info[2] & (1 << 20)) != 0;
+	#else
+		unsigned int eax, ebx, ecx, edx;
+		if(!__get_cpuid(1, &eax, &ebx, &ecx, &edx)){
+			return false;
+		}
+		return (ecx & bit_SSE4_2) != 0;
+	#endif
+}
+
+#endif
+
+using Kernel = std::uint32_t (*)(const unsigned char *, std::size_t, std::uint32_t) noexcept;
+
+static Kernel selectKernel() noexcept {
+	#ifdef DESKUP_CRC32C_X86
+		if(cpuHasSse42()){
+			return crc32cHardware;
+		}
+	#endif
+	return crc32cPortable;
+}
+
+static Kernel kernel() noexcept {
+	//resolved on first use, thread-safe since C++11
+	static const Kernel selected = selectKernel();
+	return selected;
+}
+
+std::uint32_t DeskUp::Workspace::crc32c(const void * data, std::size_t size, std::uint32_t crc) noexcept {
+	return ~kernel()(static_cast<const unsigned char *>(data), size, ~crc);
+}
+
+bool DeskUp::Workspace::crc32cIsHardwareAccelerated() noexcept {
+	#ifdef DESKUP_CRC32C_X86
+		return kernel() != crc32cPortable;
+	#else
+		return false;
+	#endif
+}
@@ -0,0 +1,73 @@
+/**
+ * @file crc32c.h
+ * @brief CRC32C (Castagnoli) checksums used to detect corrupted workspaces.
+ *
+ * This file is part of DeskUp
+ *
+ * @details
+ * CRC32C was picked over the zlib CRC32 because x86-64 processors compute it in hardware (the SSE4.2 \c crc32
+ * instruction). The kernel is chosen once, the first time a checksum is computed: the hardware one when the CPU
+ * supports it, a portable slicing-by-8 table otherwise. Both produce exactly the same values.
+ *
+ * @author
+ *   Nicolas Serrano Garcia <serranogarcianicolas@gmail.com>
+ * @date
+ *   2025
+ * @copyright
+ *   Copyright (C) 2025 Nicolas Serrano Garcia
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace DeskUp::Workspace {
+
+    /**
+     * @brief Computes the CRC32C of \c size bytes starting at \c data.
+     *
+     * @details Checksums can be chained: `crc32c(b, n, crc32c(a, m))` is the checksum of \c a followed by \c b.
+     *
+     * @param data The bytes to checksum. May be null if \c size is 0.
+     * @param size Number of bytes.
+     * @param crc The checksum of the bytes preceding \c data, or 0 to start a new one.
+     * @return The checksum.
+     * @version 0.3.4
+     * @date 2025
+     */
+    std::uint32_t crc32c(const void * data, std::size_t size, std::uint32_t crc = 0) noexcept;
+
+    /**
+     * @brief Same as @ref crc32c(const void*, std::size_t, std::uint32_t) for a string view.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline std::uint32_t crc32c(std::string_view bytes, std::uint32_t crc = 0) noexcept {
+        return crc32c(bytes.data(), bytes.size(), crc);
+    }
+
+    /**
+     * @brief Whether checksums are computed with the hardware instruction.
+     * @version 0.3.4
+     * @date 2025
+     */
+    bool crc32cIsHardwareAccelerated() noexcept;
+}
+
+#endif
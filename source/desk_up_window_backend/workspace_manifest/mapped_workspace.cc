@@ -0,0 +1,227 @@
+#include "mapped_workspace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+std::int32_t DeskUp::Workspace::RecordView::field(std::size_t offset) const noexcept {
+	//records aren't guaranteed to be aligned if a future header grows, memcpy compiles down to a plain load anyway
+	std::int32_t v;
+	std::memcpy(&v, record + offset, sizeof(v));
+	return v;
+}
+
+std::uint32_t DeskUp::Workspace::RecordView::ufield(std::size_t offset) const noexcept {
+	std::uint32_t v;
+	std::memcpy(&v, record + offset, sizeof(v));
+	return v;
+}
+
+std::string_view DeskUp::Workspace::RecordView::name() const noexcept {
+	return strings.substr(ufield(offsetof(ManifestRecord, nameOffset)), ufield(offsetof(ManifestRecord, nameLength)));
+}
+
+std::string_view DeskUp::Workspace::RecordView::pathBytes() const noexcept {
+	return strings.substr(ufield(offsetof(ManifestRecord, pathOffset)), ufield(offsetof(ManifestRecord, pathLength)));
+}
+
+fs::path DeskUp::Workspace::RecordView::path() const {
+	std::string_view bytes = pathBytes();
+	return fs::path(std::u8string(bytes.begin(), bytes.end()));
+}
+
+windowDesc DeskUp::Workspace::RecordView::toWindowDesc() const {
+	windowDesc w;
+	w.x = x();
+	w.y = y();
+	w.w = this->w();
+	w.h = h();
+	w.pathToExec = path();
+	w.name = std::string(name());
+	return w;
+}
+
+DeskUp::Result<DeskUp::Workspace::WorkspaceView> DeskUp::Workspace::WorkspaceView::fromBytes(std::string_view bytes){
+
+	if(bytes.size() < sizeof(ManifestHeader)){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::CorruptedData, 0, "decodeManifest|truncated_header"));
+	}
+
+	ManifestHeader header;
+	std::memcpy(&header, bytes.data(), sizeof(header));
+
+	if(std::memcmp(header.magic, MANIFEST_MAGIC, sizeof(header.magic)) != 0){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::InvalidFormat, 0, "decodeManifest|bad_magic"));
+	}
+
+	//a manifest written by a newer DeskUp might have a layout we can't understand
+	if(header.version == 0 || header.version > MANIFEST_VERSION){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::InvalidFormat, 0, "decodeManifest|unsupported_version_" + std::to_string(header.version)));
+	}
+
+	//older or newer writers may have a bigger header or records, but never smaller ones. Version 1 records had no checksum
+	const std::uint32_t minRecordSize = header.version == 1 ? MANIFEST_V1_RECORD_SIZE : sizeof(ManifestRecord);
+	if(header.headerSize < sizeof(ManifestHeader) || header.recordSize < minRecordSize){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::InvalidFormat, 0, "decodeManifest|bad_sizes"));
+	}
+
+	const std::uint64_t recordsEnd = std::uint64_t(header.headerSize) + std::uint64_t(header.recordCount) * header.recordSize;
+	const std::uint64_t stringsEnd = std::uint64_t(header.stringsOffset) + header.stringsSize;
+
+	if(recordsEnd > bytes.size() || stringsEnd > bytes.size() || header.stringsOffset < recordsEnd){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::CorruptedData, 0, "decodeManifest|truncated_body"));
+	}
+
+	WorkspaceView view;
+	view.image = bytes;
+	view.manifestVersion = header.version;
+	view.records = bytes.data() + header.headerSize;
+	view.recordSize = header.recordSize;
+	view.count = header.recordCount;
+	view.strings = bytes.substr(header.stringsOffset, header.stringsSize);
+
+	//checked once here so that the getters of RecordView never have to
+	for(std::size_t i = 0; i < view.count; i++){
+		ManifestRecord r{};
+		std::memcpy(&r, view.records + i * view.recordSize, std::min<std::size_t>(view.recordSize, sizeof(r)));
+
+		if(std::uint64_t(r.pathOffset) + r.pathLength > view.strings.size() || std::uint64_t(r.nameOffset) + r.nameLength > view.strings.size()){
+			return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::CorruptedData, 0, "decodeManifest|bad_string_ref_" + std::to_string(i)));
+		}
+	}
+
+	return view;
+}
+
+bool DeskUp::Workspace::WorkspaceView::intact(std::size_t index) const noexcept {
+	if(!hasChecksums()){
+		return true;
+	}
+
+	ManifestRecord r;
+	std::memcpy(&r, records + index * recordSize, sizeof(r));
+
+	RecordView record = (*this)[index];
+	return recordChecksum(r, record.pathBytes(), record.name()) == r.checksum;
+}
+
+DeskUp::Workspace::MappedWorkspace::~MappedWorkspace(){
+	release();
+}
+
+DeskUp::Workspace::MappedWorkspace::MappedWorkspace(MappedWorkspace&& other) noexcept
+	: data(std::exchange(other.data, nullptr)), length(std::exchange(other.length, 0)), workspace(std::exchange(other.workspace, {})) {}
+
+DeskUp::Workspace::MappedWorkspace& DeskUp::Workspace::MappedWorkspace::operator=(MappedWorkspace&& other) noexcept {
+	if(this != &other){
+		release();
+		data = std::exchange(other.data, nullptr);
+		length = std::exchange(other.length, 0);
+		workspace = std::exchange(other.workspace, {});
+	}
+	return *this;
+}
+
+void DeskUp::Workspace::MappedWorkspace::release() noexcept {
+	if(!data){
+		return;
+	}
+
+	#ifdef _WIN32
+		UnmapViewOfFile(data);
+	#else
+		munmap(const_cast<char *>(data), length);
+	#endif
+
+	data = nullptr;
+	length = 0;
+	workspace = {};
+}
+
+DeskUp::Result<DeskUp::Workspace::MappedWorkspace> DeskUp::Workspace::MappedWorkspace::open(const fs::path& file){
+
+	MappedWorkspace mapped;
+
+	#ifdef _WIN32
+		HANDLE hFile = CreateFileW(file.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if(hFile == INVALID_HANDLE_VALUE){
+			return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::FileNotFound, 0, "MappedWorkspace::open|file_unopen_" + file.string()));
+		}
+
+		LARGE_INTEGER size;
+		if(!GetFileSizeEx(hFile, &size)){
+			auto err = DeskUp::Error::fromLastWinError("MappedWorkspace::open|GetFileSizeEx");
+			CloseHandle(hFile);
+			return std::unexpected(std::move(err));
+		}
+
+		//an empty file can't be mapped, let the validation below report it as truncated
+		if(size.QuadPart > 0){
+			HANDLE hMapping = CreateFileMappingW(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+			if(!hMapping){
+				auto err = DeskUp::Error::fromLastWinError("MappedWorkspace::open|CreateFileMappingW");
+				CloseHandle(hFile);
+				return std::unexpected(std::move(err));
+			}
+
+			LPVOID view = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+			if(!view){
+				auto err = DeskUp::Error::fromLastWinError("MappedWorkspace::open|MapViewOfFile");
+				CloseHandle(hMapping);
+				CloseHandle(hFile);
+				return std::unexpected(std::move(err));
+			}
+
+			mapped.data = static_cast<const char *>(view);
+			mapped.length = static_cast<std::size_t>(size.QuadPart);
+
+			//the view keeps the mapping alive on its own
+			CloseHandle(hMapping);
+		}
+
+		CloseHandle(hFile);
+	#else
+		int fd = ::open(file.c_str(), O_RDONLY);
+		if(fd < 0){
+			return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::FileNotFound, 0, "MappedWorkspace::open|file_unopen_" + file.string()));
+		}
+
+		struct stat st;
+		if(fstat(fd, &st) != 0){
+			::close(fd);
+			return std::unexpected(DeskUp::Error(DeskUp::Level::Retry, DeskUp::ErrType::Io, 0, "MappedWorkspace::open|no_size_" + file.string()));
+		}
+
+		if(st.st_size > 0){
+			void * view = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+			if(view == MAP_FAILED){
+				::close(fd);
+				return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::Io, 0, "MappedWorkspace::open|mmap_" + file.string()));
+			}
+
+			mapped.data = static_cast<const char *>(view);
+			mapped.length = static_cast<std::size_t>(st.st_size);
+		}
+
+		::close(fd);
+	#endif
+
+	auto view = WorkspaceView::fromBytes(mapped.bytes());
+	if(!view.has_value()){
+		return std::unexpected(std::move(view.error()));
+	}
+
+	mapped.workspace = view.value();
+	return mapped;
+}
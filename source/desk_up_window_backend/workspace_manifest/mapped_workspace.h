@@ -0,0 +1,272 @@
+/**
+ * @file mapped_workspace.h
+ * @brief Zero-copy, read-only access to a workspace manifest.
+ *
+ * This file is part of DeskUp
+ *
+ * @details
+ * `readManifest()` turns a whole manifest into a `std::vector<windowDesc>`, which allocates a `std::string` and an
+ * `fs::path` for every window even when the caller only wants to list or preview the workspace. The types in this file
+ * expose the same manifest without materializing it:
+ *
+ * - @ref DeskUp::Workspace::RecordView reads the geometry of a record in place and hands out the window name and the
+ *   executable path as `std::string_view` into the manifest bytes. The path is only decoded into an `fs::path` when
+ *   @ref DeskUp::Workspace::RecordView::path() is called, typically right before the window gets launched.
+ * - @ref DeskUp::Workspace::WorkspaceView validates a manifest image once and indexes its records. It does not own the bytes.
+ * - @ref DeskUp::Workspace::MappedWorkspace maps a manifest file read-only into memory and owns the mapping for as long
+ *   as the views taken from it are used.
+ *
+ * @author
+ *   Nicolas Serrano Garcia <serranogarcianicolas@gmail.com>
+ * @date
+ *   2025
+ * @copyright
+ *   Copyright (C) 2025 Nicolas Serrano Garcia
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MAPPEDWORKSPACE_H
+#define MAPPEDWORKSPACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include <filesystem>
+
+#include "workspace_manifest.h"
+
+namespace fs = std::filesystem;
+
+namespace DeskUp::Workspace {
+
+    /**
+     * @class RecordView
+     * @brief A non-owning view over a single window record of a manifest.
+     *
+     * @details The view is only valid while the bytes it was taken from are alive. Geometry getters read the record
+     * in place and the string getters return slices of the manifest string table, so none of them allocate.
+     *
+     * @version 0.3.4
+     * @date 2025
+     */
+    class RecordView {
+    public:
+        RecordView(const char * bytes, std::string_view stringTable) noexcept : record(bytes), strings(stringTable) {}
+
+        /** @brief X coordinate (top-left) in pixels. */
+        int x() const noexcept { return field(offsetof(ManifestRecord, x)); }
+
+        /** @brief Y coordinate (top-left) in pixels. */
+        int y() const noexcept { return field(offsetof(ManifestRecord, y)); }
+
+        /** @brief Width in pixels. */
+        int w() const noexcept { return field(offsetof(ManifestRecord, w)); }
+
+        /** @brief Height in pixels. */
+        int h() const noexcept { return field(offsetof(ManifestRecord, h)); }
+
+        /**
+         * @brief The window name, as stored in the manifest.
+         * @version 0.3.4
+         * @date 2025
+         */
+        std::string_view name() const noexcept;
+
+        /**
+         * @brief The raw UTF-8 bytes of the executable path, without decoding them.
+         * @version 0.3.4
+         * @date 2025
+         */
+        std::string_view pathBytes() const noexcept;
+
+        /**
+         * @brief Decodes the executable path. This is the only getter that allocates, so call it only when the path is needed.
+         * @version 0.3.4
+         * @date 2025
+         */
+        fs::path path() const;
+
+        /**
+         * @brief Materializes the record into an owning `windowDesc`.
+         * @version 0.3.4
+         * @date 2025
+         */
+        windowDesc toWindowDesc() const;
+
+    private:
+        std::int32_t field(std::size_t offset) const noexcept;
+
+        std::uint32_t ufield(std::size_t offset) const noexcept;
+
+        const char * record;
+        std::string_view strings;
+    };
+
+    /**
+     * @class WorkspaceView
+     * @brief A validated, non-owning view over a complete manifest image.
+     *
+     * @details Building the view checks the header and every string reference once, so accessing any record afterwards
+     * can't read out of bounds.
+     *
+     * @version 0.3.4
+     * @date 2025
+     */
+    class WorkspaceView {
+    public:
+        /**
+         * @class iterator
+         * @brief Forward iterator yielding a @ref RecordView per record.
+         */
+        class iterator {
+        public:
+            using value_type = RecordView;
+            using difference_type = std::ptrdiff_t;
+
+            iterator() = default;
+            iterator(const WorkspaceView * owner, std::size_t position) noexcept : view(owner), index(position) {}
+
+            RecordView operator*() const noexcept { return (*view)[index]; }
+            iterator& operator++() noexcept { ++index; return *this; }
+            iterator operator++(int) noexcept { iterator tmp = *this; ++index; return tmp; }
+            bool operator==(const iterator& other) const noexcept { return index == other.index; }
+
+        private:
+            const WorkspaceView * view = nullptr;
+            std::size_t index = 0;
+        };
+
+        WorkspaceView() = default;
+
+        /**
+         * @brief Validates \c bytes as a manifest and builds a view over it.
+         *
+         * @param bytes The complete manifest contents. They must outlive the view and every record taken from it.
+         * @return The view.
+         * @errors
+         * - Level::Error, ErrType::InvalidFormat → Bad magic, unknown (newer) version or inconsistent header.
+         * - Level::Error, ErrType::CorruptedData → Truncated image or a record pointing outside of the string table.
+         * @version 0.3.4
+         * @date 2025
+         */
+        static DeskUp::Result<WorkspaceView> fromBytes(std::string_view bytes);
+
+        /** @brief Number of windows in the workspace. */
+        std::size_t size() const noexcept { return count; }
+
+        /** @brief Whether the workspace has no windows. */
+        bool empty() const noexcept { return count == 0; }
+
+        /** @brief The record at \c index. No bounds checking is done. */
+        RecordView operator[](std::size_t index) const noexcept {
+            return RecordView(records + index * recordSize, strings);
+        }
+
+        iterator begin() const noexcept { return iterator(this, 0); }
+        iterator end() const noexcept { return iterator(this, count); }
+
+        /** @brief Offset of the record at \c index from the start of the manifest. Used to patch records into a copy of it. */
+        std::size_t offsetOf(std::size_t index) const noexcept {
+            return static_cast<std::size_t>(records - image.data()) + index * recordSize;
+        }
+
+        /** @brief Version of the manifest the view was built from. */
+        std::uint16_t version() const noexcept { return manifestVersion; }
+
+        /** @brief Whether the manifest carries checksums (version 2 onwards). */
+        bool hasChecksums() const noexcept { return manifestVersion >= 2; }
+
+        /**
+         * @brief Whether the record at \c index matches its checksum. Always \c true for manifests without checksums.
+         * @version 0.3.4
+         * @date 2025
+         */
+        bool intact(std::size_t index) const noexcept;
+
+    private:
+        std::string_view image;
+        std::uint16_t manifestVersion = 0;
+        const char * records = nullptr;
+        std::size_t recordSize = 0;
+        std::size_t count = 0;
+        std::string_view strings;
+    };
+
+    /**
+     * @brief Pairs every window of \c windows with the saved record describing the same window.
+     *
+     * @details Windows and records are paired by executable path and name. Several windows sharing both are paired
+     * in the order they were saved. The order of \c windows itself doesn't matter.
+     *
+     * @return For each window, the index of its record. \c std::nullopt if the workspace doesn't hold exactly the
+     * same windows (one was added, removed or renamed).
+     * @version 0.3.4
+     * @date 2025
+     */
+    std::optional<std::vector<std::size_t>> matchRecords(const WorkspaceView& view, const std::vector<windowDesc>& windows);
+
+    /**
+     * @class MappedWorkspace
+     * @brief Owns a read-only memory mapping of a manifest file and the @ref WorkspaceView over it.
+     *
+     * @details The file is never copied into the process: pages are brought in by the OS as records are touched.
+     * The object is move-only, and every view taken from it becomes invalid once it is destroyed.
+     *
+     * @version 0.3.4
+     * @date 2025
+     */
+    class MappedWorkspace {
+    public:
+        MappedWorkspace() = default;
+        ~MappedWorkspace();
+
+        MappedWorkspace(const MappedWorkspace&) = delete;
+        MappedWorkspace& operator=(const MappedWorkspace&) = delete;
+
+        MappedWorkspace(MappedWorkspace&& other) noexcept;
+        MappedWorkspace& operator=(MappedWorkspace&& other) noexcept;
+
+        /**
+         * @brief Maps \c file and validates it as a manifest.
+         *
+         * @param file The manifest file.
+         * @return The mapped workspace.
+         * @errors
+         * - Level::Error, ErrType::FileNotFound → The file could not be opened.
+         * - The error of the failing system call if the file could not be mapped (see `DeskUp::Error::fromLastWinError()` on Windows).
+         * - Any error returned by @ref WorkspaceView::fromBytes.
+         * @version 0.3.4
+         * @date 2025
+         */
+        static DeskUp::Result<MappedWorkspace> open(const fs::path& file);
+
+        /** @brief The validated view over the mapped manifest. */
+        const WorkspaceView& view() const noexcept { return workspace; }
+
+        /** @brief The raw mapped bytes. */
+        std::string_view bytes() const noexcept { return std::string_view(data, length); }
+
+    private:
+        void release() noexcept;
+
+        const char * data = nullptr;
+        std::size_t length = 0;
+        WorkspaceView workspace;
+    };
+}
+
+#endif
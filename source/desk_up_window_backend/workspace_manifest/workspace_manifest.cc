@@ -0,0 +1,444 @@
+#include "workspace_manifest.h"
+#include "mapped_workspace.h"
+#include "crc32c.h"
+
+#include <fstream>
+#include <cstring>
+#include <cerrno>
+#include <unordered_map>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+//deduplicates the strings of a manifest. Every distinct string gets appended once and any later occurrence reuses the offset
+struct StringTable {
+	std::string bytes;
+	std::unordered_map<std::string, std::uint32_t> offsets;
+
+	std::uint32_t intern(const std::string& s){
+		auto [it, inserted] = offsets.try_emplace(s, static_cast<std::uint32_t>(bytes.size()));
+		if(inserted){
+			bytes += s;
+		}
+		return it->second;
+	}
+};
+
+static std::string pathToUTF8(const fs::path& p){
+	auto u8 = p.u8string();
+	return std::string(u8.begin(), u8.end());
+}
+
+static int saveCodeFromErrno(int err){
+	switch (err) {
+		case EACCES:
+			return ERR_NO_PERMISSION;
+		case ENOENT:
+			return ERR_FILE_NOT_FOUND;
+		case ENOSPC:
+			return ERR_DISK_FULL;
+		default:
+			return ERR_FILE_NOT_OPEN;
+	}
+}
+
+//a record is built the same way whether the whole workspace is encoded at once or streamed window by window
+static DeskUp::Workspace::ManifestRecord makeRecord(const windowDesc& window, StringTable& strings){
+	std::string path = pathToUTF8(window.pathToExec);
+
+	DeskUp::Workspace::ManifestRecord r{};
+	r.x = window.x;
+	r.y = window.y;
+	r.w = window.w;
+	r.h = window.h;
+	r.pathOffset = strings.intern(path);
+	r.pathLength = static_cast<std::uint32_t>(path.size());
+	r.nameOffset = strings.intern(window.name);
+	r.nameLength = static_cast<std::uint32_t>(window.name.size());
+	r.checksum = DeskUp::Workspace::recordChecksum(r, path, window.name);
+
+	return r;
+}
+
+//bodyChecksum is the checksum of everything the header is followed by
+static DeskUp::Workspace::ManifestHeader makeHeader(std::size_t recordCount, std::size_t stringsSize, std::uint32_t bodyChecksum){
+	using namespace DeskUp::Workspace;
+
+	ManifestHeader header{};
+	std::memcpy(header.magic, MANIFEST_MAGIC, sizeof(header.magic));
+	header.version = MANIFEST_VERSION;
+	header.headerSize = sizeof(ManifestHeader);
+	header.recordCount = static_cast<std::uint32_t>(recordCount);
+	header.recordSize = sizeof(ManifestRecord);
+	header.stringsOffset = static_cast<std::uint32_t>(sizeof(ManifestHeader) + recordCount * sizeof(ManifestRecord));
+	header.stringsSize = static_cast<std::uint32_t>(stringsSize);
+	header.checksum = DeskUp::Workspace::crc32c(&header, sizeof(header), bodyChecksum);
+
+	return header;
+}
+
+std::uint32_t DeskUp::Workspace::recordChecksum(const ManifestRecord& record, std::string_view path, std::string_view name) noexcept {
+	std::uint32_t crc = crc32c(&record, MANIFEST_V1_RECORD_SIZE);
+	crc = crc32c(path, crc);
+	return crc32c(name, crc);
+}
+
+std::uint32_t DeskUp::Workspace::manifestChecksum(std::string_view bytes) noexcept {
+	ManifestHeader header;
+	std::memcpy(&header, bytes.data(), sizeof(header));
+	header.checksum = 0;
+
+	return crc32c(&header, sizeof(header), crc32c(bytes.substr(sizeof(header))));
+}
+
+std::string DeskUp::Workspace::encodeManifest(const std::vector<windowDesc>& windows){
+
+	StringTable strings;
+	std::vector<ManifestRecord> records;
+	records.reserve(windows.size());
+
+	for(const auto& window : windows){
+		records.push_back(makeRecord(window, strings));
+	}
+
+	const std::size_t recordsSize = records.size() * sizeof(ManifestRecord);
+
+	std::string image(sizeof(ManifestHeader) + recordsSize + strings.bytes.size(), '\0');
+
+	if(!records.empty()){
+		std::memcpy(image.data() + sizeof(ManifestHeader), records.data(), recordsSize);
+	}
+	std::memcpy(image.data() + sizeof(ManifestHeader) + recordsSize, strings.bytes.data(), strings.bytes.size());
+
+	const std::uint32_t bodyChecksum = crc32c(std::string_view(image).substr(sizeof(ManifestHeader)));
+	const ManifestHeader header = makeHeader(records.size(), strings.bytes.size(), bodyChecksum);
+	std::memcpy(image.data(), &header, sizeof(header));
+
+	return image;
+}
+
+DeskUp::Result<std::vector<windowDesc>> DeskUp::Workspace::decodeManifest(std::string_view bytes){
+
+	auto view = WorkspaceView::fromBytes(bytes);
+	if(!view.has_value()){
+		return std::unexpected(std::move(view.error()));
+	}
+
+	std::vector<windowDesc> windows;
+	windows.reserve(view.value().size());
+
+	for(std::size_t i = 0; i < view.value().size(); i++){
+		if(!view.value().intact(i)){
+			return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::CorruptedData, 0, "decodeManifest|bad_record_" + std::to_string(i)));
+		}
+
+		windows.push_back(view.value()[i].toWindowDesc());
+	}
+
+	return windows;
+}
+
+DeskUp::Status DeskUp::Workspace::verifyManifest(std::string_view bytes){
+
+	auto view = WorkspaceView::fromBytes(bytes);
+	if(!view.has_value()){
+		return std::unexpected(std::move(view.error()));
+	}
+
+	//nothing else to compare against
+	if(!view.value().hasChecksums()){
+		return {};
+	}
+
+	ManifestHeader header;
+	std::memcpy(&header, bytes.data(), sizeof(header));
+
+	//the common case: a single pass over the raw bytes
+	if(manifestChecksum(bytes) == header.checksum){
+		return {};
+	}
+
+	for(std::size_t i = 0; i < view.value().size(); i++){
+		if(!view.value().intact(i)){
+			return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::CorruptedData, 0, "verifyManifest|bad_record_" + std::to_string(i)));
+		}
+	}
+
+	return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::CorruptedData, 0, "verifyManifest|bad_checksum"));
+}
+
+DeskUp::Status DeskUp::Workspace::verifyWorkspace(const fs::path& file){
+
+	auto mapped = MappedWorkspace::open(file);
+	if(!mapped.has_value()){
+		return std::unexpected(std::move(mapped.error()));
+	}
+
+	return verifyManifest(mapped.value().bytes());
+}
+
+DeskUp::Status DeskUp::Workspace::writeManifest(const fs::path& file, const std::vector<windowDesc>& windows, Durability durability){
+	return writeDurably(file, encodeManifest(windows), durability);
+}
+
+DeskUp::Result<std::vector<windowDesc>> DeskUp::Workspace::readManifest(const fs::path& file){
+
+	std::ifstream in(file, std::ios::in | std::ios::binary | std::ios::ate);
+	if(!in.is_open()){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::FileNotFound, 0, "readManifest|file_unopen_" + file.string()));
+	}
+
+	const std::streamoff size = in.tellg();
+	if(size < 0){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Retry, DeskUp::ErrType::Io, 0, "readManifest|no_size_" + file.string()));
+	}
+
+	std::string image(static_cast<std::size_t>(size), '\0');
+	in.seekg(0);
+	in.read(image.data(), size);
+
+	if(in.gcount() != size){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Retry, DeskUp::ErrType::Io, 0, "readManifest|short_read_" + file.string()));
+	}
+
+	return decodeManifest(image);
+}
+
+struct DeskUp::Workspace::ManifestStreamWriter::State {
+	std::ofstream out;
+	//where the manifest starts inside the file
+	std::uint64_t base = 0;
+	std::uint64_t bytes = 0;
+	StringTable strings;
+	std::size_t count = 0;
+	//checksum of the records written so far
+	std::uint32_t crc = 0;
+};
+
+DeskUp::Workspace::ManifestStreamWriter::ManifestStreamWriter(std::unique_ptr<State> opened) noexcept : state(std::move(opened)) {}
+
+DeskUp::Workspace::ManifestStreamWriter::ManifestStreamWriter(ManifestStreamWriter&&) noexcept = default;
+
+DeskUp::Workspace::ManifestStreamWriter& DeskUp::Workspace::ManifestStreamWriter::operator=(ManifestStreamWriter&&) noexcept = default;
+
+DeskUp::Workspace::ManifestStreamWriter::~ManifestStreamWriter() = default;
+
+std::size_t DeskUp::Workspace::ManifestStreamWriter::size() const noexcept {
+	return state ? state->count : 0;
+}
+
+std::uint64_t DeskUp::Workspace::ManifestStreamWriter::bytes() const noexcept {
+	return state ? state->bytes : 0;
+}
+
+DeskUp::Result<DeskUp::Workspace::ManifestStreamWriter> DeskUp::Workspace::ManifestStreamWriter::open(const fs::path& file){
+
+	if(file.empty()){
+		return std::unexpected(DeskUp::Error::fromSaveError(ERR_EMPTY_PATH));
+	}
+
+	auto state = std::make_unique<State>();
+
+	state->out.open(file, std::ios::out | std::ios::binary | std::ios::trunc);
+	if(!state->out.is_open()){
+		return std::unexpected(DeskUp::Error::fromSaveError(saveCodeFromErrno(errno)));
+	}
+
+	return start(std::move(state));
+}
+
+DeskUp::Result<DeskUp::Workspace::ManifestStreamWriter> DeskUp::Workspace::ManifestStreamWriter::openAt(const fs::path& file, std::uint64_t offset){
+
+	if(file.empty()){
+		return std::unexpected(DeskUp::Error::fromSaveError(ERR_EMPTY_PATH));
+	}
+
+	auto state = std::make_unique<State>();
+
+	//in | out keeps what is already in the file
+	state->out.open(file, std::ios::in | std::ios::out | std::ios::binary);
+	if(!state->out.is_open()){
+		return std::unexpected(DeskUp::Error::fromSaveError(saveCodeFromErrno(errno)));
+	}
+
+	state->base = offset;
+	state->out.seekp(static_cast<std::streamoff>(offset));
+
+	return start(std::move(state));
+}
+
+DeskUp::Result<DeskUp::Workspace::ManifestStreamWriter> DeskUp::Workspace::ManifestStreamWriter::start(std::unique_ptr<State> state){
+
+	//zeroed until finish() knows the final counts
+	const ManifestHeader placeholder{};
+	state->out.write(reinterpret_cast<const char *>(&placeholder), sizeof(placeholder));
+	state->bytes = sizeof(placeholder);
+
+	if(!state->out.good()){
+		return std::unexpected(DeskUp::Error::fromSaveError(errno == ENOSPC ? ERR_DISK_FULL : ERR_UNKNOWN));
+	}
+
+	return ManifestStreamWriter(std::move(state));
+}
+
+DeskUp::Status DeskUp::Workspace::ManifestStreamWriter::append(const windowDesc& window){
+
+	const ManifestRecord r = makeRecord(window, state->strings);
+
+	state->out.write(reinterpret_cast<const char *>(&r), sizeof(r));
+
+	if(!state->out.good()){
+		return std::unexpected(DeskUp::Error::fromSaveError(errno == ENOSPC ? ERR_DISK_FULL : ERR_UNKNOWN));
+	}
+
+	state->crc = crc32c(&r, sizeof(r), state->crc);
+	state->bytes += sizeof(r);
+	state->count++;
+	return {};
+}
+
+DeskUp::Status DeskUp::Workspace::ManifestStreamWriter::finish(){
+
+	auto& out = state->out;
+
+	out.write(state->strings.bytes.data(), static_cast<std::streamsize>(state->strings.bytes.size()));
+
+	const std::uint32_t bodyChecksum = crc32c(state->strings.bytes, state->crc);
+	const ManifestHeader header = makeHeader(state->count, state->strings.bytes.size(), bodyChecksum);
+	state->bytes += state->strings.bytes.size();
+
+	out.seekp(static_cast<std::streamoff>(state->base));
+	out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	out.close();
+
+	if(!out.good()){
+		return std::unexpected(DeskUp::Error::fromSaveError(errno == ENOSPC ? ERR_DISK_FULL : ERR_UNKNOWN));
+	}
+
+	return {};
+}
+
+//geometry and the record checksum live in the record itself, so a patch never touches the string table
+struct RecordPatch {
+	std::size_t offset;
+	DeskUp::Workspace::ManifestRecord record;
+};
+
+std::optional<std::vector<std::size_t>> DeskUp::Workspace::matchRecords(const WorkspaceView& view, const std::vector<windowDesc>& windows){
+
+	if(view.size() != windows.size()){
+		return std::nullopt;
+	}
+
+	//records sharing path and name are matched in the order they were saved
+	std::unordered_map<std::string, std::vector<std::size_t>> saved;
+	saved.reserve(view.size());
+
+	for(std::size_t i = view.size(); i-- > 0;){
+		auto record = view[i];
+		std::string key(record.pathBytes());
+		key += '\0';
+		key += record.name();
+		saved[std::move(key)].push_back(i);
+	}
+
+	std::vector<std::size_t> matches;
+	matches.reserve(windows.size());
+
+	for(const auto& window : windows){
+		std::string key = pathToUTF8(window.pathToExec);
+		key += '\0';
+		key += window.name;
+
+		auto it = saved.find(key);
+		if(it == saved.end() || it->second.empty()){
+			return std::nullopt;
+		}
+
+		matches.push_back(it->second.back());
+		it->second.pop_back();
+	}
+
+	return matches;
+}
+
+DeskUp::Result<DeskUp::Workspace::ManifestDelta> DeskUp::Workspace::updateManifest(const fs::path& file, const std::vector<windowDesc>& windows){
+
+	auto rewrite = [&]() -> DeskUp::Result<ManifestDelta> {
+		//the old manifest stays whole until the new one is renamed over it
+		if(auto res = writeManifest(file, windows, Durability::AtomicRename); !res.has_value()){
+			return std::unexpected(std::move(res.error()));
+		}
+		return ManifestDelta{windows.size(), true};
+	};
+
+	std::error_code ec;
+	if(!fs::is_regular_file(file, ec)){
+		return rewrite();
+	}
+
+	std::vector<RecordPatch> patches;
+	std::string image;
+
+	{
+		//an unreadable manifest just gets replaced
+		auto mapped = MappedWorkspace::open(file);
+		if(!mapped.has_value()){
+			return rewrite();
+		}
+
+		const WorkspaceView& view = mapped.value().view();
+
+		//a manifest without checksums gets upgraded, as does a damaged one
+		if(view.size() != windows.size() || !view.hasChecksums() || !verifyManifest(mapped.value().bytes()).has_value()){
+			return rewrite();
+		}
+
+		auto matches = matchRecords(view, windows);
+		if(!matches.has_value()){
+			return rewrite();
+		}
+
+		for(std::size_t w = 0; w < windows.size(); w++){
+			const windowDesc& window = windows[w];
+			const std::size_t i = matches.value()[w];
+
+			auto record = view[i];
+			if(record.x() != window.x || record.y() != window.y || record.w() != window.w || record.h() != window.h){
+				RecordPatch patch{view.offsetOf(i), {}};
+				std::memcpy(&patch.record, mapped.value().bytes().data() + patch.offset, sizeof(patch.record));
+
+				patch.record.x = window.x;
+				patch.record.y = window.y;
+				patch.record.w = window.w;
+				patch.record.h = window.h;
+				patch.record.checksum = recordChecksum(patch.record, record.pathBytes(), record.name());
+
+				patches.push_back(patch);
+			}
+		}
+
+		if(!patches.empty()){
+			//the records are patched into a copy, the manifest is small enough for that, and so is its checksum
+			image.assign(mapped.value().bytes());
+			for(const auto& patch : patches){
+				std::memcpy(image.data() + patch.offset, &patch.record, sizeof(patch.record));
+			}
+
+			ManifestHeader header;
+			std::memcpy(&header, image.data(), sizeof(header));
+			header.checksum = manifestChecksum(image);
+			std::memcpy(image.data(), &header, sizeof(header));
+		}
+	}
+
+	//the mapping is released by now, so the file can be replaced. Patching it in place would leave the header checksum out of
+	//date with the records if a crash came in between, and the manifest would be rejected on restore
+	if(!patches.empty()){
+		if(auto res = writeDurably(file, image, Durability::AtomicRename); !res.has_value()){
+			return std::unexpected(std::move(res.error()));
+		}
+	}
+
+	return ManifestDelta{patches.size(), false};
+}
\ No newline at end of file
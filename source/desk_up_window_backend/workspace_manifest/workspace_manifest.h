@@ -0,0 +1,379 @@
+/**
+ * @file workspace_manifest.h
+ * @brief Single-file binary manifest used to persist a whole workspace.
+ *
+ * This file is part of DeskUp
+ *
+ * @details
+ * A workspace used to be stored as one 5-line text file per window (see `windowDesc::saveTo()`), which made
+ * saving and restoring cost one open/write/close (or open/read/close) per window. The manifest packs the whole
+ * workspace into a single file so that a save is a single write and a restore a single read.
+ *
+ * **Layout (little-endian):**
+ * 1. A fixed-size @ref DeskUp::Workspace::ManifestHeader.
+ * 2. `recordCount` fixed-size @ref DeskUp::Workspace::ManifestRecord entries holding the geometry of each window.
+ * 3. A string table with every distinct executable path and window name, stored once and referenced
+ *    by offset/length from the records.
+ *
+ * The header carries a version number so that the format can evolve. Readers reject manifests whose version is
+ * newer than the one they know about.
+ *
+ * Since version 2 every record carries a CRC32C of itself and its strings, and the header one of the whole file
+ * (see crc32c.h). @ref DeskUp::Workspace::verifyWorkspace compares the latter against the raw bytes, which is enough
+ * to flag a damaged workspace without decoding it.
+ *
+ * @author
+ *   Nicolas Serrano Garcia <serranogarcianicolas@gmail.com>
+ * @date
+ *   2025
+ * @copyright
+ *   Copyright (C) 2025 Nicolas Serrano Garcia
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WORKSPACEMANIFEST_H
+#define WORKSPACEMANIFEST_H
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <filesystem>
+
+#include "window_desc.h"
+#include "desk_up_error.h"
+#include "workspace_writer.h"
+
+namespace fs = std::filesystem;
+
+namespace DeskUp::Workspace {
+
+    static_assert(std::endian::native == std::endian::little, "The workspace manifest is stored in little-endian byte order");
+
+    /**
+     * @brief The four bytes every manifest starts with.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr char MANIFEST_MAGIC[4] = {'D', 'U', 'W', 'S'};
+
+    /**
+     * @brief The manifest version written by this build of DeskUp.
+     *
+     * @details
+     * - 1: Initial layout, 32-byte records and no checksums.
+     * - 2: Adds the per-record and per-workspace CRC32C checksums (`ManifestRecord::checksum`, `ManifestHeader::checksum`).
+     *
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr std::uint16_t MANIFEST_VERSION = 2;
+
+    /**
+     * @brief Size of a record in version 1 manifests, which is also the part of a record covered by its checksum.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr std::uint32_t MANIFEST_V1_RECORD_SIZE = 32;
+
+    /**
+     * @brief Name of the manifest file inside a workspace folder (`<DESKUPDIR>/<workspace>/<MANIFEST_FILE_NAME>`).
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr const char * MANIFEST_FILE_NAME = "workspace.deskup";
+
+    /**
+     * @struct ManifestHeader
+     * @brief Fixed-size header placed at offset 0 of every manifest.
+     *
+     * @details All offsets are absolute (from the start of the file). Records start right after the header,
+     * at offset `headerSize`.
+     *
+     * `checksum` is the CRC32C of every byte after the header (records and string table), continued over the header
+     * itself with `checksum` set to 0. The body goes first so that a streamed manifest can be checksummed as it is
+     * written, before its header is known.
+     *
+     * @version 0.3.4
+     * @date 2025
+     */
+    struct ManifestHeader {
+        char magic[4];                /**< Always @ref MANIFEST_MAGIC. */
+        std::uint16_t version;        /**< Format version, see @ref MANIFEST_VERSION. */
+        std::uint16_t headerSize;     /**< `sizeof(ManifestHeader)` at write time. */
+        std::uint32_t recordCount;    /**< Number of window records. */
+        std::uint32_t recordSize;     /**< `sizeof(ManifestRecord)` at write time. */
+        std::uint32_t stringsOffset;  /**< Absolute offset of the string table. */
+        std::uint32_t stringsSize;    /**< Size in bytes of the string table. */
+        std::uint32_t checksum;       /**< CRC32C of the whole manifest (version 2+). Zero in version 1. */
+        std::uint32_t reserved;       /**< Zeroed, kept for future use. */
+    };
+
+    static_assert(sizeof(ManifestHeader) == 32, "ManifestHeader must stay 32 bytes wide");
+
+    /**
+     * @struct ManifestRecord
+     * @brief Fixed-size geometry record of a single saved window.
+     *
+     * @details Strings are not stored inline: `pathOffset`/`pathLength` and `nameOffset`/`nameLength` point inside
+     * the string table, relative to `ManifestHeader::stringsOffset`. Paths are stored as UTF-8.
+     *
+     * `checksum` is the CRC32C of the first @ref MANIFEST_V1_RECORD_SIZE bytes of the record, continued over its path
+     * and its name. A damaged record can then be told apart from the rest of the workspace.
+     *
+     * @version 0.3.4
+     * @date 2025
+     */
+    struct ManifestRecord {
+        std::int32_t x;               /**< X coordinate (top-left) in pixels. */
+        std::int32_t y;               /**< Y coordinate (top-left) in pixels. */
+        std::int32_t w;               /**< Width in pixels. */
+        std::int32_t h;               /**< Height in pixels. */
+        std::uint32_t pathOffset;     /**< Offset of the executable path inside the string table. */
+        std::uint32_t pathLength;     /**< Length in bytes of the executable path. */
+        std::uint32_t nameOffset;     /**< Offset of the window name inside the string table. */
+        std::uint32_t nameLength;     /**< Length in bytes of the window name. */
+        std::uint32_t checksum;       /**< CRC32C of the record and its strings (version 2+). */
+        std::uint32_t reserved;       /**< Zeroed, kept for future use. */
+    };
+
+    static_assert(sizeof(ManifestRecord) == 40, "ManifestRecord must stay 40 bytes wide");
+    static_assert(offsetof(ManifestRecord, checksum) == MANIFEST_V1_RECORD_SIZE, "The version 1 fields must stay at the front of a record");
+
+    /**
+     * @brief Computes `ManifestRecord::checksum` for \c record, whose strings are \c path and \c name.
+     * @version 0.3.4
+     * @date 2025
+     */
+    std::uint32_t recordChecksum(const ManifestRecord& record, std::string_view path, std::string_view name) noexcept;
+
+    /**
+     * @brief Computes `ManifestHeader::checksum` for a complete manifest image. The stored checksum is ignored.
+     *
+     * @param bytes The complete manifest contents. Must hold at least a header.
+     * @version 0.3.4
+     * @date 2025
+     */
+    std::uint32_t manifestChecksum(std::string_view bytes) noexcept;
+
+    /**
+     * @brief Serializes a set of windows into an in-memory manifest image.
+     *
+     * @details Equal strings (typically the executable path of several windows of the same app) are stored only once
+     * in the string table.
+     *
+     * @param windows The windows to serialize, in the order they should be restored.
+     * @return A byte buffer holding the whole manifest, ready to be written with a single call.
+     * @version 0.3.4
+     * @date 2025
+     */
+    std::string encodeManifest(const std::vector<windowDesc>& windows);
+
+    /**
+     * @brief Parses an in-memory manifest image back into window descriptions.
+     *
+     * @param bytes The complete manifest contents.
+     * @return The decoded windows, in the order they were saved.
+     * @errors
+     * - Level::Error, ErrType::InvalidFormat → Bad magic, unknown (newer) version or inconsistent header.
+     * - Level::Error, ErrType::CorruptedData → Truncated file, a record pointing outside of the string table or a
+     *   record whose checksum doesn't match.
+     * @version 0.3.4
+     * @date 2025
+     */
+    DeskUp::Result<std::vector<windowDesc>> decodeManifest(std::string_view bytes);
+
+    /**
+     * @brief Checks the integrity of an in-memory manifest image without decoding it.
+     *
+     * @details The header and the string references are validated, then the workspace checksum is recomputed
+     * over the raw bytes. Only when it doesn't match are the record checksums looked at, to tell which record is damaged.
+     * Version 1 manifests have no checksums, so only their structure can be checked.
+     *
+     * @param bytes The complete manifest contents.
+     * @return `DeskUp::Status` — empty if the manifest is intact.
+     * @errors
+     * - Any error returned by `WorkspaceView::fromBytes()`.
+     * - Level::Error, ErrType::CorruptedData → "bad_record_<index>" for the first damaged record, or "bad_checksum"
+     *   if the records are intact but the header is not.
+     * @version 0.3.4
+     * @date 2025
+     */
+    DeskUp::Status verifyManifest(std::string_view bytes);
+
+    /**
+     * @brief Checks the integrity of the manifest stored at \c file. See @ref verifyManifest.
+     *
+     * @details The file is mapped, not read, so checking a workspace costs one pass over its bytes.
+     *
+     * @param file The manifest file.
+     * @return `DeskUp::Status` — empty if the manifest is intact.
+     * @errors
+     * - Any error returned by `MappedWorkspace::open()`.
+     * - Any error returned by @ref verifyManifest.
+     * @version 0.3.4
+     * @date 2025
+     */
+    DeskUp::Status verifyWorkspace(const fs::path& file);
+
+    /**
+     * @brief Writes the manifest of \c windows to \c file with a single write.
+     *
+     * @param file Destination file. Its parent directory must exist.
+     * @param windows The windows to serialize.
+     * @param durability See `DeskUp::Workspace::Durability`. Defaults to a plain write.
+     * @return `DeskUp::Status` — empty on success.
+     * @errors Any error returned by `writeDurably()`. Mirrors the codes of `windowDesc::saveTo()`:
+     * - Level::Error → Empty path, file could not be opened, permission denied or unexpected write failure.
+     * - Level::Fatal, ErrType::DiskFull → No space left on the device.
+     * @version 0.3.4
+     * @date 2025
+     */
+    DeskUp::Status writeManifest(const fs::path& file, const std::vector<windowDesc>& windows, Durability durability = Durability::None);
+
+    /**
+     * @brief Reads and decodes the manifest stored at \c file with a single read.
+     *
+     * @param file The manifest file.
+     * @return The decoded windows.
+     * @errors
+     * - Level::Error, ErrType::FileNotFound → The file could not be opened.
+     * - Level::Retry, ErrType::Io → The read was cut short.
+     * - Any error returned by @ref decodeManifest.
+     * @version 0.3.4
+     * @date 2025
+     */
+    DeskUp::Result<std::vector<windowDesc>> readManifest(const fs::path& file);
+
+    /**
+     * @class ManifestStreamWriter
+     * @brief Writes a manifest one window at a time, without holding the whole workspace in memory.
+     *
+     * @details Records are fixed-size, so each one is written as soon as it is appended. Only the string table
+     * (one entry per distinct path and name) is kept in memory, and it is written after the records by @ref finish(),
+     * which then fills in the header. Until @ref finish() succeeds the header on disk is zeroed, so an interrupted
+     * save is rejected as an invalid manifest instead of being misread.
+     *
+     * @version 0.3.4
+     * @date 2025
+     */
+    class ManifestStreamWriter {
+    public:
+        ManifestStreamWriter(ManifestStreamWriter&&) noexcept;
+        ManifestStreamWriter& operator=(ManifestStreamWriter&&) noexcept;
+        ~ManifestStreamWriter();
+
+        /**
+         * @brief Creates (or truncates) \c file and reserves room for the header.
+         *
+         * @param file Destination file. Its parent directory must exist.
+         * @return The writer.
+         * @errors Same as @ref writeManifest.
+         * @version 0.3.4
+         * @date 2025
+         */
+        static DeskUp::Result<ManifestStreamWriter> open(const fs::path& file);
+
+        /**
+         * @brief Writes the manifest inside an existing file, starting at \c offset. Nothing before \c offset is touched.
+         *
+         * @details Used to stream a workspace straight into the log of a `WorkspaceStore`.
+         *
+         * @param file An existing file.
+         * @param offset Where the manifest header goes. Usually the end of the file.
+         * @return The writer.
+         * @errors Same as @ref writeManifest.
+         * @version 0.3.4
+         * @date 2025
+         */
+        static DeskUp::Result<ManifestStreamWriter> openAt(const fs::path& file, std::uint64_t offset);
+
+        /**
+         * @brief Writes the record of \c window.
+         *
+         * @return `DeskUp::Status` — empty on success.
+         * @errors Level::Error (Level::Fatal if the disk is full) → The record could not be written.
+         * @version 0.3.4
+         * @date 2025
+         */
+        DeskUp::Status append(const windowDesc& window);
+
+        /**
+         * @brief Writes the string table and the header, and closes the file.
+         *
+         * @return `DeskUp::Status` — empty on success.
+         * @errors Level::Error (Level::Fatal if the disk is full) → The manifest could not be completed.
+         * @version 0.3.4
+         * @date 2025
+         */
+        DeskUp::Status finish();
+
+        /** @brief Number of records appended so far. */
+        std::size_t size() const noexcept;
+
+        /** @brief Size in bytes of the manifest written so far. After @ref finish(), the size of the whole image. */
+        std::uint64_t bytes() const noexcept;
+
+    private:
+        struct State;
+
+        explicit ManifestStreamWriter(std::unique_ptr<State> opened) noexcept;
+
+        static DeskUp::Result<ManifestStreamWriter> start(std::unique_ptr<State> state);
+
+        std::unique_ptr<State> state;
+    };
+
+    /**
+     * @struct ManifestDelta
+     * @brief Summary of what @ref updateManifest found changed, and how it wrote it.
+     * @version 0.3.4
+     * @date 2025
+     */
+    struct ManifestDelta {
+        std::size_t changed = 0;    /**< Number of records that changed: every record when encoded again, 0 if the manifest was already up to date. */
+        bool rewritten = false;     /**< Whether the whole manifest had to be encoded again instead of only its changed records. */
+    };
+
+    /**
+     * @brief Brings the manifest stored at \c file up to date with \c windows, encoding as little as possible.
+     *
+     * @details Windows are matched against the saved records by executable path and name (in order, when several
+     * share both). Then:
+     * - If every window matches a record with the same geometry, nothing is written.
+     * - If the same set of windows is still open and only their geometry changed, the changed records are patched
+     *   into a copy of the manifest, which replaces it through `Durability::AtomicRename`. Neither the rest of the
+     *   records nor the string table are encoded again.
+     * - Otherwise (new or vanished windows, missing or unreadable manifest) the manifest is written from scratch
+     *   with @ref writeManifest.
+     *
+     * Whenever something changed the whole file is replaced, so the manifest at \c file is the old one or the new one at
+     * any point.
+     *
+     * @param file The manifest file. Its parent directory must exist.
+     * @param windows The windows currently open.
+     * @return What changed.
+     * @errors
+     * - Any error returned by @ref writeManifest or `writeDurably()`.
+     * @version 0.3.4
+     * @date 2025
+     */
+    DeskUp::Result<ManifestDelta> updateManifest(const fs::path& file, const std::vector<windowDesc>& windows);
+}
+
+#endif
\ No newline at end of file
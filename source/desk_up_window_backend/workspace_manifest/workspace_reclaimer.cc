@@ -0,0 +1,107 @@
+#include "workspace_reclaimer.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+DeskUp::Result<fs::path> DeskUp::Workspace::retire(const fs::path& path){
+
+	//the clock keeps names apart across runs, the counter within one
+	static std::atomic<unsigned long long> counter{0};
+	const auto now = std::chrono::system_clock::now().time_since_epoch().count();
+
+	auto u8 = path.filename().u8string();
+	std::string name = RETIRED_PREFIX;
+	name += std::to_string(now) + "-" + std::to_string(counter++) + "-";
+	name.append(u8.begin(), u8.end());
+
+	fs::path retired = path.parent_path() / fs::path(std::u8string(name.begin(), name.end()));
+
+	std::error_code ec;
+	fs::rename(path, retired, ec);
+	if(ec){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::Io, 0, "retire|rename_failed_" + path.string()));
+	}
+
+	return retired;
+}
+
+DeskUp::Workspace::WorkspaceReclaimer::~WorkspaceReclaimer(){
+	{
+		std::lock_guard lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	if(worker.joinable()){
+		worker.join();
+	}
+}
+
+void DeskUp::Workspace::WorkspaceReclaimer::reclaim(fs::path path){
+	{
+		std::lock_guard lock(mutex);
+		queue.push_back(std::move(path));
+
+		if(!worker.joinable()){
+			worker = std::thread(&WorkspaceReclaimer::run, this);
+		}
+	}
+	wake.notify_one();
+}
+
+void DeskUp::Workspace::WorkspaceReclaimer::drain(){
+	std::unique_lock lock(mutex);
+	idle.wait(lock, [&]{ return queue.empty() && inFlight == 0; });
+}
+
+std::size_t DeskUp::Workspace::WorkspaceReclaimer::pending() const {
+	std::lock_guard lock(mutex);
+	return queue.size() + inFlight;
+}
+
+void DeskUp::Workspace::WorkspaceReclaimer::run(){
+	std::unique_lock lock(mutex);
+
+	while(true){
+		wake.wait(lock, [&]{ return stopping || !queue.empty(); });
+
+		//pending deletions are finished even when stopping
+		if(queue.empty()){
+			return;
+		}
+
+		fs::path path = std::move(queue.front());
+		queue.pop_front();
+		inFlight++;
+
+		lock.unlock();
+		std::error_code ec;
+		fs::remove_all(path, ec);
+		lock.lock();
+
+		inFlight--;
+		if(queue.empty() && inFlight == 0){
+			idle.notify_all();
+		}
+	}
+}
+
+std::size_t DeskUp::Workspace::reclaimRetired(const fs::path& root, WorkspaceReclaimer& reclaimer){
+
+	std::size_t queued = 0;
+	std::error_code ec;
+
+	for(fs::directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec)){
+		auto u8 = it->path().filename().u8string();
+		if(isRetired(std::string_view(reinterpret_cast<const char *>(u8.data()), u8.size()))){
+			reclaimer.reclaim(it->path());
+			queued++;
+		}
+	}
+
+	return queued;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file workspace_reclaimer.h
+ * @brief Deletes retired workspace files in the background.
+ *
+ * This file is part of DeskUp
+ *
+ * @details
+ * Deleting a workspace directory recursively takes as long as the directory is big, and used to run while the user
+ * waited. Instead, whatever has to go is first *retired*: renamed to a sibling whose name starts with
+ * @ref DeskUp::Workspace::RETIRED_PREFIX, which is a single rename and makes it invisible to every lookup. A
+ * @ref DeskUp::Workspace::WorkspaceReclaimer then deletes it on its own thread.
+ *
+ * Retired files left behind by a crash are picked up again by @ref DeskUp::Workspace::reclaimRetired.
+ *
+ * @author
+ *   Nicolas Serrano Garcia <serranogarcianicolas@gmail.com>
+ * @date
+ *   2025
+ * @copyright
+ *   Copyright (C) 2025 Nicolas Serrano Garcia
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WORKSPACERECLAIMER_H
+#define WORKSPACERECLAIMER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <filesystem>
+
+#include "desk_up_error.h"
+
+namespace fs = std::filesystem;
+
+namespace DeskUp::Workspace {
+
+    /**
+     * @brief Prefix of every retired file or directory. Names starting with it are never workspaces.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr const char * RETIRED_PREFIX = ".deskup-retired-";
+
+    /**
+     * @brief Whether \c name (a file name, not a path) is the name of a retired file or directory.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline bool isRetired(std::string_view name) noexcept {
+        return name.starts_with(RETIRED_PREFIX);
+    }
+
+    /**
+     * @brief Renames \c path to a unique retired sibling, so that it stops being visible under its name.
+     *
+     * @param path The file or directory to retire.
+     * @return The retired path, to be handed to `WorkspaceReclaimer::reclaim()`.
+     * @errors Level::Error, ErrType::Io → The rename failed. \c path is left where it was.
+     * @version 0.3.4
+     * @date 2025
+     */
+    DeskUp::Result<fs::path> retire(const fs::path& path);
+
+    /**
+     * @class WorkspaceReclaimer
+     * @brief A background thread deleting the paths it is handed.
+     *
+     * @details The thread is only started by the first call to @ref reclaim. Deletion failures are ignored: the
+     * retired path stays where it is and is found again by the next @ref reclaimRetired. The destructor finishes the
+     * pending deletions before returning.
+     *
+     * @version 0.3.4
+     * @date 2025
+     */
+    class WorkspaceReclaimer {
+    public:
+        WorkspaceReclaimer() = default;
+        ~WorkspaceReclaimer();
+
+        WorkspaceReclaimer(const WorkspaceReclaimer&) = delete;
+        WorkspaceReclaimer& operator=(const WorkspaceReclaimer&) = delete;
+
+        /** @brief Queues \c path (a file or a directory) to be deleted recursively. Never blocks on the disk. */
+        void reclaim(fs::path path);
+
+        /** @brief Blocks until every path queued so far is deleted. */
+        void drain();
+
+        /** @brief Number of paths queued or being deleted. */
+        std::size_t pending() const;
+
+    private:
+        void run();
+
+        std::deque<fs::path> queue;
+        std::size_t inFlight = 0;
+        bool stopping = false;
+        mutable std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable idle;
+        std::thread worker;
+    };
+
+    /**
+     * @brief Queues every retired entry directly under \c root to \c reclaimer.
+     *
+     * @param root The directory to scan. Usually `DESKUPDIR`.
+     * @param reclaimer Where the retired entries are queued.
+     * @return The number of queued entries.
+     * @version 0.3.4
+     * @date 2025
+     */
+    std::size_t reclaimRetired(const fs::path& root, WorkspaceReclaimer& reclaimer);
+}
+
+#endif
@@ -0,0 +1,520 @@
+#include "workspace_store.h"
+#include "mapped_workspace.h"
+#include "window_desc_loader.h"
+#include "workspace_reclaimer.h"
+#include "crc32c.h"
+
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include <cerrno>
+#include <limits>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+static DeskUp::Error writeError(const std::string& where){
+	if(errno == ENOSPC){
+		return DeskUp::Error::fromSaveError(ERR_DISK_FULL);
+	}
+	return DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::Io, 0, where);
+}
+
+static DeskUp::Workspace::StoreHeader makeStoreHeader(){
+	DeskUp::Workspace::StoreHeader h{};
+	std::memcpy(h.magic, DeskUp::Workspace::STORE_MAGIC, sizeof(h.magic));
+	h.version = DeskUp::Workspace::STORE_VERSION;
+	h.headerSize = sizeof(DeskUp::Workspace::StoreHeader);
+	return h;
+}
+
+static DeskUp::Workspace::StoreEntryHeader makeEntryHeader(DeskUp::Workspace::StoreEntryKind kind, std::string_view name, std::uint32_t payloadSize){
+	DeskUp::Workspace::StoreEntryHeader h{};
+	std::memcpy(h.magic, DeskUp::Workspace::STORE_ENTRY_MAGIC, sizeof(h.magic));
+	h.kind = static_cast<std::uint16_t>(kind);
+	h.nameLength = static_cast<std::uint16_t>(name.size());
+	h.payloadSize = payloadSize;
+	h.checksum = 0;
+	h.checksum = DeskUp::Workspace::crc32c(name, DeskUp::Workspace::crc32c(&h, sizeof(h)));
+	return h;
+}
+
+static bool validName(const std::string& name) noexcept {
+	return !name.empty() && name.size() <= std::numeric_limits<std::uint16_t>::max();
+}
+
+//reads the whole log with a single read
+static DeskUp::Result<std::string> readLog(const fs::path& file, const char * where){
+
+	std::ifstream in(file, std::ios::in | std::ios::binary | std::ios::ate);
+	if(!in.is_open()){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::Io, 0, std::string(where) + "|file_unopen_" + file.string()));
+	}
+
+	const std::streamoff size = in.tellg();
+	if(size < 0){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::Io, 0, std::string(where) + "|no_size_" + file.string()));
+	}
+
+	std::string image(static_cast<std::size_t>(size), '\0');
+	in.seekg(0);
+	in.read(image.data(), size);
+
+	if(in.gcount() != size){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::Io, 0, std::string(where) + "|short_read_" + file.string()));
+	}
+
+	return image;
+}
+
+//reads size bytes at offset with a single read
+static DeskUp::Result<std::string> readAt(const fs::path& file, std::uint64_t offset, std::size_t size, const char * where){
+
+	std::ifstream in(file, std::ios::in | std::ios::binary);
+	if(!in.is_open()){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Retry, DeskUp::ErrType::Io, 0, std::string(where) + "|file_unopen_" + file.string()));
+	}
+
+	std::string bytes(size, '\0');
+	in.seekg(static_cast<std::streamoff>(offset));
+	in.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+
+	if(in.gcount() != static_cast<std::streamsize>(bytes.size())){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Retry, DeskUp::ErrType::Io, 0, std::string(where) + "|short_read_" + file.string()));
+	}
+
+	return bytes;
+}
+
+//writes bytes at offset, inside an already existing file
+static bool writeAt(const fs::path& file, std::uint64_t offset, std::string_view bytes){
+	std::fstream out(file, std::ios::in | std::ios::out | std::ios::binary);
+	if(!out.is_open()){
+		return false;
+	}
+
+	out.seekp(static_cast<std::streamoff>(offset));
+	out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+	out.close();
+
+	return out.good();
+}
+
+DeskUp::Result<DeskUp::Workspace::WorkspaceStore> DeskUp::Workspace::WorkspaceStore::open(const fs::path& file){
+
+	std::error_code ec;
+	if(!fs::exists(file, ec)){
+		const StoreHeader header = makeStoreHeader();
+
+		std::ofstream out(file, std::ios::out | std::ios::binary | std::ios::trunc);
+		out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+		out.close();
+
+		if(!out.good()){
+			return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::Io, 0, "WorkspaceStore::open|create_failed_" + file.string()));
+		}
+	}
+
+	auto image = readLog(file, "WorkspaceStore::open");
+	if(!image.has_value()){
+		return std::unexpected(std::move(image.error()));
+	}
+
+	const std::string& bytes = image.value();
+
+	StoreHeader header;
+	if(bytes.size() < sizeof(header)){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::InvalidFormat, 0, "WorkspaceStore::open|too_small_" + file.string()));
+	}
+
+	std::memcpy(&header, bytes.data(), sizeof(header));
+
+	if(std::memcmp(header.magic, STORE_MAGIC, sizeof(header.magic)) != 0 || header.headerSize < sizeof(header) || header.headerSize > bytes.size()){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::InvalidFormat, 0, "WorkspaceStore::open|bad_header_" + file.string()));
+	}
+
+	if(header.version > STORE_VERSION){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::InvalidFormat, 0, "WorkspaceStore::open|unsupported_version_" + std::to_string(header.version)));
+	}
+
+	WorkspaceStore store;
+	store.path = file;
+
+	//only headers and names are looked at. The scan stops at the first entry that isn't complete
+	std::uint64_t offset = header.headerSize;
+	while(offset + sizeof(StoreEntryHeader) <= bytes.size()){
+		StoreEntryHeader entry;
+		std::memcpy(&entry, bytes.data() + offset, sizeof(entry));
+
+		if(std::memcmp(entry.magic, STORE_ENTRY_MAGIC, sizeof(entry.magic)) != 0){
+			break;
+		}
+
+		if(entry.kind != static_cast<std::uint16_t>(StoreEntryKind::Put) && entry.kind != static_cast<std::uint16_t>(StoreEntryKind::Remove)){
+			break;
+		}
+
+		const std::uint64_t size = sizeof(entry) + entry.nameLength + std::uint64_t(entry.payloadSize);
+		if(entry.nameLength == 0 || offset + size > bytes.size()){
+			break;
+		}
+
+		const std::string_view name(bytes.data() + offset + sizeof(entry), entry.nameLength);
+
+		const std::uint32_t stored = entry.checksum;
+		entry.checksum = 0;
+		if(crc32c(name, crc32c(&entry, sizeof(entry))) != stored){
+			break;
+		}
+
+		Location location{offset, size, offset + sizeof(entry) + entry.nameLength, entry.payloadSize};
+		store.indexEntry(std::string(name), static_cast<StoreEntryKind>(entry.kind), location);
+
+		offset += size;
+	}
+
+	store.end = offset;
+
+	//whatever is left is an interrupted save
+	if(store.end < bytes.size()){
+		fs::resize_file(file, store.end, ec);
+		if(ec){
+			return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::Io, 0, "WorkspaceStore::open|truncate_failed_" + file.string()));
+		}
+	}
+
+	store.compactIfNeeded();
+
+	return store;
+}
+
+std::vector<std::string> DeskUp::Workspace::WorkspaceStore::names() const {
+	std::vector<std::string> out;
+	out.reserve(index.size());
+
+	for(const auto& [name, location] : index){
+		out.push_back(name);
+	}
+
+	std::sort(out.begin(), out.end());
+	return out;
+}
+
+void DeskUp::Workspace::WorkspaceStore::indexEntry(const std::string& name, StoreEntryKind kind, Location location){
+
+	//whatever this entry replaces is dead from now on
+	if(auto it = index.find(name); it != index.end()){
+		liveBytes -= it->second.size;
+		deadBytes += it->second.size;
+		index.erase(it);
+	}
+
+	if(kind == StoreEntryKind::Put){
+		index.emplace(name, location);
+		liveBytes += location.size;
+	}
+	else{
+		//a tombstone only matters until compaction
+		deadBytes += location.size;
+	}
+}
+
+void DeskUp::Workspace::WorkspaceStore::compactIfNeeded() noexcept {
+	if(!needsCompaction()){
+		return;
+	}
+
+	//a failed compaction leaves the log as it was. It is tried again after the next append
+	try{
+		(void)compact();
+	}
+	catch(...){}
+}
+
+DeskUp::Status DeskUp::Workspace::WorkspaceStore::append(StoreEntryKind kind, const std::string& name, std::string_view payload, Durability durability){
+
+	if(!validName(name)){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::InvalidInput, 0, "WorkspaceStore::append|bad_name"));
+	}
+
+	if(payload.size() > std::numeric_limits<std::uint32_t>::max()){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::InvalidInput, 0, "WorkspaceStore::append|payload_too_big"));
+	}
+
+	//an entry started by beginPut and never committed gets overwritten
+	pendingName.clear();
+
+	const StoreEntryHeader header = makeEntryHeader(kind, name, static_cast<std::uint32_t>(payload.size()));
+
+	std::string entry;
+	entry.reserve(sizeof(header) + name.size() + payload.size());
+	entry.append(reinterpret_cast<const char *>(&header), sizeof(header));
+	entry += name;
+	entry += payload;
+
+	//an atomic entry gets its header once the rest of it is on the disk, until then it doesn't count
+	const bool headerLast = durability == Durability::AtomicRename;
+	if(headerLast){
+		std::memset(entry.data(), 0, sizeof(header));
+	}
+
+	if(!writeAt(path, end, entry)){
+		return std::unexpected(writeError("WorkspaceStore::append|write_failed_" + path.string()));
+	}
+
+	if(headerLast){
+		if(auto res = syncFile(path); !res.has_value()){
+			return res;
+		}
+
+		if(!writeAt(path, end, std::string_view(reinterpret_cast<const char *>(&header), sizeof(header)))){
+			return std::unexpected(writeError("WorkspaceStore::append|write_failed_" + path.string()));
+		}
+	}
+
+	indexEntry(name, kind, Location{end, entry.size(), end + sizeof(header) + name.size(), header.payloadSize});
+	end += entry.size();
+
+	//the entry is in the store by now, a failed flush only means it might not survive a crash
+	DeskUp::Status flushed;
+	if(durability != Durability::None){
+		flushed = syncFile(path);
+	}
+
+	compactIfNeeded();
+
+	return flushed;
+}
+
+DeskUp::Status DeskUp::Workspace::WorkspaceStore::put(const std::string& name, std::string_view manifest, Durability durability){
+	return append(StoreEntryKind::Put, name, manifest, durability);
+}
+
+DeskUp::Result<bool> DeskUp::Workspace::WorkspaceStore::remove(const std::string& name){
+	if(!contains(name)){
+		return false;
+	}
+
+	if(auto res = append(StoreEntryKind::Remove, name, {}, Durability::None); !res.has_value()){
+		return std::unexpected(std::move(res.error()));
+	}
+
+	return true;
+}
+
+DeskUp::Result<DeskUp::Workspace::ManifestStreamWriter> DeskUp::Workspace::WorkspaceStore::beginPut(const std::string& name){
+
+	if(!validName(name)){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::InvalidInput, 0, "WorkspaceStore::beginPut|bad_name"));
+	}
+
+	//a zeroed header doesn't count as an entry, so a crash before commit leaves nothing behind once the log is reopened
+	std::string placeholder(sizeof(StoreEntryHeader), '\0');
+	placeholder += name;
+
+	if(!writeAt(path, end, placeholder)){
+		return std::unexpected(writeError("WorkspaceStore::beginPut|write_failed_" + path.string()));
+	}
+
+	auto writer = ManifestStreamWriter::openAt(path, end + placeholder.size());
+	if(!writer.has_value()){
+		return std::unexpected(std::move(writer.error()));
+	}
+
+	pendingName = name;
+	pendingEntry = end;
+
+	return writer;
+}
+
+DeskUp::Status DeskUp::Workspace::WorkspaceStore::commit(const std::string& name, ManifestStreamWriter& writer, Durability durability){
+
+	if(pendingName.empty() || pendingName != name){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::InvalidInput, 0, "WorkspaceStore::commit|not_started_" + name));
+	}
+
+	if(auto res = writer.finish(); !res.has_value()){
+		pendingName.clear();
+		return std::unexpected(std::move(res.error()));
+	}
+
+	pendingName.clear();
+
+	if(writer.bytes() > std::numeric_limits<std::uint32_t>::max()){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::InvalidInput, 0, "WorkspaceStore::commit|payload_too_big"));
+	}
+
+	const StoreEntryHeader header = makeEntryHeader(StoreEntryKind::Put, name, static_cast<std::uint32_t>(writer.bytes()));
+
+	if(durability == Durability::AtomicRename){
+		if(auto res = syncFile(path); !res.has_value()){
+			return res;
+		}
+	}
+
+	//the header goes last: until it is there the entry doesn't exist
+	if(!writeAt(path, pendingEntry, std::string_view(reinterpret_cast<const char *>(&header), sizeof(header)))){
+		return std::unexpected(writeError("WorkspaceStore::commit|write_failed_" + path.string()));
+	}
+
+	const std::uint64_t size = sizeof(header) + name.size() + header.payloadSize;
+	indexEntry(name, StoreEntryKind::Put, Location{pendingEntry, size, pendingEntry + sizeof(header) + name.size(), header.payloadSize});
+	end = pendingEntry + size;
+
+	DeskUp::Status flushed;
+	if(durability != Durability::None){
+		flushed = syncFile(path);
+	}
+
+	compactIfNeeded();
+
+	return flushed;
+}
+
+DeskUp::Result<std::string> DeskUp::Workspace::WorkspaceStore::get(const std::string& name) const {
+
+	auto it = index.find(name);
+	if(it == index.end()){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::NotFound, 0, "WorkspaceStore::get|not_found_" + name));
+	}
+
+	return readAt(path, it->second.payload, it->second.payloadSize, "WorkspaceStore::get");
+}
+
+DeskUp::Result<DeskUp::Workspace::ManifestHeader> DeskUp::Workspace::WorkspaceStore::header(const std::string& name) const {
+
+	auto it = index.find(name);
+	if(it == index.end()){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::NotFound, 0, "WorkspaceStore::header|not_found_" + name));
+	}
+
+	ManifestHeader header;
+	if(it->second.payloadSize < sizeof(header)){
+		return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::CorruptedData, 0, "WorkspaceStore::header|truncated_" + name));
+	}
+
+	auto bytes = readAt(path, it->second.payload, sizeof(header), "WorkspaceStore::header");
+	if(!bytes.has_value()){
+		return std::unexpected(std::move(bytes.error()));
+	}
+
+	std::memcpy(&header, bytes.value().data(), sizeof(header));
+	return header;
+}
+
+DeskUp::Status DeskUp::Workspace::WorkspaceStore::compact(){
+
+	auto image = readLog(path, "WorkspaceStore::compact");
+	if(!image.has_value()){
+		return std::unexpected(std::move(image.error()));
+	}
+
+	//live entries keep their order in the log
+	std::vector<std::pair<std::string, Location>> live(index.begin(), index.end());
+	std::sort(live.begin(), live.end(), [](const auto& a, const auto& b){ return a.second.entry < b.second.entry; });
+
+	const StoreHeader header = makeStoreHeader();
+
+	std::string out;
+	out.reserve(sizeof(header) + liveBytes);
+	out.append(reinterpret_cast<const char *>(&header), sizeof(header));
+
+	std::unordered_map<std::string, Location> moved;
+	moved.reserve(live.size());
+
+	for(const auto& [name, location] : live){
+		if(location.entry + location.size > image.value().size()){
+			return std::unexpected(DeskUp::Error(DeskUp::Level::Error, DeskUp::ErrType::Io, 0, "WorkspaceStore::compact|short_log_" + path.string()));
+		}
+
+		Location to = location;
+		to.entry = out.size();
+		to.payload = to.entry + (location.payload - location.entry);
+		moved.emplace(name, to);
+
+		out.append(image.value(), location.entry, location.size);
+	}
+
+	//the log holds every workspace: the new one has to be on the disk before it replaces it, or a crash could leave an empty store behind
+	if(auto res = writeDurably(path, out, Durability::AtomicRename); !res.has_value()){
+		return std::unexpected(std::move(res.error()));
+	}
+
+	index = std::move(moved);
+	end = out.size();
+	pendingName.clear();
+	deadBytes = 0;
+
+	return {};
+}
+
+DeskUp::Result<DeskUp::Workspace::WorkspaceImport> DeskUp::Workspace::importWorkspaceDirectories(WorkspaceStore& store, const fs::path& root){
+
+	std::error_code ec;
+	std::vector<fs::path> directories;
+
+	for(fs::directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec)){
+		if(it->is_directory(ec)){
+			directories.push_back(it->path());
+		}
+	}
+
+	WorkspaceImport report;
+	std::vector<fs::path> imported;
+	DeskUp::Status putResult;
+	windowDescLoader loader;
+
+	for(const fs::path& directory : directories){
+		auto u8 = directory.filename().u8string();
+		const std::string name(u8.begin(), u8.end());
+
+		if(isRetired(name) || store.contains(name)){
+			continue;
+		}
+
+		std::string manifest;
+
+		if(fs::path file = directory / MANIFEST_FILE_NAME; fs::is_regular_file(file, ec)){
+			//the mapping has to be gone before the directory can be deleted
+			auto mapped = MappedWorkspace::open(file);
+			if(!mapped.has_value()){
+				report.skipped.emplace_back(name, std::move(mapped.error()));
+				continue;
+			}
+			manifest.assign(mapped.value().bytes());
+		}
+		else{
+			std::vector<windowDesc> windows;
+			if(int res = loader.loadMany(directory, windows); res != LOAD_SUCCESS){
+				report.skipped.emplace_back(name, DeskUp::Error::fromLoadError(res));
+				continue;
+			}
+			manifest = encodeManifest(windows);
+		}
+
+		putResult = store.put(name, manifest);
+		if(!putResult.has_value()){
+			break;
+		}
+
+		imported.push_back(directory);
+	}
+
+	//the directories are the only other copy: they go once the log is on the disk, not before
+	if(!imported.empty()){
+		if(auto res = store.sync(); !res.has_value()){
+			return std::unexpected(std::move(res.error()));
+		}
+	}
+
+	for(const fs::path& directory : imported){
+		fs::remove_all(directory, ec);
+	}
+
+	if(!putResult.has_value()){
+		return std::unexpected(std::move(putResult.error()));
+	}
+
+	report.imported = imported.size();
+	return report;
+}
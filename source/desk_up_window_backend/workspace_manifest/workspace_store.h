@@ -0,0 +1,378 @@
+/**
+ * @file workspace_store.h
+ * @brief Embedded, log-structured store holding every saved workspace in a single file.
+ *
+ * This file is part of DeskUp
+ *
+ * @details
+ * Workspaces used to live in one directory each under `DESKUPDIR`, so checking whether one exists, listing them or
+ * deleting one meant asking the filesystem every time. The store keeps all of them in one append-only log instead,
+ * and an in-memory index (name → where its latest manifest is) built once when the log is opened. Existence checks
+ * and listing never touch the disk, a save is one sequential append and a deletion appends a small tombstone.
+ *
+ * **Layout (little-endian):**
+ * 1. A @ref DeskUp::Workspace::StoreHeader.
+ * 2. Entries, one after the other. Each one is a @ref DeskUp::Workspace::StoreEntryHeader, the workspace name and,
+ *    for @ref DeskUp::Workspace::StoreEntryKind::Put entries, the workspace manifest (see workspace_manifest.h).
+ *
+ * An entry only counts once its header holds @ref DeskUp::Workspace::STORE_ENTRY_MAGIC and a matching checksum, and its
+ * payload fits in the file. Streamed saves write their header last. Whatever follows the last valid entry (an
+ * interrupted save) is cut off when the log is opened.
+ *
+ * Overwritten and deleted workspaces leave dead entries behind. Once they take more room than the live ones the log
+ * is compacted: live entries are copied to a new file, which then replaces the log.
+ *
+ * @author
+ *   Nicolas Serrano Garcia <serranogarcianicolas@gmail.com>
+ * @date
+ *   2025
+ * @copyright
+ *   Copyright (C) 2025 Nicolas Serrano Garcia
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WORKSPACESTORE_H
+#define WORKSPACESTORE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <filesystem>
+
+#include "workspace_manifest.h"
+#include "desk_up_error.h"
+
+namespace fs = std::filesystem;
+
+namespace DeskUp::Workspace {
+
+    /**
+     * @brief Name of the store log inside `DESKUPDIR`.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr const char * STORE_FILE_NAME = "workspaces.dulog";
+
+    /**
+     * @brief The four bytes every store log starts with.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr char STORE_MAGIC[4] = {'D', 'U', 'L', 'G'};
+
+    /**
+     * @brief The four bytes every committed entry starts with.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr char STORE_ENTRY_MAGIC[4] = {'D', 'U', 'E', 'N'};
+
+    /**
+     * @brief The store log version written by this build of DeskUp.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr std::uint16_t STORE_VERSION = 1;
+
+    /**
+     * @brief Dead bytes the log must hold before it is worth compacting.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr std::uint64_t STORE_COMPACTION_MIN_DEAD = 64 * 1024;
+
+    /**
+     * @struct StoreHeader
+     * @brief Fixed-size header placed at offset 0 of the log.
+     * @version 0.3.4
+     * @date 2025
+     */
+    struct StoreHeader {
+        char magic[4];                /**< Always @ref STORE_MAGIC. */
+        std::uint16_t version;        /**< Format version, see @ref STORE_VERSION. */
+        std::uint16_t headerSize;     /**< `sizeof(StoreHeader)` at write time. */
+        std::uint32_t reserved[2];    /**< Zeroed, kept for future use. */
+    };
+
+    static_assert(sizeof(StoreHeader) == 16, "StoreHeader must stay 16 bytes wide");
+
+    /**
+     * @enum StoreEntryKind
+     * @brief What an entry of the log does to its workspace.
+     * @version 0.3.4
+     * @date 2025
+     */
+    enum class StoreEntryKind : std::uint16_t {
+        Put = 1,        /**< Saves the workspace. The manifest follows the name. */
+        Remove = 2      /**< Deletes the workspace. Carries no payload. */
+    };
+
+    /**
+     * @struct StoreEntryHeader
+     * @brief Header of a single log entry.
+     *
+     * @details `checksum` is the CRC32C of this header (with `checksum` set to 0) followed by the name. The manifest
+     * carries its own checksums, so it is not covered again.
+     *
+     * @version 0.3.4
+     * @date 2025
+     */
+    struct StoreEntryHeader {
+        char magic[4];                /**< @ref STORE_ENTRY_MAGIC once committed, zeroed while being written. */
+        std::uint16_t kind;           /**< A @ref StoreEntryKind value. */
+        std::uint16_t nameLength;     /**< Length in bytes of the workspace name. */
+        std::uint32_t payloadSize;    /**< Size in bytes of the manifest. 0 for Remove entries. */
+        std::uint32_t checksum;       /**< CRC32C of the header and the name. */
+    };
+
+    static_assert(sizeof(StoreEntryHeader) == 16, "StoreEntryHeader must stay 16 bytes wide");
+
+    /**
+     * @class WorkspaceStore
+     * @brief An append-only log of workspace manifests with an in-memory index.
+     *
+     * @details The store is move-only and not thread-safe: a single owner (see `current_workspace_store`) is expected.
+     * The log is only opened while an operation runs, so no handle is kept in between.
+     *
+     * @version 0.3.4
+     * @date 2025
+     */
+    class WorkspaceStore {
+    public:
+        WorkspaceStore(const WorkspaceStore&) = delete;
+        WorkspaceStore& operator=(const WorkspaceStore&) = delete;
+        WorkspaceStore(WorkspaceStore&&) noexcept = default;
+        WorkspaceStore& operator=(WorkspaceStore&&) noexcept = default;
+
+        /**
+         * @brief Opens the log at \c file, creating it if it doesn't exist, and builds the index.
+         *
+         * @details The log is read with a single sequential read. Only entry headers and names are looked at.
+         * An interrupted entry at the end of the log is cut off, and the log is compacted if it needs to be.
+         *
+         * @param file The log file. Its parent directory must exist.
+         * @return The store.
+         * @errors
+         * - Level::Error, ErrType::Io → The log could not be created, read or truncated.
+         * - Level::Error, ErrType::InvalidFormat → The file is not a store log, or a newer version of it.
+         * @version 0.3.4
+         * @date 2025
+         */
+        static DeskUp::Result<WorkspaceStore> open(const fs::path& file);
+
+        /** @brief Whether a workspace called \c name is saved. Never touches the disk. */
+        bool contains(const std::string& name) const noexcept { return index.contains(name); }
+
+        /** @brief Number of saved workspaces. */
+        std::size_t size() const noexcept { return index.size(); }
+
+        /** @brief Names of every saved workspace, sorted. Never touches the disk. */
+        std::vector<std::string> names() const;
+
+        /**
+         * @brief Saves \c manifest as the workspace \c name, replacing any previous version.
+         *
+         * @details How the entry reaches the disk depends on \c durability:
+         * - `Durability::None` → A single write, flushed whenever the OS sees fit.
+         * - `Durability::Fsync` → A single write, then the log is flushed.
+         * - `Durability::AtomicRename` → The entry is written without its header and flushed, then the header is written and
+         *   flushed. Until the header is on the disk the entry doesn't count, so after a crash the workspace is either the old
+         *   one or the new one, never a torn manifest.
+         *
+         * @param name The workspace name. Must not be empty.
+         * @param manifest A complete manifest image (see `encodeManifest()`).
+         * @param durability See above.
+         * @return `DeskUp::Status` — empty once the entry is in the log, and on the disk if \c durability asks for it.
+         * @errors
+         * - Level::Error, ErrType::InvalidInput → Empty or too long name.
+         * - Level::Error, ErrType::Io (Level::Fatal, ErrType::DiskFull if the disk is full) → The entry could not be appended.
+         * - Any error returned by `syncFile()`. If the last flush failed the entry is in the store anyway, but may not survive a crash.
+         * @version 0.3.4
+         * @date 2025
+         */
+        DeskUp::Status put(const std::string& name, std::string_view manifest, Durability durability = Durability::None);
+
+        /**
+         * @brief Starts saving the workspace \c name by streaming its manifest into the log.
+         *
+         * @details An uncommitted entry is started at the end of the log, and the returned writer writes the manifest
+         * right after it. The workspace is only saved once @ref commit is called. If it never is, the next append
+         * overwrites the partial entry.
+         *
+         * @param name The workspace name. Must not be empty.
+         * @return The writer. Only @ref commit may be called on the store until it is done.
+         * @errors Same as @ref put.
+         * @version 0.3.4
+         * @date 2025
+         */
+        DeskUp::Result<ManifestStreamWriter> beginPut(const std::string& name);
+
+        /**
+         * @brief Finishes \c writer (see `ManifestStreamWriter::finish()`) and commits the entry started by @ref beginPut.
+         *
+         * @details \c durability is honoured as in @ref put: with `Durability::AtomicRename` the manifest is flushed before
+         * the header is written.
+         *
+         * @return `DeskUp::Status` — empty once the workspace is saved.
+         * @errors
+         * - Any error returned by `ManifestStreamWriter::finish()`.
+         * - Level::Error, ErrType::InvalidInput → No entry was started for \c name.
+         * - Level::Error, ErrType::Io → The entry header could not be written.
+         * - Any error returned by `syncFile()`, as in @ref put.
+         * @version 0.3.4
+         * @date 2025
+         */
+        DeskUp::Status commit(const std::string& name, ManifestStreamWriter& writer, Durability durability = Durability::None);
+
+        /**
+         * @brief Reads the manifest of the workspace \c name with a single read.
+         *
+         * @return The complete manifest image.
+         * @errors
+         * - Level::Error, ErrType::NotFound → No workspace is called \c name.
+         * - Level::Retry, ErrType::Io → The log could not be read.
+         * @version 0.3.4
+         * @date 2025
+         */
+        DeskUp::Result<std::string> get(const std::string& name) const;
+
+        /**
+         * @brief Reads only the header of the manifest of the workspace \c name.
+         *
+         * @details Enough to tell whether the workspace changed (see its `checksum`) without reading its records.
+         *
+         * @return The manifest header, as stored. It is not validated.
+         * @errors
+         * - Level::Error, ErrType::NotFound → No workspace is called \c name.
+         * - Level::Error, ErrType::CorruptedData → The manifest is smaller than a header.
+         * - Level::Retry, ErrType::Io → The log could not be read.
+         * @version 0.3.4
+         * @date 2025
+         */
+        DeskUp::Result<ManifestHeader> header(const std::string& name) const;
+
+        /**
+         * @brief Deletes the workspace \c name by appending a tombstone.
+         *
+         * @return \c true if the workspace existed and was deleted, \c false if it didn't exist.
+         * @errors Level::Error, ErrType::Io → The tombstone could not be appended.
+         * @version 0.3.4
+         * @date 2025
+         */
+        DeskUp::Result<bool> remove(const std::string& name);
+
+        /**
+         * @brief Rewrites the log with only its live entries.
+         *
+         * @details The new log is written next to the current one, flushed and renamed over it
+         * (`Durability::AtomicRename`), so a failure or a crash leaves the current log untouched.
+         *
+         * @return `DeskUp::Status` — empty on success.
+         * @errors
+         * - Level::Error, ErrType::Io → The current log could not be read.
+         * - Any error returned by `writeDurably()` → The new log could not be written.
+         * @version 0.3.4
+         * @date 2025
+         */
+        DeskUp::Status compact();
+
+        /** @brief Whether dead entries take enough room for @ref compact to be worth it. */
+        bool needsCompaction() const noexcept {
+            return deadBytes >= STORE_COMPACTION_MIN_DEAD && deadBytes > liveBytes;
+        }
+
+        /** @brief Bytes of the log taken by the latest version of every workspace. */
+        std::uint64_t live() const noexcept { return liveBytes; }
+
+        /** @brief Bytes of the log taken by overwritten or deleted workspaces and by tombstones. */
+        std::uint64_t dead() const noexcept { return deadBytes; }
+
+        /** @brief The log file. */
+        const fs::path& file() const noexcept { return path; }
+
+        /**
+         * @brief Flushes the log to the disk.
+         *
+         * @details Appends made with `Durability::None` are left to the OS to flush, so a crash may lose the last ones.
+         * Callers about to delete the only other copy of a workspace call this first.
+         *
+         * @return `DeskUp::Status` — empty once every committed entry is on the disk.
+         * @errors Any error returned by `syncFile()`.
+         * @version 0.3.4
+         * @date 2025
+         */
+        DeskUp::Status sync() const { return syncFile(path); }
+
+    private:
+        //where the latest entry of a workspace is
+        struct Location {
+            std::uint64_t entry;        //offset of its entry header
+            std::uint64_t size;         //size of the whole entry
+            std::uint64_t payload;      //offset of the manifest
+            std::uint32_t payloadSize;
+        };
+
+        WorkspaceStore() = default;
+
+        DeskUp::Status append(StoreEntryKind kind, const std::string& name, std::string_view payload, Durability durability);
+        void indexEntry(const std::string& name, StoreEntryKind kind, Location location);
+        void compactIfNeeded() noexcept;
+
+        fs::path path;
+        std::unordered_map<std::string, Location> index;
+        std::uint64_t end = 0;
+        std::uint64_t liveBytes = 0;
+        std::uint64_t deadBytes = 0;
+
+        //entry started by beginPut and not committed yet
+        std::string pendingName;
+        std::uint64_t pendingEntry = 0;
+    };
+
+    /**
+     * @struct WorkspaceImport
+     * @brief What @ref importWorkspaceDirectories moved into the store, and what it couldn't.
+     * @version 0.3.4
+     * @date 2025
+     */
+    struct WorkspaceImport {
+        std::size_t imported = 0;   /**< Workspaces now in the store, whose directory was deleted. */
+        std::vector<std::pair<std::string, DeskUp::Error>> skipped;  /**< Directories left on disk, with why they couldn't be loaded. */
+    };
+
+    /**
+     * @brief Moves every workspace directory found under \c root (the directory-per-workspace layout) into \c store.
+     *
+     * @details Directories holding a manifest are imported as they are. Directories in the legacy
+     * one-file-per-window layout are loaded with `windowDescLoader` and encoded into a manifest. Once every workspace
+     * is in the store, the log is flushed (`WorkspaceStore::sync()`), and only then are the imported directories
+     * deleted, so a crash never loses both copies. Directories whose name is already in the store and retired
+     * directories (see `isRetired()`) are left untouched. Directories that can't be loaded are left untouched too, and
+     * reported: listing the workspaces of a store doesn't show them anymore.
+     *
+     * @param store The store to import into.
+     * @param root The directory to scan. Usually `DESKUPDIR`.
+     * @return What was imported and what was skipped.
+     * @errors Any error returned by `WorkspaceStore::put()` or `WorkspaceStore::sync()`. The workspaces put before it stay
+     * in the store, and their directories are only deleted if the log could be flushed.
+     * @version 0.3.4
+     * @date 2025
+     */
+    DeskUp::Result<WorkspaceImport> importWorkspaceDirectories(WorkspaceStore& store, const fs::path& root);
+}
+
+#endif
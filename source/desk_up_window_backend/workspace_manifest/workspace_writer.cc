@@ -0,0 +1,270 @@
+#include "workspace_writer.h"
+#include "workspace_manifest.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <system_error>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+#ifdef _WIN32
+
+static int saveCodeFromLastError(){
+	switch (GetLastError()) {
+		case ERROR_ACCESS_DENIED:
+			return ERR_NO_PERMISSION;
+		case ERROR_PATH_NOT_FOUND:
+		case ERROR_FILE_NOT_FOUND:
+			return ERR_FILE_NOT_FOUND;
+		case ERROR_DISK_FULL:
+		case ERROR_HANDLE_DISK_FULL:
+			return ERR_DISK_FULL;
+		default:
+			return ERR_UNKNOWN;
+	}
+}
+
+//one handle, one WriteFile per 4 GiB, and a single flush if asked for
+static int writeFile(const fs::path& file, std::string_view bytes, bool flush){
+
+	HANDLE h = CreateFileW(file.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(h == INVALID_HANDLE_VALUE){
+		int code = saveCodeFromLastError();
+		return code == ERR_UNKNOWN ? ERR_FILE_NOT_OPEN : code;
+	}
+
+	while(!bytes.empty()){
+		DWORD chunk = static_cast<DWORD>(std::min<std::size_t>(bytes.size(), MAXDWORD));
+		DWORD written = 0;
+
+		if(!WriteFile(h, bytes.data(), chunk, &written, nullptr) || written == 0){
+			int code = saveCodeFromLastError();
+			CloseHandle(h);
+			return code;
+		}
+
+		bytes.remove_prefix(written);
+	}
+
+	if(flush && !FlushFileBuffers(h)){
+		int code = saveCodeFromLastError();
+		CloseHandle(h);
+		return code;
+	}
+
+	CloseHandle(h);
+	return SAVE_SUCCESS;
+}
+
+//flushes a file that was written through another handle
+static int flushFile(const fs::path& file){
+
+	HANDLE h = CreateFileW(file.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(h == INVALID_HANDLE_VALUE){
+		int code = saveCodeFromLastError();
+		return code == ERR_UNKNOWN ? ERR_FILE_NOT_OPEN : code;
+	}
+
+	if(!FlushFileBuffers(h)){
+		int code = saveCodeFromLastError();
+		CloseHandle(h);
+		return code;
+	}
+
+	CloseHandle(h);
+	return SAVE_SUCCESS;
+}
+
+//the rename itself is written through, so once it returns the directory entry is on the disk too
+static int replaceFile(const fs::path& from, const fs::path& to){
+	if(!MoveFileExW(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)){
+		return saveCodeFromLastError();
+	}
+	return SAVE_SUCCESS;
+}
+
+#else
+
+static int saveCodeFromErrno(int err){
+	switch (err) {
+		case EACCES:
+		case EPERM:
+			return ERR_NO_PERMISSION;
+		case ENOENT:
+			return ERR_FILE_NOT_FOUND;
+		case ENOSPC:
+		case EDQUOT:
+			return ERR_DISK_FULL;
+		default:
+			return ERR_UNKNOWN;
+	}
+}
+
+//one descriptor, one write (repeated only for short writes), and a single fsync if asked for
+static int writeFile(const fs::path& file, std::string_view bytes, bool flush){
+
+	int fd = ::open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if(fd < 0){
+		int code = saveCodeFromErrno(errno);
+		return code == ERR_UNKNOWN ? ERR_FILE_NOT_OPEN : code;
+	}
+
+	while(!bytes.empty()){
+		ssize_t written = ::write(fd, bytes.data(), bytes.size());
+		if(written < 0 && errno == EINTR){
+			continue;
+		}
+		if(written <= 0){
+			int code = written < 0 ? saveCodeFromErrno(errno) : ERR_UNKNOWN;
+			::close(fd);
+			return code;
+		}
+
+		bytes.remove_prefix(static_cast<std::size_t>(written));
+	}
+
+	if(flush && ::fsync(fd) != 0){
+		int code = saveCodeFromErrno(errno);
+		::close(fd);
+		return code;
+	}
+
+	//close can report a deferred write error
+	if(::close(fd) != 0){
+		return saveCodeFromErrno(errno);
+	}
+
+	return SAVE_SUCCESS;
+}
+
+//flushes a file that was written through another descriptor
+static int flushFile(const fs::path& file){
+
+	int fd = ::open(file.c_str(), O_WRONLY | O_CLOEXEC);
+	if(fd < 0){
+		int code = saveCodeFromErrno(errno);
+		return code == ERR_UNKNOWN ? ERR_FILE_NOT_OPEN : code;
+	}
+
+	if(::fsync(fd) != 0){
+		int code = saveCodeFromErrno(errno);
+		::close(fd);
+		return code;
+	}
+
+	if(::close(fd) != 0){
+		return saveCodeFromErrno(errno);
+	}
+
+	return SAVE_SUCCESS;
+}
+
+//the new directory entry only survives a crash once the directory itself is flushed
+static int replaceFile(const fs::path& from, const fs::path& to){
+	if(::rename(from.c_str(), to.c_str()) != 0){
+		return saveCodeFromErrno(errno);
+	}
+
+	fs::path parent = to.parent_path();
+	if(parent.empty()){
+		parent = ".";
+	}
+
+	int dir = ::open(parent.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if(dir < 0){
+		return saveCodeFromErrno(errno);
+	}
+
+	int res = ::fsync(dir);
+	int err = errno;
+	::close(dir);
+
+	return res == 0 ? SAVE_SUCCESS : saveCodeFromErrno(err);
+}
+
+#endif
+
+DeskUp::Status DeskUp::Workspace::writeDurably(const fs::path& file, std::string_view bytes, Durability durability){
+
+	if(file.empty()){
+		return std::unexpected(DeskUp::Error::fromSaveError(ERR_EMPTY_PATH));
+	}
+
+	if(durability != Durability::AtomicRename){
+		if(int res = writeFile(file, bytes, durability == Durability::Fsync); res != SAVE_SUCCESS){
+			return std::unexpected(DeskUp::Error::fromSaveError(res));
+		}
+		return {};
+	}
+
+	fs::path temporary = file;
+	temporary += ATOMIC_WRITE_SUFFIX;
+
+	//the temporary file has to be on the disk before it replaces anything, or a crash could leave an empty manifest behind
+	int res = writeFile(temporary, bytes, true);
+	if(res == SAVE_SUCCESS){
+		res = replaceFile(temporary, file);
+	}
+
+	if(res != SAVE_SUCCESS){
+		std::error_code ec;
+		fs::remove(temporary, ec);
+		return std::unexpected(DeskUp::Error::fromSaveError(res));
+	}
+
+	return {};
+}
+
+DeskUp::Status DeskUp::Workspace::syncFile(const fs::path& file){
+
+	if(file.empty()){
+		return std::unexpected(DeskUp::Error::fromSaveError(ERR_EMPTY_PATH));
+	}
+
+	if(int res = flushFile(file); res != SAVE_SUCCESS){
+		return std::unexpected(DeskUp::Error::fromSaveError(res));
+	}
+
+	return {};
+}
+
+DeskUp::Status DeskUp::Workspace::publishDurably(const fs::path& temporary, const fs::path& file){
+
+	if(temporary.empty() || file.empty()){
+		return std::unexpected(DeskUp::Error::fromSaveError(ERR_EMPTY_PATH));
+	}
+
+	//same order as an atomic write: the contents reach the disk before they replace anything
+	int res = flushFile(temporary);
+	if(res == SAVE_SUCCESS){
+		res = replaceFile(temporary, file);
+	}
+
+	if(res != SAVE_SUCCESS){
+		std::error_code ec;
+		fs::remove(temporary, ec);
+		return std::unexpected(DeskUp::Error::fromSaveError(res));
+	}
+
+	return {};
+}
+
+void DeskUp::Workspace::WorkspaceWriter::add(const windowDesc& window){
+	windows.push_back(window);
+}
+
+void DeskUp::Workspace::WorkspaceWriter::add(const std::vector<windowDesc>& workspace){
+	windows.insert(windows.end(), workspace.begin(), workspace.end());
+}
+
+DeskUp::Status DeskUp::Workspace::WorkspaceWriter::commit(const fs::path& file) const {
+	return writeDurably(file, encodeManifest(windows), mode);
+}
@@ -0,0 +1,168 @@
+/**
+ * @file workspace_writer.h
+ * @brief Buffered workspace writer with an explicit durability level.
+ *
+ * This file is part of DeskUp
+ *
+ * @details
+ * `windowDesc::saveTo()` opens one file per window and never asks the OS to flush anything, so whether a save
+ * survives a power loss is left to chance. @ref DeskUp::Workspace::WorkspaceWriter buffers every window of a
+ * workspace, encodes them into a single manifest and writes it with as few system calls as possible. How hard it
+ * tries to get the bytes onto the disk is chosen with @ref DeskUp::Workspace::Durability:
+ *
+ * | Mode           | Syscalls (POSIX)                                    | After a crash the file holds           |
+ * |----------------|-----------------------------------------------------|----------------------------------------|
+ * | `None`         | open, write, close                                  | Anything: old, new, empty or partial   |
+ * | `Fsync`        | open, write, fsync, close                           | The new manifest once commit() returns |
+ * | `AtomicRename` | open, write, fsync, close, rename, fsync(directory) | The old manifest or the new one        |
+ *
+ * On Windows, `Fsync` is `FlushFileBuffers()` and the rename is `MoveFileExW()` with `MOVEFILE_WRITE_THROUGH`.
+ *
+ * @author
+ *   Nicolas Serrano Garcia <serranogarcianicolas@gmail.com>
+ * @date
+ *   2025
+ * @copyright
+ *   Copyright (C) 2025 Nicolas Serrano Garcia
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WORKSPACEWRITER_H
+#define WORKSPACEWRITER_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include <filesystem>
+
+#include "window_desc.h"
+#include "desk_up_error.h"
+
+namespace fs = std::filesystem;
+
+namespace DeskUp::Workspace {
+
+    /**
+     * @enum Durability
+     * @brief How much a write makes sure its bytes reach the disk before returning.
+     * @version 0.3.4
+     * @date 2025
+     */
+    enum class Durability : std::uint8_t {
+        None,           /**< A single write. The OS flushes it whenever it sees fit. */
+        Fsync,          /**< A single write followed by a single flush of the file. */
+        AtomicRename    /**< Written and flushed to a temporary file, then renamed over the destination. */
+    };
+
+    /**
+     * @brief Suffix of the temporary file written by @ref Durability::AtomicRename, next to the destination.
+     * @version 0.3.4
+     * @date 2025
+     */
+    inline constexpr const char * ATOMIC_WRITE_SUFFIX = ".tmp";
+
+    /**
+     * @brief Replaces the contents of \c file with \c bytes, with the given durability.
+     *
+     * @details The bytes are handed to the OS with a single write call (repeated only if the OS accepts fewer bytes).
+     * With @ref Durability::AtomicRename a failure leaves \c file as it was and removes the temporary file.
+     *
+     * @param file Destination file. Its parent directory must exist.
+     * @param bytes The new contents.
+     * @param durability See @ref Durability.
+     * @return `DeskUp::Status` — empty on success.
+     * @errors Converted through `DeskUp::Error::fromSaveError()`:
+     * - Level::Error → Empty path, file could not be opened, permission denied, or the write, flush or rename failed.
+     * - Level::Fatal, ErrType::DiskFull → No space left on the device.
+     * @version 0.3.4
+     * @date 2025
+     */
+    DeskUp::Status writeDurably(const fs::path& file, std::string_view bytes, Durability durability);
+
+    /**
+     * @brief Flushes \c file, written and closed by someone else, to the disk (fsync, `FlushFileBuffers()` on Windows).
+     *
+     * @param file An existing file.
+     * @return `DeskUp::Status` — empty once the file is on the disk.
+     * @errors Same as @ref writeDurably.
+     * @version 0.3.4
+     * @date 2025
+     */
+    DeskUp::Status syncFile(const fs::path& file);
+
+    /**
+     * @brief Replaces \c file with \c temporary, a file written and closed by someone else: the last steps of
+     * @ref Durability::AtomicRename (fsync, rename, fsync(directory)).
+     *
+     * @details Meant for manifests too large to be handed over as a single buffer, such as the ones written by a
+     * `ManifestStreamWriter`. A failure leaves \c file as it was and removes \c temporary.
+     *
+     * @param temporary The complete new contents, next to \c file (usually \c file plus @ref ATOMIC_WRITE_SUFFIX).
+     * @param file Destination file.
+     * @return `DeskUp::Status` — empty on success.
+     * @errors Same as @ref writeDurably.
+     * @version 0.3.4
+     * @date 2025
+     */
+    DeskUp::Status publishDurably(const fs::path& temporary, const fs::path& file);
+
+    /**
+     * @class WorkspaceWriter
+     * @brief Buffers the windows of a workspace and writes them as one manifest.
+     *
+     * @details Nothing touches the disk until @ref commit, which encodes the buffered windows (see `encodeManifest()`)
+     * and writes them through @ref writeDurably. The buffer is kept after a commit, so the same workspace can be
+     * written to several files.
+     *
+     * @version 0.3.4
+     * @date 2025
+     */
+    class WorkspaceWriter {
+    public:
+        explicit WorkspaceWriter(Durability durability = Durability::Fsync) noexcept : mode(durability) {}
+
+        /** @brief Buffers \c window. */
+        void add(const windowDesc& window);
+
+        /** @brief Buffers every window of \c workspace, in order. */
+        void add(const std::vector<windowDesc>& workspace);
+
+        /** @brief Drops every buffered window. */
+        void clear() noexcept { windows.clear(); }
+
+        /** @brief Number of buffered windows. */
+        std::size_t size() const noexcept { return windows.size(); }
+
+        /** @brief The durability used by @ref commit. */
+        Durability durability() const noexcept { return mode; }
+
+        /**
+         * @brief Writes the buffered windows to \c file as a manifest.
+         *
+         * @param file Destination file. Its parent directory must exist.
+         * @return `DeskUp::Status` — empty on success.
+         * @errors Any error returned by @ref writeDurably.
+         * @version 0.3.4
+         * @date 2025
+         */
+        DeskUp::Status commit(const fs::path& file) const;
+
+    private:
+        Durability mode;
+        std::vector<windowDesc> windows;
+    };
+}
+
+#endif
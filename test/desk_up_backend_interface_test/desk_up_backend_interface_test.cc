@@ -1,10 +1,18 @@
 #include <gtest/gtest.h>
 #include <filesystem>
 #include <fstream>
+#include <future>
+#include <atomic>
+#include <thread>
 
 #include "desk_up_backend_interface.h"
 #include "desk_up_dummy_device.h"
 #include "window_core.h"
+#include "window_core_backend.h"
+#include "workspace_manifest.h"
+#include "workspace_store.h"
+#include "launch_profile.h"
+#include "restore_plan.h"
 
 // Fixture to set up and tear down the dummy device for each test
 class DeskUpBackendInterfaceTest : public ::testing::Test {
@@ -57,11 +65,15 @@ TEST_F(DeskUpBackendInterfaceTest, DummyDeviceBasicFunctions) {
     auto* data = GetData();
     ASSERT_NE(data, nullptr);
 
+    // Launched windows open at the device's geometry
+    auto window = current_window_backend->loadWindowFromPath(current_window_backend.get(), "test.exe");
+    ASSERT_TRUE(window.has_value());
+
     // Verify basic geometry functions work
-    auto x = current_window_backend->getWindowXPos(current_window_backend.get());
-    auto y = current_window_backend->getWindowYPos(current_window_backend.get());
-    auto w = current_window_backend->getWindowWidth(current_window_backend.get());
-    auto h = current_window_backend->getWindowHeight(current_window_backend.get());
+    auto x = current_window_backend->getWindowXPos(current_window_backend.get(), *window);
+    auto y = current_window_backend->getWindowYPos(current_window_backend.get(), *window);
+    auto w = current_window_backend->getWindowWidth(current_window_backend.get(), *window);
+    auto h = current_window_backend->getWindowHeight(current_window_backend.get(), *window);
 
     ASSERT_TRUE(x.has_value());
     ASSERT_TRUE(y.has_value());
@@ -72,6 +84,58 @@ TEST_F(DeskUpBackendInterfaceTest, DummyDeviceBasicFunctions) {
     EXPECT_EQ(y.value(), 150);
     EXPECT_EQ(w.value(), 800u);
     EXPECT_EQ(h.value(), 600u);
+
+    // The same rectangle in a single query
+    auto geometry = current_window_backend->getWindowGeometry(current_window_backend.get(), *window);
+    ASSERT_TRUE(geometry.has_value());
+    EXPECT_EQ(geometry->x, x.value());
+    EXPECT_EQ(geometry->y, y.value());
+    EXPECT_EQ(geometry->w, w.value());
+    EXPECT_EQ(geometry->h, h.value());
+
+    // And for several windows at once, with the ones that are gone left empty
+    windowDesc other{"Other", 5, 6, 70, 80, "other.exe"};
+    auto batch = current_window_backend->getWindowsGeometry(current_window_backend.get(), {&other, nullptr});
+    ASSERT_TRUE(batch.has_value());
+    ASSERT_EQ(batch->size(), 2u);
+    ASSERT_TRUE((*batch)[0].has_value());
+    EXPECT_EQ((*batch)[0]->w, 70u);
+    EXPECT_FALSE((*batch)[1].has_value());
+}
+
+TEST_F(DeskUpBackendInterfaceTest, DummyDeviceRunsThroughDeviceBackend) {
+    // A device no static backend owns is always reached through its function pointers
+    bool throughDevice = DU_WithBackend([](auto backend){
+        return std::is_same_v<decltype(backend), DeskUp::Backend::DeviceBackend>;
+    });
+    EXPECT_TRUE(throughDevice);
+
+    windowDesc window{"Window", 7, 8, 90, 100, "window.exe"};
+    DeskUp::Backend::DeviceBackend backend{current_window_backend.get()};
+
+    auto geometry = backend.getWindowGeometry(&window);
+    ASSERT_TRUE(geometry.has_value());
+    EXPECT_EQ(geometry->x, 7);
+    EXPECT_EQ(geometry->h, 100u);
+
+    // Devices without the single query are answered with the four per-field ones
+    current_window_backend->getWindowGeometry = nullptr;
+    auto fallback = backend.getWindowGeometry(&window);
+    ASSERT_TRUE(fallback.has_value());
+    EXPECT_EQ(fallback->y, 8);
+    EXPECT_EQ(fallback->w, 90u);
+
+    // And devices that can't stream, with a full enumeration
+    current_window_backend->streamOpenWindows = nullptr;
+    EXPECT_FALSE(backend.canStream());
+
+    std::size_t streamed = 0;
+    auto res = backend.streamOpenWindows([&](windowDesc&&) -> DeskUp::Status {
+        streamed++;
+        return {};
+    });
+    ASSERT_TRUE(res.has_value());
+    EXPECT_EQ(streamed, GetData()->windows.size());
 }
 
 TEST_F(DeskUpBackendInterfaceTest, DummyDeviceErrorSimulation) {
@@ -84,7 +148,8 @@ TEST_F(DeskUpBackendInterfaceTest, DummyDeviceErrorSimulation) {
     );
 
     // Verify functions return expected error
-    auto x = current_window_backend->getWindowXPos(current_window_backend.get());
+    windowDesc window{"Window", 1, 2, 3, 4, "window.exe"};
+    auto x = current_window_backend->getWindowXPos(current_window_backend.get(), &window);
     ASSERT_FALSE(x.has_value());
     EXPECT_TRUE(x.error().isFatal());
     EXPECT_EQ(x.error().type(), DeskUp::ErrType::AccessDenied);
@@ -111,35 +176,32 @@ TEST_F(DeskUpBackendInterfaceTest, SaveAllWindowsLocal_WritesFilesOnSuccess){
     ASSERT_TRUE(fs::exists(workspace)) << "Workspace directory not created";
     ASSERT_TRUE(fs::is_directory(workspace));
 
-    auto checkFile = [&](const windowDesc& w){
-        fs::path p = workspace / w.name; // filenames are the window name
-        ASSERT_TRUE(fs::exists(p)) << "Missing file: " << p.string();
-        ASSERT_TRUE(fs::is_regular_file(p));
-
-        std::ifstream in(p.string());
-        ASSERT_TRUE(in.is_open());
-        std::string line;
-        // 1: path
-        ASSERT_TRUE(std::getline(in, line));
-        EXPECT_EQ(line, w.pathToExec);
-        // 2: x
-        ASSERT_TRUE(std::getline(in, line));
-        EXPECT_EQ(line, std::to_string(w.x));
-        // 3: y
-        ASSERT_TRUE(std::getline(in, line));
-        EXPECT_EQ(line, std::to_string(w.y));
-        // 4: w
-        ASSERT_TRUE(std::getline(in, line));
-        EXPECT_EQ(line, std::to_string(w.w));
-        // 5: h
-        ASSERT_TRUE(std::getline(in, line));
-        EXPECT_EQ(line, std::to_string(w.h));
-        // EOF
-        EXPECT_FALSE(std::getline(in, line));
+    fs::path manifest = workspace / DeskUp::Workspace::MANIFEST_FILE_NAME;
+    ASSERT_TRUE(fs::exists(manifest)) << "Missing manifest: " << manifest.string();
+    ASSERT_TRUE(fs::is_regular_file(manifest));
+
+    // The whole workspace lives in the manifest, no per-window files
+    size_t fileCount = 0;
+    for (const auto& entry : fs::directory_iterator(workspace)) {
+        if (fs::is_regular_file(entry)) ++fileCount;
+    }
+    EXPECT_EQ(fileCount, 1u);
+
+    auto saved = DeskUp::Workspace::readManifest(manifest);
+    ASSERT_TRUE(saved.has_value()) << saved.error().what();
+    ASSERT_EQ(saved.value().size(), 2u);
+
+    auto checkWindow = [&](const windowDesc& got, const windowDesc& w){
+        EXPECT_EQ(got.name, w.name);
+        EXPECT_EQ(got.pathToExec, w.pathToExec);
+        EXPECT_EQ(got.x, w.x);
+        EXPECT_EQ(got.y, w.y);
+        EXPECT_EQ(got.w, w.w);
+        EXPECT_EQ(got.h, w.h);
     };
 
-    checkFile(a);
-    checkFile(b);
+    checkWindow(saved.value()[0], a);
+    checkWindow(saved.value()[1], b);
 }
 
 TEST_F(DeskUpBackendInterfaceTest, SaveAllWindowsLocal_EmptyWindowsList){
@@ -154,18 +216,15 @@ TEST_F(DeskUpBackendInterfaceTest, SaveAllWindowsLocal_EmptyWindowsList){
     auto status = DeskUpBackendInterface::saveAllWindowsLocal("emptyWorkspace");
     EXPECT_TRUE(status.has_value()) << "Empty windows list should succeed";
 
-    // Verify workspace directory was created but contains no files
+    // Verify workspace directory was created and holds an empty manifest
     namespace fs = std::filesystem;
     fs::path workspace = fs::path(DESKUPDIR) / "emptyWorkspace";
     ASSERT_TRUE(fs::exists(workspace));
     ASSERT_TRUE(fs::is_directory(workspace));
 
-    // Count files in directory - should be 0
-    size_t fileCount = 0;
-    for (const auto& entry : fs::directory_iterator(workspace)) {
-        if (fs::is_regular_file(entry)) ++fileCount;
-    }
-    EXPECT_EQ(fileCount, 0u) << "No files should be saved for empty windows list";
+    auto saved = DeskUp::Workspace::readManifest(workspace / DeskUp::Workspace::MANIFEST_FILE_NAME);
+    ASSERT_TRUE(saved.has_value()) << saved.error().what();
+    EXPECT_TRUE(saved.value().empty()) << "No windows should be saved for empty windows list";
 }
 
 TEST_F(DeskUpBackendInterfaceTest, SaveAllWindowsLocal_GetAllOpenWindowsReturnsError){
@@ -201,26 +260,83 @@ TEST_F(DeskUpBackendInterfaceTest, SaveAllWindowsLocal_DuplicateWindowNames){
     auto status = DeskUpBackendInterface::saveAllWindowsLocal("dupWorkspace");
     ASSERT_TRUE(status.has_value()) << "Should succeed even with duplicate names";
 
-    // Verify files exist with collision resolution (appended IDs)
+    // Windows sharing a name no longer collide: all of them are kept, in order, inside the manifest
     namespace fs = std::filesystem;
     fs::path workspace = fs::path(DESKUPDIR) / "dupWorkspace";
     ASSERT_TRUE(fs::exists(workspace));
 
-    // First file should be just "Duplicate", subsequent ones get numbered
-    fs::path f1 = workspace / "Duplicate";
-    fs::path f2 = workspace / "Duplicate0";
-    fs::path f3 = workspace / "Duplicate1";
+    auto saved = DeskUp::Workspace::readManifest(workspace / DeskUp::Workspace::MANIFEST_FILE_NAME);
+    ASSERT_TRUE(saved.has_value()) << saved.error().what();
+    ASSERT_EQ(saved.value().size(), 3u);
+
+    EXPECT_EQ(saved.value()[0].pathToExec, "app1.exe") << "First duplicate should save app1.exe";
+    EXPECT_EQ(saved.value()[1].pathToExec, "app2.exe");
+    EXPECT_EQ(saved.value()[2].pathToExec, "app3.exe");
+    EXPECT_EQ(saved.value()[2].x, 50);
+}
+
+TEST_F(DeskUpBackendInterfaceTest, SaveAllWindowsLocal_WithoutStreaming){
+    auto* data = GetData();
+    ASSERT_NE(data, nullptr);
 
-    EXPECT_TRUE(fs::exists(f1)) << "First file should exist without suffix";
-    EXPECT_TRUE(fs::exists(f2)) << "Second file should exist with '0' suffix";
-    EXPECT_TRUE(fs::exists(f3)) << "Third file should exist with '1' suffix";
+    // A backend without streamOpenWindows falls back to enumerating everything first
+    current_window_backend->streamOpenWindows = nullptr;
 
-    // Verify content of first file matches w1
-    std::ifstream in(f1.string());
-    ASSERT_TRUE(in.is_open());
-    std::string line;
-    ASSERT_TRUE(std::getline(in, line));
-    EXPECT_EQ(line, "app1.exe") << "First duplicate should save app1.exe";
+    auto status = DeskUpBackendInterface::saveAllWindowsLocal("noStreamWorkspace");
+    ASSERT_TRUE(status.has_value()) << status.error().what();
+
+    namespace fs = std::filesystem;
+    auto saved = DeskUp::Workspace::readManifest(fs::path(DESKUPDIR) / "noStreamWorkspace" / DeskUp::Workspace::MANIFEST_FILE_NAME);
+    ASSERT_TRUE(saved.has_value()) << saved.error().what();
+    ASSERT_EQ(saved.value().size(), data->windows.size());
+    EXPECT_EQ(saved.value()[3].x, data->windows[3].x);
+}
+
+TEST_F(DeskUpBackendInterfaceTest, SaveAllWindowsLocal_StreamingKeepsEveryWindow){
+    auto* data = GetData();
+    ASSERT_NE(data, nullptr);
+
+    // More windows than the queue holds, so the enumeration has to wait for the writer
+    data->windows.clear();
+    for (int i = 0; i < 500; ++i) {
+        data->windows.push_back(windowDesc{"w" + std::to_string(i), i, -i, 100 + i, 200 + i, "app" + std::to_string(i % 7) + ".exe"});
+    }
+
+    auto status = DeskUpBackendInterface::saveAllWindowsLocal("streamWorkspace");
+    ASSERT_TRUE(status.has_value()) << status.error().what();
+
+    namespace fs = std::filesystem;
+    auto saved = DeskUp::Workspace::readManifest(fs::path(DESKUPDIR) / "streamWorkspace" / DeskUp::Workspace::MANIFEST_FILE_NAME);
+    ASSERT_TRUE(saved.has_value()) << saved.error().what();
+    ASSERT_EQ(saved.value().size(), 500u);
+
+    for (int i = 0; i < 500; ++i) {
+        EXPECT_EQ(saved.value()[i].name, data->windows[i].name);
+        EXPECT_EQ(saved.value()[i].pathToExec, data->windows[i].pathToExec);
+        EXPECT_EQ(saved.value()[i].y, -i);
+        EXPECT_EQ(saved.value()[i].h, 200 + i);
+    }
+}
+
+TEST_F(DeskUpBackendInterfaceTest, SaveAllWindowsLocal_FailedStreamingKeepsPreviousManifest){
+    namespace fs = std::filesystem;
+    auto* data = GetData();
+
+    data->windows.clear();
+    data->windows.push_back(windowDesc{"Kept", 1, 2, 300, 200, "kept.exe"});
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("failedStreamWS").has_value());
+
+    // The enumeration fails: the manifest saved before is still the one on disk
+    data->simulateError = true;
+    EXPECT_FALSE(DeskUpBackendInterface::saveAllWindowsLocal("failedStreamWS").has_value());
+    data->simulateError = false;
+
+    fs::path manifest = fs::path(DESKUPDIR) / "failedStreamWS" / DeskUp::Workspace::MANIFEST_FILE_NAME;
+    auto saved = DeskUp::Workspace::readManifest(manifest);
+    ASSERT_TRUE(saved.has_value()) << saved.error().what();
+    ASSERT_EQ(saved.value().size(), 1u);
+    EXPECT_EQ(saved.value()[0].name, "Kept");
+    EXPECT_FALSE(fs::exists(fs::path(manifest) += DeskUp::Workspace::ATOMIC_WRITE_SUFFIX));
 }
 
 // TEST_F(DeskUpBackendInterfaceTest, SaveAllWindowsLocal_InvalidWorkspaceName){
@@ -338,8 +454,8 @@ TEST_F(DeskUpBackendInterfaceTest, ExistsFile_ActualFile){
     auto status = DeskUpBackendInterface::saveAllWindowsLocal("fileTestWS");
     ASSERT_TRUE(status.has_value());
 
-    // Check if the saved file exists
-    fs::path savedFile = fs::path(DESKUPDIR) / "fileTestWS" / "FileTest";
+    // Check if the saved manifest exists
+    fs::path savedFile = fs::path(DESKUPDIR) / "fileTestWS" / DeskUp::Workspace::MANIFEST_FILE_NAME;
     EXPECT_TRUE(DeskUpBackendInterface::existsFile(savedFile));
 }
 
@@ -556,3 +672,1164 @@ TEST_F(DeskUpBackendInterfaceTest, RestoreWindows_VerifyWorkflow){
     EXPECT_EQ(data->h, original.h);
 }
 
+TEST_F(DeskUpBackendInterfaceTest, RestoreWindows_LegacyWorkspace){
+    namespace fs = std::filesystem;
+    auto* data = GetData();
+
+    // A workspace saved before the manifest existed: one 5-line file per window
+    fs::path workspace = fs::path(DESKUPDIR) / "legacyWS";
+    fs::create_directories(workspace);
+
+    std::ofstream out((workspace / "legacy").string());
+    out << "legacy.exe\n10\n20\n300\n200";
+    out.close();
+
+    // The dummy device answers the recovery of legacy files with its own geometry
+    data->x = 7;
+    data->y = 8;
+    data->w = 640;
+    data->h = 480;
+
+    auto status = DeskUpBackendInterface::restoreWindows("legacyWS");
+    ASSERT_TRUE(status.has_value()) << "Legacy workspaces should still restore";
+
+    EXPECT_EQ(data->x, 7);
+    EXPECT_EQ(data->w, 640u);
+}
+
+TEST_F(DeskUpBackendInterfaceTest, RestoreWindows_CorruptManifest){
+    namespace fs = std::filesystem;
+
+    fs::path workspace = fs::path(DESKUPDIR) / "corruptManifestWS";
+    fs::create_directories(workspace);
+
+    std::ofstream out((workspace / DeskUp::Workspace::MANIFEST_FILE_NAME).string(), std::ios::binary);
+    out << "not a manifest";
+    out.close();
+
+    auto status = DeskUpBackendInterface::restoreWindows("corruptManifestWS");
+    ASSERT_FALSE(status.has_value()) << "A corrupt manifest must not be restored";
+    EXPECT_TRUE(status.error().isError());
+}
+
+TEST_F(DeskUpBackendInterfaceTest, RestoreWindows_SkipsDamagedRecord){
+    namespace fs = std::filesystem;
+    auto* data = GetData();
+
+    data->windows.clear();
+    data->windows.push_back(windowDesc{"First", 1, 2, 300, 200, "first.exe"});
+    data->windows.push_back(windowDesc{"Second", 3, 4, 500, 400, "second.exe"});
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("damagedRecordWS").has_value());
+
+    // Damage the geometry of the second record
+    fs::path manifest = fs::path(DESKUPDIR) / "damagedRecordWS" / DeskUp::Workspace::MANIFEST_FILE_NAME;
+    {
+        std::fstream f(manifest, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(sizeof(DeskUp::Workspace::ManifestHeader) + sizeof(DeskUp::Workspace::ManifestRecord));
+        f.put('\x55');
+    }
+
+    auto status = DeskUpBackendInterface::restoreWindows("damagedRecordWS");
+    ASSERT_TRUE(status.has_value()) << status.error().what();
+
+    // Only the intact window was restored
+    EXPECT_EQ(data->path, "first.exe");
+    EXPECT_EQ(data->w, 300u);
+}
+
+TEST_F(DeskUpBackendInterfaceTest, RestoreWindows_LaunchesConcurrently){
+    auto* data = GetData();
+
+    // Eight apps that each take 100ms to start up: one after another that's 800ms
+    data->windows.clear();
+    for (int i = 0; i < 8; ++i) {
+        std::string path = "slow" + std::to_string(i) + ".exe";
+        data->windows.push_back(windowDesc{"Slow" + std::to_string(i), i, i, 300, 200, path});
+        data->launchLatency[path] = std::chrono::milliseconds(100);
+    }
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("concurrentWS").has_value());
+
+    auto report = DeskUpBackendInterface::restoreWindowsWithReport("concurrentWS", 8);
+    ASSERT_TRUE(report.has_value()) << report.error().what();
+
+    EXPECT_EQ(report->windows, 8u);
+    EXPECT_EQ(report->restored, 8u);
+    EXPECT_EQ(report->failed, 0u);
+    EXPECT_EQ(report->concurrency, 8u);
+    EXPECT_EQ(data->resizeCalls, 8);
+    EXPECT_GT(data->maxActiveLoads, 1) << "Apps should be launched at the same time";
+    EXPECT_GE(report->elapsed, std::chrono::milliseconds(100));
+    EXPECT_LT(report->elapsed, std::chrono::milliseconds(800)) << "Startup times should overlap";
+}
+
+// Build with USE_SANITIZER=thread to have ThreadSanitizer check the calls share no state
+TEST_F(DeskUpBackendInterfaceTest, DeviceCallsFromManyThreads){
+    auto* device = current_window_backend.get();
+    std::atomic<int> mismatches{0};
+
+    // Every thread moves and queries its own window through the same device, each call naming its target
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&, t] {
+            std::string path = "stress" + std::to_string(t) + ".exe";
+            auto window = device->loadWindowFromPath(device, path);
+            if (!window.has_value()) {
+                mismatches++;
+                return;
+            }
+
+            for (int i = 0; i < 200; ++i) {
+                windowDesc target{"Stress", t * 1000 + i, t, 300 + i, 200, path};
+                auto resized = device->resizeWindow(device, *window, target);
+                auto geometry = device->getWindowGeometry(device, *window);
+                auto owner = device->getPathFromWindow(device, *window);
+
+                if (!resized.has_value() || !geometry.has_value() || !owner.has_value() ||
+                    geometry->x != target.x || geometry->y != target.y || geometry->w != 300u + i || *owner != path) {
+                    mismatches++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    EXPECT_EQ(mismatches.load(), 0) << "A call acted on another thread's window";
+    EXPECT_EQ(GetData()->resizeCalls, 8 * 200);
+}
+
+TEST_F(DeskUpBackendInterfaceTest, RestoreWindows_RespectsConcurrencyCap){
+    auto* data = GetData();
+
+    data->windows.clear();
+    for (int i = 0; i < 6; ++i) {
+        std::string path = "capped" + std::to_string(i) + ".exe";
+        data->windows.push_back(windowDesc{"Capped" + std::to_string(i), i, i, 300, 200, path});
+        data->launchLatency[path] = std::chrono::milliseconds(30);
+    }
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("cappedWS").has_value());
+
+    auto report = DeskUpBackendInterface::restoreWindowsWithReport("cappedWS", 2);
+    ASSERT_TRUE(report.has_value()) << report.error().what();
+
+    EXPECT_EQ(report->restored, 6u);
+    EXPECT_EQ(report->concurrency, 2u);
+    EXPECT_LE(data->maxActiveLoads, 2);
+    // Three rounds of two launches at least
+    EXPECT_GE(report->elapsed, std::chrono::milliseconds(90));
+}
+
+TEST_F(DeskUpBackendInterfaceTest, RestoreWindows_ClosesEachExecutableOnce){
+    auto* data = GetData();
+
+    // Two windows of the same app: closing it again would kill the first one just restored
+    data->windows.clear();
+    data->windows.push_back(windowDesc{"First", 1, 2, 300, 200, "shared.exe"});
+    data->windows.push_back(windowDesc{"Second", 3, 4, 500, 400, "shared.exe"});
+    data->windows.push_back(windowDesc{"Other", 5, 6, 700, 600, "other.exe"});
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("sharedExeWS").has_value());
+
+    // Without a batched close, one close per executable
+    current_window_backend->closeProcessesFromPaths = nullptr;
+
+    auto report = DeskUpBackendInterface::restoreWindowsWithReport("sharedExeWS");
+    ASSERT_TRUE(report.has_value()) << report.error().what();
+
+    EXPECT_EQ(report->restored, 3u);
+    EXPECT_EQ(data->closeCalls, 2);
+    EXPECT_EQ(data->loadCalls, 3);
+}
+
+TEST_F(DeskUpBackendInterfaceTest, DeviceWithoutCapabilitiesUsesPerWindowCalls){
+    auto* data = GetData();
+
+    data->windows.clear();
+    data->windows.push_back(windowDesc{"First", 1, 2, 300, 200, "shared.exe"});
+    data->windows.push_back(windowDesc{"Second", 3, 4, 500, 400, "shared.exe"});
+    data->windows.push_back(windowDesc{"Other", 5, 6, 700, 600, "other.exe"});
+
+    // Every optional call is still set, but the device doesn't advertise any of them
+    current_window_backend->capabilities = DeviceCapability::None;
+    EXPECT_FALSE(DeskUp::Backend::supports(current_window_backend.get(), DeviceCapability::BatchClose));
+
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("noCapabilitiesWS").has_value());
+
+    auto report = DeskUpBackendInterface::restoreWindowsWithReport("noCapabilitiesWS", 4, DeskUp::Restore::RestoreMode::ReuseLive);
+    ASSERT_TRUE(report.has_value()) << report.error().what();
+
+    EXPECT_EQ(report->restored, 3u);
+    EXPECT_EQ(report->reused, 0u) << "Open windows can't be selected";
+    EXPECT_EQ(report->concurrency, 1u) << "Calls can't be made from several threads";
+    EXPECT_EQ(data->batchCloseCalls, 0);
+    EXPECT_EQ(data->closeCalls, 2);
+    EXPECT_EQ(data->placeCalls, 0);
+    EXPECT_EQ(data->loadCalls, 3);
+    EXPECT_TRUE(data->budgets.empty());
+}
+
+TEST_F(DeskUpBackendInterfaceTest, AdvertisedCapabilitiesNeedTheirCalls){
+    auto* device = current_window_backend.get();
+
+    EXPECT_TRUE(DeskUp::Backend::supports(device, DeviceCapability::BatchPlacement));
+    EXPECT_TRUE(DeskUp::Backend::supports(device, DeviceCapability::ConcurrentCalls));
+    EXPECT_FALSE(DeskUp::Backend::supports(nullptr, DeviceCapability::ConcurrentCalls));
+
+    // Advertised but not implemented: the faster path is not taken
+    device->applyLayout = nullptr;
+    EXPECT_FALSE(DeskUp::Backend::supports(device, DeviceCapability::BatchPlacement));
+
+    device->capabilities = device->capabilities & DeviceCapability::ConcurrentCalls;
+    EXPECT_TRUE(hasCapability(device->capabilities, DeviceCapability::ConcurrentCalls));
+    EXPECT_FALSE(DeskUp::Backend::supports(device, DeviceCapability::StreamedEnumeration));
+    EXPECT_FALSE(DeskUp::Backend::DeviceBackend{device}.canStream());
+}
+
+TEST_F(DeskUpBackendInterfaceTest, RestoreWindows_ClosesEveryExecutableInOneBatch){
+    auto* data = GetData();
+
+    data->windows.clear();
+    data->windows.push_back(windowDesc{"First", 1, 2, 300, 200, "shared.exe"});
+    data->windows.push_back(windowDesc{"Second", 3, 4, 500, 400, "shared.exe"});
+    data->windows.push_back(windowDesc{"Other", 5, 6, 700, 600, "other.exe"});
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("batchCloseWS").has_value());
+
+    auto report = DeskUpBackendInterface::restoreWindowsWithReport("batchCloseWS");
+    ASSERT_TRUE(report.has_value()) << report.error().what();
+
+    EXPECT_EQ(report->restored, 3u);
+    EXPECT_EQ(data->batchCloseCalls, 1);
+    EXPECT_TRUE(data->lastBatchForced) << "Restores may terminate apps that don't close";
+    EXPECT_EQ(data->closeCalls, 0);
+    ASSERT_EQ(data->closedPaths.size(), 2u) << "Each executable is closed once";
+    EXPECT_EQ(data->closedPaths[0], fs::path("shared.exe"));
+    EXPECT_EQ(data->closedPaths[1], fs::path("other.exe"));
+    EXPECT_EQ(data->loadCalls, 3);
+}
+
+TEST_F(DeskUpBackendInterfaceTest, RestoreWindows_LaunchesEachExecutableOnce){
+    auto* data = GetData();
+
+    // An editor reopening its three windows by itself, and a browser that only reopens two of its three
+    data->windows.clear();
+    for (int i = 0; i < 3; ++i) {
+        data->windows.push_back(windowDesc{"Editor" + std::to_string(i), i * 100, 0, 400, 300, "editor.exe"});
+        data->windows.push_back(windowDesc{"Browser" + std::to_string(i), i * 100, 500, 600, 400, "browser.exe"});
+    }
+    data->windowsPerLaunch["editor.exe"] = 3;
+    data->windowsPerLaunch["browser.exe"] = 2;
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("groupedWS").has_value());
+
+    auto report = DeskUpBackendInterface::restoreWindowsWithReport("groupedWS");
+    ASSERT_TRUE(report.has_value()) << report.error().what();
+
+    EXPECT_EQ(report->restored, 6u);
+    EXPECT_EQ(report->failed, 0u);
+    EXPECT_EQ(report->launches, 3u) << "Once per executable, plus once for the browser window that didn't reopen";
+    EXPECT_EQ(std::count(data->launchOrder.begin(), data->launchOrder.end(), "editor.exe"), 1);
+    EXPECT_EQ(std::count(data->launchOrder.begin(), data->launchOrder.end(), "browser.exe"), 2);
+    EXPECT_EQ(data->placeCalls, 2);
+    EXPECT_EQ(data->resizeCalls, 6);
+    EXPECT_EQ(data->batchCloseCalls, 1);
+    EXPECT_EQ(data->closedPaths.size(), 2u) << "The browser isn't closed again before its last window is launched";
+}
+
+TEST_F(DeskUpBackendInterfaceTest, RestoreSelection_OnlyTouchesSelectedWindows){
+    auto* data = GetData();
+
+    // Two monitors side by side: an editor and a terminal on the left one, a browser and another terminal on the right one
+    data->windows.clear();
+    data->windows.push_back(windowDesc{"Editor - main.cc", 100, 100, 800, 600, "C:/Apps/editor.exe"});
+    data->windows.push_back(windowDesc{"Terminal", 1000, 500, 600, 400, "C:/Apps/term.exe"});
+    data->windows.push_back(windowDesc{"Browser", 2000, 100, 1200, 900, "C:/Apps/browser.exe"});
+    data->windows.push_back(windowDesc{"Terminal - logs", 2500, 600, 600, 400, "C:/Apps/term.exe"});
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("selectiveWS").has_value());
+
+    DeskUp::Restore::RestoreFilter byApp;
+    byApp.executables = {"c:/apps/EDITOR.exe", "C:/Apps/term.exe"};
+    byApp.region = DeskUp::Restore::Region{0, 0, 1920, 1080};
+
+    auto report = DeskUpBackendInterface::restoreSelection("selectiveWS", byApp, 1);
+    ASSERT_TRUE(report.has_value()) << report.error().what();
+
+    EXPECT_EQ(report->windows, 2u) << "The terminal on the right monitor isn't selected";
+    EXPECT_EQ(report->restored, 2u);
+    EXPECT_EQ(data->resizeCalls, 2);
+    EXPECT_EQ(std::count(data->launchOrder.begin(), data->launchOrder.end(), "C:/Apps/browser.exe"), 0);
+    ASSERT_EQ(data->closedPaths.size(), 2u) << "Only the selected apps are closed";
+
+    DeskUp::Restore::RestoreFilter byName;
+    byName.namePattern = "terminal*";
+
+    data->resizeCalls = 0;
+    report = DeskUpBackendInterface::restoreSelection("selectiveWS", byName, 1);
+    ASSERT_TRUE(report.has_value()) << report.error().what();
+
+    EXPECT_EQ(report->windows, 2u);
+    EXPECT_EQ(data->resizeCalls, 2);
+    EXPECT_EQ(data->x, 2500) << "The terminals are restored in workspace order";
+
+    DeskUp::Restore::RestoreFilter nothing;
+    nothing.executables = {"C:/Apps/missing.exe"};
+
+    data->resizeCalls = 0;
+    report = DeskUpBackendInterface::restoreSelection("selectiveWS", nothing);
+    ASSERT_TRUE(report.has_value()) << report.error().what();
+    EXPECT_EQ(report->windows, 0u);
+    EXPECT_EQ(data->resizeCalls, 0);
+}
+
+TEST_F(DeskUpBackendInterfaceTest, RestorePlan_SelectsByPatternAndRegion){
+    EXPECT_TRUE(DeskUp::Restore::matchesPattern("Terminal - logs", "terminal*"));
+    EXPECT_TRUE(DeskUp::Restore::matchesPattern("Terminal - logs", "*-*LOGS"));
+    EXPECT_TRUE(DeskUp::Restore::matchesPattern("main.cc", "m?in.*"));
+    EXPECT_FALSE(DeskUp::Restore::matchesPattern("main.cc", "main"));
+    EXPECT_FALSE(DeskUp::Restore::matchesPattern("main", "main?"));
+
+    auto plan = DeskUp::Restore::compilePlan({
+        windowDesc{"a", 0, 0, 100, 100, "one.exe"},
+        windowDesc{"b", 1900, 0, 100, 100, "two.exe"},
+        windowDesc{"c", 1950, 0, 100, 100, "one.exe"}
+    });
+
+    // Only the centre counts: the second window overlaps the first monitor, but lies mostly on the second one
+    DeskUp::Restore::RestoreFilter right;
+    right.region = DeskUp::Restore::Region{1920, 0, 1920, 1080};
+
+    auto selection = DeskUp::Restore::selectPlan(plan, right);
+    ASSERT_EQ(selection.windows.size(), 2u);
+    EXPECT_EQ(selection.windows[0].name, "b");
+    EXPECT_EQ(selection.windows[1].name, "c");
+    ASSERT_EQ(selection.executables.size(), 2u);
+    EXPECT_EQ(selection.executables[0], fs::path("two.exe"));
+    EXPECT_EQ(selection.windowsOf[1], (std::vector<std::size_t>{1}));
+    EXPECT_EQ(selection.stamp, 0u);
+}
+
+TEST_F(DeskUpBackendInterfaceTest, RestoreWindows_LaunchesSlowestAppsFirst){
+    auto* data = GetData();
+
+    data->windows.clear();
+    data->windows.push_back(windowDesc{"Fast", 1, 2, 300, 200, "fast.exe"});
+    data->windows.push_back(windowDesc{"Medium", 3, 4, 500, 400, "medium.exe"});
+    data->windows.push_back(windowDesc{"Slow", 5, 6, 700, 600, "slow.exe"});
+    data->launchLatency["fast.exe"] = std::chrono::milliseconds(10);
+    data->launchLatency["medium.exe"] = std::chrono::milliseconds(60);
+    data->launchLatency["slow.exe"] = std::chrono::milliseconds(120);
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("profiledWS").has_value());
+
+    // Nothing is known the first time: workspace order, and no budget
+    ASSERT_TRUE(DeskUpBackendInterface::restoreWindowsWithReport("profiledWS", 1).has_value());
+    EXPECT_EQ(data->launchOrder, (std::vector<std::string>{"fast.exe", "medium.exe", "slow.exe"}));
+    EXPECT_TRUE(data->budgets.empty());
+
+    fs::path file = fs::path(DESKUPDIR) / DeskUp::Restore::LAUNCH_PROFILES_FILE_NAME;
+    ASSERT_TRUE(fs::exists(file));
+    auto profiles = DeskUp::Restore::LaunchProfiles::load(file);
+    ASSERT_TRUE(profiles.has_value()) << profiles.error().what();
+    EXPECT_EQ(profiles->size(), 3u);
+
+    // The second time, the app the restore waits on the longest starts first
+    data->launchOrder.clear();
+    auto report = DeskUpBackendInterface::restoreWindowsWithReport("profiledWS", 1);
+    ASSERT_TRUE(report.has_value()) << report.error().what();
+
+    EXPECT_EQ(report->restored, 3u);
+    EXPECT_EQ(data->launchOrder, (std::vector<std::string>{"slow.exe", "medium.exe", "fast.exe"}));
+    ASSERT_EQ(data->budgets.size(), 3u);
+    EXPECT_EQ(data->budgets["slow.exe"], DeskUp::Restore::MIN_LAUNCH_BUDGET);
+}
+
+TEST_F(DeskUpBackendInterfaceTest, RestoreWindowsWithin_ReportsLateWindowsInsteadOfWaiting){
+    auto* data = GetData();
+
+    // An app that takes far longer to start than the restore is allowed to last
+    data->windows.clear();
+    data->windows.push_back(windowDesc{"Fast", 1, 2, 300, 200, "fast.exe"});
+    data->windows.push_back(windowDesc{"Hung", 3, 4, 500, 400, "hung.exe"});
+    data->windows.push_back(windowDesc{"After", 5, 6, 700, 600, "after.exe"});
+    data->launchLatency["fast.exe"] = std::chrono::milliseconds(10);
+    data->launchLatency["hung.exe"] = std::chrono::milliseconds(5000);
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("deadlineWS").has_value());
+
+    auto report = DeskUpBackendInterface::restoreWindowsWithin("deadlineWS", std::chrono::milliseconds(300), 1);
+    ASSERT_TRUE(report.has_value()) << report.error().what();
+
+    EXPECT_EQ(report->restored, 1u);
+    EXPECT_EQ(report->late, 2u) << "The hung app ran out of time, and the next one never started";
+    EXPECT_EQ(report->failed, 0u);
+    EXPECT_LT(report->elapsed, std::chrono::milliseconds(1000));
+
+    ASSERT_TRUE(data->budgets.contains("hung.exe"));
+    EXPECT_LE(data->budgets["hung.exe"], std::chrono::milliseconds(300)) << "The launch is only given what is left of the deadline";
+    EXPECT_EQ(std::count(data->launchOrder.begin(), data->launchOrder.end(), "after.exe"), 0);
+}
+
+TEST_F(DeskUpBackendInterfaceTest, RestoreWindowsWithin_PassedDeadlineClosesAndMovesNothing){
+    auto* data = GetData();
+
+    data->windows.clear();
+    data->windows.push_back(windowDesc{"Moved", 10, 20, 300, 200, "moved.exe"});
+    data->windows.push_back(windowDesc{"Closed", 30, 40, 500, 400, "closed.exe"});
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("passedDeadlineWS").has_value());
+
+    data->windows[0].x = 900;
+    data->windows.pop_back();
+
+    auto report = DeskUpBackendInterface::restoreWindowsWithin("passedDeadlineWS", std::chrono::milliseconds(0), 4,
+        DeskUp::Restore::RestoreMode::ReuseLive);
+    ASSERT_TRUE(report.has_value()) << report.error().what();
+
+    EXPECT_EQ(report->late, 2u);
+    EXPECT_EQ(report->restored, 0u);
+    EXPECT_EQ(data->batchCloseCalls, 0) << "No app is closed once the deadline has passed";
+    EXPECT_EQ(data->layoutCalls, 0) << "Nor is any open window moved";
+    EXPECT_EQ(data->loadCalls, 0);
+    EXPECT_EQ(data->windows[0].x, 900);
+}
+
+TEST_F(DeskUpBackendInterfaceTest, RestoreWorkspaces_MergesLayersIntoOnePass){
+    auto* data = GetData();
+
+    // A base workspace with a browser and a chat app, and a project one placing the browser elsewhere next to an editor
+    data->windows.clear();
+    data->windows.push_back(windowDesc{"Browser", 0, 0, 800, 600, "C:/Apps/browser.exe"});
+    data->windows.push_back(windowDesc{"Chat", 800, 0, 400, 600, "C:/Apps/chat.exe"});
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("baseWS").has_value());
+
+    data->windows.clear();
+    data->windows.push_back(windowDesc{"Editor", 0, 0, 1200, 900, "C:/Apps/editor.exe"});
+    data->windows.push_back(windowDesc{"Browser", 1200, 0, 700, 900, "c:/apps/BROWSER.exe"});
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("projectWS").has_value());
+
+    auto report = DeskUpBackendInterface::restoreWorkspaces({"baseWS", "projectWS"}, 1);
+    ASSERT_TRUE(report.has_value()) << report.error().what();
+
+    EXPECT_EQ(report->windows, 3u) << "The browser is only restored once";
+    EXPECT_EQ(report->restored, 3u);
+    EXPECT_EQ(report->launches, 3u);
+    EXPECT_EQ(data->batchCloseCalls, 1) << "A single close phase for every layer";
+    EXPECT_EQ(data->closedPaths.size(), 3u);
+    EXPECT_EQ(data->x, 1200) << "The browser takes the geometry of the top layer, restored last";
+
+    // A missing layer stops the restore before anything is closed
+    data->batchCloseCalls = 0;
+    auto missing = DeskUpBackendInterface::restoreWorkspaces({"baseWS", "noSuchWS"});
+    EXPECT_FALSE(missing.has_value());
+    EXPECT_EQ(data->batchCloseCalls, 0);
+}
+
+TEST_F(DeskUpBackendInterfaceTest, RestoreWindows_CachesPlanUntilWorkspaceChanges){
+    auto* data = GetData();
+
+    data->windows.clear();
+    data->windows.push_back(windowDesc{"First", 10, 20, 300, 200, "first.exe"});
+    data->windows.push_back(windowDesc{"Second", 30, 40, 500, 400, "second.exe"});
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("plannedWS").has_value());
+
+    fs::path file = fs::path(DESKUPDIR) / (std::string(DeskUp::Restore::RESTORE_PLAN_PREFIX) + "plannedWS");
+    ASSERT_FALSE(fs::exists(file));
+
+    // The first restore compiles the plan and caches it
+    ASSERT_TRUE(DeskUpBackendInterface::restoreWindows("plannedWS").has_value());
+    auto plan = DeskUp::Restore::readPlan(file);
+    ASSERT_TRUE(plan.has_value()) << plan.error().what();
+    ASSERT_EQ(plan->windows.size(), 2u);
+    EXPECT_EQ(plan->executables.size(), 2u);
+    EXPECT_EQ(plan->keys[1], "second.exe");
+
+    // While the manifest is the same, the next restores run the cached plan without looking at the records
+    plan->windows[1].w = 555;
+    ASSERT_TRUE(DeskUp::Restore::writePlan(file, plan.value()).has_value());
+    data->path.clear();
+    ASSERT_TRUE(DeskUpBackendInterface::restoreWindowsWithReport("plannedWS", 1).has_value());
+    EXPECT_EQ(data->w, 555u);
+
+    // Saving the workspace again makes the plan stale
+    data->windows[1].w = 640;
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("plannedWS").has_value());
+    ASSERT_TRUE(DeskUpBackendInterface::restoreWindowsWithReport("plannedWS", 1).has_value());
+    EXPECT_EQ(data->w, 640u);
+
+    auto recompiled = DeskUp::Restore::readPlan(file);
+    ASSERT_TRUE(recompiled.has_value()) << recompiled.error().what();
+    EXPECT_NE(recompiled->stamp, plan->stamp);
+    EXPECT_EQ(recompiled->windows[1].w, 640u);
+
+    // And removing the workspace removes its plan
+    EXPECT_EQ(DeskUpBackendInterface::removeWorkspace("plannedWS"), 1);
+    EXPECT_FALSE(fs::exists(file));
+}
+
+TEST_F(DeskUpBackendInterfaceTest, RestorePlan_GroupsByExecutableAndRejectsDamage){
+    std::vector<windowDesc> windows{
+        windowDesc{"A", 0, 0, 100, 100, "C:/Apps/Editor.exe"},
+        windowDesc{"B", 0, 0, 100, 100, "C:/Apps/Term.exe"},
+        windowDesc{"C", 0, 0, 100, 100, "c:/apps/editor.exe"},
+        windowDesc{"D", 0, 0, 100, 100, ""}
+    };
+
+    auto plan = DeskUp::Restore::compilePlan(windows, 42);
+
+    // The window without an executable can't be restored, and paths are grouped case-insensitively
+    ASSERT_EQ(plan.windows.size(), 3u);
+    ASSERT_EQ(plan.executables.size(), 2u);
+    EXPECT_EQ(plan.windowsOf[0], (std::vector<std::size_t>{0, 2}));
+    EXPECT_EQ(plan.windowsOf[1], (std::vector<std::size_t>{1}));
+
+    std::string image = DeskUp::Restore::encodePlan(plan);
+    auto decoded = DeskUp::Restore::decodePlan(image);
+    ASSERT_TRUE(decoded.has_value()) << decoded.error().what();
+    EXPECT_EQ(decoded->stamp, 42u);
+    EXPECT_EQ(decoded->keys, plan.keys);
+    EXPECT_EQ(decoded->windowsOf, plan.windowsOf);
+    EXPECT_EQ(decoded->windows[2].name, "C");
+    EXPECT_EQ(decoded->windows[2].pathToExec, plan.windows[2].pathToExec);
+    EXPECT_EQ(decoded->executables, plan.executables);
+
+    image[image.size() - 1] ^= 0x01;
+    auto damaged = DeskUp::Restore::decodePlan(image);
+    ASSERT_FALSE(damaged.has_value());
+    EXPECT_EQ(damaged.error().type(), DeskUp::ErrType::CorruptedData);
+}
+
+TEST_F(DeskUpBackendInterfaceTest, LaunchProfiles_PersistAndRejectDamage){
+    fs::path file = fs::path(DESKUPDIR) / DeskUp::Restore::LAUNCH_PROFILES_FILE_NAME;
+
+    // No file yet is not an error
+    auto empty = DeskUp::Restore::LaunchProfiles::load(file);
+    ASSERT_TRUE(empty.has_value());
+    EXPECT_EQ(empty->size(), 0u);
+
+    DeskUp::Restore::LaunchProfiles profiles;
+    for (int i = 0; i < 9; ++i) profiles.record("C:/Apps/Editor.exe", std::chrono::milliseconds(700));
+    profiles.record("C:/Apps/Editor.exe", std::chrono::milliseconds(30000));
+    profiles.record("C:/Apps/Term.exe", std::chrono::milliseconds(20));
+    ASSERT_TRUE(profiles.save(file).has_value());
+
+    auto loaded = DeskUp::Restore::LaunchProfiles::load(file);
+    ASSERT_TRUE(loaded.has_value()) << loaded.error().what();
+    EXPECT_EQ(loaded->size(), 2u);
+
+    // Paths are compared case-insensitively, and a single outlier moves neither the median nor the budget
+    EXPECT_EQ(loaded->expected("c:/apps/editor.exe"), std::chrono::milliseconds(800));
+    EXPECT_EQ(loaded->budget("C:/Apps/Editor.exe"), std::chrono::milliseconds(2000));
+    EXPECT_EQ(loaded->expected("C:/Apps/Term.exe"), std::chrono::milliseconds(50));
+    EXPECT_FALSE(loaded->expected("C:/Apps/Other.exe").has_value());
+
+    // Old launches fade out once a histogram is full
+    DeskUp::Restore::LatencyHistogram histogram;
+    for (std::uint32_t i = 0; i < DeskUp::Restore::LATENCY_MAX_SAMPLES; ++i) histogram.record(std::chrono::milliseconds(10));
+    histogram.record(std::chrono::milliseconds(10));
+    EXPECT_EQ(histogram.samples(), DeskUp::Restore::LATENCY_MAX_SAMPLES / 2 + 1);
+
+    {
+        std::fstream f(file, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(10);
+        f.put('\x55');
+    }
+    auto damaged = DeskUp::Restore::LaunchProfiles::load(file);
+    ASSERT_FALSE(damaged.has_value());
+    EXPECT_EQ(damaged.error().type(), DeskUp::ErrType::CorruptedData);
+}
+
+TEST_F(DeskUpBackendInterfaceTest, RestoreWindows_ReusesOpenWindows){
+    auto* data = GetData();
+
+    data->windows.clear();
+    data->windows.push_back(windowDesc{"InPlace", 10, 20, 300, 200, "inplace.exe"});
+    data->windows.push_back(windowDesc{"Moved", 30, 40, 500, 400, "moved.exe"});
+    data->windows.push_back(windowDesc{"Closed", 50, 60, 700, 600, "closed.exe"});
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("reuseWS").has_value());
+
+    // Since the save: one window was moved and another one closed
+    data->windows[1].x = 900;
+    data->windows[1].w = 100;
+    data->windows.pop_back();
+
+    auto report = DeskUpBackendInterface::restoreWindowsWithReport("reuseWS", 4, DeskUp::Restore::RestoreMode::ReuseLive);
+    ASSERT_TRUE(report.has_value()) << report.error().what();
+
+    EXPECT_EQ(report->restored, 3u);
+    EXPECT_EQ(report->reused, 2u);
+    EXPECT_EQ(data->selectCalls, 1) << "A window already in place needs no call";
+    EXPECT_EQ(data->resizeCalls, 2);
+    EXPECT_EQ(data->loadCalls, 1) << "Only the closed window is launched";
+    ASSERT_EQ(data->closedPaths.size(), 1u) << "Apps with a reused window keep running";
+    EXPECT_EQ(data->closedPaths[0], fs::path("closed.exe"));
+}
+
+TEST_F(DeskUpBackendInterfaceTest, RestoreWindows_ReusedWindowsAreMovedInOneLayout){
+    auto* data = GetData();
+
+    data->windows.clear();
+    for (int i = 0; i < 5; ++i) {
+        data->windows.push_back(windowDesc{"Window" + std::to_string(i), i * 100, 0, 300, 200, "app" + std::to_string(i) + ".exe"});
+    }
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("layoutWS").has_value());
+
+    // Every window but the first one was moved since the save
+    for (std::size_t i = 1; i < data->windows.size(); ++i) {
+        data->windows[i].y = 500;
+    }
+
+    auto report = DeskUpBackendInterface::restoreWindowsWithReport("layoutWS", 4, DeskUp::Restore::RestoreMode::ReuseLive);
+    ASSERT_TRUE(report.has_value()) << report.error().what();
+
+    EXPECT_EQ(report->restored, 5u);
+    EXPECT_EQ(report->reused, 5u);
+    EXPECT_EQ(data->layoutCalls, 1) << "Every moved window goes in the same layout";
+    EXPECT_EQ(data->resizeCalls, 4);
+    EXPECT_EQ(data->loadCalls, 0);
+    for (const auto& w : data->windows) {
+        EXPECT_EQ(w.y, 0);
+    }
+
+    // Devices without layouts move them one by one
+    for (std::size_t i = 1; i < data->windows.size(); ++i) {
+        data->windows[i].y = 500;
+    }
+    current_window_backend->applyLayout = nullptr;
+
+    report = DeskUpBackendInterface::restoreWindowsWithReport("layoutWS", 4, DeskUp::Restore::RestoreMode::ReuseLive);
+    ASSERT_TRUE(report.has_value()) << report.error().what();
+
+    EXPECT_EQ(report->reused, 5u);
+    EXPECT_EQ(data->layoutCalls, 1);
+    EXPECT_EQ(data->resizeCalls, 8);
+}
+
+TEST_F(DeskUpBackendInterfaceTest, RestoreWindows_ReusePairsEachOpenWindowOnce){
+    auto* data = GetData();
+
+    // Two saved windows of the same app, only one of them still open, away from both
+    data->windows.clear();
+    data->windows.push_back(windowDesc{"Left", 0, 0, 800, 600, "editor.exe"});
+    data->windows.push_back(windowDesc{"Right", 800, 0, 800, 600, "editor.exe"});
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("reusePairWS").has_value());
+
+    data->windows.pop_back();
+    data->windows[0].x = 700;
+
+    auto report = DeskUpBackendInterface::restoreWindowsWithReport("reusePairWS", 4, DeskUp::Restore::RestoreMode::ReuseLive);
+    ASSERT_TRUE(report.has_value()) << report.error().what();
+
+    // The open window goes to the closest saved one, the other one is launched next to it
+    EXPECT_EQ(report->reused, 1u);
+    EXPECT_EQ(data->loadCalls, 1);
+    EXPECT_TRUE(data->closedPaths.empty());
+    EXPECT_EQ(data->batchCloseCalls, 0);
+}
+
+TEST_F(DeskUpBackendInterfaceTest, RestoreWindows_RelaunchIsTheDefault){
+    auto* data = GetData();
+
+    data->windows.clear();
+    data->windows.push_back(windowDesc{"InPlace", 10, 20, 300, 200, "inplace.exe"});
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("relaunchWS").has_value());
+
+    auto report = DeskUpBackendInterface::restoreWindowsWithReport("relaunchWS");
+    ASSERT_TRUE(report.has_value()) << report.error().what();
+
+    EXPECT_EQ(report->reused, 0u);
+    EXPECT_EQ(data->selectCalls, 0);
+    EXPECT_EQ(data->loadCalls, 1);
+}
+
+TEST_F(DeskUpBackendInterfaceTest, RestoreWindows_FatalErrorStopsRestore){
+    auto* data = GetData();
+
+    data->windows.clear();
+    data->windows.push_back(windowDesc{"App", 1, 2, 300, 200, "app.exe"});
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("fatalRestoreWS").has_value());
+
+    data->simulateError = true;
+    data->errorToReturn = DeskUp::Error(DeskUp::Level::Fatal, DeskUp::ErrType::InsufficientMemory, 0, "No memory");
+
+    auto report = DeskUpBackendInterface::restoreWindowsWithReport("fatalRestoreWS");
+    ASSERT_FALSE(report.has_value());
+    EXPECT_TRUE(report.error().isFatal());
+    EXPECT_EQ(data->loadCalls, 0) << "Nothing should be launched after a fatal close";
+}
+
+TEST_F(DeskUpBackendInterfaceTest, RestoreWindowsAsync_ReportsProgress){
+    auto* data = GetData();
+
+    data->windows.clear();
+    data->windows.push_back(windowDesc{"A", 1, 2, 300, 200, "a.exe"});
+    data->windows.push_back(windowDesc{"B", 3, 4, 500, 400, "b.exe"});
+    data->windows.push_back(windowDesc{"C", 5, 6, 700, 600, "c.exe"});
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("asyncRestoreWS").has_value());
+
+    std::mutex mutex;
+    std::vector<DeskUp::Async::Progress> events;
+    auto op = DeskUpBackendInterface::restoreWindowsAsync("asyncRestoreWS", [&](const DeskUp::Async::Progress& p) {
+        std::lock_guard lock(mutex);
+        events.push_back(p);
+    });
+
+    auto report = op.get();
+    ASSERT_TRUE(report.has_value()) << report.error().what();
+    EXPECT_EQ(report->restored, 3u);
+
+    int closing = 0, launching = 0, placing = 0, done = 0;
+    std::size_t lastCompleted = 0;
+    for (const auto& e : events) {
+        EXPECT_EQ(e.total, 3u);
+        EXPECT_LT(e.window, 3u);
+        switch (e.phase) {
+            case DeskUp::Async::Phase::Closing: closing++; break;
+            case DeskUp::Async::Phase::Launching: launching++; break;
+            case DeskUp::Async::Phase::Placing: placing++; break;
+            case DeskUp::Async::Phase::Done: done++; lastCompleted = std::max(lastCompleted, e.completed); break;
+            default: ADD_FAILURE() << "Unexpected phase";
+        }
+    }
+    EXPECT_EQ(closing, 3);
+    EXPECT_EQ(launching, 3);
+    EXPECT_EQ(placing, 3);
+    EXPECT_EQ(done, 3);
+    EXPECT_EQ(lastCompleted, 3u);
+}
+
+TEST_F(DeskUpBackendInterfaceTest, RestoreWindowsAsync_CancelStopsPartway){
+    auto* data = GetData();
+
+    data->windows.clear();
+    for (int i = 0; i < 8; ++i) {
+        std::string path = "cancel" + std::to_string(i) + ".exe";
+        data->windows.push_back(windowDesc{"Cancel" + std::to_string(i), i, i, 300, 200, path});
+        data->launchLatency[path] = std::chrono::milliseconds(50);
+    }
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("cancelRestoreWS").has_value());
+
+    std::promise<void> firstDone;
+    std::atomic<bool> signalled{false};
+    auto op = DeskUpBackendInterface::restoreWindowsAsync("cancelRestoreWS", [&](const DeskUp::Async::Progress& p) {
+        if (p.phase == DeskUp::Async::Phase::Done && !signalled.exchange(true)) firstDone.set_value();
+    }, 1);
+
+    // The caller isn't blocked while apps start up
+    EXPECT_FALSE(op.ready());
+
+    firstDone.get_future().wait();
+    op.cancel();
+    EXPECT_TRUE(op.cancelled());
+
+    auto report = op.get();
+    ASSERT_FALSE(report.has_value());
+    EXPECT_EQ(report.error().type(), DeskUp::ErrType::Cancelled);
+    EXPECT_FALSE(report.error().isFatal());
+
+    std::lock_guard lock(data->mutex);
+    EXPECT_GE(data->loadCalls, 1);
+    EXPECT_LT(data->loadCalls, 8) << "No launch should start after the cancellation";
+    EXPECT_EQ(data->activeLoads, 0) << "The launch in flight is finished, not abandoned";
+}
+
+TEST_F(DeskUpBackendInterfaceTest, SaveAllWindowsLocalAsync_ProgressAndCancel){
+    auto* data = GetData();
+    data->windows.clear();
+    ASSERT_TRUE(DUMMY_getAllOpenWindows(current_window_backend.get()).has_value());
+    ASSERT_EQ(data->windows.size(), 4u);
+
+    std::vector<DeskUp::Async::Progress> events;
+    auto saved = DeskUpBackendInterface::saveAllWindowsLocalAsync("asyncSaveWS", [&](const DeskUp::Async::Progress& p) {
+        events.push_back(p);
+    }).get();
+    ASSERT_TRUE(saved.has_value()) << saved.error().what();
+    ASSERT_EQ(events.size(), 4u);
+    EXPECT_EQ(events.back().phase, DeskUp::Async::Phase::Saving);
+    EXPECT_EQ(events.back().window, 3u);
+
+    // Cancelled while the first window is being handed over: nothing after it is enumerated, and the workspace saved
+    // before is left as it was
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("cancelSaveWS").has_value());
+
+    std::promise<void> reached;
+    std::promise<void> release;
+    auto releaseFuture = release.get_future();
+    int seen = 0;
+    auto op = DeskUpBackendInterface::saveAllWindowsLocalAsync("cancelSaveWS", [&](const DeskUp::Async::Progress&) {
+        if (seen++ == 0) {
+            reached.set_value();
+            releaseFuture.wait();
+        }
+    });
+
+    reached.get_future().wait();
+    op.cancel();
+    release.set_value();
+
+    auto cancelled = op.get();
+    ASSERT_FALSE(cancelled.has_value());
+    EXPECT_EQ(cancelled.error().type(), DeskUp::ErrType::Cancelled);
+    EXPECT_EQ(seen, 1);
+
+    namespace fs = std::filesystem;
+    fs::path manifest = fs::path(DESKUPDIR) / "cancelSaveWS" / DeskUp::Workspace::MANIFEST_FILE_NAME;
+    auto kept = DeskUp::Workspace::readManifest(manifest);
+    ASSERT_TRUE(kept.has_value()) << kept.error().what();
+    EXPECT_EQ(kept.value().size(), 4u);
+    EXPECT_FALSE(fs::exists(fs::path(manifest) += DeskUp::Workspace::ATOMIC_WRITE_SUFFIX));
+}
+
+TEST_F(DeskUpBackendInterfaceTest, VerifyWorkspace_IntactAndDamaged){
+    namespace fs = std::filesystem;
+    auto* data = GetData();
+    ASSERT_NE(data, nullptr);
+
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("intactWS").has_value());
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("damagedWS").has_value());
+
+    // Legacy workspaces carry no checksum and are not flagged
+    fs::create_directories(fs::path(DESKUPDIR) / "legacyVerifyWS");
+    std::ofstream((fs::path(DESKUPDIR) / "legacyVerifyWS" / "old").string()) << "old.exe\n1\n2\n3\n4";
+
+    {
+        std::fstream f(fs::path(DESKUPDIR) / "damagedWS" / DeskUp::Workspace::MANIFEST_FILE_NAME, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(sizeof(DeskUp::Workspace::ManifestHeader) + 2);
+        f.put('\x01');
+    }
+
+    EXPECT_TRUE(DeskUpBackendInterface::verifyWorkspace("intactWS").has_value());
+    EXPECT_TRUE(DeskUpBackendInterface::verifyWorkspace("legacyVerifyWS").has_value());
+
+    auto damaged = DeskUpBackendInterface::verifyWorkspace("damagedWS");
+    ASSERT_FALSE(damaged.has_value());
+    EXPECT_EQ(damaged.error().type(), DeskUp::ErrType::CorruptedData);
+
+    auto missing = DeskUpBackendInterface::verifyWorkspace("missingWS");
+    ASSERT_FALSE(missing.has_value());
+    EXPECT_EQ(missing.error().type(), DeskUp::ErrType::InvalidInput);
+
+    auto corrupted = DeskUpBackendInterface::findCorruptedWorkspaces();
+    ASSERT_EQ(corrupted.size(), 1u);
+    EXPECT_EQ(corrupted[0].first, "damagedWS");
+    EXPECT_EQ(corrupted[0].second.type(), DeskUp::ErrType::CorruptedData);
+
+    // Saving again repairs it
+    ASSERT_TRUE(DeskUpBackendInterface::updateWorkspace("damagedWS").has_value());
+    EXPECT_TRUE(DeskUpBackendInterface::findCorruptedWorkspaces().empty());
+}
+
+TEST_F(DeskUpBackendInterfaceTest, UpdateWorkspace_OnlyWritesChangedWindows){
+    namespace fs = std::filesystem;
+    auto* data = GetData();
+
+    data->windows.clear();
+    for(int i = 0; i < 200; i++){
+        data->windows.push_back(windowDesc{"app" + std::to_string(i), i, i, 300, 200, "app" + std::to_string(i) + ".exe"});
+    }
+
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("deltaWS").has_value());
+
+    // Nothing moved: nothing gets written
+    auto unchanged = DeskUpBackendInterface::updateWorkspace("deltaWS");
+    ASSERT_TRUE(unchanged.has_value());
+    EXPECT_EQ(unchanged.value(), 0u);
+
+    // Two windows moved: only their records get written
+    data->windows[3].x = 1000;
+    data->windows[150].h = 900;
+
+    auto moved = DeskUpBackendInterface::updateWorkspace("deltaWS");
+    ASSERT_TRUE(moved.has_value());
+    EXPECT_EQ(moved.value(), 2u);
+
+    auto saved = DeskUp::Workspace::readManifest(fs::path(DESKUPDIR) / "deltaWS" / DeskUp::Workspace::MANIFEST_FILE_NAME);
+    ASSERT_TRUE(saved.has_value());
+    ASSERT_EQ(saved.value().size(), 200u);
+    EXPECT_EQ(saved.value()[3].x, 1000);
+    EXPECT_EQ(saved.value()[150].h, 900);
+
+    // A window vanished: the manifest is rewritten without it
+    data->windows.pop_back();
+
+    auto vanished = DeskUpBackendInterface::updateWorkspace("deltaWS");
+    ASSERT_TRUE(vanished.has_value());
+    EXPECT_EQ(vanished.value(), 199u);
+
+    saved = DeskUp::Workspace::readManifest(fs::path(DESKUPDIR) / "deltaWS" / DeskUp::Workspace::MANIFEST_FILE_NAME);
+    ASSERT_TRUE(saved.has_value());
+    EXPECT_EQ(saved.value().size(), 199u);
+}
+
+TEST_F(DeskUpBackendInterfaceTest, UpdateWorkspace_ReplacesLegacyFiles){
+    namespace fs = std::filesystem;
+    auto* data = GetData();
+
+    fs::path workspace = fs::path(DESKUPDIR) / "legacyUpdateWS";
+    fs::create_directories(workspace);
+    std::ofstream((workspace / "old").string()) << "old.exe\n1\n2\n3\n4";
+
+    data->windows.clear();
+    data->windows.push_back(windowDesc{"New", 1, 2, 3, 4, "new.exe"});
+
+    auto res = DeskUpBackendInterface::updateWorkspace("legacyUpdateWS");
+    ASSERT_TRUE(res.has_value());
+    EXPECT_EQ(res.value(), 1u);
+
+    EXPECT_FALSE(fs::exists(workspace / "old"));
+    EXPECT_TRUE(fs::exists(workspace / DeskUp::Workspace::MANIFEST_FILE_NAME));
+}
+
+TEST_F(DeskUpBackendInterfaceTest, ReplaceWorkspace_PublishesWithOneRename){
+    namespace fs = std::filesystem;
+    auto* data = GetData();
+
+    fs::path workspace = fs::path(DESKUPDIR) / "replaceWS";
+    fs::create_directories(workspace);
+    std::ofstream((workspace / "old").string()) << "old.exe\n1\n2\n3\n4";
+
+    data->windows.clear();
+    data->windows.push_back(windowDesc{"New", 1, 2, 3, 4, "new.exe"});
+
+    auto res = DeskUpBackendInterface::replaceWorkspace("replaceWS");
+    ASSERT_TRUE(res.has_value()) << res.error().what();
+
+    auto saved = DeskUp::Workspace::readManifest(workspace / DeskUp::Workspace::MANIFEST_FILE_NAME);
+    ASSERT_TRUE(saved.has_value());
+    ASSERT_EQ(saved.value().size(), 1u);
+    EXPECT_EQ(saved.value()[0].pathToExec, fs::path("new.exe"));
+
+    // Legacy files are gone and nothing staged is left behind
+    EXPECT_FALSE(fs::exists(workspace / "old"));
+    fs::path staged = workspace / DeskUp::Workspace::MANIFEST_FILE_NAME;
+    staged += DeskUp::Workspace::ATOMIC_WRITE_SUFFIX;
+    EXPECT_FALSE(fs::exists(staged));
+}
+
+TEST_F(DeskUpBackendInterfaceTest, ReplaceWorkspace_FailedEnumerationKeepsOldWorkspace){
+    namespace fs = std::filesystem;
+    auto* data = GetData();
+
+    data->windows.clear();
+    data->windows.push_back(windowDesc{"Old", 1, 2, 3, 4, "old.exe"});
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("keepWS").has_value());
+
+    data->simulateError = true;
+    data->errorToReturn = DeskUp::Error(DeskUp::Level::Fatal, DeskUp::ErrType::Default, 0, "Backend enumeration failed");
+
+    ASSERT_FALSE(DeskUpBackendInterface::replaceWorkspace("keepWS").has_value());
+
+    auto saved = DeskUp::Workspace::readManifest(fs::path(DESKUPDIR) / "keepWS" / DeskUp::Workspace::MANIFEST_FILE_NAME);
+    ASSERT_TRUE(saved.has_value());
+    ASSERT_EQ(saved.value().size(), 1u);
+    EXPECT_EQ(saved.value()[0].pathToExec, fs::path("old.exe"));
+}
+
+TEST_F(DeskUpBackendInterfaceTest, RemoveWorkspace_ReclaimsInBackground){
+    namespace fs = std::filesystem;
+
+    current_workspace_reclaimer = std::make_unique<DeskUp::Workspace::WorkspaceReclaimer>();
+
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("reclaimWS").has_value());
+    EXPECT_EQ(DeskUpBackendInterface::removeWorkspace("reclaimWS"), 1);
+
+    // Gone as soon as removeWorkspace returns, even if not deleted yet
+    EXPECT_FALSE(DeskUpBackendInterface::existsWorkspace("reclaimWS"));
+    EXPECT_TRUE(DeskUpBackendInterface::listWorkspaces().empty());
+    EXPECT_TRUE(DeskUpBackendInterface::findCorruptedWorkspaces().empty());
+
+    current_workspace_reclaimer->drain();
+    EXPECT_TRUE(fs::is_empty(DESKUPDIR));
+
+    current_workspace_reclaimer.reset();
+}
+
+TEST_F(DeskUpBackendInterfaceTest, IsWorkspaceValid_RejectsRetiredNames){
+    EXPECT_FALSE(DeskUpBackendInterface::isWorkspaceValid(std::string(DeskUp::Workspace::RETIRED_PREFIX) + "ws"));
+    EXPECT_TRUE(DeskUpBackendInterface::isWorkspaceValid(".hiddenWorkspace"));
+}
+
+// Same as DeskUpBackendInterfaceTest, with a workspace store installed as DU_Init would
+class DeskUpWorkspaceStoreTest : public DeskUpBackendInterfaceTest {
+protected:
+    void SetUp() override {
+        DeskUpBackendInterfaceTest::SetUp();
+
+        auto store = DeskUp::Workspace::WorkspaceStore::open(std::filesystem::path(DESKUPDIR) / DeskUp::Workspace::STORE_FILE_NAME);
+        ASSERT_TRUE(store.has_value()) << store.error().what();
+        current_workspace_store = std::make_unique<DeskUp::Workspace::WorkspaceStore>(std::move(store.value()));
+    }
+
+    void TearDown() override {
+        current_workspace_store.reset();
+        DeskUpBackendInterfaceTest::TearDown();
+    }
+};
+
+TEST_F(DeskUpWorkspaceStoreTest, SaveExistsListRemove){
+    namespace fs = std::filesystem;
+
+    EXPECT_FALSE(DeskUpBackendInterface::existsWorkspace("storeWS"));
+
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("storeWS").has_value());
+    current_window_backend->streamOpenWindows = nullptr;
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("otherWS").has_value());
+
+    // No directory is created for them
+    EXPECT_FALSE(fs::exists(fs::path(DESKUPDIR) / "storeWS"));
+
+    EXPECT_TRUE(DeskUpBackendInterface::existsWorkspace("storeWS"));
+    EXPECT_EQ(DeskUpBackendInterface::listWorkspaces(), (std::vector<std::string>{"otherWS", "storeWS"}));
+
+    EXPECT_EQ(DeskUpBackendInterface::removeWorkspace("storeWS"), 1);
+    EXPECT_EQ(DeskUpBackendInterface::removeWorkspace("storeWS"), 0);
+    EXPECT_FALSE(DeskUpBackendInterface::existsWorkspace("storeWS"));
+    EXPECT_EQ(DeskUpBackendInterface::listWorkspaces(), std::vector<std::string>{"otherWS"});
+}
+
+TEST_F(DeskUpWorkspaceStoreTest, AsyncSaveWhileListing){
+    auto* data = GetData();
+
+    data->windows.clear();
+    for (int i = 0; i < 500; ++i) {
+        data->windows.push_back(windowDesc{"w" + std::to_string(i), i, i, 100, 100, "app" + std::to_string(i % 7) + ".exe"});
+    }
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("listedWS").has_value());
+
+    // The GUI keeps reading the store while the save appends to it from its own thread
+    auto op = DeskUpBackendInterface::saveAllWindowsLocalAsync("asyncStoreWS");
+    while (!op.ready()) {
+        EXPECT_TRUE(DeskUpBackendInterface::existsWorkspace("listedWS"));
+        EXPECT_FALSE(DeskUpBackendInterface::listWorkspaces().empty());
+    }
+
+    auto saved = op.get();
+    ASSERT_TRUE(saved.has_value()) << saved.error().what();
+    EXPECT_EQ(DeskUpBackendInterface::listWorkspaces(), (std::vector<std::string>{"asyncStoreWS", "listedWS"}));
+    EXPECT_TRUE(DeskUpBackendInterface::verifyWorkspace("asyncStoreWS").has_value());
+}
+
+TEST_F(DeskUpWorkspaceStoreTest, SaveProgressCanReadTheStore){
+    namespace fs = std::filesystem;
+    auto* data = GetData();
+
+    data->windows.clear();
+    for (int i = 0; i < 20; ++i) {
+        data->windows.push_back(windowDesc{"w" + std::to_string(i), i, i, 100, 100, "app" + std::to_string(i) + ".exe"});
+    }
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("listedWS").has_value());
+
+    // The store isn't locked while the windows are enumerated, so the caller can keep reading it meanwhile
+    std::size_t notified = 0;
+    auto saved = DeskUpBackendInterface::saveAllWindowsLocalAsync("progressStoreWS", [&](const DeskUp::Async::Progress&) {
+        EXPECT_TRUE(DeskUpBackendInterface::existsWorkspace("listedWS"));
+        EXPECT_EQ(DeskUpBackendInterface::listWorkspaces().size(), 1u);
+        notified++;
+    }).get();
+    ASSERT_TRUE(saved.has_value()) << saved.error().what();
+    EXPECT_EQ(notified, 20u);
+    EXPECT_EQ(DeskUpBackendInterface::listWorkspaces(), (std::vector<std::string>{"listedWS", "progressStoreWS"}));
+
+    // The manifest streamed next to the log is gone once appended
+    for (const auto& entry : fs::directory_iterator(current_workspace_store->file().parent_path())) {
+        EXPECT_NE(entry.path().extension(), DeskUp::Workspace::ATOMIC_WRITE_SUFFIX) << entry.path();
+    }
+}
+
+TEST_F(DeskUpWorkspaceStoreTest, RestoreWindows){
+    auto* data = GetData();
+
+    data->windows.clear();
+    data->windows.push_back(windowDesc{"Saved", 11, 22, 333, 444, "saved.exe"});
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("restoreStoreWS").has_value());
+
+    auto status = DeskUpBackendInterface::restoreWindows("restoreStoreWS");
+    ASSERT_TRUE(status.has_value()) << status.error().what();
+    EXPECT_EQ(data->path, "saved.exe");
+    EXPECT_EQ(data->x, 11);
+    EXPECT_EQ(data->h, 444u);
+
+    auto missing = DeskUpBackendInterface::restoreWindows("missingStoreWS");
+    ASSERT_FALSE(missing.has_value());
+    EXPECT_EQ(missing.error().type(), DeskUp::ErrType::InvalidInput);
+}
+
+TEST_F(DeskUpWorkspaceStoreTest, RestoreWindows_CachesPlanUntilWorkspaceChanges){
+    namespace fs = std::filesystem;
+    auto* data = GetData();
+
+    data->windows.clear();
+    data->windows.push_back(windowDesc{"Stored", 10, 20, 300, 200, "stored.exe"});
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("plannedStoreWS").has_value());
+
+    fs::path file = fs::path(DESKUPDIR) / (std::string(DeskUp::Restore::RESTORE_PLAN_PREFIX) + "plannedStoreWS");
+    ASSERT_TRUE(DeskUpBackendInterface::restoreWindows("plannedStoreWS").has_value());
+
+    // The header of the entry is enough to pick the cached plan
+    auto plan = DeskUp::Restore::readPlan(file);
+    ASSERT_TRUE(plan.has_value()) << plan.error().what();
+    plan->windows[0].w = 555;
+    ASSERT_TRUE(DeskUp::Restore::writePlan(file, plan.value()).has_value());
+    ASSERT_TRUE(DeskUpBackendInterface::restoreWindows("plannedStoreWS").has_value());
+    EXPECT_EQ(data->w, 555u);
+
+    data->windows[0].w = 640;
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("plannedStoreWS").has_value());
+    ASSERT_TRUE(DeskUpBackendInterface::restoreWindows("plannedStoreWS").has_value());
+    EXPECT_EQ(data->w, 640u);
+}
+
+TEST_F(DeskUpWorkspaceStoreTest, UpdateWorkspace_OnlyAppendsWhenChanged){
+    namespace fs = std::filesystem;
+    auto* data = GetData();
+
+    data->windows.clear();
+    data->windows.push_back(windowDesc{"A", 1, 2, 300, 200, "a.exe"});
+    data->windows.push_back(windowDesc{"B", 3, 4, 500, 400, "b.exe"});
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("updateStoreWS").has_value());
+
+    const auto size = fs::file_size(current_workspace_store->file());
+
+    auto unchanged = DeskUpBackendInterface::updateWorkspace("updateStoreWS");
+    ASSERT_TRUE(unchanged.has_value());
+    EXPECT_EQ(unchanged.value(), 0u);
+    EXPECT_EQ(fs::file_size(current_workspace_store->file()), size);
+
+    data->windows[1].x = 900;
+
+    auto moved = DeskUpBackendInterface::updateWorkspace("updateStoreWS");
+    ASSERT_TRUE(moved.has_value());
+    EXPECT_EQ(moved.value(), 2u);
+
+    auto saved = DeskUp::Workspace::decodeManifest(current_workspace_store->get("updateStoreWS").value());
+    ASSERT_TRUE(saved.has_value());
+    EXPECT_EQ(saved.value()[1].x, 900);
+}
+
+TEST_F(DeskUpWorkspaceStoreTest, VerifyWorkspace){
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("intactStoreWS").has_value());
+
+    // A damaged manifest put in the store as it is
+    std::string damaged = DeskUp::Workspace::encodeManifest({windowDesc{"a", 1, 2, 3, 4, "a.exe"}});
+    damaged[sizeof(DeskUp::Workspace::ManifestHeader) + 2] ^= 0x01;
+    ASSERT_TRUE(current_workspace_store->put("damagedStoreWS", damaged).has_value());
+
+    EXPECT_TRUE(DeskUpBackendInterface::verifyWorkspace("intactStoreWS").has_value());
+
+    auto missing = DeskUpBackendInterface::verifyWorkspace("missingStoreWS");
+    ASSERT_FALSE(missing.has_value());
+    EXPECT_EQ(missing.error().type(), DeskUp::ErrType::InvalidInput);
+
+    auto corrupted = DeskUpBackendInterface::findCorruptedWorkspaces();
+    ASSERT_EQ(corrupted.size(), 1u);
+    EXPECT_EQ(corrupted[0].first, "damagedStoreWS");
+    EXPECT_EQ(corrupted[0].second.type(), DeskUp::ErrType::CorruptedData);
+}
+
+TEST_F(DeskUpWorkspaceStoreTest, ReplaceWorkspace){
+    auto* data = GetData();
+
+    data->windows.clear();
+    data->windows.push_back(windowDesc{"Old", 1, 2, 3, 4, "old.exe"});
+    ASSERT_TRUE(DeskUpBackendInterface::saveAllWindowsLocal("replaceStoreWS").has_value());
+
+    data->windows[0] = windowDesc{"New", 5, 6, 7, 8, "new.exe"};
+    ASSERT_TRUE(DeskUpBackendInterface::replaceWorkspace("replaceStoreWS").has_value());
+
+    auto saved = DeskUp::Workspace::decodeManifest(current_workspace_store->get("replaceStoreWS").value());
+    ASSERT_TRUE(saved.has_value());
+    ASSERT_EQ(saved.value().size(), 1u);
+    EXPECT_EQ(saved.value()[0].pathToExec, std::filesystem::path("new.exe"));
+}
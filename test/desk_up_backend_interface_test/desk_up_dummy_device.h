@@ -31,6 +31,13 @@
 #include <vector>
 #include <string>
 #include <filesystem>
+#include <functional>
+#include <map>
+#include <deque>
+#include <algorithm>
+#include <mutex>
+#include <chrono>
+#include <thread>
 
 #include "desk_up_window_device.h"
 #include "window_desc.h"
@@ -43,40 +50,93 @@ struct DummyDeviceData {
     unsigned int h = 600;
     std::string path = "/dummy/test.exe";
     std::vector<windowDesc> windows;
+    // Windows opened by launches. Handles of the dummy point to the windowDesc of their window, these or the ones in windows
+    std::deque<windowDesc> launched;
 	bool forceNonEmpty = true;
     bool simulateError = false;
     DeskUp::Error errorToReturn = {DeskUp::Level::Fatal, DeskUp::ErrType::Default, 0, "Dummy error"};
+
+    // Simulated startup time of each app, by executable path, spent inside loadWindowFromPath
+    std::map<std::string, std::chrono::milliseconds> launchLatency;
+    // Windows each launch of an app opens, by executable path. Apps not listed open one
+    std::map<std::string, std::size_t> windowsPerLaunch;
+    // Restores call the device from several threads at once
+    std::mutex mutex;
+    int closeCalls = 0;
+    int batchCloseCalls = 0;
+    // allowForce of the last batched close
+    bool lastBatchForced = false;
+    int selectCalls = 0;
+    int placeCalls = 0;
+    int layoutCalls = 0;
+    std::vector<fs::path> closedPaths;
+    int loadCalls = 0;
+    // Executables in the order their launches started, and the budget each budgeted launch was given
+    std::vector<std::string> launchOrder;
+    std::map<std::string, std::chrono::milliseconds> budgets;
+    int resizeCalls = 0;
+    int activeLoads = 0;
+    int maxActiveLoads = 0;
 };
 
 // Stub function implementations
-inline DeskUp::Result<unsigned int> DUMMY_getWindowHeight(DeskUpWindowDevice* _this) {
+inline DeskUp::Result<windowGeometry> DUMMY_getWindowGeometry(DeskUpWindowDevice* _this, windowHandle window) {
     auto* data = static_cast<DummyDeviceData*>(_this->internalData);
     if (data->simulateError) return std::unexpected(data->errorToReturn);
-    return data->h;
+
+    const auto* w = static_cast<const windowDesc*>(window);
+    if (!w) return std::unexpected(DeskUp::Error(DeskUp::Level::Skip, DeskUp::ErrType::InvalidInput, 0, "No window"));
+
+    // Resizes from other threads write the same windowDesc
+    std::lock_guard lock(data->mutex);
+    return windowGeometry{w->x, w->y, static_cast<unsigned int>(w->w), static_cast<unsigned int>(w->h)};
 }
 
-inline DeskUp::Result<unsigned int> DUMMY_getWindowWidth(DeskUpWindowDevice* _this) {
-    auto* data = static_cast<DummyDeviceData*>(_this->internalData);
-    if (data->simulateError) return std::unexpected(data->errorToReturn);
-    return data->w;
+inline DeskUp::Result<unsigned int> DUMMY_getWindowHeight(DeskUpWindowDevice* _this, windowHandle window) {
+    auto geometry = DUMMY_getWindowGeometry(_this, window);
+    if (!geometry.has_value()) return std::unexpected(std::move(geometry.error()));
+    return geometry->h;
 }
 
-inline DeskUp::Result<int> DUMMY_getWindowXPos(DeskUpWindowDevice* _this) {
-    auto* data = static_cast<DummyDeviceData*>(_this->internalData);
-    if (data->simulateError) return std::unexpected(data->errorToReturn);
-    return data->x;
+inline DeskUp::Result<unsigned int> DUMMY_getWindowWidth(DeskUpWindowDevice* _this, windowHandle window) {
+    auto geometry = DUMMY_getWindowGeometry(_this, window);
+    if (!geometry.has_value()) return std::unexpected(std::move(geometry.error()));
+    return geometry->w;
+}
+
+inline DeskUp::Result<int> DUMMY_getWindowXPos(DeskUpWindowDevice* _this, windowHandle window) {
+    auto geometry = DUMMY_getWindowGeometry(_this, window);
+    if (!geometry.has_value()) return std::unexpected(std::move(geometry.error()));
+    return geometry->x;
+}
+
+inline DeskUp::Result<int> DUMMY_getWindowYPos(DeskUpWindowDevice* _this, windowHandle window) {
+    auto geometry = DUMMY_getWindowGeometry(_this, window);
+    if (!geometry.has_value()) return std::unexpected(std::move(geometry.error()));
+    return geometry->y;
 }
 
-inline DeskUp::Result<int> DUMMY_getWindowYPos(DeskUpWindowDevice* _this) {
+inline DeskUp::Result<std::vector<std::optional<windowGeometry>>> DUMMY_getWindowsGeometry(DeskUpWindowDevice* _this, const std::vector<windowHandle>& windows) {
     auto* data = static_cast<DummyDeviceData*>(_this->internalData);
     if (data->simulateError) return std::unexpected(data->errorToReturn);
-    return data->y;
+
+    std::lock_guard lock(data->mutex);
+    std::vector<std::optional<windowGeometry>> geometries;
+    for (windowHandle handle : windows) {
+        const auto* w = static_cast<const windowDesc*>(handle);
+        if (w) geometries.push_back(windowGeometry{w->x, w->y, static_cast<unsigned int>(w->w), static_cast<unsigned int>(w->h)});
+        else geometries.push_back(std::nullopt);
+    }
+    return geometries;
 }
 
-inline DeskUp::Result<fs::path> DUMMY_getPathFromWindow(DeskUpWindowDevice* _this) {
+inline DeskUp::Result<fs::path> DUMMY_getPathFromWindow(DeskUpWindowDevice* _this, windowHandle window) {
     auto* data = static_cast<DummyDeviceData*>(_this->internalData);
     if (data->simulateError) return std::unexpected(data->errorToReturn);
-    return fs::path(data->path);
+
+    const auto* w = static_cast<const windowDesc*>(window);
+    if (!w) return std::unexpected(DeskUp::Error(DeskUp::Level::Skip, DeskUp::ErrType::InvalidInput, 0, "No window"));
+    return w->pathToExec;
 }
 
 inline DeskUp::Result<std::string> DUMMY_getDeskUpPath() {
@@ -107,7 +167,24 @@ inline DeskUp::Result<std::vector<windowDesc>> DUMMY_getAllOpenWindows(DeskUpWin
     return data->windows;
 }
 
-inline DeskUp::Status DUMMY_loadWindowFromPath(DeskUpWindowDevice* _this, const fs::path& path) {
+inline DeskUp::Status DUMMY_streamOpenWindows(DeskUpWindowDevice* _this, const std::function<DeskUp::Status(windowDesc&&)>& sink) {
+    auto* data = static_cast<DummyDeviceData*>(_this->internalData);
+    if (data->simulateError) return std::unexpected(data->errorToReturn);
+    // Same windows as DUMMY_getAllOpenWindows, handed over one at a time
+    auto windows = DUMMY_getAllOpenWindows(_this);
+    for (auto& w : windows.value()) {
+        if (auto res = sink(std::move(w)); !res.has_value()) return res;
+    }
+    return {};
+}
+
+inline DeskUp::Result<windowHandle> DUMMY_loadWindowFromPathWithin(DeskUpWindowDevice* _this, const fs::path& path, std::chrono::milliseconds budget);
+
+inline DeskUp::Result<windowHandle> DUMMY_loadWindowFromPath(DeskUpWindowDevice* _this, const fs::path& path) {
+    return DUMMY_loadWindowFromPathWithin(_this, path, std::chrono::milliseconds::max());
+}
+
+inline DeskUp::Result<windowHandle> DUMMY_loadWindowFromPathWithin(DeskUpWindowDevice* _this, const fs::path& path, std::chrono::milliseconds budget) {
     auto* data = static_cast<DummyDeviceData*>(_this->internalData);
     if (data->simulateError) return std::unexpected(data->errorToReturn);
     if (path.empty()) {
@@ -115,8 +192,30 @@ inline DeskUp::Status DUMMY_loadWindowFromPath(DeskUpWindowDevice* _this, const
             DeskUp::Level::Fatal, DeskUp::ErrType::InvalidInput, 0, "Empty path"
         ));
     }
+
+    std::chrono::milliseconds latency{0};
+    {
+        std::lock_guard lock(data->mutex);
+        data->loadCalls++;
+        data->maxActiveLoads = std::max(data->maxActiveLoads, ++data->activeLoads);
+        data->launchOrder.push_back(path.string());
+        if (budget != std::chrono::milliseconds::max()) data->budgets[path.string()] = budget;
+        if (auto it = data->launchLatency.find(path.string()); it != data->launchLatency.end()) latency = it->second;
+    }
+
+    // The app "starts up" without holding the lock, like a real launch
+    std::this_thread::sleep_for(std::min(latency, budget));
+
+    std::lock_guard lock(data->mutex);
+    data->activeLoads--;
+    if (latency > budget) {
+        return std::unexpected(DeskUp::Error(DeskUp::Level::Retry, DeskUp::ErrType::Timeout, 0, "Budget ran out"));
+    }
     data->path = path.string();
-    return {};
+
+    // The app opens its window wherever the device's geometry is
+    data->launched.push_back(windowDesc{path.stem().string(), data->x, data->y, static_cast<int>(data->w), static_cast<int>(data->h), path.string()});
+    return static_cast<windowHandle>(&data->launched.back());
 }
 
 inline DeskUp::Result<windowDesc> DUMMY_recoverSavedWindow(DeskUpWindowDevice* _this, const fs::path& filePath) {
@@ -133,15 +232,22 @@ inline DeskUp::Result<windowDesc> DUMMY_recoverSavedWindow(DeskUpWindowDevice* _
     return windowDesc{"DummyApp", data->x, data->y, data->w, data->h, data->path};
 }
 
-inline DeskUp::Status DUMMY_resizeWindow(DeskUpWindowDevice* _this, const windowDesc window) {
+inline DeskUp::Status DUMMY_resizeWindow(DeskUpWindowDevice* _this, windowHandle window, const windowDesc geometry) {
     auto* data = static_cast<DummyDeviceData*>(_this->internalData);
     if (data->simulateError) return std::unexpected(data->errorToReturn);
 
-    // Update internal state
-    data->x = window.x;
-    data->y = window.y;
-    data->w = window.w;
-    data->h = window.h;
+    auto* w = static_cast<windowDesc*>(window);
+    if (!w) return std::unexpected(DeskUp::Error(DeskUp::Level::Skip, DeskUp::ErrType::InvalidInput, 0, "No window"));
+
+    // Move the window, and keep its geometry as the device's last placed one
+    std::lock_guard lock(data->mutex);
+    data->resizeCalls++;
+    w->x = data->x = geometry.x;
+    w->y = data->y = geometry.y;
+    w->w = geometry.w;
+    w->h = geometry.h;
+    data->w = geometry.w;
+    data->h = geometry.h;
     return {};
 }
 
@@ -156,9 +262,97 @@ inline DeskUp::Result<unsigned int> DUMMY_closeProcessFromPath(DeskUpWindowDevic
     }
 
     // Simulate closing processes (return a dummy count)
+    std::lock_guard lock(data->mutex);
+    data->closeCalls++;
     return 1u;
 }
 
+inline DeskUp::Result<unsigned int> DUMMY_closeProcessesFromPaths(DeskUpWindowDevice* _this, const std::vector<fs::path>& paths, bool allowForce) {
+    auto* data = static_cast<DummyDeviceData*>(_this->internalData);
+    if (data->simulateError) return std::unexpected(data->errorToReturn);
+
+    std::lock_guard lock(data->mutex);
+    data->batchCloseCalls++;
+    data->lastBatchForced = allowForce;
+    data->closedPaths.insert(data->closedPaths.end(), paths.begin(), paths.end());
+    return static_cast<unsigned int>(paths.size());
+}
+
+inline DeskUp::Result<std::size_t> DUMMY_placeLaunchedWindows(DeskUpWindowDevice* _this, windowHandle launched, const std::vector<windowDesc>& windows, std::chrono::milliseconds) {
+    auto* data = static_cast<DummyDeviceData*>(_this->internalData);
+    if (data->simulateError) return std::unexpected(data->errorToReturn);
+
+    auto* first = static_cast<windowDesc*>(launched);
+    if (!first) return std::size_t{0};
+
+    // The launched app opens its windows right away, so there is never anything to wait for
+    std::lock_guard lock(data->mutex);
+    data->placeCalls++;
+    std::size_t opened = 1;
+    if (auto it = data->windowsPerLaunch.find(first->pathToExec.string()); it != data->windowsPerLaunch.end()) opened = it->second;
+
+    std::size_t placed = std::min(opened, windows.size());
+    for (std::size_t i = 0; i < placed; ++i) {
+        // The first geometry goes to the launched window, the others to the windows the app opens after it
+        if (i > 0) data->launched.push_back(*first);
+        windowDesc& w = i == 0 ? *first : data->launched.back();
+        w.x = windows[i].x;
+        w.y = windows[i].y;
+        w.w = windows[i].w;
+        w.h = windows[i].h;
+
+        data->resizeCalls++;
+        data->x = windows[i].x;
+        data->y = windows[i].y;
+        data->w = windows[i].w;
+        data->h = windows[i].h;
+    }
+    return placed;
+}
+
+inline DeskUp::Result<std::vector<DeskUp::Status>> DUMMY_applyLayout(DeskUpWindowDevice* _this, std::span<const windowPlacement> placements) {
+    auto* data = static_cast<DummyDeviceData*>(_this->internalData);
+    if (data->simulateError) return std::unexpected(data->errorToReturn);
+
+    // The whole layout is applied under a single lock, as one transaction
+    std::lock_guard lock(data->mutex);
+    data->layoutCalls++;
+
+    std::vector<DeskUp::Status> results(placements.size());
+    for (std::size_t i = 0; i < placements.size(); ++i) {
+        auto* w = static_cast<windowDesc*>(placements[i].window);
+        if (!w) {
+            results[i] = std::unexpected(DeskUp::Error(DeskUp::Level::Skip, DeskUp::ErrType::InvalidInput, 0, "No window"));
+            continue;
+        }
+
+        const auto& geometry = placements[i].geometry;
+        data->resizeCalls++;
+        w->x = data->x = geometry.x;
+        w->y = data->y = geometry.y;
+        w->w = static_cast<int>(geometry.w);
+        w->h = static_cast<int>(geometry.h);
+        data->w = geometry.w;
+        data->h = geometry.h;
+    }
+    return results;
+}
+
+inline DeskUp::Result<windowHandle> DUMMY_selectOpenWindow(DeskUpWindowDevice* _this, const windowDesc& window) {
+    auto* data = static_cast<DummyDeviceData*>(_this->internalData);
+    if (data->simulateError) return std::unexpected(data->errorToReturn);
+
+    // The open windows are the ones getAllOpenWindows returns
+    std::lock_guard lock(data->mutex);
+    data->selectCalls++;
+    for (auto& w : data->windows) {
+        if (w.pathToExec == window.pathToExec && w.x == window.x && w.y == window.y && w.w == window.w && w.h == window.h) {
+            return static_cast<windowHandle>(&w);
+        }
+    }
+    return std::unexpected(DeskUp::Error(DeskUp::Level::Skip, DeskUp::ErrType::NotFound, 0, "No such open window"));
+}
+
 /**
  * @brief Creates a dummy device for testing
  */
@@ -169,13 +363,26 @@ inline DeskUpWindowDevice DUMMY_CreateDevice() {
     device.getWindowWidth = DUMMY_getWindowWidth;
     device.getWindowXPos = DUMMY_getWindowXPos;
     device.getWindowYPos = DUMMY_getWindowYPos;
+    device.getWindowGeometry = DUMMY_getWindowGeometry;
+    device.getWindowsGeometry = DUMMY_getWindowsGeometry;
     device.getPathFromWindow = DUMMY_getPathFromWindow;
     device.getDeskUpPath = DUMMY_getDeskUpPath;
     device.getAllOpenWindows = DUMMY_getAllOpenWindows;
+    device.streamOpenWindows = DUMMY_streamOpenWindows;
     device.loadWindowFromPath = DUMMY_loadWindowFromPath;
+    device.loadWindowFromPathWithin = DUMMY_loadWindowFromPathWithin;
     device.recoverSavedWindow = DUMMY_recoverSavedWindow;
     device.resizeWindow = DUMMY_resizeWindow;
     device.closeProcessFromPath = DUMMY_closeProcessFromPath;
+    device.closeProcessesFromPaths = DUMMY_closeProcessesFromPaths;
+    device.selectOpenWindow = DUMMY_selectOpenWindow;
+    device.placeLaunchedWindows = DUMMY_placeLaunchedWindows;
+    device.applyLayout = DUMMY_applyLayout;
+
+    // The dummy implements every capability, and tests remove the ones they don't want
+    device.capabilities = DeviceCapability::BatchQueries | DeviceCapability::StreamedEnumeration | DeviceCapability::BatchClose
+        | DeviceCapability::BudgetedLaunch | DeviceCapability::OpenWindowSelection | DeviceCapability::LaunchedWindowPlacement
+        | DeviceCapability::BatchPlacement | DeviceCapability::ConcurrentCalls;
 
     device.internalData = new DummyDeviceData();
 
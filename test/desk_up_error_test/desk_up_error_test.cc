@@ -59,6 +59,7 @@ std::vector<ErrType> r = {
         ErrType::ProtocolError,
         ErrType::Unexpected,
         ErrType::NotImplemented,
+        ErrType::Cancelled,
         ErrType::Default,
         ErrType::None
     };
@@ -218,6 +219,46 @@ TEST(DeskUpErrorTest, fromSaveErrorMapping){
     }
 }
 
+// fromLoadError mapping tests.
+TEST(DeskUpErrorTest, fromLoadErrorMapping){
+    // Success code 1
+    {
+        Error e = Error::fromLoadError(1);
+        EXPECT_EQ(e.level(), Level::Info);
+        EXPECT_EQ(e.type(), ErrType::None);
+    }
+    // ERR_LOAD_NO_FILE -1 and ERR_LOAD_INCOMPLETE -3
+    for(int code : {-1, -3}){
+        Error e = Error::fromLoadError(code);
+        EXPECT_EQ(e.level(), Level::Fatal);
+        EXPECT_EQ(e.type(), ErrType::InvalidInput);
+    }
+    // ERR_LOAD_FILE_NOT_OPEN -2
+    {
+        Error e = Error::fromLoadError(-2);
+        EXPECT_EQ(e.level(), Level::Skip);
+        EXPECT_EQ(e.type(), ErrType::Io);
+    }
+    // ERR_LOAD_INVALID_X..H -4..-7
+    for(int code = -4; code >= -7; code--){
+        Error e = Error::fromLoadError(code);
+        EXPECT_EQ(e.level(), Level::Retry);
+        EXPECT_EQ(e.type(), ErrType::InvalidInput);
+    }
+    // ERR_LOAD_UNSUPPORTED_VERSION -8
+    {
+        Error e = Error::fromLoadError(-8);
+        EXPECT_EQ(e.level(), Level::Error);
+        EXPECT_EQ(e.type(), ErrType::InvalidFormat);
+    }
+    // Unrecognized code e.g. 42
+    {
+        Error e = Error::fromLoadError(42);
+        EXPECT_EQ(e.level(), Level::Warning);
+        EXPECT_EQ(e.type(), ErrType::Default);
+    }
+}
+
 #include <filesystem>
 namespace {
     std::filesystem::path tempTestDir(){
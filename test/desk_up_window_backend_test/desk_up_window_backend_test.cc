@@ -5,9 +5,25 @@
 #include <chrono>
 #include <vector>
 #include <string>
+#include <sstream>
+#include <cstring>
+#include <cstddef>
+#include <climits>
+#include <optional>
+#include <iterator>
+#include <atomic>
 
 #include "window_desc.h"
+#include "window_desc_loader.h"
+#include "window_desc_schema.h"
 #include "backend_utils.h"
+#include "workspace_manifest.h"
+#include "mapped_workspace.h"
+#include "bounded_queue.h"
+#include "crc32c.h"
+#include "workspace_store.h"
+#include "workspace_writer.h"
+#include "workspace_reclaimer.h"
 
 #ifdef _WIN32
 #include "window_backends/desk_up_win/desk_up_win.h"
@@ -96,6 +112,149 @@ TEST(DeskUpWindowBackend_windowDesc, SaveToSuccess){
     EXPECT_FALSE(std::getline(in, line));
 }
 
+// =========================
+// windowDescLoader tests
+// =========================
+
+TEST(DeskUpWindowBackend_windowDescLoader, ParseSuccess){
+    windowDesc wd;
+    ASSERT_EQ(windowDescLoader::parse("C:/Apps/editor.exe\n10\n-20\n640\n480", wd), LOAD_SUCCESS);
+    EXPECT_EQ(wd.pathToExec, fs::path("C:/Apps/editor.exe"));
+    EXPECT_EQ(wd.name, "editor");
+    EXPECT_EQ(wd.x, 10);
+    EXPECT_EQ(wd.y, -20);
+    EXPECT_EQ(wd.w, 640);
+    EXPECT_EQ(wd.h, 480);
+}
+
+TEST(DeskUpWindowBackend_windowDescLoader, ParseCRLFAndTrailingLines){
+    windowDesc wd;
+    ASSERT_EQ(windowDescLoader::parse("app.exe\r\n1\r\n2\r\n3\r\n4\r\nextra\r\n", wd), LOAD_SUCCESS);
+    EXPECT_EQ(wd.pathToExec, fs::path("app.exe"));
+    EXPECT_EQ(wd.h, 4);
+}
+
+TEST(DeskUpWindowBackend_windowDescLoader, ParseQuotedPath){
+    // operator<< on fs::path quotes the path and escapes backslashes and quotes, exactly as saveTo() does
+    fs::path original("C:\\Program Files\\\"Quoted\"\\app.exe");
+    std::ostringstream os;
+    os << original << "\n1\n2\n3\n4";
+
+    windowDesc wd;
+    ASSERT_EQ(windowDescLoader::parse(os.str(), wd), LOAD_SUCCESS);
+    EXPECT_EQ(wd.pathToExec, original);
+}
+
+TEST(DeskUpWindowBackend_windowDescLoader, ParseErrors){
+    windowDesc wd;
+    wd.x = 99;
+    EXPECT_EQ(windowDescLoader::parse("", wd), ERR_LOAD_INCOMPLETE);
+    EXPECT_EQ(windowDescLoader::parse("a.exe\n1\n2\n3", wd), ERR_LOAD_INCOMPLETE);
+    EXPECT_EQ(windowDescLoader::parse("a.exe\nnot-an-int\n2\n3\n4", wd), ERR_LOAD_INVALID_X);
+    EXPECT_EQ(windowDescLoader::parse("a.exe\n1\n 2\n3\n4", wd), ERR_LOAD_INVALID_Y);
+    EXPECT_EQ(windowDescLoader::parse("a.exe\n1\n2\n-1\n4", wd), ERR_LOAD_INVALID_W);
+    EXPECT_EQ(windowDescLoader::parse("a.exe\n1\n2\n3\n4px", wd), ERR_LOAD_INVALID_H);
+    EXPECT_EQ(windowDescLoader::parse("a.exe\n1\n2\n3\n99999999999", wd), ERR_LOAD_INVALID_H);
+
+    // A failed parse leaves the output untouched
+    EXPECT_EQ(wd.x, 99);
+}
+
+TEST(DeskUpWindowBackend_windowDescLoader, LoadWhatSaveToWrites){
+    auto dir = makeTempDir("loader_roundtrip");
+    fs::path file = dir / "win.txt";
+
+    windowDesc saved("Ignored", 5, 6, 700, 500, "C:/Some Dir/app.exe");
+    ASSERT_EQ(saved.saveTo(file), SAVE_SUCCESS);
+
+    windowDescLoader loader;
+    windowDesc wd;
+    ASSERT_EQ(loader.load(file, wd), LOAD_SUCCESS);
+    EXPECT_EQ(wd.pathToExec, saved.pathToExec);
+    EXPECT_EQ(wd.name, "app");
+    EXPECT_EQ(wd.x, 5);
+    EXPECT_EQ(wd.y, 6);
+    EXPECT_EQ(wd.w, 700);
+    EXPECT_EQ(wd.h, 500);
+
+    fs::remove_all(dir);
+}
+
+TEST(DeskUpWindowBackend_windowDescLoader, LoadMissingFile){
+    windowDescLoader loader;
+    windowDesc wd;
+    EXPECT_EQ(loader.load(makeTempDir("loader_missing") / "nope.txt", wd), ERR_LOAD_NO_FILE);
+}
+
+TEST(DeskUpWindowBackend_windowDescLoader, LoadManyDirectory){
+    auto dir = makeTempDir("loader_many");
+    fs::remove_all(dir);
+    fs::create_directories(dir / "subdir");
+
+    for(int i = 0; i < 4; i++){
+        std::ofstream((dir / ("w" + std::to_string(i))).string()) << "app" << i << ".exe\n" << i << "\n0\n10\n10";
+    }
+
+    windowDescLoader loader;
+    std::vector<windowDesc> windows;
+    ASSERT_EQ(loader.loadMany(dir, windows), LOAD_SUCCESS);
+    EXPECT_EQ(windows.size(), 4u);
+
+    // A broken file stops the batch and is reported
+    std::ofstream((dir / "broken").string()) << "app.exe\n1";
+
+    windows.clear();
+    fs::path failed;
+    EXPECT_EQ(loader.loadMany(dir, windows, &failed), ERR_LOAD_INCOMPLETE);
+    EXPECT_EQ(failed.filename(), "broken");
+
+    EXPECT_EQ(loader.loadMany(dir / "missing", windows), ERR_LOAD_NO_FILE);
+
+    fs::remove_all(dir);
+}
+
+// =========================
+// windowDescSchema tests
+// =========================
+
+TEST(DeskUpWindowBackend_windowDescSchema, WritesLegacyLayout){
+    windowDesc wd("Calc", 11, -22, 333, 444, "/usr/bin/calc");
+    std::string out;
+    windowDescSchema::write(wd, out);
+    EXPECT_EQ(out, "/usr/bin/calc\n11\n-22\n333\n444");
+}
+
+TEST(DeskUpWindowBackend_windowDescSchema, WriteAppendsAndRoundtrips){
+    windowDesc wd("Ignored", INT_MIN, INT_MAX, 0, 1, "C:/Program Files/App/app.exe");
+    std::string out = "keep";
+    windowDescSchema::write(wd, out);
+    ASSERT_EQ(out.substr(0, 4), "keep");
+
+    windowDesc back;
+    ASSERT_EQ(windowDescSchema::parse(std::string_view(out).substr(4), back), LOAD_SUCCESS);
+    EXPECT_EQ(back.pathToExec, wd.pathToExec);
+    EXPECT_EQ(back.name, "app");
+    EXPECT_EQ(back.x, INT_MIN);
+    EXPECT_EQ(back.y, INT_MAX);
+    EXPECT_EQ(back.w, 0);
+    EXPECT_EQ(back.h, 1);
+}
+
+TEST(DeskUpWindowBackend_windowDescSchema, VersionLine){
+    windowDesc wd;
+
+    // An explicit version line equal to the current version is accepted
+    std::string current = "#v" + std::to_string(windowDescSchema::CURRENT_VERSION) + "\na.exe\n1\n2\n3\n4";
+    EXPECT_EQ(windowDescSchema::parse(current, wd), LOAD_SUCCESS);
+    EXPECT_EQ(wd.h, 4);
+
+    // Files from a newer DeskUp are rejected instead of being misread
+    std::string newer = "#v" + std::to_string(windowDescSchema::CURRENT_VERSION + 1) + "\na.exe\n1\n2\n3\n4";
+    EXPECT_EQ(windowDescSchema::parse(newer, wd), ERR_LOAD_UNSUPPORTED_VERSION);
+
+    EXPECT_EQ(windowDescSchema::parse("#vx\na.exe\n1\n2\n3\n4", wd), ERR_LOAD_INCOMPLETE);
+}
+
 // =========================
 // backend_utils tests
 // =========================
@@ -117,6 +276,865 @@ TEST(DeskUpWindowBackend_backendUtils, NormalizePathLower){
     EXPECT_EQ(out2, "d:\\projects\\deskup\\assets\\icon.png");
 }
 
+// =========================
+// workspace_manifest tests
+// =========================
+
+static windowDesc makeWindow(const std::string& name, const fs::path& path, int x, int y, int w, int h){
+    windowDesc wd;
+    wd.name = name;
+    wd.pathToExec = path;
+    wd.x = x;
+    wd.y = y;
+    wd.w = w;
+    wd.h = h;
+    return wd;
+}
+
+TEST(DeskUpWindowBackend_workspaceManifest, RoundtripInMemory){
+    std::vector<windowDesc> windows = {
+        makeWindow("Editor", "C:/Apps/editor.exe", 10, 20, 800, 600),
+        makeWindow("Editor", "C:/Apps/editor.exe", -5, 0, 400, 300),
+        makeWindow("Caf\u00E9", "C:/Apps/caf\u00E9/app.exe", 1, 2, 3, 4)
+    };
+
+    std::string image = DeskUp::Workspace::encodeManifest(windows);
+    auto decoded = DeskUp::Workspace::decodeManifest(image);
+    ASSERT_TRUE(decoded.has_value()) << decoded.error().what();
+    ASSERT_EQ(decoded.value().size(), windows.size());
+
+    for(size_t i = 0; i < windows.size(); i++){
+        EXPECT_EQ(decoded.value()[i].name, windows[i].name);
+        EXPECT_EQ(decoded.value()[i].pathToExec, windows[i].pathToExec);
+        EXPECT_EQ(decoded.value()[i].x, windows[i].x);
+        EXPECT_EQ(decoded.value()[i].y, windows[i].y);
+        EXPECT_EQ(decoded.value()[i].w, windows[i].w);
+        EXPECT_EQ(decoded.value()[i].h, windows[i].h);
+    }
+}
+
+TEST(DeskUpWindowBackend_workspaceManifest, EqualStringsAreStoredOnce){
+    std::vector<windowDesc> one = { makeWindow("Term", "C:/term.exe", 0, 0, 1, 1) };
+    std::vector<windowDesc> three(3, one[0]);
+
+    std::string a = DeskUp::Workspace::encodeManifest(one);
+    std::string b = DeskUp::Workspace::encodeManifest(three);
+
+    // Only the two extra records are added, the strings are shared
+    EXPECT_EQ(b.size() - a.size(), 2 * sizeof(DeskUp::Workspace::ManifestRecord));
+}
+
+TEST(DeskUpWindowBackend_workspaceManifest, EmptyWorkspace){
+    std::string image = DeskUp::Workspace::encodeManifest({});
+    EXPECT_EQ(image.size(), sizeof(DeskUp::Workspace::ManifestHeader));
+
+    auto decoded = DeskUp::Workspace::decodeManifest(image);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_TRUE(decoded.value().empty());
+}
+
+TEST(DeskUpWindowBackend_workspaceManifest, RejectsBadMagic){
+    std::string image = DeskUp::Workspace::encodeManifest({ makeWindow("A", "a.exe", 0, 0, 1, 1) });
+    image[0] = 'X';
+
+    auto decoded = DeskUp::Workspace::decodeManifest(image);
+    ASSERT_FALSE(decoded.has_value());
+    EXPECT_EQ(decoded.error().type(), DeskUp::ErrType::InvalidFormat);
+}
+
+TEST(DeskUpWindowBackend_workspaceManifest, RejectsNewerVersion){
+    std::string image = DeskUp::Workspace::encodeManifest({ makeWindow("A", "a.exe", 0, 0, 1, 1) });
+    std::uint16_t version = DeskUp::Workspace::MANIFEST_VERSION + 1;
+    std::memcpy(image.data() + offsetof(DeskUp::Workspace::ManifestHeader, version), &version, sizeof(version));
+
+    auto decoded = DeskUp::Workspace::decodeManifest(image);
+    ASSERT_FALSE(decoded.has_value());
+    EXPECT_EQ(decoded.error().type(), DeskUp::ErrType::InvalidFormat);
+}
+
+TEST(DeskUpWindowBackend_workspaceManifest, RejectsTruncatedImage){
+    std::string image = DeskUp::Workspace::encodeManifest({ makeWindow("A", "a.exe", 0, 0, 1, 1) });
+
+    auto headerOnly = DeskUp::Workspace::decodeManifest(std::string_view(image).substr(0, 10));
+    ASSERT_FALSE(headerOnly.has_value());
+    EXPECT_EQ(headerOnly.error().type(), DeskUp::ErrType::CorruptedData);
+
+    auto cut = DeskUp::Workspace::decodeManifest(std::string_view(image).substr(0, image.size() - 1));
+    ASSERT_FALSE(cut.has_value());
+    EXPECT_EQ(cut.error().type(), DeskUp::ErrType::CorruptedData);
+}
+
+TEST(DeskUpWindowBackend_workspaceManifest, WriteAndReadFile){
+    fs::path dir = makeTempDir("manifest");
+    fs::path file = dir / DeskUp::Workspace::MANIFEST_FILE_NAME;
+
+    std::vector<windowDesc> windows = { makeWindow("A", "a.exe", 1, 2, 3, 4), makeWindow("B", "b.exe", 5, 6, 7, 8) };
+    auto st = DeskUp::Workspace::writeManifest(file, windows);
+    ASSERT_TRUE(st.has_value()) << st.error().what();
+
+    auto read = DeskUp::Workspace::readManifest(file);
+    ASSERT_TRUE(read.has_value()) << read.error().what();
+    ASSERT_EQ(read.value().size(), 2u);
+    EXPECT_EQ(read.value()[1].name, "B");
+    EXPECT_EQ(read.value()[1].h, 8);
+
+    fs::remove_all(dir);
+}
+
+TEST(DeskUpWindowBackend_workspaceManifest, ReadMissingFile){
+    auto read = DeskUp::Workspace::readManifest(makeTempDir("manifest_missing") / "nope.deskup");
+    ASSERT_FALSE(read.has_value());
+    EXPECT_EQ(read.error().type(), DeskUp::ErrType::FileNotFound);
+}
+
+TEST(DeskUpWindowBackend_workspaceManifest, ViewReadsRecordsInPlace){
+    std::vector<windowDesc> windows = { makeWindow("A", "a.exe", 1, 2, 3, 4), makeWindow("B", "dir/b.exe", -5, 6, 7, 8) };
+    std::string image = DeskUp::Workspace::encodeManifest(windows);
+
+    auto view = DeskUp::Workspace::WorkspaceView::fromBytes(image);
+    ASSERT_TRUE(view.has_value()) << view.error().what();
+    ASSERT_EQ(view.value().size(), 2u);
+
+    auto rec = view.value()[1];
+    EXPECT_EQ(rec.x(), -5);
+    EXPECT_EQ(rec.y(), 6);
+    EXPECT_EQ(rec.w(), 7);
+    EXPECT_EQ(rec.h(), 8);
+    EXPECT_EQ(rec.name(), "B");
+    EXPECT_EQ(rec.pathBytes(), "dir/b.exe");
+    EXPECT_EQ(rec.path(), fs::path("dir/b.exe"));
+
+    // Strings are slices of the image, not copies
+    EXPECT_GE(rec.name().data(), image.data());
+    EXPECT_LT(rec.name().data(), image.data() + image.size());
+
+    size_t count = 0;
+    for(const auto& r : view.value()){
+        EXPECT_EQ(r.toWindowDesc().name, windows[count].name);
+        ++count;
+    }
+    EXPECT_EQ(count, 2u);
+}
+
+TEST(DeskUpWindowBackend_workspaceManifest, ViewRejectsBadStringReference){
+    std::string image = DeskUp::Workspace::encodeManifest({ makeWindow("A", "a.exe", 0, 0, 1, 1) });
+    std::uint32_t huge = 0xFFFFu;
+    std::memcpy(image.data() + sizeof(DeskUp::Workspace::ManifestHeader) + offsetof(DeskUp::Workspace::ManifestRecord, nameLength), &huge, sizeof(huge));
+
+    auto view = DeskUp::Workspace::WorkspaceView::fromBytes(image);
+    ASSERT_FALSE(view.has_value());
+    EXPECT_EQ(view.error().type(), DeskUp::ErrType::CorruptedData);
+}
+
+TEST(DeskUpWindowBackend_workspaceManifest, MappedWorkspaceOpen){
+    fs::path dir = makeTempDir("mapped");
+    fs::path file = dir / DeskUp::Workspace::MANIFEST_FILE_NAME;
+
+    std::vector<windowDesc> windows = { makeWindow("A", "a.exe", 1, 2, 3, 4), makeWindow("B", "b.exe", 5, 6, 7, 8) };
+    ASSERT_TRUE(DeskUp::Workspace::writeManifest(file, windows).has_value());
+
+    {
+        auto mapped = DeskUp::Workspace::MappedWorkspace::open(file);
+        ASSERT_TRUE(mapped.has_value()) << mapped.error().what();
+        EXPECT_EQ(mapped.value().bytes().size(), fs::file_size(file));
+
+        // The mapping must survive being moved around
+        DeskUp::Workspace::MappedWorkspace moved = std::move(mapped.value());
+        ASSERT_EQ(moved.view().size(), 2u);
+        EXPECT_EQ(moved.view()[0].name(), "A");
+        EXPECT_EQ(moved.view()[1].h(), 8);
+    }
+
+    fs::remove_all(dir);
+}
+
+TEST(DeskUpWindowBackend_workspaceManifest, UpdateManifestPatchesChangedRecords){
+    fs::path dir = makeTempDir("manifest_update");
+    fs::path file = dir / DeskUp::Workspace::MANIFEST_FILE_NAME;
+    fs::remove(file);
+
+    std::vector<windowDesc> windows = {
+        makeWindow("A", "a.exe", 1, 2, 3, 4),
+        makeWindow("A", "a.exe", 5, 6, 7, 8),
+        makeWindow("B", "b.exe", 9, 10, 11, 12)
+    };
+
+    // Missing manifest: written from scratch
+    auto first = DeskUp::Workspace::updateManifest(file, windows);
+    ASSERT_TRUE(first.has_value()) << first.error().what();
+    EXPECT_TRUE(first.value().rewritten);
+    EXPECT_EQ(first.value().changed, 3u);
+
+    // Same windows in another order: nothing to write
+    std::vector<windowDesc> reordered = { windows[2], windows[0], windows[1] };
+    auto same = DeskUp::Workspace::updateManifest(file, reordered);
+    ASSERT_TRUE(same.has_value());
+    EXPECT_FALSE(same.value().rewritten);
+    EXPECT_EQ(same.value().changed, 0u);
+
+    // Second "A" moved: a single record is patched and the string table stays as it was
+    windows[1].x = -100;
+    auto moved = DeskUp::Workspace::updateManifest(file, windows);
+    ASSERT_TRUE(moved.has_value());
+    EXPECT_FALSE(moved.value().rewritten);
+    EXPECT_EQ(moved.value().changed, 1u);
+
+    // The patch keeps both checksums up to date, and the patched copy was renamed over the manifest
+    EXPECT_TRUE(DeskUp::Workspace::verifyWorkspace(file).has_value());
+    EXPECT_FALSE(fs::exists(fs::path(file) += DeskUp::Workspace::ATOMIC_WRITE_SUFFIX));
+
+    auto read = DeskUp::Workspace::readManifest(file);
+    ASSERT_TRUE(read.has_value());
+    EXPECT_EQ(read.value()[0].x, 1);
+    EXPECT_EQ(read.value()[1].x, -100);
+    EXPECT_EQ(read.value()[2].x, 9);
+
+    // A new window: the manifest is rewritten
+    windows.push_back(makeWindow("C", "c.exe", 0, 0, 1, 1));
+    auto added = DeskUp::Workspace::updateManifest(file, windows);
+    ASSERT_TRUE(added.has_value());
+    EXPECT_TRUE(added.value().rewritten);
+    EXPECT_EQ(added.value().changed, 4u);
+
+    fs::remove_all(dir);
+}
+
+TEST(DeskUpWindowBackend_workspaceManifest, UpdateManifestReplacesCorruptFile){
+    fs::path dir = makeTempDir("manifest_update_corrupt");
+    fs::path file = dir / DeskUp::Workspace::MANIFEST_FILE_NAME;
+    std::ofstream(file.string(), std::ios::binary) << "garbage";
+
+    auto res = DeskUp::Workspace::updateManifest(file, { makeWindow("A", "a.exe", 1, 2, 3, 4) });
+    ASSERT_TRUE(res.has_value());
+    EXPECT_TRUE(res.value().rewritten);
+
+    auto read = DeskUp::Workspace::readManifest(file);
+    ASSERT_TRUE(read.has_value());
+    EXPECT_EQ(read.value().size(), 1u);
+
+    fs::remove_all(dir);
+}
+
+TEST(DeskUpWindowBackend_workspaceManifest, MappedWorkspaceErrors){
+    fs::path dir = makeTempDir("mapped_errors");
+
+    auto missing = DeskUp::Workspace::MappedWorkspace::open(dir / "nope.deskup");
+    ASSERT_FALSE(missing.has_value());
+    EXPECT_EQ(missing.error().type(), DeskUp::ErrType::FileNotFound);
+
+    fs::path empty = dir / "empty.deskup";
+    std::ofstream(empty.string()).close();
+
+    auto truncated = DeskUp::Workspace::MappedWorkspace::open(empty);
+    ASSERT_FALSE(truncated.has_value());
+    EXPECT_EQ(truncated.error().type(), DeskUp::ErrType::CorruptedData);
+
+    fs::remove_all(dir);
+}
+
+// Bit-by-bit reference of the Castagnoli CRC, to check the fast kernels against
+static std::uint32_t referenceCrc32c(std::string_view bytes){
+    std::uint32_t crc = 0xFFFFFFFFu;
+    for (unsigned char c : bytes) {
+        crc ^= c;
+        for (int i = 0; i < 8; ++i) {
+            crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+TEST(DeskUpWindowBackend_crc32c, KnownValues){
+    EXPECT_EQ(DeskUp::Workspace::crc32c(std::string_view("")), 0u);
+    EXPECT_EQ(DeskUp::Workspace::crc32c(std::string_view("123456789")), 0xE3069283u);
+    EXPECT_EQ(DeskUp::Workspace::crc32c(std::string(32, '\0')), 0x8A9136AAu);
+}
+
+TEST(DeskUpWindowBackend_crc32c, MatchesReferenceAtEveryLengthAndAlignment){
+    std::string data(300, '\0');
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<char>(i * 31 + 7);
+    }
+
+    // Covers the 8-byte main loop, the byte tail and unaligned starts
+    for (std::size_t offset = 0; offset < 8; ++offset) {
+        for (std::size_t len = 0; len + offset <= 70; ++len) {
+            std::string_view slice = std::string_view(data).substr(offset, len);
+            ASSERT_EQ(DeskUp::Workspace::crc32c(slice), referenceCrc32c(slice)) << "offset " << offset << " length " << len;
+        }
+    }
+
+    // Chaining gives the checksum of the concatenation
+    std::string_view all(data);
+    EXPECT_EQ(DeskUp::Workspace::crc32c(all.substr(123), DeskUp::Workspace::crc32c(all.substr(0, 123))), DeskUp::Workspace::crc32c(all));
+}
+
+TEST(DeskUpWindowBackend_workspaceManifest, VerifyAcceptsIntactManifest){
+    std::string image = DeskUp::Workspace::encodeManifest({
+        makeWindow("A", "a.exe", 1, 2, 3, 4),
+        makeWindow("B", "b.exe", 5, 6, 7, 8)
+    });
+
+    EXPECT_TRUE(DeskUp::Workspace::verifyManifest(image).has_value());
+    EXPECT_TRUE(DeskUp::Workspace::verifyManifest(DeskUp::Workspace::encodeManifest({})).has_value());
+}
+
+TEST(DeskUpWindowBackend_workspaceManifest, VerifyFindsDamagedRecord){
+    using namespace DeskUp::Workspace;
+    std::string image = encodeManifest({
+        makeWindow("A", "a.exe", 1, 2, 3, 4),
+        makeWindow("B", "b.exe", 5, 6, 7, 8)
+    });
+
+    // Flip a geometry bit of the second record
+    std::string geometry = image;
+    geometry[sizeof(ManifestHeader) + sizeof(ManifestRecord) + offsetof(ManifestRecord, w)] ^= 0x10;
+
+    auto res = verifyManifest(geometry);
+    ASSERT_FALSE(res.has_value());
+    EXPECT_EQ(res.error().type(), DeskUp::ErrType::CorruptedData);
+    EXPECT_NE(std::string(res.error().what()).find("bad_record_1"), std::string::npos) << res.error().what();
+
+    // Decoding refuses it too, instead of handing back a wrong window
+    EXPECT_FALSE(decodeManifest(geometry).has_value());
+
+    WorkspaceView view = WorkspaceView::fromBytes(geometry).value();
+    EXPECT_TRUE(view.intact(0));
+    EXPECT_FALSE(view.intact(1));
+
+    // A damaged string belongs to the records pointing at it
+    std::string strings = image;
+    strings[strings.size() - 1] ^= 0x01;
+    auto stringRes = verifyManifest(strings);
+    ASSERT_FALSE(stringRes.has_value());
+    EXPECT_NE(std::string(stringRes.error().what()).find("bad_record_1"), std::string::npos) << stringRes.error().what();
+
+    // Records intact, header not
+    std::string header = image;
+    header[offsetof(ManifestHeader, reserved)] ^= 0x01;
+    auto headerRes = verifyManifest(header);
+    ASSERT_FALSE(headerRes.has_value());
+    EXPECT_NE(std::string(headerRes.error().what()).find("bad_checksum"), std::string::npos) << headerRes.error().what();
+}
+
+TEST(DeskUpWindowBackend_workspaceManifest, VersionOneManifestIsStillRead){
+    using namespace DeskUp::Workspace;
+
+    // Rebuild the image the way version 1 wrote it: 32-byte records and no checksums
+    std::string v2 = encodeManifest({ makeWindow("A", "a.exe", 1, 2, 3, 4), makeWindow("B", "b.exe", 5, 6, 7, 8) });
+    ManifestHeader header;
+    std::memcpy(&header, v2.data(), sizeof(header));
+
+    std::string v1(sizeof(ManifestHeader), '\0');
+    for (std::uint32_t i = 0; i < header.recordCount; ++i) {
+        v1.append(v2, sizeof(ManifestHeader) + i * sizeof(ManifestRecord), MANIFEST_V1_RECORD_SIZE);
+    }
+    const std::uint32_t stringsOffset = static_cast<std::uint32_t>(v1.size());
+    v1.append(v2, header.stringsOffset, header.stringsSize);
+
+    header.version = 1;
+    header.recordSize = MANIFEST_V1_RECORD_SIZE;
+    header.stringsOffset = stringsOffset;
+    header.checksum = 0;
+    std::memcpy(v1.data(), &header, sizeof(header));
+
+    auto decoded = decodeManifest(v1);
+    ASSERT_TRUE(decoded.has_value()) << decoded.error().what();
+    ASSERT_EQ(decoded.value().size(), 2u);
+    EXPECT_EQ(decoded.value()[1].name, "B");
+    EXPECT_EQ(decoded.value()[1].h, 8);
+
+    // Only the structure can be checked
+    EXPECT_TRUE(verifyManifest(v1).has_value());
+}
+
+TEST(DeskUpWindowBackend_workspaceManifest, VerifyWorkspaceFile){
+    fs::path dir = makeTempDir("verify_file");
+    fs::path file = dir / DeskUp::Workspace::MANIFEST_FILE_NAME;
+
+    ASSERT_TRUE(DeskUp::Workspace::writeManifest(file, { makeWindow("A", "a.exe", 1, 2, 3, 4) }).has_value());
+    EXPECT_TRUE(DeskUp::Workspace::verifyWorkspace(file).has_value());
+
+    // Damage a byte on disk
+    {
+        std::fstream f(file, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(sizeof(DeskUp::Workspace::ManifestHeader) + 1);
+        f.put('\x7F');
+    }
+
+    auto res = DeskUp::Workspace::verifyWorkspace(file);
+    ASSERT_FALSE(res.has_value());
+    EXPECT_EQ(res.error().type(), DeskUp::ErrType::CorruptedData);
+
+    // Saving over it repairs it
+    auto repaired = DeskUp::Workspace::updateManifest(file, { makeWindow("A", "a.exe", 1, 2, 3, 4) });
+    ASSERT_TRUE(repaired.has_value());
+    EXPECT_TRUE(repaired.value().rewritten);
+    EXPECT_TRUE(DeskUp::Workspace::verifyWorkspace(file).has_value());
+
+    fs::remove_all(dir);
+}
+
+TEST(DeskUpWindowBackend_workspaceManifest, StreamWriterMatchesEncoder){
+    fs::path dir = makeTempDir("stream_writer");
+    fs::path file = dir / "ws.deskup";
+
+    std::vector<windowDesc> windows{
+        windowDesc{"a", 1, 2, 3, 4, "app.exe"},
+        windowDesc{"b", -5, 6, 7, 8, "other.exe"},
+        windowDesc{"a", 9, 10, 11, 12, "app.exe"}
+    };
+
+    auto writer = DeskUp::Workspace::ManifestStreamWriter::open(file);
+    ASSERT_TRUE(writer.has_value());
+    for (const auto& w : windows) {
+        ASSERT_TRUE(writer->append(w).has_value());
+    }
+    EXPECT_EQ(writer->size(), 3u);
+    ASSERT_TRUE(writer->finish().has_value());
+
+    // Streaming must produce the exact same bytes as encoding the whole workspace at once
+    std::ifstream in(file, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(bytes, DeskUp::Workspace::encodeManifest(windows));
+
+    fs::remove_all(dir);
+}
+
+TEST(DeskUpWindowBackend_workspaceManifest, UnfinishedStreamIsRejected){
+    fs::path dir = makeTempDir("stream_unfinished");
+    fs::path file = dir / "ws.deskup";
+
+    {
+        auto writer = DeskUp::Workspace::ManifestStreamWriter::open(file);
+        ASSERT_TRUE(writer.has_value());
+        ASSERT_TRUE(writer->append(windowDesc{"a", 1, 2, 3, 4, "app.exe"}).has_value());
+        // Dropped without finish(), as an interrupted save would be
+    }
+
+    auto read = DeskUp::Workspace::readManifest(file);
+    ASSERT_FALSE(read.has_value());
+    EXPECT_EQ(read.error().type(), DeskUp::ErrType::InvalidFormat);
+
+    fs::remove_all(dir);
+}
+
+TEST(DeskUpWindowBackend_workspaceWriter, EveryDurabilityWritesTheSameManifest){
+    fs::path dir = makeTempDir("writer_modes");
+
+    const std::vector<windowDesc> windows = {
+        windowDesc{"a", 1, 2, 3, 4, "a.exe"},
+        windowDesc{"b", 5, 6, 7, 8, "b.exe"}
+    };
+
+    for (auto mode : {DeskUp::Workspace::Durability::None, DeskUp::Workspace::Durability::Fsync, DeskUp::Workspace::Durability::AtomicRename}) {
+        fs::path file = dir / ("ws" + std::to_string(static_cast<int>(mode)) + ".deskup");
+
+        DeskUp::Workspace::WorkspaceWriter writer(mode);
+        EXPECT_EQ(writer.durability(), mode);
+        writer.add(windows[0]);
+        writer.add(std::vector<windowDesc>{windows[1]});
+        EXPECT_EQ(writer.size(), 2u);
+
+        // Nothing is written before commit
+        EXPECT_FALSE(fs::exists(file));
+
+        auto res = writer.commit(file);
+        ASSERT_TRUE(res.has_value()) << res.error().what();
+
+        std::ifstream in(file, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        EXPECT_EQ(bytes, DeskUp::Workspace::encodeManifest(windows));
+    }
+
+    fs::remove_all(dir);
+}
+
+TEST(DeskUpWindowBackend_workspaceWriter, AtomicRenameReplacesWithoutLeftovers){
+    fs::path dir = makeTempDir("writer_atomic");
+    fs::path file = dir / "ws.deskup";
+    fs::path temporary = file;
+    temporary += DeskUp::Workspace::ATOMIC_WRITE_SUFFIX;
+
+    ASSERT_TRUE(DeskUp::Workspace::writeDurably(file, "old contents that are longer", DeskUp::Workspace::Durability::AtomicRename).has_value());
+    ASSERT_TRUE(DeskUp::Workspace::writeDurably(file, "new", DeskUp::Workspace::Durability::AtomicRename).has_value());
+
+    std::ifstream in(file, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(bytes, "new");
+    EXPECT_FALSE(fs::exists(temporary));
+
+    fs::remove_all(dir);
+}
+
+TEST(DeskUpWindowBackend_workspaceWriter, FailuresAreReported){
+    fs::path dir = makeTempDir("writer_fail");
+    fs::path missing = dir / "missing" / "ws.deskup";
+
+    auto empty = DeskUp::Workspace::writeDurably("", "x", DeskUp::Workspace::Durability::Fsync);
+    ASSERT_FALSE(empty.has_value());
+    EXPECT_EQ(empty.error().type(), DeskUp::ErrType::InvalidInput);
+
+    for (auto mode : {DeskUp::Workspace::Durability::None, DeskUp::Workspace::Durability::Fsync, DeskUp::Workspace::Durability::AtomicRename}) {
+        DeskUp::Workspace::WorkspaceWriter writer(mode);
+        writer.add(windowDesc{"a", 1, 2, 3, 4, "a.exe"});
+
+        auto res = writer.commit(missing);
+        ASSERT_FALSE(res.has_value());
+        EXPECT_EQ(res.error().type(), DeskUp::ErrType::FileNotFound);
+    }
+
+    fs::remove_all(dir);
+}
+
+TEST(DeskUpWindowBackend_workspaceReclaimer, RetireThenReclaim){
+    fs::path root = makeTempDir("reclaimer_retire");
+    fs::create_directories(root / "ws" / "nested");
+    std::ofstream(root / "ws" / "nested" / "file") << "data";
+
+    auto retired = DeskUp::Workspace::retire(root / "ws");
+    ASSERT_TRUE(retired.has_value());
+    EXPECT_FALSE(fs::exists(root / "ws"));
+    EXPECT_TRUE(fs::exists(retired.value()));
+    EXPECT_TRUE(DeskUp::Workspace::isRetired(retired.value().filename().string()));
+
+    // Retiring the same name again never collides
+    fs::create_directories(root / "ws");
+    auto again = DeskUp::Workspace::retire(root / "ws");
+    ASSERT_TRUE(again.has_value());
+    EXPECT_NE(again.value(), retired.value());
+
+    EXPECT_FALSE(DeskUp::Workspace::retire(root / "missing").has_value());
+
+    DeskUp::Workspace::WorkspaceReclaimer reclaimer;
+    reclaimer.reclaim(retired.value());
+    reclaimer.reclaim(again.value());
+    reclaimer.drain();
+
+    EXPECT_EQ(reclaimer.pending(), 0u);
+    EXPECT_TRUE(fs::is_empty(root));
+
+    fs::remove_all(root);
+}
+
+TEST(DeskUpWindowBackend_workspaceReclaimer, LeftoversAreReclaimedAndDestructorFinishes){
+    fs::path root = makeTempDir("reclaimer_leftovers");
+    fs::create_directories(root / (std::string(DeskUp::Workspace::RETIRED_PREFIX) + "1-0-old"));
+    std::ofstream(root / (std::string(DeskUp::Workspace::RETIRED_PREFIX) + "1-1-file")) << "data";
+    fs::create_directories(root / "kept");
+
+    {
+        DeskUp::Workspace::WorkspaceReclaimer reclaimer;
+        EXPECT_EQ(DeskUp::Workspace::reclaimRetired(root, reclaimer), 2u);
+        // Destroyed without drain(): pending deletions still run
+    }
+
+    EXPECT_TRUE(fs::exists(root / "kept"));
+    EXPECT_EQ(std::distance(fs::directory_iterator(root), fs::directory_iterator()), 1);
+
+    fs::remove_all(root);
+}
+
+TEST(DeskUpWindowBackend_workspaceStore, PutGetRemoveAndReopen){
+    fs::path dir = makeTempDir("store_basic");
+    fs::path file = dir / DeskUp::Workspace::STORE_FILE_NAME;
+    fs::remove(file);
+
+    const std::string first = DeskUp::Workspace::encodeManifest({windowDesc{"a", 1, 2, 3, 4, "a.exe"}});
+    const std::string second = DeskUp::Workspace::encodeManifest({windowDesc{"b", 5, 6, 7, 8, "b.exe"}});
+
+    {
+        auto store = DeskUp::Workspace::WorkspaceStore::open(file);
+        ASSERT_TRUE(store.has_value()) << store.error().what();
+        EXPECT_EQ(store->size(), 0u);
+
+        ASSERT_TRUE(store->put("work", first).has_value());
+        ASSERT_TRUE(store->put("home", second).has_value());
+        ASSERT_TRUE(store->put("work", second).has_value());
+
+        EXPECT_TRUE(store->contains("work"));
+        EXPECT_EQ(store->names(), (std::vector<std::string>{"home", "work"}));
+
+        auto got = store->get("work");
+        ASSERT_TRUE(got.has_value());
+        EXPECT_EQ(got.value(), second);
+
+        // Only the header of the latest manifest
+        auto header = store->header("work");
+        ASSERT_TRUE(header.has_value());
+        EXPECT_EQ(std::memcmp(&header.value(), second.data(), sizeof(DeskUp::Workspace::ManifestHeader)), 0);
+
+        auto removed = store->remove("home");
+        ASSERT_TRUE(removed.has_value());
+        EXPECT_TRUE(removed.value());
+
+        removed = store->remove("home");
+        ASSERT_TRUE(removed.has_value());
+        EXPECT_FALSE(removed.value());
+
+        auto missing = store->get("home");
+        ASSERT_FALSE(missing.has_value());
+        EXPECT_EQ(missing.error().type(), DeskUp::ErrType::NotFound);
+
+        EXPECT_FALSE(store->put("", first).has_value());
+    }
+
+    // The index is rebuilt from the log
+    auto reopened = DeskUp::Workspace::WorkspaceStore::open(file);
+    ASSERT_TRUE(reopened.has_value());
+    EXPECT_EQ(reopened->names(), std::vector<std::string>{"work"});
+    EXPECT_EQ(reopened->get("work").value(), second);
+    EXPECT_GT(reopened->dead(), 0u);
+
+    fs::remove_all(dir);
+}
+
+TEST(DeskUpWindowBackend_workspaceStore, TornTailIsCutOff){
+    fs::path dir = makeTempDir("store_torn");
+    fs::path file = dir / DeskUp::Workspace::STORE_FILE_NAME;
+    fs::remove(file);
+
+    const std::string manifest = DeskUp::Workspace::encodeManifest({windowDesc{"a", 1, 2, 3, 4, "a.exe"}});
+    std::uintmax_t committed;
+
+    {
+        auto store = DeskUp::Workspace::WorkspaceStore::open(file);
+        ASSERT_TRUE(store.has_value());
+        ASSERT_TRUE(store->put("kept", manifest).has_value());
+        committed = fs::file_size(file);
+        ASSERT_TRUE(store->put("torn", manifest).has_value());
+    }
+
+    // Cut the last entry in half, as a crash during the append would
+    fs::resize_file(file, committed + 20);
+
+    auto store = DeskUp::Workspace::WorkspaceStore::open(file);
+    ASSERT_TRUE(store.has_value());
+    EXPECT_EQ(store->names(), std::vector<std::string>{"kept"});
+    EXPECT_EQ(fs::file_size(file), committed);
+
+    // Appends go right after the last valid entry
+    ASSERT_TRUE(store->put("next", manifest).has_value());
+    auto reopened = DeskUp::Workspace::WorkspaceStore::open(file);
+    ASSERT_TRUE(reopened.has_value());
+    EXPECT_EQ(reopened->names(), (std::vector<std::string>{"kept", "next"}));
+
+    fs::remove_all(dir);
+}
+
+TEST(DeskUpWindowBackend_workspaceStore, RejectsForeignFile){
+    fs::path dir = makeTempDir("store_foreign");
+    fs::path file = dir / DeskUp::Workspace::STORE_FILE_NAME;
+    std::ofstream(file, std::ios::binary) << "definitely not a workspace log";
+
+    auto store = DeskUp::Workspace::WorkspaceStore::open(file);
+    ASSERT_FALSE(store.has_value());
+    EXPECT_EQ(store.error().type(), DeskUp::ErrType::InvalidFormat);
+
+    fs::remove_all(dir);
+}
+
+TEST(DeskUpWindowBackend_workspaceStore, CompactionKeepsLiveWorkspaces){
+    fs::path dir = makeTempDir("store_compact");
+    fs::path file = dir / DeskUp::Workspace::STORE_FILE_NAME;
+    fs::remove(file);
+
+    std::vector<windowDesc> windows;
+    for (int i = 0; i < 50; i++) {
+        windows.push_back(windowDesc{"w" + std::to_string(i), i, i, 10, 10, "app" + std::to_string(i) + ".exe"});
+    }
+    const std::string manifest = DeskUp::Workspace::encodeManifest(windows);
+
+    auto store = DeskUp::Workspace::WorkspaceStore::open(file);
+    ASSERT_TRUE(store.has_value());
+    ASSERT_TRUE(store->put("other", manifest).has_value());
+
+    // Saving the same workspace over and over leaves dead entries behind, until the log compacts itself
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TRUE(store->put("busy", manifest).has_value());
+        EXPECT_FALSE(store->needsCompaction());
+    }
+
+    EXPECT_LT(fs::file_size(file), 4 * store->live() + DeskUp::Workspace::STORE_COMPACTION_MIN_DEAD);
+
+    ASSERT_TRUE(store->compact().has_value());
+    EXPECT_EQ(store->dead(), 0u);
+    EXPECT_EQ(fs::file_size(file), sizeof(DeskUp::Workspace::StoreHeader) + store->live());
+    EXPECT_FALSE(fs::exists(fs::path(file) += DeskUp::Workspace::ATOMIC_WRITE_SUFFIX));
+    EXPECT_EQ(store->get("other").value(), manifest);
+    EXPECT_EQ(store->get("busy").value(), manifest);
+
+    auto reopened = DeskUp::Workspace::WorkspaceStore::open(file);
+    ASSERT_TRUE(reopened.has_value());
+    EXPECT_EQ(reopened->names(), (std::vector<std::string>{"busy", "other"}));
+
+    fs::remove_all(dir);
+}
+
+TEST(DeskUpWindowBackend_workspaceStore, StreamedPutOnlyCountsOnceCommitted){
+    fs::path dir = makeTempDir("store_stream");
+    fs::path file = dir / DeskUp::Workspace::STORE_FILE_NAME;
+    fs::remove(file);
+
+    const std::vector<windowDesc> windows = {
+        windowDesc{"a", 1, 2, 3, 4, "a.exe"},
+        windowDesc{"b", 5, 6, 7, 8, "b.exe"}
+    };
+
+    {
+        auto store = DeskUp::Workspace::WorkspaceStore::open(file);
+        ASSERT_TRUE(store.has_value());
+
+        // Never committed, as an interrupted save would be
+        auto abandoned = store->beginPut("abandoned");
+        ASSERT_TRUE(abandoned.has_value());
+        ASSERT_TRUE(abandoned->append(windows[0]).has_value());
+    }
+
+    auto store = DeskUp::Workspace::WorkspaceStore::open(file);
+    ASSERT_TRUE(store.has_value());
+    EXPECT_EQ(store->size(), 0u);
+    EXPECT_EQ(fs::file_size(file), sizeof(DeskUp::Workspace::StoreHeader));
+
+    auto writer = store->beginPut("streamed");
+    ASSERT_TRUE(writer.has_value());
+    for (const auto& w : windows) {
+        ASSERT_TRUE(writer->append(w).has_value());
+    }
+    EXPECT_FALSE(store->commit("other", writer.value()).has_value());
+    ASSERT_TRUE(store->commit("streamed", writer.value()).has_value());
+
+    // Same bytes as a manifest encoded at once
+    EXPECT_EQ(store->get("streamed").value(), DeskUp::Workspace::encodeManifest(windows));
+
+    auto reopened = DeskUp::Workspace::WorkspaceStore::open(file);
+    ASSERT_TRUE(reopened.has_value());
+    EXPECT_EQ(reopened->get("streamed").value(), DeskUp::Workspace::encodeManifest(windows));
+
+    fs::remove_all(dir);
+}
+
+TEST(DeskUpWindowBackend_workspaceStore, DurablePutsSurviveReopen){
+    fs::path dir = makeTempDir("store_durable");
+    fs::path file = dir / DeskUp::Workspace::STORE_FILE_NAME;
+    fs::remove(file);
+
+    const std::string manifest = DeskUp::Workspace::encodeManifest({windowDesc{"a", 1, 2, 3, 4, "a.exe"}});
+
+    {
+        auto store = DeskUp::Workspace::WorkspaceStore::open(file);
+        ASSERT_TRUE(store.has_value());
+        ASSERT_TRUE(store->put("none", manifest, DeskUp::Workspace::Durability::None).has_value());
+        ASSERT_TRUE(store->put("fsync", manifest, DeskUp::Workspace::Durability::Fsync).has_value());
+        ASSERT_TRUE(store->put("atomic", manifest, DeskUp::Workspace::Durability::AtomicRename).has_value());
+
+        auto writer = store->beginPut("streamed");
+        ASSERT_TRUE(writer.has_value());
+        ASSERT_TRUE(writer->append(windowDesc{"a", 1, 2, 3, 4, "a.exe"}).has_value());
+        ASSERT_TRUE(store->commit("streamed", writer.value(), DeskUp::Workspace::Durability::AtomicRename).has_value());
+    }
+
+    auto reopened = DeskUp::Workspace::WorkspaceStore::open(file);
+    ASSERT_TRUE(reopened.has_value());
+    EXPECT_EQ(reopened->names(), (std::vector<std::string>{"atomic", "fsync", "none", "streamed"}));
+    for (const auto& name : reopened->names()) {
+        EXPECT_EQ(reopened->get(name).value(), manifest);
+    }
+
+    fs::remove_all(dir);
+}
+
+TEST(DeskUpWindowBackend_workspaceStore, ImportsWorkspaceDirectories){
+    fs::path root = makeTempDir("store_import");
+    fs::path file = root / DeskUp::Workspace::STORE_FILE_NAME;
+    fs::remove(file);
+
+    const std::vector<windowDesc> windows = {windowDesc{"a", 1, 2, 3, 4, "a.exe"}};
+
+    fs::create_directories(root / "manifestWS");
+    ASSERT_TRUE(DeskUp::Workspace::writeManifest(root / "manifestWS" / DeskUp::Workspace::MANIFEST_FILE_NAME, windows).has_value());
+
+    fs::create_directories(root / "legacyWS");
+    std::ofstream(root / "legacyWS" / "old") << "old.exe\n1\n2\n3\n4";
+
+    // Can't be loaded, so it stays where it is
+    fs::create_directories(root / "brokenWS");
+    std::ofstream(root / "brokenWS" / "bad") << "bad.exe\nnot a number";
+
+    auto store = DeskUp::Workspace::WorkspaceStore::open(file);
+    ASSERT_TRUE(store.has_value());
+
+    auto imported = DeskUp::Workspace::importWorkspaceDirectories(store.value(), root);
+    ASSERT_TRUE(imported.has_value());
+    EXPECT_EQ(imported.value().imported, 2u);
+    ASSERT_EQ(imported.value().skipped.size(), 1u);
+    EXPECT_EQ(imported.value().skipped[0].first, "brokenWS");
+
+    EXPECT_EQ(store->names(), (std::vector<std::string>{"legacyWS", "manifestWS"}));
+    EXPECT_EQ(store->get("manifestWS").value(), DeskUp::Workspace::encodeManifest(windows));
+
+    auto legacy = DeskUp::Workspace::decodeManifest(store->get("legacyWS").value());
+    ASSERT_TRUE(legacy.has_value());
+    ASSERT_EQ(legacy.value().size(), 1u);
+    EXPECT_EQ(legacy.value()[0].pathToExec, fs::path("old.exe"));
+    EXPECT_EQ(legacy.value()[0].h, 4);
+
+    EXPECT_FALSE(fs::exists(root / "manifestWS"));
+    EXPECT_FALSE(fs::exists(root / "legacyWS"));
+    EXPECT_TRUE(fs::exists(root / "brokenWS"));
+
+    fs::remove_all(root);
+}
+
+TEST(DeskUpWindowBackend_boundedQueue, KeepsOrderAndDrainsAfterClose){
+    BoundedQueue<int> queue(4);
+    EXPECT_TRUE(queue.push(1));
+    EXPECT_TRUE(queue.push(2));
+    queue.close();
+
+    EXPECT_TRUE(queue.isClosed());
+    EXPECT_FALSE(queue.push(3)) << "A closed queue rejects producers";
+    EXPECT_EQ(queue.pop(), 1);
+    EXPECT_EQ(queue.pop(), 2);
+    EXPECT_EQ(queue.pop(), std::nullopt);
+}
+
+TEST(DeskUpWindowBackend_boundedQueue, ProducerBlocksWhileFull){
+    BoundedQueue<int> queue(2);
+    std::vector<int> received;
+
+    std::thread consumer([&]{
+        while (auto v = queue.pop()) {
+            received.push_back(*v);
+        }
+    });
+
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(queue.push(i));
+    }
+    queue.close();
+    consumer.join();
+
+    ASSERT_EQ(received.size(), 100u);
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(received[i], i);
+    }
+}
+
+TEST(DeskUpWindowBackend_boundedQueue, CloseWakesBlockedProducer){
+    BoundedQueue<int> queue(1);
+    ASSERT_TRUE(queue.push(0));
+
+    std::thread closer([&]{
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        queue.close();
+    });
+
+    // Blocks until the other thread closes the queue
+    EXPECT_FALSE(queue.push(1));
+    closer.join();
+}
+
 #ifdef _WIN32
 TEST(DeskUpWindowBackend_backendUtils, UTF8ToWideRoundtripSimple){
     std::string utf8 = "caf\u00E9"; // café
@@ -216,7 +1234,7 @@ protected:
         ASSERT_NE(s_atom, (ATOM)0) << "Failed to register window class";
 
         // Initialize device FIRST (before creating test window)
-        // This ensures desk_up_hwnd doesn't point to our test window
+        // This ensures the DeskUp HWND of the device doesn't point to our test window
         device = WIN_CreateDevice();
         ASSERT_NE(device.internalData, nullptr);
 
@@ -240,9 +1258,6 @@ protected:
 
         // Small message pump to let window manager process show request
         ProcessEvents();
-
-        // Set our test window as the active window in the device
-        WIN_TEST_setHWND(&device, hwnd);
     }
 
     void TearDown() override {
@@ -262,10 +1277,10 @@ ATOM Win32WindowFixture::s_atom = 0;
 
 TEST_F(Win32WindowFixture, GetWindowGeometry) {
     // Get geometry via backend functions
-    auto x_res = WIN_getWindowXPos(&device);
-    auto y_res = WIN_getWindowYPos(&device);
-    auto w_res = WIN_getWindowWidth(&device);
-    auto h_res = WIN_getWindowHeight(&device);
+    auto x_res = WIN_getWindowXPos(&device, hwnd);
+    auto y_res = WIN_getWindowYPos(&device, hwnd);
+    auto w_res = WIN_getWindowWidth(&device, hwnd);
+    auto h_res = WIN_getWindowHeight(&device, hwnd);
 
     ASSERT_TRUE(x_res.has_value()) << "Failed to get X position";
     ASSERT_TRUE(y_res.has_value()) << "Failed to get Y position";
@@ -292,10 +1307,30 @@ TEST_F(Win32WindowFixture, GetWindowGeometry) {
     EXPECT_GT(h, 0u);
 }
 
+TEST_F(Win32WindowFixture, GetWindowGeometryInOneQuery) {
+    auto geometry = WIN_getWindowGeometry(&device, hwnd);
+    ASSERT_TRUE(geometry.has_value()) << "Failed to get geometry";
+
+    RECT r{};
+    ASSERT_TRUE(GetWindowRect(hwnd, &r));
+    EXPECT_EQ(geometry->x, static_cast<int>(r.left));
+    EXPECT_EQ(geometry->y, static_cast<int>(r.top));
+    EXPECT_EQ(geometry->w, static_cast<unsigned>(r.right - r.left));
+    EXPECT_EQ(geometry->h, static_cast<unsigned>(r.bottom - r.top));
+
+    // A closed window doesn't fail the rest of the batch
+    auto batch = WIN_getWindowsGeometry(&device, {hwnd, nullptr});
+    ASSERT_TRUE(batch.has_value());
+    ASSERT_EQ(batch->size(), 2u);
+    ASSERT_TRUE((*batch)[0].has_value());
+    EXPECT_EQ((*batch)[0]->w, geometry->w);
+    EXPECT_FALSE((*batch)[1].has_value());
+}
+
 TEST_F(Win32WindowFixture, ResizeWindowChangesRect) {
     // Request a specific geometry
     windowDesc wd{"TestResize", 200, 250, 640, 480, ""};
-    auto status = WIN_resizeWindow(&device, wd);
+    auto status = WIN_resizeWindow(&device, hwnd, wd);
     ASSERT_TRUE(status.has_value()) << "WIN_resizeWindow failed";
 
     // Allow window manager to process
@@ -322,8 +1357,44 @@ TEST_F(Win32WindowFixture, ResizeWindowChangesRect) {
     EXPECT_NEAR(actual_h, wd.h, 40) << "Height mismatch (title bar + borders)";
 }
 
+TEST_F(Win32WindowFixture, ApplyLayoutMovesEveryWindowAtOnce) {
+    HWND other = CreateExtraWindow(L"DeskUpLayoutWindow", 50, 60, 400, 300);
+    ASSERT_NE(other, nullptr);
+
+    std::vector<windowPlacement> layout{
+        {hwnd, windowGeometry{200, 250, 640, 480}},
+        {other, windowGeometry{300, 350, 500, 400}},
+        {nullptr, windowGeometry{0, 0, 100, 100}},
+    };
+
+    auto results = WIN_applyLayout(&device, layout);
+    ASSERT_TRUE(results.has_value()) << "WIN_applyLayout failed";
+    ASSERT_EQ(results->size(), 3u);
+    EXPECT_TRUE((*results)[0].has_value());
+    EXPECT_TRUE((*results)[1].has_value());
+    ASSERT_FALSE((*results)[2].has_value()) << "A missing window only fails its own placement";
+    EXPECT_EQ((*results)[2].error().type(), DeskUp::ErrType::InvalidInput);
+
+    ProcessEvents();
+
+    for (std::size_t i = 0; i < 2; ++i) {
+        RECT r{};
+        ASSERT_TRUE(GetWindowRect(static_cast<HWND>(layout[i].window), &r));
+        EXPECT_NEAR(r.left, layout[i].geometry.x, 10);
+        EXPECT_NEAR(r.top, layout[i].geometry.y, 10);
+        EXPECT_NEAR(r.right - r.left, static_cast<int>(layout[i].geometry.w), 20);
+        EXPECT_NEAR(r.bottom - r.top, static_cast<int>(layout[i].geometry.h), 40);
+    }
+
+    // Applying the same layout again leaves the windows alone
+    auto again = WIN_applyLayout(&device, std::span(layout).first(2));
+    ASSERT_TRUE(again.has_value());
+    EXPECT_TRUE((*again)[0].has_value());
+    EXPECT_TRUE((*again)[1].has_value());
+}
+
 TEST_F(Win32WindowFixture, GetPathFromWindowIsCurrentProcess) {
-    auto path_res = WIN_getPathFromWindow(&device);
+    auto path_res = WIN_getPathFromWindow(&device, hwnd);
     ASSERT_TRUE(path_res.has_value()) << "Failed to get path from window";
 
     std::string path = path_res.value().string();
@@ -439,11 +1510,11 @@ TEST_F(Win32WindowFixture, EnumerateWindows_SkipsDeskUpGlobalWindow) {
     HWND special = CreateExtraWindow(L"DeskUpGlobalSkip", 413, 457, 321, 123, true);
     ASSERT_NE(special, nullptr);
 
-    // Create a new device AFTER creation to refresh the global 'desk_up_hwnd'
+    // Create a new device AFTER creation, so that the special window is its DeskUp HWND
     auto dev2 = WIN_CreateDevice();
-    (void)dev2;
 
-    auto res = WIN_getAllOpenWindows(&device);
+    auto res = WIN_getAllOpenWindows(&dev2);
+    WIN_destroyDevice(&dev2);
     ASSERT_TRUE(res.has_value());
     auto windows = res.value();
 
@@ -463,11 +1534,58 @@ TEST_F(Win32WindowFixture, EnumerateWindows_SkipsDeskUpGlobalWindow) {
     EXPECT_FALSE(foundSpecialGeometry) << "Window matching global DeskUp HWND should be skipped";
 }
 
-TEST_F(Win32WindowFixture, InvalidHWNDReturnsError) {
-    // Set an invalid HWND
-    WIN_TEST_setHWND(&device, nullptr);
+// Build with USE_SANITIZER=thread to have ThreadSanitizer check the calls share no state
+TEST_F(Win32WindowFixture, DeviceCallsFromManyThreads) {
+    std::vector<HWND> windows{hwnd};
+    for (int i = 1; i < 4; ++i) {
+        HWND w = CreateExtraWindow(L"DeskUpStressWindow", 100 + i * 50, 100, 400, 300, true);
+        ASSERT_NE(w, nullptr);
+        windows.push_back(w);
+    }
+
+    char buf[MAX_PATH]{};
+    GetModuleFileNameA(nullptr, buf, MAX_PATH);
+    const std::string ourExe = normalizePathLower(std::string(buf));
+
+    std::atomic<int> mismatches{0};
+    std::atomic<int> running{static_cast<int>(windows.size())};
+
+    // Every thread moves and queries its own window through the same device
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < windows.size(); ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 50; ++i) {
+                windowDesc target{"Stress", 100 + static_cast<int>(t) * 50 + i, 100 + i, 400 + i, 300, ""};
+                auto resized = WIN_resizeWindow(&device, windows[t], target);
+                auto geometry = WIN_getWindowGeometry(&device, windows[t]);
+                auto owner = WIN_getPathFromWindow(&device, windows[t]);
+
+                if (!resized.has_value() || !geometry.has_value() || !owner.has_value() ||
+                    std::abs(geometry->x - target.x) > 10 || normalizePathLower(owner->string()) != ourExe) {
+                    mismatches++;
+                }
+            }
+            running--;
+        });
+    }
 
-    auto x_res = WIN_getWindowXPos(&device);
+    // The windows belong to this thread, which has to keep pumping for SetWindowPos to return
+    while (running > 0) {
+        MSG msg;
+        while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE)) {
+            TranslateMessage(&msg);
+            DispatchMessageW(&msg);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    for (auto& thread : threads) thread.join();
+
+    EXPECT_EQ(mismatches.load(), 0) << "A call acted on another thread's window";
+}
+
+TEST_F(Win32WindowFixture, InvalidHWNDReturnsError) {
+    // Pass an invalid HWND
+    auto x_res = WIN_getWindowXPos(&device, nullptr);
     EXPECT_FALSE(x_res.has_value());
     ASSERT_TRUE(x_res.error().isFatal());
     EXPECT_TRUE(x_res.error().type() == DeskUp::ErrType::InvalidInput);
@@ -475,7 +1593,7 @@ TEST_F(Win32WindowFixture, InvalidHWNDReturnsError) {
 
 TEST_F(Win32WindowFixture, ResizeWithInvalidDimensionsReturnsWarning) {
     windowDesc wd{"", 100, 100, 0, 0, ""}; // zero width/height
-    auto status = WIN_resizeWindow(&device, wd);
+    auto status = WIN_resizeWindow(&device, hwnd, wd);
 
     EXPECT_FALSE(status.has_value());
     EXPECT_TRUE(status.error().level() == DeskUp::Level::Warning);
@@ -619,28 +1737,23 @@ TEST_F(Win32WindowFixture, LoadProcessFromPath_NonExistentExe) {
     EXPECT_EQ(status.error().type(), DeskUp::ErrType::FileNotFound);
 }
 
-struct windowDataMock{
-	HWND hwnd;
-};
-
 TEST_F(Win32WindowFixture, LoadProcessFromPath_SuccessWithNotepad) {
     // Launch notepad.exe which should be available on all Windows systems
     auto status = WIN_loadProcessFromPath(&device, "C:\\Windows\\notepad.exe");
 
     if (status.has_value()) {
-        // Success: a window HWND should now be set in the device
+        // Success: the launch returned the HWND of the notepad window
         // Verify we can query geometry (indicating HWND is valid)
-        auto x_res = WIN_getWindowXPos(&device);
-        auto y_res = WIN_getWindowYPos(&device);
+        auto x_res = WIN_getWindowXPos(&device, *status);
+        auto y_res = WIN_getWindowYPos(&device, *status);
 
         EXPECT_TRUE(x_res.has_value()) << "Should be able to get X position after loading process";
         EXPECT_TRUE(y_res.has_value()) << "Should be able to get Y position after loading process";
 
         // Clean up: close the launched notepad
-        // We can use WIN_closeProcessFromPath or just terminate via the device's HWND
-        auto* data = static_cast<windowDataMock*>(device.internalData);
-        if (data && data->hwnd) {
-            PostMessageA(data->hwnd, WM_CLOSE, 0, 0);
+        // We can use WIN_closeProcessFromPath or just close the returned HWND
+        if (*status) {
+            PostMessageA(static_cast<HWND>(*status), WM_CLOSE, 0, 0);
             ProcessEvents();
         }
     } else {